@@ -11,6 +11,12 @@
 //
 
 #include "App.h"
+#ifdef PIVOT_BENCHMARK
+#include "Benchmark.h"
+#endif
+#ifdef PIVOT_CONVERT_LEVELS
+#include "LevelData.h"
+#endif
 
 using namespace cugl;
 
@@ -32,6 +38,9 @@ using namespace cugl;
 void PivotApp::onStartup() {
 
     getDisplaySize();
+#ifdef CU_PROFILING
+    Profiler::start();
+#endif
 
     std::string jsonPath = "json/assets.json";
 
@@ -71,6 +80,8 @@ void PivotApp::onStartup() {
 
     Application::setVSync(false);
     Application::setFPS(80);
+    // the physics was tuned at 80 frames per second, so keep that rate fixed
+    Application::setFixedRate(80);
 
     Application::onStartup(); // YOU MUST END with call to parent
 }
@@ -94,6 +105,7 @@ void PivotApp::onShutdown() {
 
     // TODO: dispose of other modes here (ex: level select) when they are implemented
     _loading.dispose();
+    _levelLoading.dispose();
     _gameplay.dispose();
     _mainMenu.dispose();
     _levelSelect.dispose();
@@ -114,6 +126,13 @@ void PivotApp::onShutdown() {
 
     AudioEngine::stop();
 
+#ifdef CU_PROFILING
+    // the trace opens in chrome://tracing (or ui.perfetto.dev)
+    Profiler::stop();
+    Profiler::writeTrace(filetool::normalize_path(getSaveDirectory() + "profile.json"));
+    Profiler::writeSummary(filetool::normalize_path(getSaveDirectory() + "profile.csv"));
+#endif
+
     Application::onShutdown();  // YOU MUST END with call to parent
 }
 
@@ -217,6 +236,20 @@ void PivotApp::update(float timestep) {
     }
 }
 
+/**
+ * The method called to advance the simulation by a fixed amount.
+ *
+ * This is called zero or more times each frame, after update, so that the
+ * physics advances at the same rate whatever the frame rate.
+ *
+ * @param step  The length of a fixed update (in seconds)
+ */
+void PivotApp::fixedUpdate(float step) {
+    if (_scene == GAME && _gameplay.getState() == GameplayController::State::NONE) {
+        _gameplay.fixedUpdate(step);
+    }
+}
+
 /**
  * The method called to draw the application to the screen.
  *
@@ -225,8 +258,10 @@ void PivotApp::update(float timestep) {
  *
  * When overriding this method, you do not need to call the parent method
  * at all. The default implmentation does nothing.
+ *
+ * @param alpha The fraction of a fixed update since the last one
  */
-void PivotApp::draw() {
+void PivotApp::draw(float alpha) {
     switch (_scene) {
         case LOAD:
             _loading.render(_batch);
@@ -244,7 +279,11 @@ void PivotApp::draw() {
             _quitMenu.render(_batch);
             break;
         case GAME:
-            _gameplay.render(_batch);
+            if (_gameplay.isLoading()) {
+                _levelLoading.render(_batch);
+            } else {
+                _gameplay.render(_batch, alpha);
+            }
             break;
         case SETTINGS: case SETTINGSQUIT:
             _settings.render(_batch);
@@ -264,13 +303,25 @@ void PivotApp::updateLoadingScene(float timestep){
             _loading.update(timestep);
             break;
         case Loading::Status::LOADED:
+#ifdef PIVOT_BENCHMARK
+            if (!Benchmark::runAssetLoading("json/assets.json")) {
+                break;
+            }
+#endif
             _loading.dispose(); // Permanently disables the input listeners in this mode
+#ifdef PIVOT_CONVERT_LEVELS
+            CULog("Converted %d levels", LevelData::convertAll());
+#endif
+#ifdef PIVOT_BENCHMARK
+            Benchmark::runAll(_assets);
+#endif
             _mainMenu.init(_assets);
             if(_testing){ _levelSelect.initMax(_assets); }
             else{ _levelSelect.init(_assets); }
             _endMenu.init(_assets);
             _quitMenu.init(_assets);
             _gameplay.init(_assets, getDisplaySize(), _sound);
+            _levelLoading.init(_assets, [this]() { return _gameplay.getLoadProgress(); });
             if(_testing){ _gameplay.setMaxLevel(_levelSelect.getMaxLevel()); }
             _settings.init(_assets, _gameplay.getDataController());
             updateSettings();
@@ -286,6 +337,11 @@ void PivotApp::updateGameScene(float timestep){
     switch (_gameplay.getState()) {
         case GameplayController::State::NONE:
             _gameplay.update(timestep);
+            if (_gameplay.isLoading()) {
+                _levelLoading.update(timestep);
+            }
+            // the player usually goes on to the next level
+            _gameplay.prefetchLevel(_levelSelect.peekNextLevelString());
             break;
         case GameplayController::State::QUIT:
             _gameplay.setActive(false);
@@ -346,6 +402,7 @@ void PivotApp::updateLevelScene(float timestep){
     switch (_levelSelect.getChoice()) {
         case LevelSelect::Choice::NONE:
             _levelSelect.update(timestep);
+            _gameplay.prefetchLevel(_levelSelect.getLikelyLevelString());
             break;
         case LevelSelect::Choice::NEXT:
             _levelSelect.nextPack();
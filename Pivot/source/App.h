@@ -72,8 +72,8 @@ protected:
     // TODO: change this to be our loading scenes
     // TODO: add more scenes as they are created
     // Player modes
-    /** The controller for the demo loading screen */
-    PFLoadingScene _demoloading;
+    /** The loading screen shown while a level loads in the background */
+    PFLoadingScene _levelLoading;
     /** The controller for the loading screen*/
     Loading _loading;
     /** The  controller for all sound functions */
@@ -187,6 +187,16 @@ public:
      * @param timestep  The amount of time (in seconds) since the last frame
      */
     virtual void update(float timestep) override;
+
+    /**
+     * The method called to advance the simulation by a fixed amount.
+     *
+     * This is called zero or more times each frame, after update, so that
+     * the physics advances at the same rate whatever the frame rate.
+     *
+     * @param step  The length of a fixed update (in seconds)
+     */
+    virtual void fixedUpdate(float step) override;
     
     /**
      * The method called to draw the application to the screen.
@@ -197,7 +207,16 @@ public:
      * When overriding this method, you do not need to call the parent method
      * at all. The default implmentation does nothing.
      */
-    virtual void draw() override;
+    virtual void draw() override { draw(1.0f); }
+
+    /**
+     * The method called to draw the application with an interpolation factor.
+     *
+     * The gameplay scene draws the player between its last two physics steps.
+     *
+     * @param alpha The fraction of a fixed update since the last one
+     */
+    virtual void draw(float alpha) override;
     
 #pragma mark Menu Updates
 private:
@@ -0,0 +1,1334 @@
+//
+//  Benchmark.cpp
+//  Pivot
+//
+//  Timing harnesses for the performance sensitive parts of the game.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+#ifdef PIVOT_BENCHMARK
+
+#include "Benchmark.h"
+#include "Mesh.h"
+#include "PlaneController.h"
+#include "BillboardBatch.h"
+#include "FrameVisibility.h"
+#include "LightGrid.h"
+#include "TriggerIndex.h"
+#include "LevelData.h"
+#include "GameModel.h"
+#include "SoundEmitters.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+using namespace cugl;
+
+/** The number of angles each mesh is cut at */
+#define SLICE_ANGLES    360
+/** The largest distance between matching cut points, as a fraction of the mesh size */
+#define SLICE_TOLERANCE 0.0001f
+/** The number of angles each mesh is cut at for the obstacle benchmark */
+#define OBSTACLE_ANGLES 12
+/** The number of physics steps timed for each cut */
+#define OBSTACLE_STEPS  120
+/** The number of distinct billboard textures */
+#define BILLBOARD_TEXTURES  8
+/** The number of frames timed for each billboard count */
+#define BILLBOARD_FRAMES    200
+/** The side of the cube the visibility benchmark billboards are scattered over */
+#define VISIBILITY_SPREAD   3000.0f
+/** The number of plane angles each render mesh is culled at */
+#define CHUNK_ANGLES        36
+/** The number of player positions each render mesh is culled from */
+#define CHUNK_ORIGINS       8
+/** The number of frames timed for each light count */
+#define LIGHT_FRAMES        200
+/** The side of the square the benchmark lights are scattered over */
+#define LIGHT_SPREAD        4000.0f
+/** The number of frames timed for each item count */
+#define ITEM_FRAMES         200
+/** The side of the square the benchmark items are scattered over */
+#define ITEM_SPREAD         4000.0f
+/** The number of frames the player walks past the emitters */
+#define EMITTER_FRAMES      2000
+/** The side of the square the benchmark emitters are scattered over */
+#define EMITTER_SPREAD      2000.0f
+/** The number of frames the player walks across the trigger regions */
+#define TRIGGER_FRAMES      2000
+/** The number of scopes each thread times in the profiler benchmark */
+#define PROFILER_SCOPES     200000
+/** The number of threads that record alongside the main thread */
+#define PROFILER_WORKERS    3
+/** The number of tiny tasks each pool runs in the thread pool benchmark */
+#define POOL_TASKS          200000
+/** The number of threads in the larger benchmark pools */
+#define POOL_THREADS        4
+/** The number of indices in each parallelFor chunk */
+#define POOL_GRAIN          64
+/** The number of keys in the synthetic object of the JSON lookup benchmark */
+#define JSON_KEYS           10000
+/** The number of times each file is parsed in the JSON parsing benchmark */
+#define JSON_PARSE_RUNS     10
+/** The smallest level file (in bytes) timed by the JSON parsing benchmark */
+#define JSON_PARSE_MINIMUM  65536
+
+/**
+ * Returns the paths of every file in the mesh directory with the given suffix
+ *
+ * @param suffix    The end of the file name (e.g. "_col.obj")
+ */
+static std::vector<std::string> meshFiles(const std::string& suffix) {
+    std::vector<std::string> result;
+    std::string root = filetool::join_path({ Application::get()->getAssetDirectory(), "meshes" });
+    for (auto& pack : filetool::dir_contents(root)) {
+        if (!filetool::is_dir(pack)) {
+            continue;
+        }
+        for (auto& file : filetool::dir_contents(pack)) {
+            if (file.size() >= suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                result.push_back(file);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * Returns the average position of the mesh vertices
+ *
+ * @param mesh  The mesh
+ */
+static Vec3 meshCenter(const std::shared_ptr<PivotMesh>& mesh) {
+    Vec3 center;
+    for (auto& v : mesh->vertices) {
+        center += v.position;
+    }
+    return center / std::max((size_t)1, mesh->vertices.size());
+}
+
+/**
+ * Returns the largest distance from a point of one cut to the other cut
+ *
+ * This is the Hausdorff distance between the two point sets. It is infinite
+ * if only one of the cuts is empty.
+ *
+ * @param a     The points of the first cut
+ * @param b     The points of the second cut
+ */
+static float cutDistance(const std::vector<Vec3>& a, const std::vector<Vec3>& b) {
+    if (a.empty() || b.empty()) {
+        return (a.empty() && b.empty()) ? 0.0f : std::numeric_limits<float>::infinity();
+    }
+    auto oneway = [](const std::vector<Vec3>& from, const std::vector<Vec3>& to) {
+        float result = 0;
+        for (auto& p : from) {
+            float best = std::numeric_limits<float>::max();
+            for (auto& q : to) {
+                best = std::min(best, p.distanceSquared(q));
+            }
+            result = std::max(result, best);
+        }
+        return result;
+    };
+    return sqrtf(std::max(oneway(a, b), oneway(b, a)));
+}
+
+/**
+ * Runs every benchmark
+ *
+ * @param assets    The (loaded) asset manager
+ */
+void Benchmark::runAll(const std::shared_ptr<AssetManager>& assets) {
+    runSlicing();
+    runCutObstacles();
+    runBillboards();
+    runVisibility();
+    runMeshChunks();
+    runLightBinning();
+    runItems();
+    runEmitters();
+    runTriggers();
+    runMeshLoading();
+    runLevelLoading(assets);
+    runJsonLookup(assets);
+    runJsonParsing();
+    runProfiler();
+    runThreadPool();
+}
+
+/**
+ * Times loading the asset directory with 1, 2, 4 and 8 loader threads
+ *
+ * @param directory The path to the JSON asset directory
+ *
+ * @return true once every thread count has been timed
+ */
+bool Benchmark::runAssetLoading(const std::string& directory) {
+    static const Uint32 workers[] = { 1, 2, 4, 8 };
+    static const size_t runs = sizeof(workers)/sizeof(Uint32);
+    static size_t run = 0;
+    static std::shared_ptr<AssetManager> assets;
+    static Timestamp start;
+    static Uint32 frames = 0;
+    if (run == runs) {
+        return true;
+    }
+
+    if (assets == nullptr) {
+        if (run == 0) {
+            CULog("BENCHMARK asset loading: threads, ms to loaded, frames");
+        }
+        assets = AssetManager::alloc(workers[run]);
+        assets->attach<Font>(FontLoader::alloc()->getHook());
+        assets->attach<Texture>(TextureLoader::alloc()->getHook());
+        assets->attach<Sound>(SoundLoader::alloc()->getHook());
+        assets->attach<scene2::SceneNode>(Scene2Loader::alloc()->getHook());
+        assets->attach<JsonValue>(JsonLoader::alloc()->getHook());
+        assets->attach<WidgetValue>(WidgetLoader::alloc()->getHook());
+        frames = 0;
+        start.mark();
+        assets->loadDirectoryAsync(directory, nullptr);
+        return false;
+    }
+
+    frames++;
+    if (!assets->complete()) {
+        return false;
+    }
+    Timestamp end;
+    CULog("BENCHMARK asset loading: %u, %llu, %u", workers[run],
+          (unsigned long long)Timestamp::ellapsedMillis(start, end), frames);
+    assets->unloadAll();
+    assets = nullptr;
+    run++;
+    return run == runs;
+}
+
+/**
+ * Compares the libigl isoline cut against the PlaneSlicer engine
+ */
+void Benchmark::runSlicing() {
+    CULog("BENCHMARK slicing: mesh, faces, build ms, slicer KB, igl us/cut, slicer us/cut, speedup, max error, mismatched cuts");
+    for (auto& path : meshFiles("_col.obj")) {
+        auto mesh = PivotMesh::MeshFromOBJ(path);
+        if (mesh == nullptr) {
+            continue;
+        }
+
+        Timestamp start;
+        mesh->buildSlicer();
+        Timestamp built;
+        auto slicer = mesh->getSlicer();
+        if (slicer == nullptr) {
+            continue;
+        }
+
+        // cut through the middle of the mesh
+        Vec3 center = meshCenter(mesh);
+        Vec3 lo = mesh->vertices.empty() ? Vec3::ZERO : mesh->vertices[0].position;
+        Vec3 hi = lo;
+        for (auto& v : mesh->vertices) {
+            lo.x = std::min(lo.x, v.position.x); hi.x = std::max(hi.x, v.position.x);
+            lo.y = std::min(lo.y, v.position.y); hi.y = std::max(hi.y, v.position.y);
+            lo.z = std::min(lo.z, v.position.z); hi.z = std::max(hi.z, v.position.z);
+        }
+        float tolerance = SLICE_TOLERANCE * lo.distance(hi);
+
+        Uint64 igl = 0;
+        Uint64 ours = 0;
+        float error = 0;
+        int mismatches = 0;
+        for (int deg = 0; deg < SLICE_ANGLES; deg++) {
+            float rad = deg * M_PI / 180.0f;
+            Vec3 normal(cos(rad), sin(rad), 0);
+
+            Timestamp t0;
+            auto cut = mesh->intersectPlane(center, normal);
+            Timestamp t1;
+            auto contours = mesh->slice(center, normal);
+            Timestamp t2;
+
+            igl += Timestamp::ellapsedMicros(t0, t1);
+            ours += Timestamp::ellapsedMicros(t1, t2);
+
+            // Both cuts must have a segment in the same faces, at the same points
+            auto& verts = std::get<0>(cut);
+            std::vector<Vec3> expected;
+            expected.reserve(verts.rows());
+            for (int ii = 0; ii < verts.rows(); ii++) {
+                expected.push_back(Vec3(verts(ii, 0), verts(ii, 1), verts(ii, 2)));
+            }
+            std::vector<Vec3> actual;
+            size_t segments = 0;
+            for (auto& contour : contours) {
+                actual.insert(actual.end(), contour.points.begin(), contour.points.end());
+                segments += contour.points.size() - (contour.closed ? 0 : 1);
+            }
+            float dist = cutDistance(expected, actual);
+            error = std::max(error, dist);
+            if (dist > tolerance || segments != (size_t)std::get<1>(cut).rows()) {
+                mismatches++;
+            }
+        }
+
+        CULog("BENCHMARK slicing: %s, %zu, %llu, %zu, %.1f, %.1f, %.1fx, %g, %d",
+              filetool::base_name(path).c_str(), slicer->getFaceCount(),
+              (unsigned long long)Timestamp::ellapsedMillis(start, built), slicer->getMemoryUsage() / 1024,
+              igl / (float)SLICE_ANGLES, ours / (float)SLICE_ANGLES, ours ? igl / (float)ours : 0.0f,
+              error, mismatches);
+        if (mismatches) {
+            CULogError("BENCHMARK slicing: %s differs from libigl on %d of %d cuts",
+                       filetool::base_name(path).c_str(), mismatches, SLICE_ANGLES);
+        }
+    }
+}
+
+/**
+ * Returns the child of a JSON object with the given key, by a linear scan
+ *
+ * This is how JsonValue::get looked up keys before it had an index, and is
+ * the baseline of the JSON lookup benchmark.
+ *
+ * @param json  The JSON object
+ * @param key   The key identifying the child
+ */
+static std::shared_ptr<JsonValue> scanKey(const std::shared_ptr<JsonValue>& json, const std::string& key) {
+    for (auto& child : json->children()) {
+        if (child->key() == key) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Times creating the cut obstacles and stepping the world
+ *
+ * @param bounds    The world bounds
+ * @param create    Adds the cut obstacles to the world
+ * @param createUs  Accumulates the creation time in microseconds
+ * @param stepUs    Accumulates the time of all steps in microseconds
+ */
+static void timeWorld(const Rect& bounds, const std::function<void(const std::shared_ptr<physics2::ObstacleWorld>&)>& create,
+                      Uint64& createUs, Uint64& stepUs) {
+    auto world = physics2::ObstacleWorld::alloc(bounds, Vec2(0, -9.8f));
+    world->setLockStep(true);
+    world->setStepsize(0.012f);
+
+    // Something dynamic so the contacts and the broad phase do real work
+    auto box = physics2::BoxObstacle::alloc(Vec2(bounds.getMidX(), bounds.getMaxY() + 1), Size(1, 2));
+    box->setDensity(1);
+    world->addObstacle(box);
+
+    Timestamp t0;
+    create(world);
+    Timestamp t1;
+    for (int ii = 0; ii < OBSTACLE_STEPS; ii++) {
+        world->update(0.012f);
+    }
+    Timestamp t2;
+
+    createUs += Timestamp::ellapsedMicros(t0, t1);
+    stepUs += Timestamp::ellapsedMicros(t1, t2);
+    world->clear();
+}
+
+/**
+ * Compares one PolygonObstacle per extruded cut segment against a single
+ * ChainObstacle per cut
+ */
+void Benchmark::runCutObstacles() {
+    CULog("BENCHMARK obstacles: mesh, segments, chains, polygon create us, chain create us, polygon step us, chain step us");
+    for (auto& path : meshFiles("_col.obj")) {
+        auto mesh = PivotMesh::MeshFromOBJ(path);
+        if (mesh == nullptr || !mesh->buildSlicer()) {
+            continue;
+        }
+        Vec3 center = meshCenter(mesh);
+
+        size_t segments = 0;
+        size_t chains = 0;
+        Uint64 polyCreate = 0, polyStep = 0;
+        Uint64 chainCreate = 0, chainStep = 0;
+        for (int ii = 0; ii < OBSTACLE_ANGLES; ii++) {
+            float rad = ii * 2 * M_PI / OBSTACLE_ANGLES;
+            auto paths = PlaneController::computeCut(mesh, center, Vec3(cos(rad), sin(rad), 0));
+
+            // the cut as it used to be built, one extruded polygon per segment
+            std::vector<Poly2> polys;
+            SimpleExtruder extruder;
+            for (auto& p : paths) {
+                size_t count = p.closed ? p.vertices.size() : p.vertices.size() - 1;
+                for (size_t jj = 0; jj < count; jj++) {
+                    extruder.set(Path2(std::vector<Vec2>{ p.vertices[jj], p.vertices[(jj + 1) % p.vertices.size()] }));
+                    extruder.calculate(CUT_WIDTH);
+                    polys.push_back(extruder.getPolygon());
+                }
+            }
+            if (polys.empty()) {
+                continue;
+            }
+
+            Rect bounds = polys.front().getBounds();
+            for (auto& p : polys) {
+                bounds.merge(p.getBounds());
+            }
+            segments += polys.size();
+            chains += paths.size();
+
+            timeWorld(bounds, [&](const std::shared_ptr<physics2::ObstacleWorld>& world) {
+                for (auto& p : polys) {
+                    auto obstacle = physics2::PolygonObstacle::alloc(p);
+                    obstacle->setBodyType(b2_staticBody);
+                    world->addObstacle(obstacle);
+                }
+            }, polyCreate, polyStep);
+
+            timeWorld(bounds, [&](const std::shared_ptr<physics2::ObstacleWorld>& world) {
+                auto obstacle = physics2::ChainObstacle::alloc(paths);
+                obstacle->setTwoSided(true);
+                obstacle->setRadius(CUT_RADIUS);
+                obstacle->setBodyType(b2_staticBody);
+                world->addObstacle(obstacle);
+            }, chainCreate, chainStep);
+        }
+
+        CULog("BENCHMARK obstacles: %s, %.1f, %.1f, %.1f, %.1f, %.1f, %.1f",
+              filetool::base_name(path).c_str(),
+              segments / (float)OBSTACLE_ANGLES, chains / (float)OBSTACLE_ANGLES,
+              polyCreate / (float)OBSTACLE_ANGLES, chainCreate / (float)OBSTACLE_ANGLES,
+              polyStep / (float)(OBSTACLE_ANGLES * OBSTACLE_STEPS), chainStep / (float)(OBSTACLE_ANGLES * OBSTACLE_STEPS));
+    }
+}
+
+/**
+ * Compares building one quad per billboard against the BillboardBatch
+ */
+void Benchmark::runBillboards() {
+    CULog("BENCHMARK billboards: count, per-object us, batch us, per-object draws, batch draws, batch groups");
+
+    // A few textures, half of them lit (with a normal map)
+    std::vector<std::shared_ptr<Texture>> textures;
+    std::vector<std::shared_ptr<Texture>> normals;
+    for (int ii = 0; ii < BILLBOARD_TEXTURES; ii++) {
+        textures.push_back(Texture::alloc(64, 64));
+        normals.push_back(ii % 2 ? Texture::alloc(64, 64) : nullptr);
+    }
+
+    Vec3 right(1, 0, 0);
+    Vec3 up(0, 0, 1);
+    auto visible = [](const Vec3& pos) { return pos.x > -500 && pos.x < 500; };
+    for (int count : { 10, 100, 1000 }) {
+        std::vector<DrawObject> drawables;
+        std::vector<Uint32> onscreen;
+        for (int ii = 0; ii < count; ii++) {
+            int tex = ii % BILLBOARD_TEXTURES;
+            Vec3 pos((ii * 37) % 1200 - 600.0f, 0, (ii * 11) % 300);
+            drawables.push_back(DrawObject(pos, textures[tex], normals[tex], ii == 0, nullptr, false, 1.0));
+            if (visible(pos)) {
+                onscreen.push_back(ii);
+            }
+        }
+
+        // The old path rebuilt each quad in the billboard and position passes
+        size_t objectDraws = 0;
+        std::vector<PivotVertex3> quad;
+        Timestamp t0;
+        for (int frame = 0; frame < BILLBOARD_FRAMES; frame++) {
+            objectDraws = 0;
+            for (int pass = 0; pass < 2; pass++) {
+                for (const DrawObject& dro : drawables) {
+                    if (pass == 1 && dro.emission) continue;
+                    quad.clear();
+                    BillboardBatch::buildQuad(dro, right, up, quad);
+                    if (std::any_of(quad.begin(), quad.end(), [&](const PivotVertex3& v) { return visible(v.position); })) {
+                        objectDraws++;
+                    }
+                }
+            }
+        }
+        Timestamp t1;
+
+        BillboardBatch batch;
+        size_t batchDraws = 0;
+        for (int frame = 0; frame < BILLBOARD_FRAMES; frame++) {
+            batch.build(drawables, onscreen, right, up, true);
+            batchDraws = 0;
+            for (auto& group : batch.getGroups()) {
+                batchDraws += group.emission() ? 1 : 2;
+            }
+        }
+        Timestamp t2;
+
+        CULog("BENCHMARK billboards: %d, %.1f, %.1f, %zu, %zu, %zu", count,
+              Timestamp::ellapsedMicros(t0, t1) / (float)BILLBOARD_FRAMES,
+              Timestamp::ellapsedMicros(t1, t2) / (float)BILLBOARD_FRAMES,
+              objectDraws, batchDraws, batch.getGroups().size());
+    }
+}
+
+/**
+ * Compares projecting the quad corners of every billboard in each pass against
+ * culling them once with FrameVisibility
+ */
+void Benchmark::runVisibility() {
+    CULog("BENCHMARK visibility: count, corner us, sphere us, corner visible, front visible, behind visible");
+    Size screen(1024, 576);
+    auto camera = OrthographicCamera::alloc(screen);
+    camera->setFar(10000);
+    camera->setZoom(2);
+    camera->setPosition(Vec3::ZERO);
+    camera->setDirection(Vec3(0, 1, 0));
+    camera->setUp(Vec3(0, 0, 1));
+    camera->update();
+    Vec3 up = camera->getUp();
+    Vec3 right = Vec3(0, -1, 0).cross(up);
+    Rect viewport(Vec2::ZERO, screen);
+
+    FrameVisibility visibility;
+    visibility.setView(Vec3::ZERO, camera->getDirection(), right, up, screen / camera->getZoom(), -30, 10000);
+
+    auto texture = Texture::alloc(64, 64);
+    for (int count : { 10, 100, 1000 }) {
+        // Scatter billboards all around the camera (deterministically)
+        std::vector<DrawObject> drawables;
+        for (int ii = 0; ii < count; ii++) {
+            float x = ((ii * 7919) % 1000) / 1000.0f - 0.5f;
+            float y = ((ii * 104729) % 1000) / 1000.0f - 0.5f;
+            float z = ((ii * 15485863) % 1000) / 1000.0f - 0.5f;
+            Vec3 pos = Vec3(x, y, z) * VISIBILITY_SPREAD;
+            drawables.push_back(DrawObject(pos, texture, nullptr, false, nullptr, true, 1.0));
+        }
+
+        // The old path projected every corner in the billboard and position passes
+        size_t cornerVisible = 0;
+        std::vector<PivotVertex3> quad;
+        Timestamp t0;
+        for (int frame = 0; frame < BILLBOARD_FRAMES; frame++) {
+            cornerVisible = 0;
+            for (int pass = 0; pass < 2; pass++) {
+                for (const DrawObject& dro : drawables) {
+                    quad.clear();
+                    BillboardBatch::buildQuad(dro, right, up, quad);
+                    for (auto& v : quad) {
+                        Vec3 window = camera->project(v.position, viewport);
+                        if (window.x > 0 && window.x < screen.width) {
+                            cornerVisible++;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        Timestamp t1;
+
+        for (int frame = 0; frame < BILLBOARD_FRAMES; frame++) {
+            visibility.cull(drawables);
+        }
+        Timestamp t2;
+
+        CULog("BENCHMARK visibility: %d, %.1f, %.1f, %zu, %zu, %zu", count,
+              Timestamp::ellapsedMicros(t0, t1) / (float)BILLBOARD_FRAMES,
+              Timestamp::ellapsedMicros(t1, t2) / (float)BILLBOARD_FRAMES,
+              cornerVisible / 2, visibility.getList(FrameVisibility::FRONT).size(),
+              visibility.getList(FrameVisibility::BEHIND).size());
+    }
+}
+
+/**
+ * Reports how many triangles of each render mesh the chunks leave to draw
+ */
+void Benchmark::runMeshChunks() {
+    CULog("BENCHMARK chunks: level, triangles, chunks, chunk ms, drawn %%, draws/frame, cull us/frame");
+    Size screen(1024, 576);
+    float zoom = 2;
+    for (auto& path : meshFiles("_dec.obj")) {
+        auto mesh = PivotMesh::MeshFromOBJ(path, PivotMesh::LOAD_RENDER);
+        if (mesh == nullptr) {
+            continue;
+        }
+        Timestamp t0;
+        mesh->buildChunks();
+        Timestamp t1;
+        auto chunks = mesh->getChunks();
+        if (chunks == nullptr || chunks->getTriangleCount() == 0) {
+            continue;
+        }
+
+        // Stand the player on a few vertices spread over the mesh, and turn the plane around them
+        FrameVisibility visibility;
+        std::vector<MeshChunks::Range> ranges;
+        size_t drawn = 0;
+        size_t draws = 0;
+        Timestamp t2;
+        for (int origin = 0; origin < CHUNK_ORIGINS; origin++) {
+            Vec3 pos = mesh->vertices[(mesh->vertices.size() - 1) * origin / (CHUNK_ORIGINS - 1)].position;
+            for (int angle = 0; angle < CHUNK_ANGLES; angle++) {
+                float rad = angle * 2 * M_PI / CHUNK_ANGLES;
+                Vec3 normal(std::cos(rad), std::sin(rad), 0);
+                Vec3 up(0, 0, 1);
+                visibility.setView(pos, -normal, normal.getCross(up), up, screen / zoom, -30, 10000);
+                drawn += chunks->cull([&](const Vec3& min, const Vec3& max) {
+                    return visibility.intersects(min, max, -0.001f, visibility.getFar());
+                }, ranges);
+                draws += ranges.size();
+            }
+        }
+        Timestamp t3;
+
+        float frames = CHUNK_ORIGINS * CHUNK_ANGLES;
+        CULog("BENCHMARK chunks: %s, %zu, %zu, %llu, %.1f, %.1f, %.1f", filetool::base_name(path).c_str(),
+              chunks->getTriangleCount(), chunks->getChunks().size(), (unsigned long long)Timestamp::ellapsedMillis(t0, t1),
+              100.0f * drawn / (frames * chunks->getTriangleCount()), draws / frames,
+              Timestamp::ellapsedMicros(t2, t3) / frames);
+    }
+}
+
+/**
+ * Times the LightGrid binning at 8, 64 and 256 lights
+ */
+void Benchmark::runLightBinning() {
+    CULog("BENCHMARK lights: count, bin us, tiles, avg lights per tile, max lights per tile, tile work vs full screen");
+    Size screen(1024, 576);
+    auto camera = OrthographicCamera::alloc(screen);
+    camera->setZoom(2);
+    camera->update();
+    auto grid = LightGrid::alloc(screen);
+
+    for (int count : { 8, 64, 256 }) {
+        // Scatter lights around the camera (deterministically)
+        std::vector<Vec3> positions;
+        std::vector<float> powers;
+        for (int ii = 0; ii < count; ii++) {
+            float x = ((ii * 7919) % 1000) / 1000.0f - 0.5f;
+            float y = ((ii * 104729) % 1000) / 1000.0f - 0.5f;
+            positions.push_back(Vec3(x * LIGHT_SPREAD, y * LIGHT_SPREAD, 0));
+            powers.push_back(ii % 3 == 0 ? 1.0f : 0.2f);
+        }
+
+        Timestamp t0;
+        for (int frame = 0; frame < LIGHT_FRAMES; frame++) {
+            grid->clear();
+            for (int ii = 0; ii < count; ii++) {
+                grid->addLight(positions[ii], Vec3::ONE, powers[ii]);
+            }
+            grid->bin(camera->getCombined(), Vec3::UNIT_X, Vec3::UNIT_Y);
+        }
+        Timestamp t1;
+
+        int tiles = grid->getCols() * grid->getRows();
+        Uint32 most = 0;
+        for (int row = 0; row < grid->getRows(); row++) {
+            for (int col = 0; col < grid->getCols(); col++) {
+                most = std::max(most, grid->getTileCount(col, row));
+            }
+        }
+        CULog("BENCHMARK lights: %d, %.1f, %d, %.1f, %u, %.2f", count,
+              Timestamp::ellapsedMicros(t0, t1) / (float)LIGHT_FRAMES, tiles,
+              grid->getIndexCount() / (float)tiles, most,
+              grid->getIndexCount() / (float)(tiles * count));
+    }
+}
+
+/**
+ * Compares the old GameModel item containers against the ItemStore
+ */
+void Benchmark::runItems() {
+    CULog("BENCHMARK items: count, legacy us, store us, drawables, store KB, light power");
+    std::shared_ptr<Texture> texture = Texture::alloc(96, 96);
+
+    /** A collectible as GameModel used to keep it */
+    struct LegacyCollectible : public GameItem {
+        bool collected = false;
+        LegacyCollectible(const Vec3& pos, const std::string& name) : GameItem(pos, name) {}
+    };
+
+    for (int count : { 1000, 10000 }) {
+        // A quarter collectibles, half decorations (half of them lit) and a quarter glowsticks
+        std::map<std::string, LegacyCollectible> legacyColls;
+        std::vector<std::shared_ptr<GameItem>> legacyDecor;
+        std::vector<GameItem> legacyGlows;
+        std::unordered_map<std::string, GameModel::Light> legacyLights;
+        std::unordered_set<std::string> legacyBackpack;
+        ItemStore colls, decor, glows;
+        std::unordered_set<std::string> backpack;
+        std::vector<std::shared_ptr<SpriteSheet>> glowSheets;
+
+        for (int ii = 0; ii < count; ii++) {
+            float x = ((ii * 7919) % 1000) / 1000.0f - 0.5f;
+            float y = ((ii * 104729) % 1000) / 1000.0f - 0.5f;
+            Vec3 pos(x * ITEM_SPREAD, y * ITEM_SPREAD, (ii * 31) % 300);
+            float offset = (ii * 37) % 360;
+            std::shared_ptr<SpriteSheet> sheet = SpriteSheet::alloc(texture, 6, 6);
+            if (ii % 4 == 0) {
+                std::shared_ptr<SpriteSheet> normal = SpriteSheet::alloc(texture, 6, 6);
+                std::string key = std::to_string(ii / 4);
+                LegacyCollectible item(pos, key);
+                item.setOffsetAngle(offset);
+                item.setScale(1);
+                item.rotateSpriteSheet = sheet;
+                item.rotateNormalSpriteSheet = normal;
+                legacyColls.insert({ key, item });
+                colls.add(pos, sheet, normal, offset, 1, key);
+            } else if (ii % 4 == 1) {
+                glowSheets.push_back(sheet);
+            } else {
+                std::shared_ptr<SpriteSheet> normal = ii % 4 == 2 ? SpriteSheet::alloc(texture, 6, 6) : nullptr;
+                std::shared_ptr<GameItem> item = std::make_shared<GameItem>(pos, "deco" + std::to_string(ii), texture, offset, 1);
+                item->setIsemit(normal == nullptr);
+                item->rotateSpriteSheet = sheet;
+                item->rotateNormalSpriteSheet = normal;
+                legacyDecor.push_back(item);
+                decor.add(pos, sheet, normal, offset, 1, item->getName());
+            }
+        }
+
+        // Places the next glowstick in both layouts
+        size_t placed = 0;
+        auto place = [&]() {
+            Vec3 pos = colls.getPosition(placed % colls.size()) + Vec3(0, 0, 50);
+            const std::shared_ptr<SpriteSheet>& sheet = glowSheets[placed % glowSheets.size()];
+            GameItem g(pos);
+            g.setIsemit(true);
+            g.setIntense(GLOWSTICK_INTENSITY);
+            g.setPulse(0);
+            g.setOffsetAngle(0);
+            g.setColor(Vec3::ONE);
+            g.rotateSpriteSheet = sheet;
+            legacyGlows.push_back(g);
+            legacyLights[std::string(pos)] = GameModel::Light(Vec3::ONE, GLOWSTICK_INTENSITY, pos, GLOWSTICK_FALLOFF, 0);
+            glows.add(pos, sheet, nullptr, 0, 1);
+            glows.setLight(glows.size() - 1, Vec3::ONE, GLOWSTICK_INTENSITY, GLOWSTICK_FALLOFF, 0);
+            placed++;
+        };
+        while (placed < glowSheets.size()) {
+            place();
+        }
+        // The player walks across the items
+        auto player = [](int frame) {
+            return Vec3((frame / (float)ITEM_FRAMES - 0.5f) * ITEM_SPREAD, 0, 150);
+        };
+
+        std::vector<DrawObject> drawables;
+        float power = 0;
+        Timestamp t0;
+        for (int frame = 0; frame < ITEM_FRAMES; frame++) {
+            float angle = frame * 3.0f;
+            for (auto& c : legacyColls) {
+                c.second.setRotationalSprite(angle);
+            }
+            for (auto& d : legacyDecor) {
+                d->setRotationalSprite(angle);
+            }
+            for (auto& g : legacyGlows) {
+                g.setRotationalSprite(angle);
+            }
+
+            Vec3 loc = player(frame);
+            for (auto& c : legacyColls) {
+                if (loc.distance(c.second.getPosition()) <= COLLECTING_DIST && !c.second.collected) {
+                    c.second.collected = true;
+                    legacyBackpack.insert(c.first);
+                }
+            }
+
+            // pick up the oldest glowstick and place another
+            GameItem g = legacyGlows.front();
+            legacyLights.erase(std::string(g.getPosition()));
+            legacyGlows.erase(legacyGlows.begin());
+            g.setPosition(g.getPosition() + Vec3(0, 0, 1));
+            legacyGlows.push_back(g);
+            legacyLights[std::string(g.getPosition())] = GameModel::Light(Vec3::ONE, GLOWSTICK_INTENSITY, g.getPosition(), GLOWSTICK_FALLOFF, 0);
+
+            // the billboards copied each container as RenderPipeline::billboardSetup did
+            drawables.clear();
+            std::map<std::string, LegacyCollectible> copy = legacyColls;
+            for (std::pair<std::string, LegacyCollectible> c : copy) {
+                if (!c.second.collected) {
+                    drawables.push_back(DrawObject(c.second.getPosition(), c.second.rotateSpriteSheet->getTexture(), NULL, false, c.second.rotateSpriteSheet, true, c.second.getScale()));
+                }
+            }
+            for (GameItem g : legacyGlows) {
+                drawables.push_back(DrawObject(g.getPosition(), g.rotateSpriteSheet->getTexture(), g.getNorm(), false, g.rotateSpriteSheet, true, 1.0));
+            }
+            auto decorCopy = legacyDecor;
+            for (auto d : decorCopy) {
+                drawables.push_back(DrawObject(d->getPosition(), d->rotateSpriteSheet->getTexture(), d->isEmissive() ? NULL : d->rotateNormalSpriteSheet->getTexture(), false, d->rotateSpriteSheet, false, d->getScale()));
+            }
+
+            for (auto& p : legacyLights) {
+                power += p.second.intensity;
+            }
+        }
+        Timestamp t1;
+        size_t legacyDrawables = drawables.size();
+
+        for (int frame = 0; frame < ITEM_FRAMES; frame++) {
+            float angle = frame * 3.0f;
+            colls.updateFrames(angle);
+            decor.updateFrames(angle);
+            glows.updateFrames(angle);
+
+            Vec3 loc = player(frame);
+            for (size_t ii = 0; ii < colls.size(); ii++) {
+                if (loc.distance(colls.getPosition(ii)) <= COLLECTING_DIST && !colls.isCollected(ii)) {
+                    colls.setCollected(ii, true);
+                    backpack.insert(colls.getName(ii));
+                }
+            }
+
+            // pick up a glowstick and place another
+            Vec3 pos = glows.getPosition(0) + Vec3(0, 0, 1);
+            std::shared_ptr<SpriteSheet> sheet = glows.getSheet(0);
+            glows.remove(glows.getHandle(0));
+            glows.add(pos, sheet, nullptr, 0, 1);
+            glows.setLight(glows.size() - 1, Vec3::ONE, GLOWSTICK_INTENSITY, GLOWSTICK_FALLOFF, 0);
+
+            drawables.clear();
+            for (size_t ii = 0; ii < colls.size(); ii++) {
+                if (!colls.isCollected(ii)) {
+                    drawables.push_back(DrawObject(colls.getPosition(ii), colls.getSheet(ii)->getTexture(), NULL, false, colls.getSheet(ii), true, colls.getScale(ii)));
+                }
+            }
+            for (size_t ii = 0; ii < glows.size(); ii++) {
+                drawables.push_back(DrawObject(glows.getPosition(ii), glows.getSheet(ii)->getTexture(), NULL, false, glows.getSheet(ii), true, 1.0));
+            }
+            for (size_t ii = 0; ii < decor.size(); ii++) {
+                std::shared_ptr<Texture> normal = decor.isEmissive(ii) ? NULL : decor.getNormalSheet(ii)->getTexture();
+                drawables.push_back(DrawObject(decor.getPosition(ii), decor.getSheet(ii)->getTexture(), normal, false, decor.getSheet(ii), false, decor.getScale(ii)));
+            }
+
+            for (size_t ii = 0; ii < glows.size(); ii++) {
+                if (glows.hasLight(ii)) {
+                    power += glows.getIntensity(ii);
+                }
+            }
+        }
+        Timestamp t2;
+
+        if (legacyDrawables != drawables.size() || legacyBackpack != backpack) {
+            CULogError("BENCHMARK items: the layouts disagree at %d items", count);
+        }
+        CULog("BENCHMARK items: %d, %.1f, %.1f, %zu, %.1f, %.0f", count,
+              Timestamp::ellapsedMicros(t0, t1) / (float)ITEM_FRAMES,
+              Timestamp::ellapsedMicros(t1, t2) / (float)ITEM_FRAMES,
+              drawables.size(), (colls.getMemoryUsage() + decor.getMemoryUsage() + glows.getMemoryUsage()) / 1024.0f, power);
+    }
+}
+
+/**
+ * Times the SoundEmitters update and reports the voices it needs
+ */
+void Benchmark::runEmitters() {
+    CULog("BENCHMARK emitters: count, update us, most in earshot, most voices, starts per 100 frames");
+    for (int count : { 16, 64, 256 }) {
+        SoundEmitters emitters;
+        for (int ii = 0; ii < count; ii++) {
+            float x = ((ii * 7919) % 1000) / 1000.0f - 0.5f;
+            float y = ((ii * 104729) % 1000) / 1000.0f - 0.5f;
+            emitters.add("ambient", Vec3(x * EMITTER_SPREAD, y * EMITTER_SPREAD, 0), 30, 4.0f + ii % 3);
+        }
+
+        // The player walks across the square, turning the plane as it goes
+        size_t audible = 0;
+        size_t voices = 0;
+        size_t starts = 0;
+        Uint64 micros = 0;
+        for (int frame = 0; frame < EMITTER_FRAMES; frame++) {
+            float t = frame / (float)EMITTER_FRAMES;
+            Vec3 listener((t - 0.5f) * EMITTER_SPREAD, 100 * std::sin(t * 20), 0);
+            Vec3 right(std::cos(t * 5), std::sin(t * 5), 0);
+            Timestamp t0;
+            emitters.update(1 / 60.0f, listener, right);
+            Timestamp t1;
+            micros += Timestamp::ellapsedMicros(t0, t1);
+
+            size_t heard = 0;
+            for (size_t ii = 0; ii < emitters.size(); ii++) {
+                heard += emitters.getEmitter(ii).gain >= EMITTER_MIN_GAIN ? 1 : 0;
+            }
+            audible = std::max(audible, heard);
+            voices = std::max(voices, emitters.getVoiceCount());
+            starts += emitters.getStarted().size();
+            emitters.takeStopped();
+        }
+
+        CULog("BENCHMARK emitters: %d, %.2f, %zu, %zu, %.1f", count, micros / (float)EMITTER_FRAMES,
+              audible, voices, starts * 100.0f / EMITTER_FRAMES);
+    }
+}
+
+/**
+ * Compares brute force trigger tests against the RegionVolume and TriggerIndex
+ */
+void Benchmark::runTriggers() {
+    std::vector<std::shared_ptr<PivotMesh>> plain;
+    std::vector<std::shared_ptr<Trigger>> triggers;
+    Vec3 lo(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vec3 hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (auto& path : meshFiles(".obj")) {
+        std::string name = filetool::base_name(path);
+        if (name.find("_death_") == std::string::npos && name.find("_popup_") == std::string::npos &&
+            name.find("_message_") == std::string::npos && name.find("_exitregion_") == std::string::npos) {
+            continue;
+        }
+        auto region = PivotMesh::MeshFromOBJ(path, PivotMesh::LOAD_CONTAINMENT);
+        auto plainMesh = PivotMesh::MeshFromOBJ(path);
+        if (region == nullptr || plainMesh == nullptr) {
+            continue;
+        }
+        auto trig = std::make_shared<Trigger>(region);
+        auto volume = region->getVolume();
+        lo.set(std::min(lo.x, volume->getMin().x), std::min(lo.y, volume->getMin().y), std::min(lo.z, volume->getMin().z));
+        hi.set(std::max(hi.x, volume->getMax().x), std::max(hi.y, volume->getMax().y), std::max(hi.z, volume->getMax().z));
+        triggers.push_back(trig);
+        plain.push_back(plainMesh);
+    }
+    if (triggers.empty()) {
+        CULog("BENCHMARK triggers: no trigger regions found");
+        return;
+    }
+
+    Timestamp b0;
+    auto index = TriggerIndex::alloc(triggers);
+    Timestamp b1;
+
+    // A straight walk through the middle of all of the regions
+    std::vector<Vec3> path;
+    for (int frame = 0; frame < TRIGGER_FRAMES; frame++) {
+        float t = frame / (float)(TRIGGER_FRAMES - 1);
+        path.push_back(Vec3(lo.x + (hi.x - lo.x) * t, (lo.y + hi.y) / 2, (lo.z + hi.z) / 2));
+    }
+
+    std::vector<char> expected(path.size() * plain.size());
+    Timestamp t0;
+    for (size_t frame = 0; frame < path.size(); frame++) {
+        for (size_t ii = 0; ii < plain.size(); ii++) {
+            expected[frame * plain.size() + ii] = plain[ii]->containsPoint(path[frame]);
+        }
+    }
+    Timestamp t1;
+    int mismatches = 0;
+    for (size_t frame = 0; frame < path.size(); frame++) {
+        for (size_t ii = 0; ii < triggers.size(); ii++) {
+            if (triggers[ii]->getMesh()->containsPoint(path[frame]) != (bool)expected[frame * plain.size() + ii]) {
+                mismatches++;
+            }
+        }
+    }
+    Timestamp t2;
+    size_t active = 0;
+    for (size_t frame = 0; frame < path.size(); frame++) {
+        index->update(path[frame]);
+        active += index->getActiveCount();
+    }
+    Timestamp t3;
+
+    float frames = (float)path.size();
+    CULog("BENCHMARK triggers: regions, cells, build us, igl us/frame, volume us/frame, index us/frame, regions tested/frame, lookups, mismatches");
+    CULog("BENCHMARK triggers: %zu, %zu, %llu, %.1f, %.2f, %.2f, %.1f, %llu, %d", triggers.size(), index->getCellCount(),
+          (unsigned long long)Timestamp::ellapsedMicros(b0, b1), Timestamp::ellapsedMicros(t0, t1) / frames,
+          Timestamp::ellapsedMicros(t1, t2) / frames, Timestamp::ellapsedMicros(t2, t3) / frames,
+          active / frames, (unsigned long long)index->getLookups(), mismatches);
+}
+
+/**
+ * Compares loading with LOAD_ALL against loading with the mode each mesh needs
+ */
+void Benchmark::runMeshLoading() {
+    CULog("BENCHMARK mesh loading: pack, meshes, all ms, modes ms, all KB, modes KB");
+    std::string root = filetool::join_path({ Application::get()->getAssetDirectory(), "meshes" });
+    for (auto& pack : filetool::dir_contents(root)) {
+        if (!filetool::is_dir(pack)) {
+            continue;
+        }
+        std::vector<std::pair<std::string, PivotMesh::LoadMode>> files;
+        for (auto& file : filetool::dir_contents(pack)) {
+            std::string name = filetool::base_name(file);
+            if (name.size() < 4 || name.compare(name.size() - 4, 4, ".obj") != 0) {
+                continue;
+            }
+            if (name.find("_dec.obj") != std::string::npos) {
+                files.push_back(std::make_pair(file, PivotMesh::LOAD_RENDER));
+            } else if (name.find("_col.obj") != std::string::npos) {
+                files.push_back(std::make_pair(file, PivotMesh::LOAD_SLICE));
+            } else {
+                files.push_back(std::make_pair(file, PivotMesh::LOAD_CONTAINMENT));
+            }
+        }
+
+        size_t allBytes = 0;
+        Timestamp t0;
+        for (auto& file : files) {
+            auto mesh = PivotMesh::MeshFromOBJ(file.first);
+            if (mesh == nullptr) {
+                continue;
+            }
+            if (file.second == PivotMesh::LOAD_SLICE) {
+                mesh->buildSlicer();
+            } else if (file.second == PivotMesh::LOAD_CONTAINMENT) {
+                mesh->buildVolume();
+            }
+            allBytes += mesh->getMemoryUsage();
+        }
+        Timestamp t1;
+        size_t modeBytes = 0;
+        for (auto& file : files) {
+            auto mesh = PivotMesh::MeshFromOBJ(file.first, file.second);
+            modeBytes += mesh != nullptr ? mesh->getMemoryUsage() : 0;
+        }
+        Timestamp t2;
+
+        CULog("BENCHMARK mesh loading: %s, %zu, %llu, %llu, %zu, %zu", filetool::base_name(pack).c_str(), files.size(),
+              (unsigned long long)Timestamp::ellapsedMillis(t0, t1), (unsigned long long)Timestamp::ellapsedMillis(t1, t2),
+              allBytes / 1024, modeBytes / 1024);
+    }
+}
+
+/**
+ * Compares loading each level from its JSON and OBJ files against loading it
+ * from its binary level
+ *
+ * @param assets    The loaded assets (for the level JSON)
+ */
+void Benchmark::runLevelLoading(const std::shared_ptr<AssetManager>& assets) {
+    CULog("BENCHMARK level loading: level, json cold ms, json warm ms, binary cold ms, binary warm ms");
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset("json/assets.json");
+    std::shared_ptr<JsonValue> directory = reader == nullptr ? nullptr : reader->readJson();
+    if (directory == nullptr || !directory->has("jsons")) {
+        return;
+    }
+
+    std::shared_ptr<JsonValue> jsons = directory->get("jsons");
+    for (int i = 0; i < jsons->size(); i++) {
+        std::string key = jsons->get(i)->key();
+        std::shared_ptr<JsonValue> json = assets->get<JsonValue>(key);
+        if (json == nullptr || !json->has("render_mesh") || !json->has("collision_mesh")) {
+            continue;
+        }
+
+        Uint64 times[4] = { 0, 0, 0, 0 };
+        bool binary = true;
+        for (int run = 0; run < 2; run++) {
+            Timestamp t0;
+            LevelData::allocWithJson(json);
+            Timestamp t1;
+            binary = binary && LevelData::allocWithBinary(LevelData::getBinaryPath(key), json) != nullptr;
+            Timestamp t2;
+            times[run] = Timestamp::ellapsedMillis(t0, t1);
+            times[run + 2] = Timestamp::ellapsedMillis(t1, t2);
+        }
+
+        if (binary) {
+            CULog("BENCHMARK level loading: %s, %llu, %llu, %llu, %llu", key.c_str(),
+                  (unsigned long long)times[0], (unsigned long long)times[1],
+                  (unsigned long long)times[2], (unsigned long long)times[3]);
+        } else {
+            CULog("BENCHMARK level loading: %s, %llu, %llu, -, -", key.c_str(),
+                  (unsigned long long)times[0], (unsigned long long)times[1]);
+        }
+    }
+}
+
+/**
+ * Compares JsonValue key lookups against a linear scan of the children
+ *
+ * @param assets    The loaded assets (for the level JSON)
+ */
+void Benchmark::runJsonLookup(const std::shared_ptr<AssetManager>& assets) {
+    CULog("BENCHMARK json lookup: object, keys, lookups, scan us, get us, mismatches");
+
+    // Lookups in a random order on a large synthetic object
+    std::shared_ptr<JsonValue> object = JsonValue::allocObject();
+    std::vector<std::string> keys;
+    for (int i = 0; i < JSON_KEYS; i++) {
+        object->appendChild(std::to_string(i), JsonValue::alloc((long)i));
+        keys.push_back(std::to_string((i * 7919) % JSON_KEYS));
+    }
+    int mismatches = 0;
+    Timestamp t0;
+    for (auto& key : keys) {
+        mismatches += scanKey(object, key) == nullptr;
+    }
+    Timestamp t1;
+    for (auto& key : keys) {
+        mismatches += object->get(key) == nullptr;
+    }
+    Timestamp t2;
+    CULog("BENCHMARK json lookup: synthetic, %d, %zu, %llu, %llu, %d", JSON_KEYS, keys.size(),
+          (unsigned long long)Timestamp::ellapsedMicros(t0, t1),
+          (unsigned long long)Timestamp::ellapsedMicros(t1, t2), mismatches);
+
+    // The sprite lookups of LevelData on the level with the most sprites
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset("json/assets.json");
+    std::shared_ptr<JsonValue> directory = reader == nullptr ? nullptr : reader->readJson();
+    if (directory == nullptr || !directory->has("jsons")) {
+        return;
+    }
+    std::string level;
+    std::shared_ptr<JsonValue> sprites;
+    std::shared_ptr<JsonValue> jsons = directory->get("jsons");
+    for (int i = 0; i < jsons->size(); i++) {
+        std::string key = jsons->get(i)->key();
+        std::shared_ptr<JsonValue> json = assets->get<JsonValue>(key);
+        std::shared_ptr<JsonValue> child = json == nullptr || !json->has("sprites") ? nullptr : json->get("sprites");
+        if (child != nullptr && (sprites == nullptr || child->size() > sprites->size())) {
+            level = key;
+            sprites = child;
+        }
+    }
+    if (sprites == nullptr) {
+        return;
+    }
+
+    static const char* fields[] = { "loc", "tex", "color", "pulse", "intense", "radius",
+                                    "collectible", "billboard", "emissive", "norm", "scale" };
+    size_t lookups = sprites->size() * (1 + sizeof(fields) / sizeof(fields[0]));
+    size_t scanned = 0;
+    size_t found = 0;
+    t0.mark();
+    for (int i = 0; i < sprites->size(); i++) {
+        std::shared_ptr<JsonValue> entry = scanKey(sprites, std::to_string(i));
+        for (const char* field : fields) {
+            scanned += scanKey(entry, field) != nullptr;
+        }
+    }
+    t1.mark();
+    for (int i = 0; i < sprites->size(); i++) {
+        std::shared_ptr<JsonValue> entry = sprites->get(std::to_string(i));
+        for (const char* field : fields) {
+            found += entry->get(field) != nullptr;
+        }
+    }
+    t2.mark();
+    CULog("BENCHMARK json lookup: %s, %zu, %zu, %llu, %llu, %d", level.c_str(), sprites->size(), lookups,
+          (unsigned long long)Timestamp::ellapsedMicros(t0, t1),
+          (unsigned long long)Timestamp::ellapsedMicros(t1, t2), (int)(scanned != found));
+}
+
+/**
+ * Compares parsing the large level files with JsonParser against parsing
+ * them with cJSON and converting the result
+ */
+void Benchmark::runJsonParsing() {
+    CULog("BENCHMARK json parsing: file, KB, cJSON ms, parser ms, parser MB/s");
+    std::string root = filetool::join_path({ Application::get()->getAssetDirectory(), "json", "level_json" });
+    for (auto& pack : filetool::dir_contents(root)) {
+        if (!filetool::is_dir(pack)) {
+            continue;
+        }
+        for (auto& file : filetool::dir_contents(pack)) {
+            std::shared_ptr<TextReader> reader = TextReader::alloc(file);
+            std::string text = reader == nullptr ? "" : reader->readAll();
+            if (text.size() < JSON_PARSE_MINIMUM) {
+                continue;
+            }
+
+            Timestamp t0;
+            for (int run = 0; run < JSON_PARSE_RUNS; run++) {
+                cJSON* node = cJSON_ParseWithOpts(text.c_str(), nullptr, 0);
+                JsonValue::toJsonValue(node);
+                cJSON_Delete(node);
+            }
+            Timestamp t1;
+            for (int run = 0; run < JSON_PARSE_RUNS; run++) {
+                JsonValue::allocWithJson(text);
+            }
+            Timestamp t2;
+
+            double cjson = Timestamp::ellapsedMicros(t0, t1) / (1000.0 * JSON_PARSE_RUNS);
+            double parser = Timestamp::ellapsedMicros(t1, t2) / (1000.0 * JSON_PARSE_RUNS);
+            CULog("BENCHMARK json parsing: %s, %zu, %.2f, %.2f, %.1f", filetool::base_name(file).c_str(),
+                  text.size() / 1024, cjson, parser, text.size() / (parser * 1000.0));
+        }
+    }
+}
+
+/**
+ * Times a Profiler scope stopped, recording, and recording on several threads
+ */
+void Benchmark::runProfiler() {
+    if (Profiler::isActive()) {
+        CULog("BENCHMARK profiler: skipped, the game is profiling itself");
+        return;
+    }
+    // Keeps the timed scopes from being optimized away
+    std::atomic<Uint64> sink(0);
+    auto scopes = [&sink]() {
+        for (int ii = 0; ii < PROFILER_SCOPES; ii++) {
+            Profiler::Scope scope("Benchmark::scope");
+            sink.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    Timestamp t0;
+    scopes();
+    Timestamp t1;
+
+    // Collect once per "frame" of a thousand scopes, as Application::step would
+    Profiler::start(PROFILER_CAPACITY, PROFILER_SCOPES);
+    Timestamp t2;
+    for (int ii = 0; ii < PROFILER_SCOPES; ii++) {
+        Profiler::Scope scope("Benchmark::scope");
+        sink.fetch_add(1, std::memory_order_relaxed);
+        if (ii % 1000 == 999) {
+            Profiler::frame();
+        }
+    }
+    Timestamp t3;
+    Profiler::stop();
+
+    // Workers record while the main thread collects
+    Profiler::start(PROFILER_CAPACITY, PROFILER_SCOPES * PROFILER_WORKERS);
+    std::atomic<int> running(PROFILER_WORKERS);
+    std::vector<std::thread> workers;
+    Timestamp t4;
+    for (int ii = 0; ii < PROFILER_WORKERS; ii++) {
+        workers.emplace_back([&]() {
+            scopes();
+            running--;
+        });
+    }
+    while (running > 0) {
+        Profiler::frame();
+        std::this_thread::yield();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    Timestamp t5;
+    Profiler::stop();
+
+    CULog("BENCHMARK profiler: stopped %.1f ns, recording %.1f ns, %d threads %.1f ns per scope (%llu dropped, mean %.3f us)",
+          Timestamp::ellapsedNanos(t0, t1) / (double)PROFILER_SCOPES,
+          Timestamp::ellapsedNanos(t2, t3) / (double)PROFILER_SCOPES, PROFILER_WORKERS,
+          Timestamp::ellapsedNanos(t4, t5) / (double)(PROFILER_SCOPES * PROFILER_WORKERS),
+          (unsigned long long)Profiler::getDropped(), Profiler::getMean("Benchmark::scope"));
+}
+
+/**
+ * The thread pool as it was before work stealing: one queue behind one lock
+ */
+class QueuePool {
+private:
+    /** The worker threads */
+    std::vector<std::thread> _workers;
+    /** The shared task queue */
+    std::queue<std::function<void()>> _tasks;
+    /** The lock for the queue */
+    std::mutex _mutex;
+    /** The condition the workers wait on */
+    std::condition_variable _condition;
+    /** Whether the workers should exit */
+    bool _stop;
+
+public:
+    QueuePool(int threads) : _stop(false) {
+        for (int ii = 0; ii < threads; ii++) {
+            _workers.emplace_back([this]() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+                        if (_stop) {
+                            return;
+                        }
+                        task = std::move(_tasks.front());
+                        _tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~QueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+            _condition.notify_all();
+        }
+        for (auto& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    void addTask(const std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(task);
+        _condition.notify_one();
+    }
+};
+
+/**
+ * Compares the throughput of tiny tasks on the ThreadPool against the single
+ * locked queue it replaced
+ */
+void Benchmark::runThreadPool() {
+    CULog("BENCHMARK threadpool: threads, queue ns/task, addTask ns/task, from worker ns/task, parallelFor ns/index");
+    for (int threads : { 1, POOL_THREADS }) {
+        std::atomic<int> done(0);
+        auto wait = [&done]() {
+            while (done < POOL_TASKS) {
+                std::this_thread::yield();
+            }
+        };
+
+        Timestamp t0;
+        {
+            QueuePool pool(threads);
+            for (int ii = 0; ii < POOL_TASKS; ii++) {
+                pool.addTask([&done]() { done++; });
+            }
+            wait();
+        }
+        Timestamp t1;
+
+        done = 0;
+        std::shared_ptr<ThreadPool> pool = ThreadPool::alloc(threads);
+        Timestamp t2;
+        for (int ii = 0; ii < POOL_TASKS; ii++) {
+            pool->addTask([&done]() { done++; });
+        }
+        wait();
+        Timestamp t3;
+
+        done = 0;
+        Timestamp t4;
+        {
+            TaskGroup group(pool);
+            group.run([&]() {
+                for (int ii = 0; ii < POOL_TASKS; ii++) {
+                    pool->addTask([&done]() { done++; });
+                }
+            });
+        }
+        wait();
+        Timestamp t5;
+
+        done = 0;
+        Timestamp t6;
+        pool->parallelFor(0, POOL_TASKS, POOL_GRAIN, [&done](size_t begin, size_t end) {
+            for (size_t ii = begin; ii < end; ii++) {
+                done++;
+            }
+        });
+        Timestamp t7;
+        pool->dispose();
+
+        CULog("BENCHMARK threadpool: %d, %.0f, %.0f, %.0f, %.1f", threads,
+              Timestamp::ellapsedNanos(t0, t1) / (double)POOL_TASKS,
+              Timestamp::ellapsedNanos(t2, t3) / (double)POOL_TASKS,
+              Timestamp::ellapsedNanos(t4, t5) / (double)POOL_TASKS,
+              Timestamp::ellapsedNanos(t6, t7) / (double)POOL_TASKS);
+    }
+}
+
+#endif /* PIVOT_BENCHMARK */
@@ -0,0 +1,200 @@
+//
+//  Benchmark.h
+//  Pivot
+//
+//  Timing harnesses for the performance sensitive parts of the game. These are
+//  only compiled into the game when PIVOT_BENCHMARK is defined, in which case
+//  they run once after the assets have loaded and log their results.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef Benchmark_h
+#define Benchmark_h
+#include <cugl/cugl.h>
+
+/**
+ * A collection of benchmarks, each of which logs its results with CULog
+ */
+class Benchmark {
+public:
+    /**
+     * Runs every benchmark
+     *
+     * @param assets    The (loaded) asset manager
+     */
+    static void runAll(const std::shared_ptr<cugl::AssetManager>& assets);
+
+    /**
+     * Times loading the asset directory with 1, 2, 4 and 8 loader threads
+     *
+     * Asynchronous loading finishes on the main thread, so this benchmark
+     * spans many frames. It must be called once a frame, before runAll,
+     * until it returns true. Each run loads the whole directory into a new
+     * asset manager, and logs the time until that manager is complete.
+     *
+     * @param directory The path to the JSON asset directory
+     *
+     * @return true once every thread count has been timed
+     */
+    static bool runAssetLoading(const std::string& directory);
+
+    /**
+     * Compares the libigl isoline cut against the PlaneSlicer engine
+     *
+     * Every collision mesh in assets/meshes is cut at 360 integer degree
+     * angles through its center. Each slicer cut is also checked against the
+     * libigl cut: both must have the same number of segments, and every point
+     * of one must be within SLICE_TOLERANCE (of the mesh size) of the other.
+     * Any mesh with a mismatched cut is logged as an error.
+     */
+    static void runSlicing();
+
+    /**
+     * Compares one PolygonObstacle per extruded cut segment against a single
+     * ChainObstacle per cut
+     *
+     * Every collision mesh is cut at a few angles through its center. For
+     * each cut we time creating the obstacles and stepping the world with a
+     * box dropped onto the cut.
+     */
+    static void runCutObstacles();
+
+    /**
+     * Compares building one quad (and draw) per billboard against the
+     * BillboardBatch at 10, 100 and 1000 billboards
+     *
+     * This only times the CPU side, but also reports how many draw calls
+     * each approach needs for the billboard and position passes.
+     */
+    static void runBillboards();
+
+    /**
+     * Compares projecting the corners of each billboard quad in every pass
+     * against culling the billboards once by their bounding spheres with
+     * FrameVisibility, at 10, 100 and 1000 billboards
+     *
+     * The billboards are scattered all around the camera, so most of them
+     * are off screen or out of the slab. Also reports how many billboards
+     * each approach keeps.
+     */
+    static void runVisibility();
+
+    /**
+     * Reports how much of each render mesh is left to draw once it is split
+     * into MeshChunks and culled against the visible slab
+     *
+     * The player is placed on a few vertices spread over every render mesh
+     * in assets/meshes, and the plane is turned all the way around each of
+     * them. Reports the time to chunk the mesh, the share of the triangles
+     * drawn, the draw calls the merged ranges need, and the culling time.
+     */
+    static void runMeshChunks();
+
+    /**
+     * Times binning 8, 64 and 256 lights into the screen tiles of a
+     * LightGrid, and reports how much of the full-screen-per-light work
+     * the tiles leave
+     */
+    static void runLightBinning();
+
+    /**
+     * Compares the per-frame item work on the containers GameModel used to
+     * keep (a map of collectibles copied every frame, shared decorations,
+     * glowsticks by value and their lights keyed by position strings) against
+     * the ItemStore, at 1000 and 10000 items
+     *
+     * Each frame turns every sprite, checks the collectibles against a moving
+     * player, picks up and places a glowstick, builds the billboards and
+     * gathers the glowstick lights.
+     */
+    static void runItems();
+
+    /**
+     * Times updating 16, 64 and 256 SoundEmitters as the player walks past
+     * them, and reports how many voices they needed
+     *
+     * Without a budget every emitter in earshot would be a mixer input; the
+     * report shows the most that were in earshot at once against the most
+     * voices used, and how often a voice was started.
+     */
+    static void runEmitters();
+
+    /**
+     * Compares testing every trigger region with libigl, testing every
+     * region with its RegionVolume, and updating through a TriggerIndex
+     *
+     * Every trigger region mesh in assets/meshes (well over 100 of them) is
+     * loaded into one index, and the player walks a straight line across
+     * all of them.
+     */
+    static void runTriggers();
+
+    /**
+     * Compares loading every mesh of each level pack with LOAD_ALL against
+     * loading it with the mode it is used for
+     *
+     * Render meshes use LOAD_RENDER, collision meshes LOAD_SLICE and trigger
+     * regions LOAD_CONTAINMENT. The LOAD_ALL run builds the same engines
+     * afterwards, so both end up able to do the same work. Reports the load
+     * time and the resident memory of the meshes.
+     */
+    static void runMeshLoading();
+
+    /**
+     * Compares loading each level from its JSON and OBJ files against
+     * loading it from its binary level
+     *
+     * Each level is loaded twice per path, so the first (cold) load and a
+     * repeated (warm) load are both reported. Levels that have not been
+     * converted are reported with the JSON times only.
+     *
+     * @param assets    The loaded assets (for the level JSON)
+     */
+    static void runLevelLoading(const std::shared_ptr<cugl::AssetManager>& assets);
+
+    /**
+     * Compares JsonValue key lookups against a linear scan of the children
+     *
+     * The first test looks up every key of a JSON_KEYS object in a scattered
+     * order. The second repeats the sprite lookups of LevelData on the level
+     * with the most sprites. The scan is how JsonValue found keys before it
+     * had a hash index, so the two times show what the index saves.
+     *
+     * @param assets    The loaded assets (for the level JSON)
+     */
+    static void runJsonLookup(const std::shared_ptr<cugl::AssetManager>& assets);
+
+    /**
+     * Compares parsing the large level files with JsonParser against parsing
+     * them with cJSON and converting the result
+     *
+     * Every level file of at least JSON_PARSE_MINIMUM bytes is parsed
+     * JSON_PARSE_RUNS times each way. The cJSON path is what JsonValue did
+     * before it had its own parser.
+     */
+    static void runJsonParsing();
+
+    /**
+     * Times a Profiler scope while the profiler is stopped and while it is
+     * recording, with PROFILER_WORKERS threads recording at the same time as
+     * the main thread collects
+     *
+     * This uses the Profiler class directly, so it runs whether or not the
+     * game was compiled with CU_PROFILING (the macros cost nothing without
+     * it). It is skipped if the game is already profiling itself.
+     */
+    static void runProfiler();
+
+    /**
+     * Compares the throughput of tiny tasks on the ThreadPool against the
+     * single locked queue it replaced
+     *
+     * Each pool runs POOL_TASKS tasks that only bump a counter, with one and
+     * POOL_THREADS threads. The tasks are queued from the main thread, from
+     * a worker (which keeps them on its own queue), and as a parallelFor.
+     */
+    static void runThreadPool();
+};
+
+#endif /* Benchmark_h */
@@ -0,0 +1,137 @@
+//
+//  BillboardBatch.cpp
+//  Pivot
+//
+//  CPU side of the batched billboard rendering.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "BillboardBatch.h"
+#include <algorithm>
+
+/** The quad size is the texture size divided by this */
+#define BILLBOARD_DIV   4
+
+/**
+ * Rebuilds the batch from the visible drawables
+ *
+ * @param drawables     The billboards of the frame
+ * @param visible       The indices of the billboards to draw
+ * @param right         The camera right vector
+ * @param up            The camera up vector
+ * @param flipPlayer    Whether the player sprite is flipped
+ */
+void BillboardBatch::build(const std::vector<DrawObject>& drawables, const std::vector<Uint32>& visible,
+                           const Vec3& right, const Vec3& up, bool flipPlayer) {
+    _vertices.clear();
+    _indices.clear();
+    _groups.clear();
+
+    // Rank the textures by first appearance, so the order is the same every run
+    _ranks.clear();
+    for (Uint32 ii : visible) {
+        _ranks.emplace(drawables[ii].tex.get(), (Uint32)_ranks.size());
+        _ranks.emplace(drawables[ii].normalMap.get(), (Uint32)_ranks.size());
+    }
+
+    // Sort by texture, then normal map, then flip (only the player flips)
+    _order.assign(visible.begin(), visible.end());
+    auto flipped = [&](const DrawObject& dro) { return dro.isPlayer && flipPlayer; };
+    auto rank = [&](const std::shared_ptr<Texture>& tex) { return _ranks.find(tex.get())->second; };
+    std::stable_sort(_order.begin(), _order.end(), [&](Uint32 a, Uint32 b) {
+        const DrawObject& da = drawables[a];
+        const DrawObject& db = drawables[b];
+        if (da.tex != db.tex) return rank(da.tex) < rank(db.tex);
+        if (da.normalMap != db.normalMap) return rank(da.normalMap) < rank(db.normalMap);
+        return flipped(da) < flipped(db);
+    });
+
+    _vertices.reserve(_order.size() * 4);
+    _indices.reserve(_order.size() * 6);
+    for (Uint32 ii : _order) {
+        const DrawObject& dro = drawables[ii];
+        buildQuad(dro, right, up, _vertices);
+
+        bool flip = flipped(dro);
+        if (_groups.empty() || _groups.back().tex != dro.tex || _groups.back().normalMap != dro.normalMap || _groups.back().flip != flip) {
+            Group group;
+            group.tex = dro.tex;
+            group.normalMap = dro.normalMap;
+            group.flip = flip;
+            group.offset = (Uint32)_indices.size();
+            group.count = 0;
+            _groups.push_back(group);
+        }
+
+        Uint32 base = (Uint32)_vertices.size() - 4;
+        for (int tri = 0; tri <= 1; tri++) {
+            for (int i = 0; i < 3; i++) {
+                _indices.push_back(base + tri + i);
+            }
+        }
+        _groups.back().count += 6;
+    }
+}
+
+/**
+ * Writes the quad of a single billboard
+ *
+ * @param dro       The billboard to draw
+ * @param right     The camera right vector
+ * @param up        The camera up vector
+ * @param result    The list to append the four vertices to
+ */
+void BillboardBatch::buildQuad(const DrawObject& dro, const Vec3& right, const Vec3& up,
+                               std::vector<PivotVertex3>& result) {
+    buildQuad(dro, dro.tex->getSize(), right, up, result);
+}
+
+/**
+ * Writes the quad of a single billboard with a texture of the given size
+ *
+ * @param dro       The billboard to draw
+ * @param sz        The size of the billboard texture
+ * @param right     The camera right vector
+ * @param up        The camera up vector
+ * @param result    The list to append the four vertices to
+ */
+void BillboardBatch::buildQuad(const DrawObject& dro, const Size& sz, const Vec3& right, const Vec3& up,
+                               std::vector<PivotVertex3>& result) {
+    Vec3 quadRight = dro.isPoster ? dro.posterNormal.getCross(up) : right;
+    PivotVertex3 tempV;
+    for (int si = -1; si <= 1; si += 2) {
+        for (int sj = -1; sj <= 1; sj += 2) {
+            float i = si * sz.width / (2 * BILLBOARD_DIV);
+            float j = sj * sz.height / (2 * BILLBOARD_DIV);
+            Vec3 addOn = (i * quadRight + j * up) * dro.scale;
+            tempV.texcoord = Vec2(si > 0 ? 1 : 0, sj > 0 ? 0 : 1);
+            if (dro.sheet != NULL) {
+                // assuming the spritesheet has square dimensions
+                addOn /= dro.sheet->getDimen().first;
+                tempV.texcoord.x += dro.sheet->getFrameCoords().first - 1;
+                tempV.texcoord.y += dro.sheet->getFrameCoords().second - 1;
+                tempV.texcoord.x /= dro.sheet->getDimen().first;
+                tempV.texcoord.y /= dro.sheet->getDimen().second;
+            }
+            tempV.position = dro.pos + addOn;
+            result.push_back(tempV);
+        }
+    }
+}
+
+/**
+ * Returns the radius of the bounding sphere of a billboard quad
+ *
+ * This is half the diagonal of the quad that buildQuad writes.
+ *
+ * @param dro   The billboard
+ */
+float BillboardBatch::getRadius(const DrawObject& dro) {
+    Size sz = dro.tex->getSize();
+    float radius = std::sqrt(sz.width * sz.width + sz.height * sz.height) / (2 * BILLBOARD_DIV) * dro.scale;
+    if (dro.sheet != NULL) {
+        radius /= dro.sheet->getDimen().first;
+    }
+    return std::abs(radius);
+}
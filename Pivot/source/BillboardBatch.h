@@ -0,0 +1,156 @@
+//
+//  BillboardBatch.h
+//  Pivot
+//
+//  CPU side of the batched billboard rendering. Every visible billboard is
+//  written as a quad into one vertex list, grouped so that billboards sharing
+//  a texture and normal map can be drawn with a single call.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef BillboardBatch_h
+#define BillboardBatch_h
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include "Mesh.h"
+
+using namespace cugl;
+
+/**
+ * An abstraction to draw billboards
+ */
+struct DrawObject {
+    Vec3 pos;
+    std::shared_ptr<cugl::Texture> tex;
+    std::shared_ptr<cugl::Texture> normalMap;
+    std::shared_ptr<cugl::SpriteSheet> sheet;
+    bool isPlayer;
+    bool emission;
+    bool fade;
+    bool isPoster;
+    float scale;
+    Vec3 posterNormal;
+
+    DrawObject(Vec3 pos, std::shared_ptr<cugl::Texture> tex, std::shared_ptr<cugl::Texture> normalMap, bool isPlayer, std::shared_ptr<cugl::SpriteSheet> sheet, bool fade, float scale,  Vec3 posterNormal = Vec3(0, 0, 0)) {
+        this->pos = pos;
+        this->tex = tex;
+        this->normalMap = normalMap;
+        this->isPlayer = isPlayer;
+        this->emission = normalMap == NULL;
+        this->sheet = sheet;
+        this->fade = fade;
+        this->isPoster = posterNormal != Vec3(0, 0, 0);
+        this->scale = scale;
+        this->posterNormal = posterNormal;
+    }
+};
+
+/**
+ * A batch of billboard quads, grouped by texture, normal map and flip.
+ *
+ * Everything in a group shares the same uniforms, so each group is one draw
+ * call. Groups are sorted by texture and then normal map, so consecutive
+ * groups only need to rebind what actually changed. Textures are ordered by
+ * when they are first seen in the drawables, so the drawing order does not
+ * depend on where the textures happen to be allocated.
+ *
+ * This class does not touch OpenGL; the pipeline uploads the vertices and
+ * indices and draws each group from its index range.
+ */
+class BillboardBatch {
+public:
+    /** A range of quads that can be drawn with a single call */
+    struct Group {
+        /** The texture of every billboard in the group */
+        std::shared_ptr<Texture> tex;
+        /** The normal map of every billboard in the group (NULL if emissive) */
+        std::shared_ptr<Texture> normalMap;
+        /** Whether the billboards are flipped horizontally */
+        bool flip;
+        /** The first index of the group */
+        Uint32 offset;
+        /** The number of indices in the group */
+        Uint32 count;
+
+        /** Returns true if the billboards are emissive (no lighting) */
+        bool emission() const { return normalMap == nullptr; }
+    };
+
+private:
+    /** The quad vertices, four per billboard */
+    std::vector<PivotVertex3> _vertices;
+    /** The quad indices, six per billboard */
+    std::vector<Uint32> _indices;
+    /** The groups, in drawing order */
+    std::vector<Group> _groups;
+    /** Scratch list for sorting the drawables */
+    std::vector<Uint32> _order;
+    /** The order each texture was first seen in this build (the sort key) */
+    std::unordered_map<const Texture*, Uint32> _ranks;
+
+public:
+    /**
+     * Rebuilds the batch from the visible drawables
+     *
+     * Only the drawables in the visible list are written, so the culling is
+     * up to the caller (see FrameVisibility).
+     *
+     * @param drawables     The billboards of the frame
+     * @param visible       The indices of the billboards to draw
+     * @param right         The camera right vector
+     * @param up            The camera up vector
+     * @param flipPlayer    Whether the player sprite is flipped
+     */
+    void build(const std::vector<DrawObject>& drawables, const std::vector<Uint32>& visible,
+               const Vec3& right, const Vec3& up, bool flipPlayer);
+
+    /**
+     * Writes the quad of a single billboard
+     *
+     * @param dro       The billboard to draw
+     * @param right     The camera right vector
+     * @param up        The camera up vector
+     * @param result    The list to append the four vertices to
+     */
+    static void buildQuad(const DrawObject& dro, const Vec3& right, const Vec3& up,
+                          std::vector<PivotVertex3>& result);
+
+    /**
+     * Writes the quad of a single billboard with a texture of the given size
+     *
+     * The vertices go left to right, and bottom to top within each side.
+     *
+     * @param dro       The billboard to draw
+     * @param size      The size of the billboard texture
+     * @param right     The camera right vector
+     * @param up        The camera up vector
+     * @param result    The list to append the four vertices to
+     */
+    static void buildQuad(const DrawObject& dro, const Size& size, const Vec3& right, const Vec3& up,
+                          std::vector<PivotVertex3>& result);
+
+    /**
+     * Returns the radius of the bounding sphere of a billboard quad
+     *
+     * The sphere is centered on the billboard position, and holds the quad
+     * whichever way it faces.
+     *
+     * @param dro   The billboard
+     */
+    static float getRadius(const DrawObject& dro);
+
+    /** Returns the quad vertices of the batch */
+    const std::vector<PivotVertex3>& getVertices() const { return _vertices; }
+
+    /** Returns the quad indices of the batch */
+    const std::vector<Uint32>& getIndices() const { return _indices; }
+
+    /** Returns the groups of the batch, in drawing order */
+    const std::vector<Group>& getGroups() const { return _groups; }
+
+    /** Returns the number of billboards in the batch */
+    size_t size() const { return _vertices.size() / 4; }
+};
+
+#endif /* BillboardBatch_h */
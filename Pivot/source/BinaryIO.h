@@ -0,0 +1,147 @@
+//
+//  BinaryIO.h
+//  Pivot
+//
+//  Array and string helpers on top of the CUGL binary reader and writer. Every
+//  array is stored as a 32 bit count followed by the elements, so it can be
+//  read back with a single bulk read.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef BinaryIO_h
+#define BinaryIO_h
+#include <cugl/cugl.h>
+#include <string>
+#include <vector>
+
+using namespace cugl;
+
+/** Arrays longer than this are treated as a corrupt file */
+#define BINARY_MAX_COUNT    (1u << 28)
+
+/**
+ * Static helpers for reading and writing arrays with a leading count.
+ *
+ * The read methods return false (rather than asserting) if the stream ends
+ * early or a count is unreasonable, so a damaged file can be rejected.
+ */
+class BinaryIO {
+public:
+    /**
+     * Reads an array count
+     *
+     * @param reader    The stream to read from
+     * @param count     The count read
+     *
+     * @return true if the count was read and is reasonable
+     */
+    static bool readCount(const std::shared_ptr<BinaryReader>& reader, Uint32& count) {
+        if (!reader->ready(4)) {
+            return false;
+        }
+        count = reader->readUint32();
+        return count <= BINARY_MAX_COUNT;
+    }
+
+    /**
+     * Reads a single float, returning false if the stream has ended
+     *
+     * @param reader    The stream to read from
+     * @param value     The value read
+     */
+    static bool readFloat(const std::shared_ptr<BinaryReader>& reader, float& value) {
+        if (!reader->ready(4)) {
+            return false;
+        }
+        value = reader->readFloat();
+        return true;
+    }
+
+    /**
+     * Reads an array of elements with a leading count
+     *
+     * @param reader    The stream to read from
+     * @param result    The array to fill
+     * @param width     The number of scalars per element
+     *
+     * @return true if the whole array was read
+     */
+    template <typename T, typename S>
+    static bool readArray(const std::shared_ptr<BinaryReader>& reader, std::vector<T>& result, size_t width = 1) {
+        Uint32 count;
+        if (!readCount(reader, count)) {
+            return false;
+        }
+        result.resize(count);
+        size_t scalars = count * width;
+        return scalars == 0 || reader->read((S*)result.data(), scalars) == scalars;
+    }
+
+    /**
+     * Writes an array of elements with a leading count
+     *
+     * @param writer    The stream to write to
+     * @param data      The array to write
+     * @param width     The number of scalars per element
+     */
+    template <typename T, typename S>
+    static void writeArray(const std::shared_ptr<BinaryWriter>& writer, const std::vector<T>& data, size_t width = 1) {
+        writer->writeUint32((Uint32)data.size());
+        if (!data.empty()) {
+            writer->write((const S*)data.data(), data.size() * width);
+        }
+    }
+
+    /** Reads an array of unsigned integers */
+    static bool readUints(const std::shared_ptr<BinaryReader>& reader, std::vector<Uint32>& result) {
+        return readArray<Uint32, Uint32>(reader, result);
+    }
+
+    /** Writes an array of unsigned integers */
+    static void writeUints(const std::shared_ptr<BinaryWriter>& writer, const std::vector<Uint32>& data) {
+        writeArray<Uint32, Uint32>(writer, data);
+    }
+
+    /** Reads an array of points (three floats each) */
+    static bool readVec3s(const std::shared_ptr<BinaryReader>& reader, std::vector<Vec3>& result) {
+        return readArray<Vec3, float>(reader, result, 3);
+    }
+
+    /** Writes an array of points (three floats each) */
+    static void writeVec3s(const std::shared_ptr<BinaryWriter>& writer, const std::vector<Vec3>& data) {
+        writeArray<Vec3, float>(writer, data, 3);
+    }
+
+    /** Reads a single point */
+    static bool readVec3(const std::shared_ptr<BinaryReader>& reader, Vec3& result) {
+        return readFloat(reader, result.x) && readFloat(reader, result.y) && readFloat(reader, result.z);
+    }
+
+    /** Writes a single point */
+    static void writeVec3(const std::shared_ptr<BinaryWriter>& writer, const Vec3& value) {
+        writer->writeFloat(value.x);
+        writer->writeFloat(value.y);
+        writer->writeFloat(value.z);
+    }
+
+    /** Reads a string */
+    static bool readString(const std::shared_ptr<BinaryReader>& reader, std::string& result) {
+        std::vector<char> chars;
+        if (!readArray<char, char>(reader, chars)) {
+            return false;
+        }
+        result.assign(chars.begin(), chars.end());
+        return true;
+    }
+
+    /** Writes a string */
+    static void writeString(const std::shared_ptr<BinaryWriter>& writer, const std::string& value) {
+        writer->writeUint32((Uint32)value.size());
+        if (!value.empty()) {
+            writer->write(value.data(), value.size());
+        }
+    }
+};
+
+#endif /* BinaryIO_h */
@@ -0,0 +1,191 @@
+//
+//  CutCache.cpp
+//  Pivot
+//
+//  LRU cache of finished cuts.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "CutCache.h"
+
+/** Plane offsets closer than this share a cache entry */
+#define OFFSET_QUANTUM  0.001
+/** Normals with a larger z component are not cached */
+#define HORIZONTAL_EPS  0.0001f
+
+/**
+ * Initializes an empty cache with the given budget
+ *
+ * @param budget    The memory budget in bytes
+ * @param step      The angle quantum in degrees
+ * @param tolerance The distance in degrees a normal may be from a quantized angle
+ *
+ * @return true if the cache was initialized properly
+ */
+bool CutCache::init(size_t budget, float step, float tolerance) {
+    if (step <= 0) {
+        CULogError("Cut cache step must be positive");
+        return false;
+    }
+    if (tolerance < 0) {
+        CULogError("Cut cache tolerance must not be negative");
+        return false;
+    }
+    _angles = std::max(1, (int)std::round(360.0f / step));
+    _step = 2 * M_PI / _angles;
+    _tolerance = std::min(tolerance * (float)M_PI / 180.0f, _step / 2);
+    _budget = budget;
+    clear();
+    resetCounters();
+    return true;
+}
+
+/**
+ * Returns the normal rounded to the nearest quantized angle
+ *
+ * @param normal    The plane normal
+ */
+Vec3 CutCache::snap(const Vec3& normal) const {
+    if (std::abs(normal.z) > HORIZONTAL_EPS) {
+        return normal;
+    }
+    int k = (int)std::lround(std::atan2(normal.y, normal.x) / _step);
+    k = ((k % _angles) + _angles) % _angles;
+    return Vec3(std::cos(k * _step), std::sin(k * _step), 0);
+}
+
+/**
+ * Looks up the cut for the given plane, counting a hit or a miss
+ *
+ * @param origin    The plane origin
+ * @param normal    The plane normal
+ * @param paths     The list to store the projected contours
+ *
+ * @return true if the cut was in the cache
+ */
+bool CutCache::find(const Vec3& origin, const Vec3& normal, std::vector<Path2>& paths) {
+    Key key;
+    auto it = makeKey(origin, normal, key) ? _index.find(key) : _index.end();
+    if (it == _index.end()) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+
+    // most recently used goes to the front
+    _entries.splice(_entries.begin(), _entries, it->second);
+    const Entry& entry = _entries.front();
+
+    Vec2 shift = project(origin, normal);
+    paths.clear();
+    paths.reserve(entry.paths.size());
+    for (auto& path : entry.paths) {
+        paths.push_back(Path2(path) -= shift);
+    }
+    return true;
+}
+
+/**
+ * Returns true if the cut for the given plane is in the cache
+ *
+ * @param origin    The plane origin
+ * @param normal    The plane normal
+ */
+bool CutCache::contains(const Vec3& origin, const Vec3& normal) const {
+    Key key;
+    return makeKey(origin, normal, key) && _index.find(key) != _index.end();
+}
+
+/**
+ * Stores the cut for the given plane, evicting old cuts to stay in budget
+ *
+ * @param origin    The plane origin
+ * @param normal    The plane normal
+ * @param paths     The projected contours
+ */
+void CutCache::insert(const Vec3& origin, const Vec3& normal, const std::vector<Path2>& paths) {
+    Key key;
+    if (!makeKey(origin, normal, key)) {
+        return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.bytes = sizeof(Entry);
+
+    // store relative to the world origin so any origin in the plane can use it
+    Vec2 shift = project(origin, normal);
+    entry.paths.reserve(paths.size());
+    for (auto& path : paths) {
+        entry.paths.push_back(path + shift);
+        entry.bytes += sizeof(Path2) + path.vertices.size() * sizeof(Vec2) + path.corners.size() * sizeof(size_t);
+    }
+    if (entry.bytes > _budget) {
+        return;
+    }
+
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        _usage -= it->second->bytes;
+        _entries.erase(it->second);
+        _index.erase(it);
+    }
+
+    while (!_entries.empty() && _usage + entry.bytes > _budget) {
+        _usage -= _entries.back().bytes;
+        _index.erase(_entries.back().key);
+        _entries.pop_back();
+        _evictions++;
+    }
+
+    _usage += entry.bytes;
+    _entries.push_front(std::move(entry));
+    _index[key] = _entries.begin();
+}
+
+/**
+ * Removes every cut from the cache (the counters are kept)
+ */
+void CutCache::clear() {
+    _entries.clear();
+    _index.clear();
+    _usage = 0;
+}
+
+/**
+ * Computes the key for the given plane
+ *
+ * @param origin    The plane origin
+ * @param normal    The plane normal
+ * @param key       The key to store the result
+ *
+ * @return false if the plane cannot be cached (or is off the quantized angles)
+ */
+bool CutCache::makeKey(const Vec3& origin, const Vec3& normal, Key& key) const {
+    if (_angles == 0 || std::abs(normal.z) > HORIZONTAL_EPS) {
+        return false;
+    }
+    float angle = std::atan2(normal.y, normal.x);
+    int k = (int)std::lround(angle / _step);
+    if (std::abs(angle - k * _step) > _tolerance) {
+        return false;
+    }
+    key.angle = ((k % _angles) + _angles) % _angles;
+    key.offset = std::llround(normal.dot(origin) / OFFSET_QUANTUM);
+    return true;
+}
+
+/**
+ * Returns the position of the world space point in the plane basis
+ *
+ * This is the same basis that PlaneController uses to project the cut.
+ *
+ * @param point     The world space point
+ * @param normal    The plane normal
+ */
+Vec2 CutCache::project(const Vec3& point, const Vec3& normal) {
+    Vec3 upvec(0, 0, 1);
+    Vec3 rightvec = upvec.getCross(normal).normalize();
+    return Vec2(rightvec.dot(point), upvec.dot(point));
+}
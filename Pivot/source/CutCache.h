@@ -0,0 +1,245 @@
+//
+//  CutCache.h
+//  Pivot
+//
+//  LRU cache of finished cuts. Players tend to swing back and forth around the
+//  same few angles, so a cut that was computed once is kept around (within a
+//  memory budget) and reused the next time the plane lands on that angle.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef CutCache_h
+#define CutCache_h
+#include <cugl/cugl.h>
+#include <list>
+#include <unordered_map>
+
+using namespace cugl;
+
+/** Default memory budget of the cache in kilobytes */
+#define CUT_CACHE_BUDGET_KB 16384
+/** Default angle quantum of the cache in degrees */
+#define CUT_CACHE_STEP      1.0f
+/** Default distance in degrees a normal may be from a quantized angle and still use its cut */
+#define CUT_CACHE_TOLERANCE 0.01f
+
+/**
+ * A least-recently-used cache of cuts through a single collision mesh.
+ *
+ * A cut only depends on the plane, not on where the origin sits inside of it.
+ * So entries are keyed by the quantized normal angle and the plane offset
+ * (normal.dot(origin)), and are stored in plane coordinates relative to the
+ * world origin. A lookup shifts the stored cut into the frame of the current
+ * origin.
+ *
+ * The quantized angle is only a key, and never changes the plane. A cut is
+ * only cached or reused if the normal is within the tolerance of its
+ * quantized angle, so the cache holds the cuts that PlaneController::
+ * prewarmCuts computes at those angles and any plane that lands on one of
+ * them. Only horizontal normals are cached.
+ *
+ * This class is not thread safe. Once it is given to the model it should only
+ * be used on the main thread, though the level loader may fill a new cache on
+ * its worker first.
+ */
+class CutCache {
+private:
+    /** The cache key (quantized angle and offset) */
+    struct Key {
+        /** The index of the quantized normal angle */
+        int angle;
+        /** The quantized plane offset */
+        long long offset;
+
+        bool operator==(const Key& other) const {
+            return angle == other.angle && offset == other.offset;
+        }
+    };
+
+    /** Hash function for a cache key */
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<long long>()(key.offset * 1000003LL + key.angle);
+        }
+    };
+
+    /** A cached cut, in plane coordinates relative to the world origin */
+    struct Entry {
+        /** The key of this entry */
+        Key key;
+        /** The projected contours */
+        std::vector<Path2> paths;
+        /** The approximate size of this entry in bytes */
+        size_t bytes;
+    };
+
+    /** The entries, most recently used first */
+    std::list<Entry> _entries;
+    /** The position of each key in the entry list */
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+
+    /** The angle quantum in radians */
+    float _step;
+    /** The distance in radians a normal may be from a quantized angle */
+    float _tolerance;
+    /** The number of quantized angles around the circle */
+    int _angles;
+    /** The memory budget in bytes */
+    size_t _budget;
+    /** The memory currently used by the entries in bytes */
+    size_t _usage;
+    /** Whether the level asked for the cache to be filled at load time */
+    bool _prewarm;
+
+    /** The number of lookups that found a cut */
+    Uint64 _hits;
+    /** The number of lookups that did not find a cut */
+    Uint64 _misses;
+    /** The number of cuts dropped to stay within budget */
+    Uint64 _evictions;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty cache. You must call init before using it.
+     */
+    CutCache() : _step(0), _tolerance(0), _angles(0), _budget(0), _usage(0), _prewarm(false),
+        _hits(0), _misses(0), _evictions(0) {}
+
+    /**
+     * Initializes an empty cache with the given budget
+     *
+     * @param budget    The memory budget in bytes
+     * @param step      The angle quantum in degrees
+     * @param tolerance The distance in degrees a normal may be from a quantized angle
+     *
+     * @return true if the cache was initialized properly
+     */
+    bool init(size_t budget, float step = CUT_CACHE_STEP, float tolerance = CUT_CACHE_TOLERANCE);
+
+    /**
+     * Returns a newly allocated cache with the given budget
+     *
+     * @param budget    The memory budget in bytes
+     * @param step      The angle quantum in degrees
+     * @param tolerance The distance in degrees a normal may be from a quantized angle
+     *
+     * @return a newly allocated cache with the given budget
+     */
+    static std::shared_ptr<CutCache> alloc(size_t budget, float step = CUT_CACHE_STEP,
+                                           float tolerance = CUT_CACHE_TOLERANCE) {
+        std::shared_ptr<CutCache> result = std::make_shared<CutCache>();
+        return (result->init(budget, step, tolerance) ? result : nullptr);
+    }
+
+#pragma mark Cache Access
+    /**
+     * Returns the normal rounded to the nearest quantized angle
+     *
+     * This is the normal the cut of a cache entry should be computed for.
+     * Normals that are not horizontal are returned unchanged.
+     *
+     * @param normal    The plane normal
+     */
+    Vec3 snap(const Vec3& normal) const;
+
+    /**
+     * Looks up the cut for the given plane, counting a hit or a miss
+     *
+     * On a hit the cut is shifted into the plane frame of the given origin and
+     * copied into paths. The entry becomes the most recently used.
+     *
+     * @param origin    The plane origin
+     * @param normal    The plane normal
+     * @param paths     The list to store the projected contours
+     *
+     * @return true if the cut was in the cache
+     */
+    bool find(const Vec3& origin, const Vec3& normal, std::vector<Path2>& paths);
+
+    /**
+     * Returns true if the cut for the given plane is in the cache
+     *
+     * This does not count towards the hit and miss counters.
+     *
+     * @param origin    The plane origin
+     * @param normal    The plane normal
+     */
+    bool contains(const Vec3& origin, const Vec3& normal) const;
+
+    /**
+     * Stores the cut for the given plane, evicting old cuts to stay in budget
+     *
+     * The cut must be in the plane frame of the given origin, as computed by
+     * PlaneController::computeCut. Nothing is stored if the normal is not
+     * within the tolerance of a quantized angle.
+     *
+     * @param origin    The plane origin
+     * @param normal    The plane normal
+     * @param paths     The projected contours
+     */
+    void insert(const Vec3& origin, const Vec3& normal, const std::vector<Path2>& paths);
+
+    /**
+     * Removes every cut from the cache (the counters are kept)
+     */
+    void clear();
+
+#pragma mark Attributes
+    /** Returns the number of cached cuts */
+    size_t size() const { return _entries.size(); }
+
+    /** Returns the approximate memory used by the cached cuts in bytes */
+    size_t getMemoryUsage() const { return _usage; }
+
+    /** Returns the memory budget in bytes */
+    size_t getBudget() const { return _budget; }
+
+    /** Returns the angle quantum in degrees */
+    float getStep() const { return _step * 180.0f / M_PI; }
+
+    /** Returns the distance in degrees a normal may be from a quantized angle */
+    float getTolerance() const { return _tolerance * 180.0f / M_PI; }
+
+    /** Returns whether the cache should be filled when the level is loaded */
+    bool getPrewarm() const { return _prewarm; }
+
+    /** Sets whether the cache should be filled when the level is loaded */
+    void setPrewarm(bool value) { _prewarm = value; }
+
+#pragma mark Profiling
+    /** Returns the number of lookups that found a cut */
+    Uint64 getHits() const { return _hits; }
+
+    /** Returns the number of lookups that did not find a cut */
+    Uint64 getMisses() const { return _misses; }
+
+    /** Returns the number of cuts dropped to stay within budget */
+    Uint64 getEvictions() const { return _evictions; }
+
+    /** Resets the hit, miss and eviction counters */
+    void resetCounters() { _hits = _misses = _evictions = 0; }
+
+private:
+    /**
+     * Computes the key for the given plane
+     *
+     * @param origin    The plane origin
+     * @param normal    The plane normal
+     * @param key       The key to store the result
+     *
+     * @return false if the plane cannot be cached (or is off the quantized angles)
+     */
+    bool makeKey(const Vec3& origin, const Vec3& normal, Key& key) const;
+
+    /**
+     * Returns the position of the world space point in the plane basis
+     *
+     * @param point     The world space point
+     * @param normal    The plane normal
+     */
+    static Vec2 project(const Vec3& point, const Vec3& normal);
+};
+
+#endif /* CutCache_h */
@@ -24,22 +24,33 @@ bool DataController::loadGameModel(std::string level, const std::shared_ptr<Game
     // get the level json
     std::shared_ptr<cugl::JsonValue> constants = _assets->get<JsonValue>(level);
 
-    // load the new meshes
-    //CULog("%s", Application::get()->getAssetDirectory().c_str());
-    std::string assetDirectoryPath = Application::get()->getAssetDirectory();
-    std::string rendmeshPath = constants->getString("render_mesh");
-
-    assetDirectoryPath.append(rendmeshPath);
-    assetDirectoryPath = filetool::normalize_path(assetDirectoryPath);
-    model->_renderMesh = PivotMesh::MeshFromOBJ(assetDirectoryPath);
-
-    assetDirectoryPath = Application::get()->getAssetDirectory();
-    std::string colmeshPath = constants->getString("collision_mesh");
+    // load the meshes and tables, from the binary level if it has been converted
+    if (!loadLevelData(level, constants)) {
+        return false;
+    }
 
-    assetDirectoryPath.append(colmeshPath);
-    assetDirectoryPath = filetool::normalize_path(assetDirectoryPath);
-    model->_colMesh = PivotMesh::MeshFromOBJ(assetDirectoryPath);
+    // cuts depend on the collision mesh, so every level gets a fresh cache
+    return loadGameModel(level, model, _level, allocCutCache(constants));
+}
 
+/**
+ *  Loads a new level that has already been read
+ *
+ *  @param level    The location of the level json to be loaded
+ *  @param model    The game model to load the level data into
+ *  @param data     The level data (see readLevelData)
+ *  @param cache    The cut cache of the level (see allocCutCache)
+ *
+ *  @return true if the model is initialized properly, false otherwise.
+ */
+bool DataController::loadGameModel(std::string level, const std::shared_ptr<GameModel>& model,
+                                   const std::shared_ptr<LevelData>& data, const std::shared_ptr<CutCache>& cache) {
+    if (!setLevelData(level, data)) {
+        return false;
+    }
+    model->_renderMesh = _level->getRenderMesh();
+    model->_colMesh = _level->getColMesh();
+    model->setCutCache(cache);
 
     // call reset game model
     return resetGameModel(level, model);
@@ -137,9 +148,6 @@ bool DataController::resetGameModel(std::string level, const std::shared_ptr<Gam
     // get the number of glowsticks
     model->_numGlowsticks = constants->get("glowsticks")->asInt();
     
-    // get the sprites
-    std::shared_ptr<cugl::JsonValue> sprites = constants->get("sprites");
-
     // remove any active popups
     model->clearPopups();
     // remove any active messages
@@ -168,198 +176,81 @@ bool DataController::resetGameModel(std::string level, const std::shared_ptr<Gam
     std::vector<float> col_scales;
     std::vector<float> col_angles;
 
-    for (int i = 0; i < sprites->size(); i++) {
-        auto iscol = sprites->get(std::to_string(i))->get("collectible")->asBool();
-        auto isbill = sprites->get(std::to_string(i))->get("billboard")->asBool();
-        auto isemit = sprites->get(std::to_string(i))->get("emissive")->asBool();
-        
-        float pulse;
-        if(sprites->get(std::to_string(i))->get("pulse") != nullptr){
-            pulse = sprites->get(std::to_string(i))->get("pulse")->asFloat();
-//            CULog("%f, pulse", sprites->get(std::to_string(i))->get("pulse")->asFloat());
-        }else{
-            pulse = 0.0f;
-        }
-        
-        auto tex = sprites->get(std::to_string(i))->getString("tex");
+    if ((_level == nullptr || _levelName != level) && !loadLevelData(level, constants)) {
+        return false;
+    }
 
-        if (iscol && (tex != "")) {
+    for (const LevelData::Sprite& sprite : _level->getSprites()) {
+        std::string texkey = sprite.tex;
+        // TODO: convert normal to an angle,
+        float offsetAngle = getOffsetAngleDeg(sprite.norm);
+
+        if (sprite.is(LevelData::SPRITE_COLLECTIBLE)) {
             // its a collectible
-            // get sprite location
-            Vec3 loc;
-            loc.x = sprites->get(std::to_string(i))->get("loc")->get(0)->asFloat();
-            loc.y = sprites->get(std::to_string(i))->get("loc")->get(1)->asFloat();
-            loc.z = sprites->get(std::to_string(i))->get("loc")->get(2)->asFloat();
-            col_locs.push_back(loc);
-
-            Vec3 norm;
-            norm.x = sprites->get(std::to_string(i))->get("norm")->get(0)->asFloat();
-            norm.y = sprites->get(std::to_string(i))->get("norm")->get(1)->asFloat();
-            norm.z = sprites->get(std::to_string(i))->get("norm")->get(2)->asFloat();
-            // TODO: convert normal to an angle,
-            float offsetAngle = getOffsetAngleDeg(norm);
-            col_angles.push_back(offsetAngle);
+            col_locs.push_back(sprite.loc);
             // use angle to offset the rotating sprite index so they dont all look the same
-
-            //get sprite scale
-            float scale = sprites->get(std::to_string(i))->get("scale")->asFloat();
-            col_scales.push_back(scale);
+            col_angles.push_back(offsetAngle);
             // TODO use scale to scale sprites differently @matt
+            col_scales.push_back(sprite.scale);
 
             // get sprite texture
-            std::string texKey = tex;
-            std::shared_ptr<Texture> tex = _assets->get<Texture>(texKey);
-            std::shared_ptr<Texture> normaltex = _assets->get<Texture>(texKey + "-normal");
-            col_texs.push_back(tex);
-            col_normal_texs.push_back(normaltex);
+            col_texs.push_back(_assets->get<Texture>(texkey));
+            col_normal_texs.push_back(_assets->get<Texture>(texkey + "-normal"));
 
-            // does the sprite emit light?
-            auto haslight = !sprites->get(std::to_string(i))->get("color")->isNull();
-            if (haslight) {
-                Vec3 color;
-                color.x = sprites->get(std::to_string(i))->get("color")->get(0)->asFloat();
-                color.y = sprites->get(std::to_string(i))->get("color")->get(1)->asFloat();
-                color.z = sprites->get(std::to_string(i))->get("color")->get(2)->asFloat();
-
-                float intensity = sprites->get(std::to_string(i))->get("intense")->asFloat();
-                float radius = sprites->get(std::to_string(i))->get("radius")->asFloat(); //falloff
-                // TODO make lights for those sprites here
-                // those lights need to disappear when the collectible is collected
-                // same as glowsticks @jolene
-            }
+            // TODO make lights for those sprites here
+            // those lights need to disappear when the collectible is collected
+            // same as glowsticks @jolene
 
             //TODO if(isemit) put it in the emissive collectibles
         }
-        else if (tex == "") {
-            // its ONLY a light with no texture
-            Vec3 color;
-            color.x = sprites->get(std::to_string(i))->get("color")->get(0)->asFloat();
-            color.y = sprites->get(std::to_string(i))->get("color")->get(1)->asFloat();
-            color.z = sprites->get(std::to_string(i))->get("color")->get(2)->asFloat();
-
-            Vec3 loc;
-            loc.x = sprites->get(std::to_string(i))->get("loc")->get(0)->asFloat();
-            loc.y = sprites->get(std::to_string(i))->get("loc")->get(1)->asFloat();
-            loc.z = sprites->get(std::to_string(i))->get("loc")->get(2)->asFloat();
-
-
-            float intensity = sprites->get(std::to_string(i))->get("intense")->asFloat();
-            float radius = sprites->get(std::to_string(i))->get("radius")->asFloat(); //falloff
-            //TODO @matt how to make lights with falloff?
-
-            GameModel::Light light = GameModel::Light(color, intensity, loc, radius, pulse);
-            model->_lights.push_back(light);
-
-        }
-
-        else if (isbill) {
+        else if (sprite.is(LevelData::SPRITE_BILLBOARD)) {
             // its a decoration
-            Vec3 loc;
-            loc.x = sprites->get(std::to_string(i))->get("loc")->get(0)->asFloat();
-            loc.y = sprites->get(std::to_string(i))->get("loc")->get(1)->asFloat();
-            loc.z = sprites->get(std::to_string(i))->get("loc")->get(2)->asFloat();
-            
-            Vec3 norm;
-            norm.x = sprites->get(std::to_string(i))->get("norm")->get(0)->asFloat();
-            norm.y = sprites->get(std::to_string(i))->get("norm")->get(1)->asFloat();
-            norm.z = sprites->get(std::to_string(i))->get("norm")->get(2)->asFloat();
-            // TODO: convert normal to an angle,
-            float offsetAngle = getOffsetAngleDeg(norm);
-            // use angle to offset the rotating sprite index so they dont all look the same
-            
-            //get sprite scale
-            float scale = sprites->get(std::to_string(i))->get("scale")->asFloat();
-            // TODO use scale to scale sprites differently @matt
-            
-            //get texture
-            auto texkey = sprites->get(std::to_string(i))->getString("tex");
-            std::shared_ptr<GameItem> decPtr = std::make_shared<GameItem>(loc, "deco" + std::to_string(i), _assets->get<Texture>(texkey), offsetAngle, scale);
+            std::shared_ptr<Texture> normal = _assets->get<Texture>(texkey + "-normal");
+            model->_decorations.add(sprite.loc, SpriteSheet::alloc(_assets->get<Texture>(texkey), 6, 6),
+                                    normal != nullptr ? SpriteSheet::alloc(_assets->get<Texture>(texkey), 6, 6) : nullptr,
+                                    offsetAngle, sprite.scale, "deco" + std::to_string(sprite.index));
+            size_t index = model->_decorations.size() - 1;
             
             // does the sprite emit light?
-            auto haslight = !sprites->get(std::to_string(i))->get("color")->isNull();
-            if (haslight) {
-                Vec3 color;
-                color.x = sprites->get(std::to_string(i))->get("color")->get(0)->asFloat();
-                color.y = sprites->get(std::to_string(i))->get("color")->get(1)->asFloat();
-                color.z = sprites->get(std::to_string(i))->get("color")->get(2)->asFloat();
-                
-                float intensity = sprites->get(std::to_string(i))->get("intense")->asFloat();
-                float radius = sprites->get(std::to_string(i))->get("radius")->asFloat(); //falloff
-                // TODO make lights for those sprites here
-                decPtr->setColor(color);
-                decPtr->setIntense(intensity);
-                decPtr->setRadius(radius);
-                decPtr->setPulse(pulse);
+            if (sprite.is(LevelData::SPRITE_LIGHT)) {
+                model->_decorations.setLight(index, sprite.color, sprite.intensity, sprite.radius, sprite.pulse);
                 // These could just go in the scene bc they never disappear
             }
-        
-            decPtr->setIsemit(isemit);
-            decPtr->rotateSpriteSheet = SpriteSheet::alloc(_assets->get<Texture>(texkey), 6, 6);
             
-            if(_assets->get<Texture>(texkey + "-normal") != nullptr){
-                decPtr->rotateNormalSpriteSheet = SpriteSheet::alloc(_assets->get<Texture>(texkey), 6, 6);
+            // without a normal map it is always emissive
+            if (normal != nullptr) {
+                model->_decorations.setEmissive(index, sprite.is(LevelData::SPRITE_EMISSIVE));
             }
-            else {
-                decPtr->setIsemit(true);
-            }
-            
-            model->_decorations.push_back(decPtr);
-            
         }
         else {
-            // its a poster
-            Vec3 loc;
-            loc.x = sprites->get(std::to_string(i))->get("loc")->get(0)->asFloat();
-            loc.y = sprites->get(std::to_string(i))->get("loc")->get(1)->asFloat();
-            loc.z = sprites->get(std::to_string(i))->get("loc")->get(2)->asFloat();
-
-            Vec3 norm;
-            norm.x = sprites->get(std::to_string(i))->get("norm")->get(0)->asFloat();
-            norm.y = sprites->get(std::to_string(i))->get("norm")->get(1)->asFloat();
-            norm.z = sprites->get(std::to_string(i))->get("norm")->get(2)->asFloat();
-            // TODO: convert normal to an angle,
-            float offsetAngle = getOffsetAngleDeg(norm);
-            // use normal to orient poster
-
-            //get sprite scale
-            float scale = sprites->get(std::to_string(i))->get("scale")->asFloat();
-            // TODO use scale to scale sprites differently @matt
-
-            //get texture
-            auto texkey = sprites->get(std::to_string(i))->getString("tex");
-            std::shared_ptr<GameItem> posPtr = std::make_shared<GameItem>(loc, "poster" + std::to_string(i), _assets->get<Texture>(texkey), offsetAngle, scale);
+            // its a poster (the normal orients it)
+            std::shared_ptr<Texture> normal = _assets->get<Texture>(texkey + "-normal");
+            model->_posters.add(sprite.loc, SpriteSheet::alloc(_assets->get<Texture>(texkey), 1, 1),
+                                normal != nullptr ? SpriteSheet::alloc(_assets->get<Texture>(texkey), 1, 1) : nullptr,
+                                offsetAngle, sprite.scale, "poster" + std::to_string(sprite.index));
+            size_t index = model->_posters.size() - 1;
             
             // does the sprite emit light?
-            auto haslight = !sprites->get(std::to_string(i))->get("color")->isNull();
-            if (haslight){
-                Vec3 color;
-                color.x = sprites->get(std::to_string(i))->get("color")->get(0)->asFloat();
-                color.y = sprites->get(std::to_string(i))->get("color")->get(1)->asFloat();
-                color.z = sprites->get(std::to_string(i))->get("color")->get(2)->asFloat();
-
-                float intensity = sprites->get(std::to_string(i))->get("intense")->asFloat();
-                float radius = sprites->get(std::to_string(i))->get("radius")->asFloat(); //falloff
-                posPtr->setColor(color);
-                posPtr->setIntense(intensity);
-                posPtr->setRadius(radius);
-                posPtr->setPulse(pulse);
+            if (sprite.is(LevelData::SPRITE_LIGHT)) {
+                model->_posters.setLight(index, sprite.color, sprite.intensity, sprite.radius, sprite.pulse);
                 // TODO make lights for those sprites here @jolene
             }
-            //TODO add poster to model
-            posPtr->setIsemit(isemit);
-            posPtr->setNormal(norm);
-            posPtr->rotateSpriteSheet = SpriteSheet::alloc(_assets->get<Texture>(texkey), 1, 1);
+            model->_posters.setNormal(index, sprite.norm);
             
-            if(_assets->get<Texture>(texkey + "-normal") != nullptr){
-                posPtr->rotateNormalSpriteSheet = SpriteSheet::alloc(_assets->get<Texture>(texkey), 1, 1);
-            }
-            else {
-                posPtr->setIsemit(true);
+            // without a normal map it is always emissive
+            if (normal != nullptr) {
+                model->_posters.setEmissive(index, sprite.is(LevelData::SPRITE_EMISSIVE));
             }
-            model->_posters.push_back(posPtr);
             //TODO if(isemit) put it in the emissive posters
         }
     }
+
+    // the lights with no texture
+    //TODO @matt how to make lights with falloff?
+    for (const LevelData::Light& light : _level->getLights()) {
+        model->_lights.push_back(GameModel::Light(light.color, light.intensity, light.loc, light.falloff, light.pulse));
+    }
+
     if (col_locs.size() > 0) {
         model->_nav_target = col_locs[0];
     }
@@ -369,89 +260,177 @@ bool DataController::resetGameModel(std::string level, const std::shared_ptr<Gam
     model->setCollectibles(col_locs, col_texs, col_normal_texs, col_scales, col_angles);
 
 
-    // emitters (sound points)
-    std::shared_ptr<cugl::JsonValue> emitters = constants->get("sounds");
-    for (int i = 0; i < emitters->size(); i++) {
-        //get location
-        Vec3 loc;
-        loc.x = sprites->get(std::to_string(i))->get("loc")->get(0)->asFloat();
-        loc.y = sprites->get(std::to_string(i))->get("loc")->get(1)->asFloat();
-        loc.z = sprites->get(std::to_string(i))->get("loc")->get(2)->asFloat();
-
-        //get the sound
-        std::string sound = emitters->get(std::to_string(i))->get("sound")->asString();
-
-        //get the radius
-        float radius = emitters->get(std::to_string(i))->get("radius")->asFloat();
-
-        //TODO @Gordi ^^^ use these, make emitters
-        // rn the sounds are named sound_0 and sound_1, you will need to change them in the level json
-        // we need to meet about what makes what sounds, and we can set this up properly later
-
+    // sound emitters (only the loudest few are given a voice)
+    model->_emitters.clear();
+    model->_emitters.setVoiceBudget(_emitterVoices);
+    for (const LevelData::Emitter& emitter : _level->getEmitters()) {
+        std::shared_ptr<Sound> sound = _assets->get<Sound>(emitter.sound);
+        if (sound == nullptr) {
+            CULogError("Level %s has an emitter with the unknown sound %s", level.c_str(), emitter.sound.c_str());
+            continue;
+        }
+        model->_emitters.add(emitter.sound, emitter.loc, emitter.radius, (float)sound->getDuration());
     }
 
+    // get and set triggers (the regions are kept with the level, so a reset does not reload them)
+    loadTriggers(_level, model);
 
-    // get and set triggers
-    std::shared_ptr<cugl::JsonValue> triggers = constants->get("triggers");
 
-    if (triggers != nullptr) {
-        for (int i = 0; i < triggers->size(); i++) {
-            std::string region_path = triggers->get(std::to_string(i))->getString("mesh");
-            std::string assetDirectoryPath = Application::get()->getAssetDirectory();
-            assetDirectoryPath.append(region_path);
-            assetDirectoryPath = filetool::normalize_path(assetDirectoryPath);
-            auto region = PivotMesh::MeshFromOBJ(assetDirectoryPath);
-            auto trig = std::make_shared<Trigger>(region);
 
-            std::string trig_type = triggers->get(std::to_string(i))->getString("type");
+    // get and set level id
+    std::string level_id = constants->getString("level_id");
+    model->setName(level_id);
 
+    return true;
+}
 
+/**
+ *  Gives the model a new cut cache, as configured by the level json
+ *
+ *  @param constants    The level json
+ *  @param model        The game model to set the cache of
+ */
+void DataController::loadCutCache(const std::shared_ptr<cugl::JsonValue>& constants, const std::shared_ptr<GameModel>& model) {
+    model->setCutCache(allocCutCache(constants));
+}
 
-            if (trig_type == "DEATH") {
-                auto args = TriggerArgs();
-                args.player = model->_player;
-                trig->registerEnterCallback(Trigger::killPlayer, args);
-            }
-            else if (trig_type == "POPUP"){
-                std::string image = triggers->get(std::to_string(i))->getString("image");
-                auto args = TriggerArgs();
-                args.popup = model->_popup;
-                args.image = image;
-                trig->registerEnterCallback(Trigger::showPopup, args);
-                trig->registerInBoundsCallback(Trigger::showPopup, args);
-                trig->registerExitCallback(Trigger::stopPopups, args);
-            }
-            else if (trig_type == "MESSAGE") {
-                std::string message = triggers->get(std::to_string(i))->getString("message");
-                auto args = TriggerArgs();
-                args.messages = model->_messages;
-                args.text = message;
-                trig->registerEnterCallback(Trigger::showMessage, args);
-                trig->registerInBoundsCallback(Trigger::showMessage, args);
-                trig->registerExitCallback(Trigger::stopMessages, args);
-            }
-            else if (trig_type == "EXITREGION") {
-                auto args = TriggerArgs();
-                args.messages = model->_messages;
-                args.text = "I FEEL LIKE I'M MISSING SOMETHING...";
-                trig->registerEnterCallback(Trigger::showExitMess, args);
-                trig->registerInBoundsCallback(Trigger::showExitMess, args);
-                trig->registerExitCallback(Trigger::stopMessages, args);
-
-                // TODO @sarah you wanted this to check if you have enough collectibles
-            }
+/**
+ *  Returns a new cut cache, as configured by the level json
+ *
+ *  @param constants    The level json
+ *
+ *  @return a new cut cache, or nullptr if the level turns caching off
+ */
+std::shared_ptr<CutCache> DataController::allocCutCache(const std::shared_ptr<cugl::JsonValue>& constants) {
+    int cacheKB = constants->getInt("cut_cache_kb", CUT_CACHE_BUDGET_KB);
+    if (cacheKB <= 0) {
+        return nullptr;
+    }
+    auto cache = CutCache::alloc((size_t)cacheKB * 1024, constants->getFloat("cut_cache_step", CUT_CACHE_STEP),
+                                 constants->getFloat("cut_cache_tolerance", CUT_CACHE_TOLERANCE));
+    if (cache != nullptr) {
+        cache->setPrewarm(constants->getBool("cut_cache_prewarm", false));
+    }
+    return cache;
+}
 
-            model->_triggers.push_back(trig);
+/**
+ *  Creates the triggers of a level and indexes them in the model
+ *
+ *  The trigger callbacks only change the model state, so this needs no
+ *  assets and may be used without a running application.
+ *
+ *  @param level    The loaded level data
+ *  @param model    The game model to add the triggers to
+ */
+void DataController::loadTriggers(const std::shared_ptr<LevelData>& level, const std::shared_ptr<GameModel>& model) {
+    for (const LevelData::Region& region : level->getRegions()) {
+        auto trig = std::make_shared<Trigger>(region.mesh);
+        const std::string& trig_type = region.type;
+
+        if (trig_type == "DEATH") {
+            auto args = TriggerArgs();
+            args.player = model->_player;
+            trig->registerEnterCallback(Trigger::killPlayer, args);
+        }
+        else if (trig_type == "POPUP"){
+            auto args = TriggerArgs();
+            args.popup = model->_popup;
+            args.image = region.image;
+            trig->registerEnterCallback(Trigger::showPopup, args);
+            trig->registerInBoundsCallback(Trigger::showPopup, args);
+            trig->registerExitCallback(Trigger::stopPopups, args);
         }
+        else if (trig_type == "MESSAGE") {
+            auto args = TriggerArgs();
+            args.messages = model->_messages;
+            args.text = region.message;
+            trig->registerEnterCallback(Trigger::showMessage, args);
+            trig->registerInBoundsCallback(Trigger::showMessage, args);
+            trig->registerExitCallback(Trigger::stopMessages, args);
+        }
+        else if (trig_type == "EXITREGION") {
+            auto args = TriggerArgs();
+            args.messages = model->_messages;
+            args.text = "I FEEL LIKE I'M MISSING SOMETHING...";
+            trig->registerEnterCallback(Trigger::showExitMess, args);
+            trig->registerInBoundsCallback(Trigger::showExitMess, args);
+            trig->registerExitCallback(Trigger::stopMessages, args);
+
+            // TODO @sarah you wanted this to check if you have enough collectibles
+        }
+
+        model->_triggers.push_back(trig);
     }
+    model->_triggerIndex = TriggerIndex::alloc(model->_triggers);
+}
 
+/**
+ *  Loads the meshes and tables of a level
+ *
+ *  The level comes from the level cache if it was read recently or
+ *  prefetched, and is read with readLevelData otherwise.
+ *
+ *  @param level        The key of the level json
+ *  @param constants    The level json
+ *
+ *  @return true if the level data was loaded
+ */
+bool DataController::loadLevelData(std::string level, const std::shared_ptr<cugl::JsonValue>& constants) {
+    return setLevelData(level, _cache->acquire(level, constants));
+}
 
+/**
+ *  Starts reading a level in the background, so that loading it later is fast
+ *
+ *  @param level    The key of the level json
+ */
+void DataController::prefetchLevel(const std::string& level) {
+    std::shared_ptr<cugl::JsonValue> constants = _assets->get<JsonValue>(level);
+    if (constants != nullptr && constants->has("render_mesh")) {
+        _cache->prefetch(level, constants);
+    }
+}
 
-    // get and set level id
-    std::string level_id = constants->getString("level_id");
-    model->setName(level_id);
+/**
+ *  Keeps level data that has already been read as the current level
+ *
+ *  @param level    The key of the level json
+ *  @param data     The level data (or nullptr if it failed to load)
+ *
+ *  @return true if there is level data
+ */
+bool DataController::setLevelData(const std::string& level, const std::shared_ptr<LevelData>& data) {
+    _level = data;
+    _levelName = data == nullptr ? "" : level;
+    return data != nullptr;
+}
 
-    return true;
+/**
+ *  Reads the meshes and tables of a level
+ *
+ *  This touches neither the assets nor GL, so it is safe to call from a
+ *  worker thread.
+ *
+ *  @param level        The key of the level json
+ *  @param constants    The level json
+ *
+ *  @return the level data, or nullptr if it could not be read
+ */
+std::shared_ptr<LevelData> DataController::readLevelData(const std::string& level, const std::shared_ptr<cugl::JsonValue>& constants) {
+    Timestamp start;
+    std::shared_ptr<LevelData> data = LevelData::allocWithBinary(LevelData::getBinaryPath(level), constants);
+    bool binary = data != nullptr;
+    if (!binary) {
+        data = LevelData::allocWithJson(constants);
+    }
+    if (data == nullptr) {
+        CULogError("Could not load level %s", level.c_str());
+        return nullptr;
+    }
+    CULog("Loaded level %s from %s in %llu ms", level.c_str(), binary ? "binary" : "json",
+          (unsigned long long)Timestamp::ellapsedMillis(start, Timestamp()));
+    return data;
 }
 
 // Note: dir includes "save.json"
@@ -459,6 +438,10 @@ void DataController::setupSave(std::string dir, bool exists){
     _saveDir = dir;
     // get default save file
     _default = _assets->get<JsonValue>("default_save");
+    // the shipped defaults may resize the level cache for the platform
+    _cache->setBudget((size_t)_default->getInt("level_cache_mb", LEVEL_CACHE_BUDGET_MB) * 1024 * 1024);
+    // and how many sound emitters the mixer can afford
+    _emitterVoices = (size_t)std::max(0, _default->getInt("emitter_voices", EMITTER_VOICES));
     if(exists){ // save file already exists
         // make a reader
         std::shared_ptr<JsonReader> read = JsonReader::alloc(_saveDir);
@@ -12,6 +12,8 @@
 #include <cugl/base/CUApplication.h>
 #include <cugl/cugl.h>
 #include "GameModel.h"
+#include "LevelData.h"
+#include "LevelCache.h"
 #include <vector>
 
 /**
@@ -27,13 +29,41 @@ protected:
     std::string _saveDir;
     /** The default save file JsonValue */
     std::shared_ptr<cugl::JsonValue> _default;
+    /** The data of the current level (kept so a reset need not reload it) */
+    std::shared_ptr<LevelData> _level;
+    /** The key of the current level */
+    std::string _levelName;
+    /** The levels that have been read (or prefetched) recently */
+    std::shared_ptr<LevelCache> _cache;
+    /** The number of sound emitters that may play at once */
+    size_t _emitterVoices;
+
+    /**
+     *  Loads the meshes and tables of a level
+     *
+     *  @param level        The key of the level json
+     *  @param constants    The level json
+     *
+     *  @return true if the level data was loaded
+     */
+    bool loadLevelData(std::string level, const std::shared_ptr<cugl::JsonValue>& constants);
+
+    /**
+     *  Keeps level data that has already been read as the current level
+     *
+     *  @param level    The key of the level json
+     *  @param data     The level data (or nullptr if it failed to load)
+     *
+     *  @return true if there is level data
+     */
+    bool setLevelData(const std::string& level, const std::shared_ptr<LevelData>& data);
   
 #pragma mark Constructors
 public:
     /**
      * Creates a new data controller with no values.
      */
-    DataController() {}
+    DataController() : _emitterVoices(EMITTER_VOICES) {}
     
     /**
      * Disposes of all (non-static) resources allocated to this mode.
@@ -61,8 +91,23 @@ public:
      */
     bool init(const std::shared_ptr<cugl::AssetManager>& assets) {
         _assets = assets;
-        return true;
+        _cache = LevelCache::alloc((size_t)LEVEL_CACHE_BUDGET_MB * 1024 * 1024);
+        return _cache != nullptr;
     };
+
+    /**
+     * Returns the cache of recently read levels
+     */
+    std::shared_ptr<LevelCache> getLevelCache() const { return _cache; }
+
+    /**
+     * Starts reading a level in the background, so that loading it later is fast
+     *
+     * This does nothing if the level does not exist or is already cached.
+     *
+     *  @param level    The key of the level json
+     */
+    void prefetchLevel(const std::string& level);
     
     /**
      * Loads a new level
@@ -73,6 +118,37 @@ public:
      *  @return true if the controller is initialized properly, false otherwise.
      */
     bool loadGameModel(std::string level, const std::shared_ptr<GameModel>& model);
+
+    /**
+     * Loads a new level that has already been read
+     *
+     * This is the main thread half of loadGameModel, for when the level data
+     * and cut cache were prepared on a worker thread.
+     *
+     *  @param level    The location of the level json to be loaded
+     *  @param model    The game model to load the level data into
+     *  @param data     The level data (see readLevelData)
+     *  @param cache    The cut cache of the level (see allocCutCache)
+     *
+     *  @return true if the model is initialized properly, false otherwise.
+     */
+    bool loadGameModel(std::string level, const std::shared_ptr<GameModel>& model,
+                       const std::shared_ptr<LevelData>& data, const std::shared_ptr<CutCache>& cache);
+
+    /**
+     * Reads the meshes and tables of a level
+     *
+     * The binary level is used if it has been converted and is up to date;
+     * otherwise this falls back to the exported JSON and OBJ files. This
+     * touches neither the assets nor GL, so it is safe to call from a worker
+     * thread.
+     *
+     *  @param level        The key of the level json
+     *  @param constants    The level json
+     *
+     *  @return the level data, or nullptr if it could not be read
+     */
+    static std::shared_ptr<LevelData> readLevelData(const std::string& level, const std::shared_ptr<cugl::JsonValue>& constants);
     
     /**
      * Resets current level
@@ -83,6 +159,34 @@ public:
      *  @return true if the model is initialized properly, false otherwise.
      */
     bool resetGameModel(std::string level, const std::shared_ptr<GameModel>& model);
+
+    /**
+     * Gives the model a new cut cache, as configured by the level json
+     *
+     *  @param constants    The level json
+     *  @param model        The game model to set the cache of
+     */
+    static void loadCutCache(const std::shared_ptr<cugl::JsonValue>& constants, const std::shared_ptr<GameModel>& model);
+
+    /**
+     * Returns a new cut cache, as configured by the level json
+     *
+     *  @param constants    The level json
+     *
+     *  @return a new cut cache, or nullptr if the level turns caching off
+     */
+    static std::shared_ptr<CutCache> allocCutCache(const std::shared_ptr<cugl::JsonValue>& constants);
+
+    /**
+     * Creates the triggers of a level and indexes them in the model
+     *
+     * The trigger callbacks only change the model state, so this needs no
+     * assets and may be used without a running application.
+     *
+     *  @param level    The loaded level data
+     *  @param model    The game model to add the triggers to
+     */
+    static void loadTriggers(const std::shared_ptr<LevelData>& level, const std::shared_ptr<GameModel>& model);
     
     /**
      * Sets up the save file writer, json value, and path
@@ -0,0 +1,117 @@
+//
+//  FrameVisibility.cpp
+//  Pivot
+//
+//  The visibility stage of the render pipeline.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "FrameVisibility.h"
+#include <algorithm>
+
+/**
+ * Creates an empty visibility set with an empty view
+ */
+FrameVisibility::FrameVisibility() : _near(0), _far(0) {
+    std::fill(_culled, _culled + LIST_COUNT, 0);
+}
+
+/**
+ * Sets the view the billboards are tested against
+ *
+ * @param origin    The point of the plane the depths are measured from
+ * @param direction The camera direction (into the screen)
+ * @param right     The camera right vector
+ * @param up        The camera up vector
+ * @param extent    The width and height of the screen in world units
+ * @param near      The depth of the near side of the slab (negative)
+ * @param far       The depth of the far side of the slab
+ */
+void FrameVisibility::setView(const Vec3& origin, const Vec3& direction, const Vec3& right, const Vec3& up,
+                              const Size& extent, float near, float far) {
+    _origin = origin;
+    _direction = direction;
+    _right = right;
+    _up = up;
+    _extent = Vec2(extent.width / 2, extent.height / 2);
+    _near = near;
+    _far = far;
+}
+
+/**
+ * Returns true if a sphere overlaps the screen rectangle
+ *
+ * @param center    The sphere center
+ * @param radius    The sphere radius
+ */
+bool FrameVisibility::onScreen(const Vec3& center, float radius) const {
+    Vec3 offset = center - _origin;
+    return std::abs(_right.dot(offset)) <= _extent.x + radius && std::abs(_up.dot(offset)) <= _extent.y + radius;
+}
+
+/**
+ * Returns true if an axis aligned box overlaps the depths [near, far] and
+ * the screen rectangle
+ *
+ * @param min       The lower corner of the box
+ * @param max       The upper corner of the box
+ * @param near      The nearest depth that counts
+ * @param far       The furthest depth that counts
+ */
+bool FrameVisibility::intersects(const Vec3& min, const Vec3& max, float near, float far) const {
+    Vec3 center = (min + max) / 2;
+    Vec3 half = (max - min) / 2;
+    // the half length of the box along an axis
+    auto reach = [&](const Vec3& axis) {
+        return std::abs(axis.x) * half.x + std::abs(axis.y) * half.y + std::abs(axis.z) * half.z;
+    };
+
+    Vec3 offset = center - _origin;
+    float depth = _direction.dot(offset);
+    float extent = reach(_direction);
+    if (depth + extent < near || depth - extent > far) {
+        return false;
+    }
+    return std::abs(_right.dot(offset)) <= _extent.x + reach(_right) &&
+           std::abs(_up.dot(offset)) <= _extent.y + reach(_up);
+}
+
+/**
+ * Rebuilds the index lists from the given billboards
+ *
+ * @param drawables The billboards of the frame
+ */
+void FrameVisibility::cull(const std::vector<DrawObject>& drawables) {
+    for (int ii = 0; ii < LIST_COUNT; ii++) {
+        _lists[ii].clear();
+        _culled[ii] = 0;
+    }
+
+    for (Uint32 ii = 0; ii < drawables.size(); ii++) {
+        const DrawObject& dro = drawables[ii];
+        bool behind = dro.fade && !dro.isPlayer;
+        float radius = BillboardBatch::getRadius(dro);
+        if (!onScreen(dro.pos, radius)) {
+            _culled[FRONT]++;
+            _culled[BEHIND] += behind ? 1 : 0;
+            continue;
+        }
+
+        if (inDepth(dro.pos, radius, 0, _far)) {
+            _lists[FRONT].push_back(ii);
+        } else {
+            _culled[FRONT]++;
+        }
+
+        // the behind pass fades by the depth of the center, so test that
+        if (behind) {
+            float depth = getDepth(dro.pos);
+            if (depth < 0 && depth > _near) {
+                _lists[BEHIND].push_back(ii);
+            } else {
+                _culled[BEHIND]++;
+            }
+        }
+    }
+}
@@ -0,0 +1,169 @@
+//
+//  FrameVisibility.h
+//  Pivot
+//
+//  The visibility stage of the render pipeline. Once a frame, before any pass
+//  draws, the billboards are tested against the visible slab along the plane
+//  normal and the screen rectangle of the orthographic camera. Every pass then
+//  draws from the resulting index lists instead of testing on its own.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef FrameVisibility_h
+#define FrameVisibility_h
+#include <cugl/cugl.h>
+#include <vector>
+#include "BillboardBatch.h"
+
+using namespace cugl;
+
+/**
+ * The set of billboards visible in the current frame.
+ *
+ * The view is a slab along the camera direction, from the near depth (behind
+ * the plane, where the faded billboards are still shown) to the far depth,
+ * crossed with the screen rectangle of the orthographic camera. Depths are
+ * measured along the camera direction from the plane origin, so anything in
+ * front of the plane has a positive depth.
+ *
+ * Billboards are tested by their bounding sphere, which is a handful of dot
+ * products instead of projecting every corner of every quad. The sphere is
+ * conservative, so a billboard is only culled if its quad cannot be seen.
+ * The chunks of the level mesh are tested against the same view by their
+ * bounding boxes.
+ *
+ * This class does not touch OpenGL, so the culling can run without a context.
+ */
+class FrameVisibility {
+public:
+    /** The index lists the passes draw from */
+    enum List {
+        /** Billboards in front of the plane (the billboard and position passes) */
+        FRONT,
+        /** Faded billboards just behind the plane (the behind pass) */
+        BEHIND,
+        /** The number of lists */
+        LIST_COUNT
+    };
+
+private:
+    /** The point of the plane the depths are measured from */
+    Vec3 _origin;
+    /** The camera direction (into the screen) */
+    Vec3 _direction;
+    /** The camera right vector */
+    Vec3 _right;
+    /** The camera up vector */
+    Vec3 _up;
+    /** Half the width and height of the screen rectangle in world units */
+    Vec2 _extent;
+    /** The depth of the near side of the slab (negative, behind the plane) */
+    float _near;
+    /** The depth of the far side of the slab */
+    float _far;
+
+    /** The indices of the visible billboards, for each list */
+    std::vector<Uint32> _lists[LIST_COUNT];
+    /** The number of billboards culled from each list */
+    size_t _culled[LIST_COUNT];
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty visibility set with an empty view
+     */
+    FrameVisibility();
+
+#pragma mark View
+    /**
+     * Sets the view the billboards are tested against
+     *
+     * @param origin    The point of the plane the depths are measured from
+     * @param direction The camera direction (into the screen)
+     * @param right     The camera right vector
+     * @param up        The camera up vector
+     * @param extent    The width and height of the screen in world units
+     * @param near      The depth of the near side of the slab (negative)
+     * @param far       The depth of the far side of the slab
+     */
+    void setView(const Vec3& origin, const Vec3& direction, const Vec3& right, const Vec3& up,
+                 const Size& extent, float near, float far);
+
+    /** Returns the depth of a point along the camera direction */
+    float getDepth(const Vec3& pos) const { return _direction.dot(pos - _origin); }
+
+    /** Returns the depth of the near side of the slab */
+    float getNear() const { return _near; }
+
+    /** Returns the depth of the far side of the slab */
+    float getFar() const { return _far; }
+
+    /**
+     * Returns true if a sphere overlaps the depths [near, far]
+     *
+     * @param center    The sphere center
+     * @param radius    The sphere radius
+     * @param near      The nearest depth that counts
+     * @param far       The furthest depth that counts
+     */
+    bool inDepth(const Vec3& center, float radius, float near, float far) const {
+        float depth = getDepth(center);
+        return depth + radius >= near && depth - radius <= far;
+    }
+
+    /**
+     * Returns true if a sphere overlaps the screen rectangle
+     *
+     * As the camera is orthographic, this ignores the depth.
+     *
+     * @param center    The sphere center
+     * @param radius    The sphere radius
+     */
+    bool onScreen(const Vec3& center, float radius) const;
+
+    /**
+     * Returns true if a sphere overlaps the slab and the screen rectangle
+     *
+     * @param center    The sphere center
+     * @param radius    The sphere radius
+     */
+    bool intersects(const Vec3& center, float radius) const {
+        return inDepth(center, radius, _near, _far) && onScreen(center, radius);
+    }
+
+    /**
+     * Returns true if an axis aligned box overlaps the depths [near, far] and
+     * the screen rectangle
+     *
+     * The box is tested along the camera axes only, which is exact for the
+     * depth and conservative near the corners of the screen.
+     *
+     * @param min       The lower corner of the box
+     * @param max       The upper corner of the box
+     * @param near      The nearest depth that counts
+     * @param far       The furthest depth that counts
+     */
+    bool intersects(const Vec3& min, const Vec3& max, float near, float far) const;
+
+#pragma mark Culling
+    /**
+     * Rebuilds the index lists from the given billboards
+     *
+     * A billboard is in the front list if its quad can reach past the plane
+     * and is on screen. It is in the behind list if it fades (and is not the
+     * player), its center is between the near side of the slab and the plane,
+     * and it is on screen.
+     *
+     * @param drawables The billboards of the frame
+     */
+    void cull(const std::vector<DrawObject>& drawables);
+
+    /** Returns the indices of the visible billboards in the given list, in order */
+    const std::vector<Uint32>& getList(List list) const { return _lists[list]; }
+
+    /** Returns the number of billboards culled from the given list */
+    size_t getCulled(List list) const { return _culled[list]; }
+};
+
+#endif /* FrameVisibility_h */
@@ -10,15 +10,38 @@
 #ifndef GameModel_h
 #define GameModel_h
 #include <cugl/cugl.h>
-#include "Collectible.h"
 #include "PlayerModel.h"
 #include "Mesh.h"
-#include "Glowstick.h"
+#include "CutCache.h"
 #include "GameItem.h"
+#include "ItemStore.h"
+#include "SoundEmitters.h"
 #include "Trigger.h"
+#include "TriggerIndex.h"
 
 using namespace cugl;
 
+#pragma mark Gameplay Constants
+// TODO: make this dependent on scene width and height -Sarah
+/** Width of the game world in Box2d units */
+#define DEFAULT_WIDTH   32.0f
+/** Height of the game world in Box2d units */
+#define DEFAULT_HEIGHT  18.0f
+/** Threshold of the collecting distance */
+#define COLLECTING_DIST   25
+/** Threshold of the reaching exit distance */
+#define EXITING_DIST   25
+/** Glowstick pickup distance*/
+#define PICKING_DIST   15
+/** Scale from player image to capsule */
+#define CAP_SCALE   1.1f
+/** Scale player capsule width */
+#define WIDTH_SCALE   2.00f
+/** Intensity of the glowstick lights */
+#define GLOWSTICK_INTENSITY 0.8f
+/** Falloff of the glowstick lights */
+#define GLOWSTICK_FALLOFF   2000.0f
+
 /**
  * A class representing an active level and its starting data
  */
@@ -64,6 +87,8 @@ public:
 
     /** Player 3D Location */
     Vec3 _player3DLoc;
+    /** The player 3D location to draw at (interpolated between physics steps) */
+    Vec3 _playerRenderLoc;
 
     /** If player just finishes rotating the cut */
     bool _justFinishRotating = false;
@@ -111,13 +136,16 @@ private:
 
 #pragma mark Cut State
 private:
-    /** Vector of cut polygons */
-    std::vector<std::shared_ptr<Poly2>> _cut;
+    /** The contours of the cut (in plane coordinates) */
+    std::vector<Path2> _cutPaths;
+
+    /** Cache of cuts through the current level (null if disabled) */
+    std::shared_ptr<CutCache> _cutCache;
 
 #pragma mark Collectibles State
 public:
-    /** map of collectibles */
-    std::map<std::string, Collectible> _collectibles;
+    /** The collectibles (named by their order in the level) */
+    ItemStore _collectibles;
     
     std::shared_ptr<cugl::scene2::SceneNode> _invent;
     
@@ -131,17 +159,20 @@ public:
 
 #pragma mark Decorations and Poster State
 public:
-    /** Vector of decorations */
-    std::vector<std::shared_ptr<GameItem>> _decorations;
+    /** The decorations */
+    ItemStore _decorations;
     
-    /** Vector of posters */
-    std::vector<std::shared_ptr<GameItem>> _posters;
+    /** The posters */
+    ItemStore _posters;
 
 #pragma mark Triggers and Popups
 public:
     /** Vector of triggers */
     std::vector<std::shared_ptr<Trigger>> _triggers;
 
+    /** Spatial index over the triggers (built once they are all loaded) */
+    std::shared_ptr<TriggerIndex> _triggerIndex;
+
     std::shared_ptr<Popups> _popup;
 
     std::shared_ptr<cugl::scene2::SceneNode> _rotatePopup;
@@ -177,8 +208,8 @@ public:
     /** Number of glowsticks */
     int _numGlowsticks;
     
-    /** Vector of glowsticks */
-    std::vector<Glowstick> _glowsticks;
+    /** The placed glowsticks (each casts a light) */
+    ItemStore _glowsticks;
 
     std::shared_ptr<cugl::scene2::Label> _glowstickCounter;
     
@@ -223,12 +254,13 @@ public:
         }
         Light(){}
     };
-    /** Vector of lights */
+    /** Vector of lights (the glowstick lights are kept with the glowsticks) */
     std::vector<Light> _lights;
-    /** A map of active lights of the GameItem
-     *  The key is the string representing the light's location
-     */
-    std::unordered_map<std::string, Light> _lightsFromItems;
+
+#pragma mark Sounds
+public:
+    /** The looping sounds placed in the level */
+    SoundEmitters _emitters;
 
 #pragma mark Meshes
 public:
@@ -243,10 +275,7 @@ public:
      * Creates the model state.
      */
     GameModel() {
-        _collectibles = std::map<std::string, Collectible>();
-        _glowsticks = std::vector<Glowstick>();
         _lights = std::vector<Light>();
-        _decorations = std::vector<std::shared_ptr<GameItem>>();
         _deathTime = std::make_shared<Timestamp>();
         _pixelInTime = std::make_shared<Timestamp>();
         _pixelOutTime = std::make_shared<Timestamp>();
@@ -340,6 +369,22 @@ public:
         return _player3DLoc;
     }
 
+    /**
+     *  Sets the player 3d location to draw at
+     *
+     *  @param renderLoc   The player 3D loc, interpolated between physics steps
+     */
+    void setPlayerRenderLoc(Vec3 renderLoc) {
+        _playerRenderLoc = renderLoc;
+    }
+
+    /**
+     *  Gets the player 3d location to draw at
+     */
+    Vec3 getPlayerRenderLoc() {
+        return _playerRenderLoc;
+    }
+
     /**
      *  Sets the Norm
      *
@@ -379,19 +424,35 @@ public:
     }
 
     /**
-     *  Sets the cut
+     *  Sets the contours of the cut
      *
-     *  @param cut          The cut
+     *  @param paths        The contours of the cut
      */
-    void setCut(std::vector<std::shared_ptr<Poly2>> cut) {
-        _cut = cut;
+    void setCutPaths(const std::vector<Path2>& paths) {
+        _cutPaths = paths;
     }
 
     /**
-     *  Gets the cut
+     *  Gets the contours of the cut
      */
-    std::vector<std::shared_ptr<Poly2>> getCut() {
-        return _cut;
+    const std::vector<Path2>& getCutPaths() {
+        return _cutPaths;
+    }
+
+    /**
+     *  Sets the cut cache for the current level
+     *
+     *  @param cache        The cut cache (null to disable caching)
+     */
+    void setCutCache(const std::shared_ptr<CutCache>& cache) {
+        _cutCache = cache;
+    }
+
+    /**
+     *  Gets the cut cache for the current level (null if disabled)
+     */
+    std::shared_ptr<CutCache> getCutCache() {
+        return _cutCache;
     }
 
     /**
@@ -417,16 +478,16 @@ public:
     }
 
     /**
-     * Gets the map of collectibles
+     * Gets the collectibles
      */
-    std::map<std::string, Collectible> getCollectibles() {
+    const ItemStore& getCollectibles() const {
         return _collectibles;
     }
 
     /**
-     * Gets the vector of decorations
+     * Gets the decorations
      */
-    std::vector<std::shared_ptr<GameItem>> getDecorations() {
+    const ItemStore& getDecorations() const {
         return _decorations;
     }
 
@@ -437,14 +498,10 @@ public:
      * @param texs  List of collectible textures
      */
     void setCollectibles(std::vector<Vec3> locs, std::vector<std::shared_ptr<cugl::Texture>> texs, std::vector<std::shared_ptr<cugl::Texture>> normalTexs, std::vector<float> col_scales, std::vector<float> col_angles) {
+        _collectibles.reserve(locs.size());
         for(int i = 0; i < locs.size(); i++) {
-            Collectible item = Collectible(locs[i], std::to_string(i));
-            item.setScale(col_scales[i]);
-            item.setOffsetAngle(col_angles[i]);
-            item.setTexture(texs[i]);
-            item.rotateSpriteSheet = SpriteSheet::alloc(texs[i], 6, 6);
-            item.rotateNormalSpriteSheet = SpriteSheet::alloc(normalTexs[i], 6, 6);
-            _collectibles.insert({std::to_string(i), item});
+            _collectibles.add(locs[i], SpriteSheet::alloc(texs[i], 6, 6), SpriteSheet::alloc(normalTexs[i], 6, 6),
+                              col_angles[i], col_scales[i], std::to_string(i));
             _expectedCol.insert(std::to_string(i));
         }
 
@@ -469,11 +526,11 @@ public:
 
     void clearLights() {
         _lights.clear();
-        _lightsFromItems.clear();
     }
 
     void clearDecorations() {
         _decorations.clear();
+        _posters.clear();
     }
 
     void clearBackpack(){
@@ -486,6 +543,7 @@ public:
 
     void clearTriggers() {
         _triggers.clear();
+        _triggerIndex = nullptr;
     }
 
     void setExpectedCol(std::unordered_set<std::string> expectedCol) {
@@ -512,6 +570,21 @@ public:
         return _expectedCol == _backpack;
     }
 
+    /**
+     * Places a glowstick with its light
+     *
+     * @param pos   The glowstick position
+     * @param sheet The glowstick sprite sheet (may be null)
+     * @param color The color of the light
+     *
+     * @return the handle of the glowstick
+     */
+    ItemStore::Handle addGlowstick(const Vec3& pos, const std::shared_ptr<SpriteSheet>& sheet, const Vec3& color) {
+        ItemStore::Handle handle = _glowsticks.add(pos, sheet, nullptr, 0, 1);
+        _glowsticks.setLight(_glowsticks.size() - 1, color, GLOWSTICK_INTENSITY, GLOWSTICK_FALLOFF, 0);
+        return handle;
+    }
+
     void updateGlowstickCount() {
         _glowstickCounter->setText(std::to_string(_numGlowsticks - _glowsticks.size()));
     }
@@ -20,26 +20,10 @@ using namespace cugl;
 #define SCENE_WIDTH 1024
 #define SCENE_HEIGHT 576
 
-// TODO: make this dependent on scene width and height -Sarah
-/** Width of the game world in Box2d units */
-#define DEFAULT_WIDTH   32.0f
-/** Height of the game world in Box2d units */
-#define DEFAULT_HEIGHT  18.0f
-
 /** Color to outline the physics nodes */
 #define DEBUG_COLOR     Color4::YELLOW
 /** Opacity of the physics outlines */
 #define DEBUG_OPACITY   192
-/** Threshold of the collecting distance */
-#define COLLECTING_DIST   25
-/** Threshold of the reaching exit distance */
-#define EXITING_DIST   25
-/** Glowstick pickup distance*/
-#define PICKING_DIST   15
-/** Scale from player image to capsule */
-#define CAP_SCALE   1.1f
-/** Scale player capsule width */
-#define WIDTH_SCALE   2.00f
 /** Width of the player capsule */
 #define PLAYER_WIDTH   10.0f
 /** Height of the player capsule*/
@@ -52,6 +36,16 @@ using namespace cugl;
 #define MAX_PORTAL_DIST 250.0
 /** Time it takes to fade from main to rotation and vice versa*/
 #define ROTATE_FADE 0.15
+
+#pragma mark Loading Constants
+/** Share of the loading bar for reading the meshes (loader thread) */
+#define LOAD_WEIGHT_MESHES  0.6f
+/** Share of the loading bar for prewarming and computing the first cut (loader thread) */
+#define LOAD_WEIGHT_CUTS    0.25f
+/** Share of the loading bar for setting up the model and physics (main thread) */
+#define LOAD_WEIGHT_MODEL   0.1f
+/** Share of the loading bar for the GL uploads (main thread) */
+#define LOAD_WEIGHT_UPLOAD  0.05f
 /**
  * Creates a new game world with the default values.
  *
@@ -75,6 +69,8 @@ void GameplayController::dispose() {
         _worldnode = nullptr;
         _debugnode = nullptr;
         _model = nullptr;
+        _logic = nullptr;
+        _loader = nullptr;
         Scene2::dispose();
     }
 }
@@ -104,6 +100,9 @@ bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const
 
 bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const Size& displaySize, std::shared_ptr<SoundController> sound) {
     _pipeline = std::make_shared<RenderPipeline>(SCENE_WIDTH, displaySize, assets);
+#ifdef PIVOT_BENCHMARK
+    _pipeline->setProfiling(true);
+#endif
     
     return init(assets,Rect(0,0,DEFAULT_WIDTH,DEFAULT_HEIGHT), sound);
 }
@@ -145,6 +144,9 @@ bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const
 
     //set up the plane controller
     _plane = std::make_shared<PlaneController>();
+
+    //set up the level loader
+    _loader = LevelLoader::alloc();
     
 #pragma mark SCENE GRAPH SETUP
     
@@ -267,7 +269,6 @@ bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const
 
 #pragma mark ADD PLAYER
     Vec2 dudePos = Vec2::ZERO;
-    prevPlay2DPos = dudePos;
     
     
     std::shared_ptr<Texture> image = assets->get<Texture>(DUDE_TEXTURE);
@@ -332,10 +333,11 @@ bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const
     std::shared_ptr<scene2::PolygonNode> sprite = scene2::PolygonNode::allocWithTexture(image);
     _model->_player->setSceneNode(sprite);
     _model->_player->setDebugColor(DEBUG_COLOR);
-
-    lastStablePlay2DPos = dudePos;
         
     addObstacle(_model->_player, true);
+
+    _logic = LogicController::alloc(_model, _plane, _physics);
+    _logic->setDebugScene(_debugnode, DEBUG_COLOR);
     
     addChild(_worldnode);
     addChild(_debugnode);
@@ -379,40 +381,6 @@ bool GameplayController::init(const std::shared_ptr<AssetManager>& assets, const
     
 }
 
-/**
-* Generates obstacle instances from the given cut, specified by the list of Poly2s given by the GameModel _model
-* (should I split this into 2 methods where I have one taking a cut for code cleanliness?)
-*/
-void GameplayController::createCutObstacles(){
-    // TODO: clean this and add function comment -Gordi
-    //remove previous poly nodes
-    //removePolyNodes();
-    createObstacleFromPolys(_model->getCut());
-}
-
-/**
- * Generates obstacle instances from a list of Poly2s. Each poly2 represents a new obstacle.
- * @param polys the list of Poly2s
- */
-void GameplayController::createObstacleFromPolys(std::vector<std::shared_ptr<Poly2>> polys){
-    //std::shared_ptr<Rect> bounds = std::make_shared<Rect>(Vec2::ZERO, getSize() / _physics->getScale());
-    
-    //std::shared_ptr<scene2::SceneNode> cutnode = scene2::SceneNode::alloc();
-    
-    for(std::shared_ptr<Poly2> p : polys){
-        std::vector<cugl::Vec2> vertices = p->getVertices();
-        std::shared_ptr<cugl::physics2::PolygonObstacle> obstacle = physics2::PolygonObstacle::alloc(*p);
-        
-        //obstacle->init(p.operator*());
-        obstacle->setBodyType(b2_staticBody);
-        //cutnode = scene2::SceneNode::alloc();
-        //_cutnodes.insert(cutnode);
-        //_cutobstacles.insert(obstacle);
-        addObstacle(obstacle, true);
-    }
-    
-}
-
 /**
  * Removes all the nodes beloning to _polynodes from _worldnodes. In essence, this cleans up all the old collisions and SceneNodes pertaining to a previous cut to make room for the new cut's collisions.
  */
@@ -476,7 +444,13 @@ void GameplayController::addObstacle(const std::shared_ptr<cugl::physics2::Obsta
  * Resets the current level
  */
 void GameplayController::reset() {
+    // a level that has not finished loading has nothing to reset yet
+    if (isLoading()) {
+        load(_loader->getName());
+        return;
+    }
     _state = NONE;
+    startRecording(_model->getName());
     // reset physics
     _physics->clear();
     // reset model
@@ -501,13 +475,13 @@ void GameplayController::reset() {
     _model->_player->setFriction(_initFriction);
     _model->_player->setInertia(_initInertia);
     _model->_glowstickOrder = 0;
-    prevPlay2DPos = Vec2::ZERO;
     _physics->getWorld()->addObstacle(_model->_player);
+    _logic->reset();
     // change plane for new model
     _plane->init(_model);
     _plane->calculateCut();
     // update physics for new cut
-    createCutObstacles();
+    _logic->createCutObstacles();
     _physics->update(0);
     // setup graphics pipeline
     _pipeline->sceneSetup(_model);
@@ -521,8 +495,6 @@ void GameplayController::reset() {
     auto color = _layer->getColor();
     auto newColor = Color4(color.r, color.g, color.b, 0.0);
     _layer->setColor(newColor);
-
-    lastStablePlay2DPos = _model->_player->getPosition();
 }
 
 /**
@@ -532,10 +504,56 @@ void GameplayController::reset() {
  */
 void GameplayController::load(std::string name){
     _state = NONE;
+    startRecording(name);
+
+    _loadStart.mark();
+    _firstFrame = true;
+
+    // the loader stages only share this, so an abandoned load never touches the next one
+    std::shared_ptr<JsonValue> constants = _assets->get<JsonValue>(name);
+    std::shared_ptr<LevelCache> cache = _data->getLevelCache();
+    auto level = std::make_shared<PendingLevel>();
+    _loader->start(name);
+    _loader->addWorkerStage("meshes", LOAD_WEIGHT_MESHES, [=]() {
+        level->data = cache->acquire(name, constants, &level->cached);
+        return level->data != nullptr;
+    });
+    _loader->addWorkerStage("cuts", LOAD_WEIGHT_CUTS, [=]() {
+        // the plane starts at the player, as in PlaneController::init
+        std::shared_ptr<JsonValue> loc = constants->get("player_loc");
+        std::shared_ptr<JsonValue> norm = constants->get("norm");
+        level->origin = Vec3(loc->get(0)->asFloat(), loc->get(1)->asFloat(), loc->get(2)->asFloat());
+        level->normal = Vec3(norm->get(0)->asFloat(), norm->get(1)->asFloat(), norm->get(2)->asFloat());
+        level->normal.normalize();
+
+        auto mesh = level->data->getColMesh();
+        level->cache = DataController::allocCutCache(constants);
+        if (level->cache != nullptr) {
+            PlaneController::prewarmCuts(level->cache, mesh, level->origin);
+        }
+        if (level->cache == nullptr || !level->cache->find(level->origin, level->normal, level->paths)) {
+            level->paths = PlaneController::computeCut(mesh, level->origin, level->normal);
+        }
+        return true;
+    });
+    _loader->addMainStage("model", LOAD_WEIGHT_MODEL, [=]() {
+        return finishLoad(name, level);
+    });
+    _loader->addMainStage("upload", LOAD_WEIGHT_UPLOAD, [=]() {
+        // setup graphics pipeline
+        _pipeline->sceneSetup(_model);
+        return true;
+    });
+}
+
+bool GameplayController::finishLoad(const std::string& name, const std::shared_ptr<PendingLevel>& level) {
+    _loadCached = level->cached;
     // reset physics
     _physics->clear();
     // update model
-    _data->loadGameModel(name, _model);
+    if (!_data->loadGameModel(name, _model, level->data, level->cache)) {
+        return false;
+    }
     // reset collectibles
     resetCollectibleUI(_model->getColNum());
     // check glowstick UI
@@ -556,18 +574,20 @@ void GameplayController::load(std::string name){
     _model->_player->setFriction(_initFriction);
     _model->_player->setInertia(_initInertia);
     _model->_glowstickOrder = 0;
-    prevPlay2DPos = Vec2::ZERO;
     _physics->getWorld()->addObstacle(_model->_player);
-    // change plane for new model
+    _logic->reset();
+    // change plane for new model, using the cut the loader made if the plane agrees
     _plane->init(_model);
-    _plane->calculateCut();
+    if (_model->getPlaneOrigin() == level->origin && _model->getPlaneNorm() == level->normal) {
+        _plane->setCut(level->origin, level->normal, std::move(level->paths));
+    } else {
+        _plane->calculateCut();
+    }
     _model->_player->lastRotateAngle = _model->getGlobalAngleDeg();
     _model->_player->setRotationalSprite(_model->getGlobalAngleDeg());
     // update physics for new cut
-    createCutObstacles();
+    _logic->createCutObstacles();
     _physics->update(0);
-    // setup graphics pipeline
-    _pipeline->sceneSetup(_model);
     //get lvlpack
     _packName = getPackName(name);
     //play sounds
@@ -584,9 +604,16 @@ void GameplayController::load(std::string name){
     auto color = _layer->getColor();
     auto newColor = Color4(color.r, color.g, color.b, 0.0);
     _layer->setColor(newColor);
-    
-
+    return true;
+}
 
+void GameplayController::prefetchLevel(const std::string& name) {
+    // the loader has the disk to itself until the level is up
+    if (name.empty() || name == _prefetched || isLoading()) {
+        return;
+    }
+    _prefetched = name;
+    _data->prefetchLevel(name);
 }
 
 std::string GameplayController::getSongName(std::string c){
@@ -652,6 +679,10 @@ void GameplayController::setActive(bool value){
         }
         // turn off the render pipeline stuff
         glDisable(GL_DEPTH_TEST);
+        // silence the level emitters (they come back on the next update)
+        if (_sound != nullptr && _model != nullptr) {
+            _sound->stopEmitters(_model->_emitters);
+        }
     }
 }
 
@@ -848,14 +879,23 @@ void GameplayController::resetMessages() {
 float saveFloat = 0.0;
 float lastFrameAngle;
 void GameplayController::update(float dt) {
+    CU_PROFILE_SCOPE("GameplayController::update");
+    // nothing plays until the level has finished loading
+    if (isLoading()) {
+        _stepPhysics = false;
+        if (_loader->update() == LevelLoader::FAILED) {
+            _state = QUIT;
+        }
+        return;
+    }
+
     // update time and global angle
     lastFrameAngle = _model->getGlobalAngleDeg();
     _model->_currentTime->mark();
+    _stepPhysics = false;
+    _playing = false;
     
-    if((_model->_player->getVY() > -5.0f && _model->_player->getVY() < 5.0f) && !(_model->_player->isGrounded())){
-        _model->_player->timeStuckAtZeroYvelocity++;
-        CULog("I'm Stuck!!!");
-    }
+    _logic->trackStuck();
     
 #pragma mark SCENE TRANSITIONS
     
@@ -876,6 +916,7 @@ void GameplayController::update(float dt) {
     if(_model->_donePixelOut){
         _model->_donePixelOut = false;
         _state = END;
+        saveRecording();
         return;
     }
     
@@ -899,11 +940,8 @@ void GameplayController::update(float dt) {
     // not done pixeling in
     if(!_model->_donePixelIn){
         // let gravity happen
-        _physics->update(dt);
-        currPlay2DPos = _model->_player->getPosition();
-        Vec2 displacement = currPlay2DPos - prevPlay2DPos;
-        updatePlayer3DLoc(displacement);
-        prevPlay2DPos = currPlay2DPos;
+        _stepPhysics = true;
+        recordFrame(false);
         return;
     }
     
@@ -914,6 +952,7 @@ void GameplayController::update(float dt) {
     
     // not done pixeling out
     if(!_model->_pixelingIn){ return; }
+    _playing = true;
     
 #pragma mark -----
     
@@ -934,6 +973,7 @@ void GameplayController::update(float dt) {
     if(!(_model->_player->shouldStartFlipping)){
         _input->update(dt);
     }
+    recordFrame(true);
     
     if (_input->didDebug()) {
         setDebug(!isDebug());
@@ -942,11 +982,9 @@ void GameplayController::update(float dt) {
     }
 
     // kill the player if marked dead
-    if (_model->_player->isDead()) {
-        _model->_player->setPosition(lastStablePlay2DPos);
+    if (_logic->respawnIfDead()) {
         _sound->playSound("die", 1.0f);
 
-        _model->_player->setDead(false);
         _model->_deathTime->mark();
         _model->_player->justDied = true;
         
@@ -957,11 +995,8 @@ void GameplayController::update(float dt) {
         Trigger::showMessage(args);
     }
     
-    if(_model->_player->timeStuckAtZeroYvelocity > 50){
-        _model->_player->setPosition(lastStablePlay2DPos);
+    if(_logic->respawnIfStuck()){
         _model->_deathTime->mark();
-        _model->_player->setPosition(lastStablePlay2DPos);
-        _model->_player->timeStuckAtZeroYvelocity = 0;
         _model->_player->justFinishedGettingUnstuck = true;
         
         // turn on stuck message
@@ -1003,12 +1038,10 @@ void GameplayController::update(float dt) {
             Trigger::stopMessages(args);
         }
         
-        for(auto it = _model->_glowsticks.begin(); it != _model->_glowsticks.end(); it ++){
-            it->setRotationalSprite(_model->getGlobalAngleDeg());
-        }
+        _model->_glowsticks.updateFrames(_model->getGlobalAngleDeg());
     }
     
-    if (_model->_player->isGrounded() && _input->isRotating) {
+    if (_input->isRotating && _logic->rotate((_input->cutFactor - saveFloat)/1000 * _input->settings_invertRotate)) {
         if(_justRotated == false){
             //#TODO set lab_r to 1
             //_sound->playSound("lab_r", 1.0, true);
@@ -1016,44 +1049,23 @@ void GameplayController::update(float dt) {
             _sound->fadeIn(getSongName("r"), ROTATE_FADE);
             _justRotated = true;
         }
-//        _plane->rotateNorm(_input->cutFactor/15000);
-        //createCutObstacles();
-        _plane->rotateNorm((_input->cutFactor - saveFloat)/1000 * _input->settings_invertRotate);
         _model->updateCompassNum();
         //only recalculate the rotational sprite if we changed our angle from the last frame
         if (_model->getGlobalAngleDeg() != lastFrameAngle) {
             _model->_player->setRotationalSprite(_model->getGlobalAngleDeg());
-            for(auto it = _model->_glowsticks.begin(); it != _model->_glowsticks.end(); it ++){
-                it->setRotationalSprite(_model->getGlobalAngleDeg());
-            }
+            _model->_glowsticks.updateFrames(_model->getGlobalAngleDeg());
         }
-        _model->_player->isRotating = true;
         saveFloat = _input->cutFactor;
-        _rotating = true;
     }
     
-    else if (_model->_player->isGrounded() && _input->didKeepChangingCut()) {
-        _plane->rotateNorm(_input->getMoveNorm() * 1.75);
+    else if (_input->didKeepChangingCut() && _logic->rotate(_input->getMoveNorm() * 1.75)) {
         _model->updateCompassNum();
         _model->_player->setRotationalSprite(_model->getGlobalAngleDeg());
-        for(auto it = _model->_glowsticks.begin(); it != _model->_glowsticks.end(); it ++){
-            it->setRotationalSprite(_model->getGlobalAngleDeg());
-        }
-        _model->_player->isRotating = true;
-        //createCutObstacles();
-        _rotating = true;
+        _model->_glowsticks.updateFrames(_model->getGlobalAngleDeg());
     }
     else {
-        if (_rotating) {
-            _physics->clear();
-            _model->_player->setPosition(Vec2::ZERO);
-            prevPlay2DPos = Vec2::ZERO;
-            //            _physics->getWorld()->addObstacle(_model->_player);
-            //            _plane->movePlaneToPlayer();
-            //            _plane->calculateCut();//calculate cut here so it only happens when we finish rotating
-            //            //_plane->debugCut(100);// enable this one to make a square of size 10 x 10 as the cut, useful for debugging
-            //            createCutObstacles();
-            _rotating = false;
+        // the cut was computed in the background while rotating
+        if (_logic->finishRotation()) {
             _model->_justFinishRotating = true;
         }
         else if(_model->_compassSpin->isVisible()) {
@@ -1065,131 +1077,54 @@ void GameplayController::update(float dt) {
             }
         }
         if (_model->_justFinishRotating) {
-            _physics->getWorld()->addObstacle(_model->_player);
             _model->_player->setRotationalSprite(_model->getGlobalAngleDeg());
-            for(auto it = _model->_glowsticks.begin(); it != _model->_glowsticks.end(); it ++){
-                it->setRotationalSprite(_model->getGlobalAngleDeg());
-            }
-            _model->_player->isRotating = false;
-            _plane->movePlaneToPlayer();
-            _plane->calculateCut();//calculate cut here so it only happens when we finish rotating
-            //_plane->debugCut(100);// enable this one to make a square of size 10 x 10 as the cut, useful for debugging
-            createCutObstacles();
-            //lastStablePlay2DPos = _model->_player->getPosition();
+            _model->_glowsticks.updateFrames(_model->getGlobalAngleDeg());
             _justRotated = false;
             _sound->fadeIn(getSongName("m"), ROTATE_FADE);
             _sound->fadeOut(getSongName("r"), ROTATE_FADE);
         }
-        _physics->update(dt);
+        _stepPhysics = true;
         // std::cout<<"curr velocity (x,y): " << _model->_player->getVelocity().x << "," << _model->_player->getVelocity().y << std::endl;
     }
     
 #pragma mark COLLECTIBLES
-    for (auto itr = _model->_collectibles.begin(); itr != _model->_collectibles.end(); itr++) {
-        if (_model->getGlobalAngleDeg() != lastFrameAngle) {
-            itr->second.setRotationalSprite(_model->getGlobalAngleDeg());
-        }
-        if (_model->getPlayer3DLoc().distance(itr->second.getPosition())<= COLLECTING_DIST && !itr->second.getCollected()) {
-            _sound->playSound("collect", 0.75);
-            itr->second.setCollected(true);
-            _justCollected = true;
-            _model->_collectTime->mark();
-            _model->_backpack.insert(itr->first);
-            if (_model->_nav_target == itr->second.getPosition()) {
-                //need a new nav target, exit unless there are collectibles left
-                Vec3 new_target = _model->_exit->getPosition();
-                for (auto it_nav = _model->_collectibles.begin(); it_nav != _model->_collectibles.end(); it_nav++) {
-                    if (_model->_backpack.count(it_nav->first) == 0) {
-                        new_target = it_nav->second.getPosition();
-                    }
-                }
-                _model->_nav_target = new_target;
-
-            }
-        }
+    ItemStore& collectibles = _model->_collectibles;
+    if (_model->getGlobalAngleDeg() != lastFrameAngle) {
+        collectibles.updateFrames(_model->getGlobalAngleDeg());
     }
-    
+    // collecting happens after each physics step (see updateAfterStep)
     _model->_exit->setRotationalSprite(_model->getGlobalAngleDeg());
     
     // update collectible UI
     collectUI(_model->getColNum(), _model->getCurrColNum());
     
-    if(_model->getPlayer3DLoc().distance(_model->_exit->getPosition()) <= EXITING_DIST) {
-        if (_model->checkBackpack()) {
-            fadeinCollectibles();
-            _model->_endOfGame = true;
-            _model->_player->shouldStartFlipping = true;
-            if(_model->_player->_isFlipping){
-                _sound->playSound("portal", 1);
-                _model->_player->_isFlipping = false;
-            }
-        }
-    }
-    
 #pragma mark DECORATIONS
     if (_model->getGlobalAngleDeg() != lastFrameAngle) {
-        for (auto itr = _model->_decorations.begin(); itr != _model->_decorations.end(); itr++) {
-            (*itr)->setRotationalSprite(_model->getGlobalAngleDeg());
-        }
+        _model->_decorations.updateFrames(_model->getGlobalAngleDeg());
     }
     
 #pragma mark Glowsticks
     if (_input->didGlowstick()) {
-        Vec3 player3DPos = _model->getPlayer3DLoc();
-        for(auto g =_model->_glowsticks.begin(); g!=_model->_glowsticks.end();){
-            if (g->getPosition().distance(player3DPos) <= PICKING_DIST) {
-                _model->_lightsFromItems.erase(std::string(g->getPosition()));
-                g = _model->_glowsticks.erase(g);
+        switch (_logic->useGlowstick()) {
+            case LogicController::PICKED_UP:
                 _model->updateGlowstickCount();
-                _pickupGlowstick = true;
-                
                 _sound->playSound("glowstick_pickup", 0.75);
-            }
-            else{
-                ++g;
-            }
-        }
-        if (!_pickupGlowstick && _model->_glowsticks.size() < _model->_numGlowsticks) {
-            auto g = Glowstick();
-            if(_model->_player->isFacingRight()){
-                g = Glowstick(player3DPos+(_plane->getBasisRight()*10)-(_model->getPlaneNorm()*1));
-            }else{
-                g = Glowstick(player3DPos-(_plane->getBasisRight()*10)-(_model->getPlaneNorm()*1));
-            }
-            int num = _model->_glowstickOrder % 4;
-            g.rotateSpriteSheet = _model->_glowstickSprites[num];
-            g.setColor(_model->_glowstickColors[num]);
-            g.setRotationalSprite(_model->getGlobalAngleDeg());
-            _model->_glowsticks.push_back(g);
-            _model->updateGlowstickCount();
-            _model->_lightsFromItems[std::string(g.getPosition())] = GameModel::Light(g.getColor(), g.getIntense(), g.getPosition(), 2000.0, g.getPulse()); // hard coded for now
-            _model->_glowstickOrder = _model->_glowstickOrder+1;
-            _sound->playSound("glowstick_place", 0.75);
+                break;
+            case LogicController::PLACED:
+                _model->_glowsticks.updateFrames(_model->getGlobalAngleDeg());
+                _model->updateGlowstickCount();
+                _sound->playSound("glowstick_place", 0.75);
+                break;
+            default:
+                break;
         }
-        
-        _pickupGlowstick = false;
     }
     
     
 #pragma mark PLAYER
     
-    _model->_player->setMovement(_input->getHorizontal() * _model->_player->getForce());
-    
-    _model->_player->setJumping(_input->didJump());
-    
-    _model->_player->setRunning(_input->isRun());
-    
-    _model->_player->applyForce();
-    
-    currPlay2DPos = _model->_player->getPosition();
-    Vec2 displacement = currPlay2DPos - prevPlay2DPos;
-    updatePlayer3DLoc(displacement);
-    prevPlay2DPos = currPlay2DPos;
-
-    // update triggers
-    for (auto trig : _model->_triggers) {
-        trig->update(_model->getPlayer3DLoc());
-    }
+    // the input is applied on every physics step (see fixedUpdate)
+    _logic->setInput(_input->getHorizontal(), _input->didJump(), _input->isRun(), _stepPhysics);
 
     //update navigator
     _model->updateNavigator();
@@ -1264,10 +1199,69 @@ void GameplayController::update(float dt) {
     
     _sound->setSpinnerPan(acosf(icos), volDist*maxLow);
     
+    // the level emitters, heard from the player (only the loudest get a voice)
+    _sound->updateEmitters(_model->_emitters, dt, _model->getPlayer3DLoc(), _plane->getBasisRight());
+    CU_PROFILE_COUNT("GameplayController::emitter voices", _model->_emitters.getVoiceCount());
+    
     _sound->checkFades();
     //CULog("spinner pan: %f", atanf(itan));
 }
 
+/**
+ * The method called to advance the physics by one fixed step.
+ *
+ * Stepping here rather than in update means the player moves at the same
+ * speed whatever the frame rate. The player forces are applied before each
+ * step (Box2D clears them after every step), and anything that depends on
+ * where the player ended up runs after it.
+ *
+ * @param step  The length of a fixed update (in seconds)
+ */
+void GameplayController::fixedUpdate(float step) {
+    CU_PROFILE_SCOPE("GameplayController::fixedUpdate");
+    if (_stepPhysics) {
+        if (_playing) {
+            _logic->applyInput();
+        }
+        _physics->update(step);
+        if (_recording != nullptr) {
+            _recording->addStep();
+        }
+        updateAfterStep();
+    }
+}
+
+/**
+ * Moves the player in 3D after a physics step, and runs what depends on it
+ *
+ * Once the level is playing, this also updates the triggers near the player
+ * and collects the items the player reached, and checks for the exit.
+ */
+void GameplayController::updateAfterStep() {
+    _logic->updatePlayer3DLoc();
+    if (!_playing) {
+        return;
+    }
+
+    // update triggers (only the ones near the player)
+    _logic->updateTriggers();
+
+    if (_logic->collect() > 0) {
+        _sound->playSound("collect", 0.75);
+        _justCollected = true;
+        _model->_collectTime->mark();
+    }
+
+    if (_logic->checkExit()) {
+        fadeinCollectibles();
+        _model->_player->shouldStartFlipping = true;
+        if(_model->_player->_isFlipping){
+            _sound->playSound("portal", 1);
+            _model->_player->_isFlipping = false;
+        }
+    }
+}
+
 void GameplayController::updatePopups() {
     // turn all visible popups down in transparency
     if (_model->_rotatePopup->isVisible()){
@@ -1458,9 +1452,28 @@ int GameplayController::getMaxLine(std::string s){
  * to the sprite batch.  By overriding it, you can do custom drawing
  * in its place.
  *
+ * The player is drawn between its last two physics steps, so it moves
+ * smoothly even when the frame rate and the physics rate do not line up.
+ *
  * @param batch     The SpriteBatch to draw with.
+ * @param alpha     The fraction of a physics step since the last one
  */
-void GameplayController::render(const std::shared_ptr<cugl::SpriteBatch>& batch) {
+void GameplayController::render(const std::shared_ptr<cugl::SpriteBatch>& batch, float alpha) {
+    CU_PROFILE_SCOPE("GameplayController::render");
+    if (_firstFrame) {
+        _firstFrame = false;
+        std::shared_ptr<LevelCache> cache = _data->getLevelCache();
+        CULog("Started %s in %llu ms (level cache %s, %.0f%% hit rate, %zu KB cached)", _model->getName().c_str(),
+              (unsigned long long)Timestamp::ellapsedMillis(_loadStart, Timestamp()), _loadCached ? "hit" : "miss",
+              cache->getHitRate() * 100, cache->getMemoryUsage() / 1024);
+    }
+    // the 3D location was last synced after the last step, so only add the difference
+    Vec3 renderLoc = _model->getPlayer3DLoc();
+    if (_stepPhysics) {
+        renderLoc += _logic->getDisplacement3D(_model->_player->getInterpolatedPosition(alpha) - _logic->getSyncedPosition());
+    }
+    _model->setPlayerRenderLoc(renderLoc);
+
     _pipeline->render(_model);
     // turn off the render pipeline stuff
     glDisable(GL_DEPTH_TEST);
@@ -1497,63 +1510,74 @@ std::tuple<cugl::Vec2, float> GameplayController::ScreenCoordinatesFrom3DPoint(c
     return(std::tuple<cugl::Vec2, float>(coords, dist));
 }
 
-void GameplayController::updatePlayer3DLoc(Vec2 displacement) {
-    float x = displacement.x;
-    float y = displacement.y;
-    /*std::cout<<"_plane->getBasisRight().x: " << _plane->getBasisRight().x << std::endl;
-    std::cout<<"_plane->getBasisRight().y: " << _plane->getBasisRight().x << std::endl;
-    std::cout<<"_plane->getBasisRight().z: " << _plane->getBasisRight().x << std::endl;
-    std::cout<<"2d-displacement x: " <<x<<std::endl;
-    std::cout<<"2d-displacement y: " <<y<<std::endl;*/
-    Vec3 temp = x * _plane->getBasisRight();
-    Vec3 displacementIn3D = Vec3(temp.x, temp.y, y);
-    /*std::cout<<"3d-displacement x: " <<displacementIn3D.x<<std::endl;
-    std::cout<<"3d-displacement y: " <<displacementIn3D.y<<std::endl;
-    std::cout<<"3d-displacement z: " <<displacementIn3D.z<<std::endl;
-    std::cout<<"here x: " <<(_model->getPlayer3DLoc() + displacementIn3D).x<<std::endl;
-    std::cout<<"here y: " <<(_model->getPlayer3DLoc() + displacementIn3D).y<<std::endl;
-    std::cout<<"here z: " <<(_model->getPlayer3DLoc() + displacementIn3D).z<<std::endl;*/
-    _model->setPlayer3DLoc(_model->getPlayer3DLoc() + displacementIn3D);
+/**
+ * Starts recording the input of a new attempt at a level
+ *
+ * This does nothing unless the game is built with PIVOT_RECORD_INPUT.
+ * The recording of any previous attempt is saved first.
+ *
+ * @param level The level key (as in assets.json)
+ */
+void GameplayController::startRecording(const std::string& level) {
+    saveRecording();
+#ifdef PIVOT_RECORD_INPUT
+    _recording = InputRecording::alloc(level, Application::get()->getFixedStep());
+#else
+    (void)level;
+#endif
 }
 
-void GameplayController::beginContact(b2Contact* contact) {
-    b2Fixture* fix1 = contact->GetFixtureA();
-    b2Fixture* fix2 = contact->GetFixtureB();
-
-    b2Body* body1 = fix1->GetBody();
-    b2Body* body2 = fix2->GetBody();
-
-    std::string* fd1 = reinterpret_cast<std::string*>(fix1->GetUserData().pointer);
-    std::string* fd2 = reinterpret_cast<std::string*>(fix2->GetUserData().pointer);
-
-    physics2::Obstacle* bd1 = reinterpret_cast<physics2::Obstacle*>(body1->GetUserData().pointer);
-    physics2::Obstacle* bd2 = reinterpret_cast<physics2::Obstacle*>(body2->GetUserData().pointer);
-
-    // See if we have landed on the ground.
-    if ((_model->_player->getSensorName() == fd2 && _model->_player.get() != bd1) ||
-        (_model->_player->getSensorName() == fd1 && _model->_player.get() != bd2)) {
-        _model->_player->setGrounded(true);
-        _model->_player->startTrackingAirTime = false;
-        _model->_player->timeStuckAtZeroYvelocity = 0.0f;
-        // Could have more than one ground
-        _sensorFixtures.emplace(_model->_player.get() == bd1 ? fix2 : fix1);
+/**
+ * Saves the input recording of the current attempt, if any
+ *
+ * The recording is written to the save directory as the level key with
+ * INPUT_RECORDING_SUFFIX, where the headless Simulation looks for it.
+ */
+void GameplayController::saveRecording() {
+    if (_recording == nullptr || _recording->isEmpty()) {
+        return;
     }
-    
-    if ((_model->_player->getLandSensorName() == fd2 && _model->_player.get() != bd1) ||
-        (_model->_player->getLandSensorName() == fd1 && _model->_player.get() != bd2)) {
-        if(_model->_player->getVY() < 0.0f){
-            _model->_player->setLanding(true);
-            //CULog("Landing");
+    std::string path = Application::get()->getSaveDirectory();
+    path.append(InputRecording::getFileName(_recording->getLevel()));
+    path = filetool::normalize_path(path);
+    if (_recording->write(path)) {
+        CULog("Saved %zu frames of input to %s", _recording->getFrames().size(), path.c_str());
+    }
+    _recording->clear();
+}
+
+/**
+ * Records the input read this frame, if recording
+ *
+ * The rotation is stored as the angle the plane is turned by, so a replay
+ * does not need the touch state that produced it.
+ *
+ * @param playing   False if the frame only lets the player fall
+ */
+void GameplayController::recordFrame(bool playing) {
+    if (_recording == nullptr) {
+        return;
+    }
+    InputFrame frame;
+    frame.playing = playing;
+    if (playing) {
+        frame.horizontal = _input->getHorizontal();
+        frame.jump = _input->didJump();
+        frame.run = _input->isRun();
+        frame.glowstick = _input->didGlowstick();
+        if (_input->isRotating) {
+            frame.rotating = true;
+            frame.rotate = (_input->cutFactor - saveFloat)/1000 * _input->settings_invertRotate;
+        } else if (_input->didKeepChangingCut()) {
+            frame.rotating = true;
+            frame.rotate = _input->getMoveNorm() * 1.75;
         }
-        // Could have more than one ground
-        //_sensorFixtures.emplace(_model->_player.get() == bd1 ? fix2 : fix1);
     }
+    _recording->addFrame(frame);
+}
 
-    // If we hit the "win" door, we are done
-//    if((bd1 == _model->_player.get() && bd2 == _goalDoor.get()) ||
-//        (bd1 == _goalDoor.get() && bd2 == _model->_player.get())) {
-//        setComplete(true);
-//    }
+void GameplayController::beginContact(b2Contact* contact) {
+    _model->_player->beginContact(contact);
 }
 
 /**
@@ -1564,25 +1588,7 @@ void GameplayController::beginContact(b2Contact* contact) {
  * double jumping.
  */
 void GameplayController::endContact(b2Contact* contact) {
-    b2Fixture* fix1 = contact->GetFixtureA();
-    b2Fixture* fix2 = contact->GetFixtureB();
-
-    b2Body* body1 = fix1->GetBody();
-    b2Body* body2 = fix2->GetBody();
-
-    std::string* fd1 = reinterpret_cast<std::string*>(fix1->GetUserData().pointer);
-    std::string* fd2 = reinterpret_cast<std::string*>(fix2->GetUserData().pointer);
-
-    physics2::Obstacle* bd1 = reinterpret_cast<physics2::Obstacle*>(body1->GetUserData().pointer);
-    physics2::Obstacle* bd2 = reinterpret_cast<physics2::Obstacle*>(body2->GetUserData().pointer);
-
-    if ((_model->_player->getSensorName() == fd2 && _model->_player.get() != bd1) ||
-        (_model->_player->getSensorName() == fd1 && _model->_player.get() != bd2)) {
-        _sensorFixtures.erase(_model->_player.get() == bd1 ? fix2 : fix1);
-        if (_sensorFixtures.empty()) {
-            _model->_player->setGrounded(false);
-        }
-    }
+    _model->_player->endContact(contact);
 }
 
 void GameplayController::fadeoutCollectibles(){
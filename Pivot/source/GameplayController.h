@@ -15,12 +15,15 @@
 #include "DataController.h"
 #include "PhysicsController.h"
 #include "PlaneController.h"
+#include "LogicController.h"
 #include "InputController.h"
 #include "GameModel.h"
 #include "RenderPipeline.h"
 #include "PlayerModel.h"
-#include "Collectible.h"
+#include "ItemStore.h"
 #include "GameItem.h"
+#include "InputRecording.h"
+#include "LevelLoader.h"
 
 class GameplayController : public cugl::Scene2 {
 public:
@@ -42,11 +45,6 @@ protected:
     /** current state of the game */
     State _state;
     
-    /** is the axis being rotated? (only remake colliders when false) */
-    bool _rotating = false;
-    
-    bool _pickupGlowstick = false;
-    
     bool _justCollected = false;
     
     bool _playOutline = true;
@@ -54,6 +52,25 @@ protected:
     bool _justRotated = false;
     
     bool _justStoppedRotating = false;
+
+    /** Whether the last update left the physics running (stepped in fixedUpdate) */
+    bool _stepPhysics = false;
+    /** Whether the last update took input (the level is playing, not fading in or out) */
+    bool _playing = false;
+
+    /** The input of the current attempt (only kept when built with PIVOT_RECORD_INPUT) */
+    std::shared_ptr<InputRecording> _recording;
+
+    /** The loader that reads new levels in the background */
+    std::shared_ptr<LevelLoader> _loader;
+    /** When the current level started loading */
+    Timestamp _loadStart;
+    /** Whether the current level came from the level cache */
+    bool _loadCached = false;
+    /** Whether the current level has not been drawn yet */
+    bool _firstFrame = false;
+    /** The last level handed to prefetchLevel */
+    std::string _prefetched;
     
     std::string _packName;
     
@@ -66,15 +83,6 @@ protected:
     //DEBUG COLLISION NODE
     std::shared_ptr<cugl::scene2::SceneNode> _debugnode;
     
-    cugl::Vec2 prevPlay2DPos;
-    
-    cugl::Vec2 currPlay2DPos;
-
-    cugl::Vec2 lastStablePlay2DPos;
-    
-    /** Mark set to handle more sophisticated collision callbacks */
-    std::unordered_set<b2Fixture*> _sensorFixtures;
-    
     std::unordered_map<std::string,std::shared_ptr<cugl::scene2::Button>> _buttons;
     /** The entire game UI scene */
     std::shared_ptr<cugl::scene2::SceneNode> _layer;
@@ -92,16 +100,56 @@ private:
     std::shared_ptr<RenderPipeline> _pipeline;
     std::shared_ptr<PlaneController> _plane;
     std::shared_ptr<DataController> _data;
+    /** The rules of play (shared with the headless Simulation) */
+    std::shared_ptr<LogicController> _logic;
     
     float _portalDistance = 100.0;
     int  _walkCooldown = 0;
 
 
     
+    /** What the loader thread makes of a level, for the main thread to pick up */
+    struct PendingLevel {
+        /** The meshes and tables of the level */
+        std::shared_ptr<LevelData> data;
+        /** Whether the level data came from the level cache */
+        bool cached = false;
+        /** The cut cache of the level (prewarmed if the level asks for it) */
+        std::shared_ptr<CutCache> cache;
+        /** The origin of the first cut */
+        Vec3 origin;
+        /** The normal of the first cut */
+        Vec3 normal;
+        /** The projected contours of the first cut */
+        std::vector<Path2> paths;
+    };
+
+    /**
+     * Sets up the model, physics and plane of a level the loader has read
+     *
+     * This is the main thread stage of load, and does everything but the GL
+     * uploads.
+     *
+     * @param name    the name of the level to be loaded (key in assets file)
+     * @param level   what the loader thread made of the level
+     *
+     * @return true if the level was set up
+     */
+    bool finishLoad(const std::string& name, const std::shared_ptr<PendingLevel>& level);
+
     /**
      * Removes all the nodes beloning to _polynodes from _worldnodes. In essence, this cleans up all the old collisions and SceneNodes pertaining to a previous cut to make room for the new cut's collisions.
      */
     void removePolyNodes();
+
+    /**
+     * Moves the player in 3D after a physics step, and runs what depends on it
+     *
+     * Once the level is playing, this also updates the triggers near the
+     * player and collects the items the player reached, and checks for the
+     * exit.
+     */
+    void updateAfterStep();
     
 protected:
     std::tuple<cugl::Vec2, float> tupleExit;
@@ -165,15 +213,6 @@ public:
      */
     std::string getSongName(std::string c);
     
-    /**
-    * Generates obstacle instances from the given cut, specified by the list of Poly2s given by the GameModel _model.
-    */
-    void createCutObstacles();
-    
-    void createObstacleFromPolys(std::vector<std::shared_ptr<Poly2>> polys);
-
-    
-    
     /**
      * Adds obstacle to both physics world and world node/debug node via an intermediary SceneNode
      * @param obj the obstacle
@@ -193,17 +232,50 @@ public:
      */
     void update(float timestep);
 
+    /**
+     * The method called to advance the physics by one fixed step.
+     *
+     * The physics only runs if the last call to update left it running
+     * (it is paused while the player rotates the plane or pixels out). The
+     * input read by the last update is applied to the player before every
+     * step, and the player position is read back after it.
+     *
+     * @param step  The length of a fixed update (in seconds)
+     */
+    void fixedUpdate(float step);
+
     /**
      * Resets the status of the game so that we can play again.
      */
     void reset();
     
     /**
-     * Loads a new level into the game model
+     * Starts loading a new level into the game model
+     *
+     * The meshes, their acceleration structures and the first cut are made
+     * on the loader thread, and the model and GL buffers are set up on the
+     * main thread over the next few calls to update. Nothing plays until then
+     * (see isLoading).
      *
      * @param name    the name of the level to be loaded (key in assets file)
      */
     void load(std::string name);
+
+    /**
+     * Reads a level in the background, so that loading it later is fast
+     *
+     * Nothing is read while a level is loading, so this may be called every
+     * frame with the level the player is likely to play next.
+     *
+     * @param name    the name of the level (key in assets file), or empty for none
+     */
+    void prefetchLevel(const std::string& name);
+
+    /** Returns true if a level is still loading */
+    bool isLoading() const { return _loader != nullptr && _loader->isLoading(); }
+
+    /** Returns the fraction of the current level load that is done */
+    float getLoadProgress() const { return _loader == nullptr ? 1.0f : _loader->getProgress(); }
     
     /**
      * Draws all this scene to the given SpriteBatch.
@@ -213,8 +285,9 @@ public:
      * in its place.
      *
      * @param batch     The SpriteBatch to draw with.
+     * @param alpha     The fraction of a physics step since the last one
      */
-    void render(const std::shared_ptr<cugl::SpriteBatch>& batch);
+    void render(const std::shared_ptr<cugl::SpriteBatch>& batch, float alpha = 1.0f);
     
     /**
      * Returns the active screen size of this scene.
@@ -276,8 +349,31 @@ public:
     * it also returns the projected distance from that point to the cut plane, which can be used to threshold drawing of an object at that location
     * RETURN: screen coordinates and projection distance pairs are returned as a std::tuple<Vec2,float>*/
     std::tuple<cugl::Vec2, float> ScreenCoordinatesFrom3DPoint(cugl::Vec3);
-    
-    void updatePlayer3DLoc(Vec2 displacement);
+
+    /**
+     * Starts recording the input of a new attempt at a level
+     *
+     * This does nothing unless the game is built with PIVOT_RECORD_INPUT.
+     * The recording of any previous attempt is saved first.
+     *
+     * @param level The level key (as in assets.json)
+     */
+    void startRecording(const std::string& level);
+
+    /**
+     * Saves the input recording of the current attempt, if any
+     *
+     * The recording is written to the save directory as the level key with
+     * INPUT_RECORDING_SUFFIX, where the headless Simulation looks for it.
+     */
+    void saveRecording();
+
+    /**
+     * Records the input read this frame, if recording
+     *
+     * @param playing   False if the frame only lets the player fall
+     */
+    void recordFrame(bool playing);
     
     /**
      * Returns the user's menu choice.
@@ -0,0 +1,113 @@
+//
+//  InputRecording.cpp
+//  Pivot
+//
+//  A recording of the player input over one attempt at a level.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "InputRecording.h"
+#include <cstdio>
+
+/** The longest line written for a frame */
+#define FRAME_LINE_SIZE 128
+
+/**
+ * Initializes an empty recording for a level
+ *
+ * @param level The level key (as in assets.json)
+ * @param step  The length of a physics step in seconds
+ *
+ * @return true if the recording was initialized properly
+ */
+bool InputRecording::init(const std::string& level, float step) {
+    if (level.empty() || level.find_first_of(" \t\n") != std::string::npos || step <= 0) {
+        CULogError("Invalid recording for level '%s'", level.c_str());
+        return false;
+    }
+    _level = level;
+    _step = step;
+    _frames.clear();
+    return true;
+}
+
+/**
+ * Initializes a recording from a file
+ *
+ * @param file  The absolute path of the recording
+ *
+ * @return true if the recording was read properly
+ */
+bool InputRecording::initWithFile(const std::string& file) {
+    std::shared_ptr<TextReader> reader = TextReader::alloc(file);
+    if (reader == nullptr || !reader->ready()) {
+        return false;
+    }
+
+    char magic[16];
+    char level[256];
+    int version = 0;
+    float step = 0;
+    std::string header = reader->readLine();
+    if (std::sscanf(header.c_str(), "%15s %d %255s %f", magic, &version, level, &step) != 4 ||
+        std::string(magic) != INPUT_RECORDING_MAGIC || version != INPUT_RECORDING_VERSION) {
+        CULogError("%s is not a version %d input recording", file.c_str(), INPUT_RECORDING_VERSION);
+        return false;
+    }
+    if (!init(level, step)) {
+        return false;
+    }
+
+    while (reader->ready()) {
+        std::string line = reader->readLine();
+        if (line.empty()) {
+            continue;
+        }
+        int playing, jump, run, rotating, glowstick;
+        unsigned int steps;
+        InputFrame frame;
+        if (std::sscanf(line.c_str(), "%d %f %d %d %d %f %d %u", &playing, &frame.horizontal, &jump, &run,
+                        &rotating, &frame.rotate, &glowstick, &steps) != 8) {
+            CULogError("%s is damaged at frame %zu", file.c_str(), _frames.size());
+            return false;
+        }
+        frame.playing = playing != 0;
+        frame.jump = jump != 0;
+        frame.run = run != 0;
+        frame.rotating = rotating != 0;
+        frame.glowstick = glowstick != 0;
+        frame.steps = steps;
+        _frames.push_back(frame);
+    }
+    reader->close();
+    return true;
+}
+
+/**
+ * Writes the recording to a file
+ *
+ * @param file  The absolute path of the recording
+ *
+ * @return true if the recording was written
+ */
+bool InputRecording::write(const std::string& file) const {
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(file);
+    if (writer == nullptr) {
+        CULogError("Could not write the input recording %s", file.c_str());
+        return false;
+    }
+
+    char line[FRAME_LINE_SIZE];
+    std::snprintf(line, FRAME_LINE_SIZE, "%s %d %s %.9g", INPUT_RECORDING_MAGIC, INPUT_RECORDING_VERSION,
+                  _level.c_str(), _step);
+    writer->writeLine(line);
+    for (const InputFrame& frame : _frames) {
+        // %.9g is enough digits for any float to read back exactly
+        std::snprintf(line, FRAME_LINE_SIZE, "%d %.9g %d %d %d %.9g %d %u", frame.playing, frame.horizontal,
+                      frame.jump, frame.run, frame.rotating, frame.rotate, frame.glowstick, frame.steps);
+        writer->writeLine(line);
+    }
+    writer->close();
+    return true;
+}
@@ -0,0 +1,181 @@
+//
+//  InputRecording.h
+//  Pivot
+//
+//  A recording of the player input over one attempt at a level, frame by
+//  frame, with the physics steps taken after each frame. It is written by the
+//  game when built with PIVOT_RECORD_INPUT and replayed by the headless
+//  Simulation.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef InputRecording_h
+#define InputRecording_h
+#include <cugl/cugl.h>
+#include <string>
+#include <vector>
+
+using namespace cugl;
+
+/** The first word of a recording file */
+#define INPUT_RECORDING_MAGIC   "PIVOTREC"
+/** The recording version; bump it whenever the layout changes */
+#define INPUT_RECORDING_VERSION 1
+/** The file suffix of a recording */
+#define INPUT_RECORDING_SUFFIX  ".pvr"
+
+/**
+ * The input for a single gameplay frame.
+ *
+ * These are the values the gameplay controller reads from the InputController
+ * each frame, after the rotation has been turned into an angle, so that a
+ * replay does not depend on the touch or keyboard state.
+ */
+struct InputFrame {
+    /** False if the frame only let the player fall while the level faded in */
+    bool playing;
+    /** The horizontal movement (-1 to 1) */
+    float horizontal;
+    /** Whether the player jumped */
+    bool jump;
+    /** Whether the player is running */
+    bool run;
+    /** Whether the player is rotating the plane */
+    bool rotating;
+    /** The rotation requested this frame in radians (if rotating) */
+    float rotate;
+    /** Whether the player placed or picked up a glowstick */
+    bool glowstick;
+    /** The number of physics steps taken after this frame */
+    Uint32 steps;
+
+    /** Creates a frame with no input and no physics steps */
+    InputFrame() : playing(true), horizontal(0), jump(false), run(false),
+    rotating(false), rotate(0), glowstick(false), steps(0) {}
+};
+
+/**
+ * The input frames of one attempt at a level.
+ *
+ * A recording is a text file. The first line is the magic word, the version,
+ * the level key and the physics step size. Every other line is one frame, as
+ * the fields of InputFrame in order, with the booleans written as 0 or 1.
+ * Floats are written with enough digits to be read back exactly, so a replay
+ * sees precisely the values the game saw.
+ */
+class InputRecording {
+private:
+    /** The level key (as in assets.json) */
+    std::string _level;
+    /** The length of a physics step in seconds */
+    float _step;
+    /** The recorded frames */
+    std::vector<InputFrame> _frames;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty recording. You must call an init method before using it.
+     */
+    InputRecording() : _step(0) {}
+
+    /**
+     * Initializes an empty recording for a level
+     *
+     * @param level The level key (as in assets.json)
+     * @param step  The length of a physics step in seconds
+     *
+     * @return true if the recording was initialized properly
+     */
+    bool init(const std::string& level, float step);
+
+    /**
+     * Initializes a recording from a file
+     *
+     * @param file  The absolute path of the recording
+     *
+     * @return true if the recording was read properly
+     */
+    bool initWithFile(const std::string& file);
+
+    /**
+     * Returns an empty recording for a level
+     *
+     * @param level The level key (as in assets.json)
+     * @param step  The length of a physics step in seconds
+     *
+     * @return an empty recording for a level
+     */
+    static std::shared_ptr<InputRecording> alloc(const std::string& level, float step) {
+        std::shared_ptr<InputRecording> result = std::make_shared<InputRecording>();
+        return (result->init(level, step) ? result : nullptr);
+    }
+
+    /**
+     * Returns a recording read from a file
+     *
+     * @param file  The absolute path of the recording
+     *
+     * @return a recording read from a file (or nullptr on failure)
+     */
+    static std::shared_ptr<InputRecording> allocWithFile(const std::string& file) {
+        std::shared_ptr<InputRecording> result = std::make_shared<InputRecording>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+#pragma mark Recording
+    /**
+     * Appends a frame to the recording
+     *
+     * @param frame The frame input
+     */
+    void addFrame(const InputFrame& frame) { _frames.push_back(frame); }
+
+    /**
+     * Records a physics step after the most recent frame
+     *
+     * Steps taken before the first frame are ignored.
+     */
+    void addStep() {
+        if (!_frames.empty()) {
+            _frames.back().steps++;
+        }
+    }
+
+    /** Removes every frame from the recording */
+    void clear() { _frames.clear(); }
+
+    /**
+     * Writes the recording to a file
+     *
+     * @param file  The absolute path of the recording
+     *
+     * @return true if the recording was written
+     */
+    bool write(const std::string& file) const;
+
+    /**
+     * Returns the recording file name for a level
+     *
+     * @param level The level key (as in assets.json)
+     */
+    static std::string getFileName(const std::string& level) {
+        return level + INPUT_RECORDING_SUFFIX;
+    }
+
+#pragma mark Attributes
+    /** Returns the level key (as in assets.json) */
+    const std::string& getLevel() const { return _level; }
+
+    /** Returns the length of a physics step in seconds */
+    float getStepSize() const { return _step; }
+
+    /** Returns the recorded frames, in order */
+    const std::vector<InputFrame>& getFrames() const { return _frames; }
+
+    /** Returns true if no frames have been recorded */
+    bool isEmpty() const { return _frames.empty(); }
+};
+
+#endif /* InputRecording_h */
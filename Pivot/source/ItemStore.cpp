@@ -0,0 +1,230 @@
+//
+//  ItemStore.cpp
+//  Pivot
+//
+//  Packed storage for the items of a level.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "ItemStore.h"
+
+/** The handle that refers to no item */
+const ItemStore::Handle ItemStore::NONE = { UINT32_MAX, 0 };
+
+/**
+ * Removes every item, so that no earlier handle finds anything
+ */
+void ItemStore::clear() {
+    for (Uint32 slot : _owners) {
+        _generations[slot]++;
+        _free.push_back(slot);
+    }
+    _positions.clear();
+    _scales.clear();
+    _offsets.clear();
+    _frameCounts.clear();
+    _frames.clear();
+    _normals.clear();
+    _flags.clear();
+    _colors.clear();
+    _intensities.clear();
+    _radii.clear();
+    _pulses.clear();
+    _sheets.clear();
+    _normalSheets.clear();
+    _names.clear();
+    _owners.clear();
+}
+
+/**
+ * Makes room for the given number of items
+ *
+ * @param count The number of items
+ */
+void ItemStore::reserve(size_t count) {
+    _positions.reserve(count);
+    _scales.reserve(count);
+    _offsets.reserve(count);
+    _frameCounts.reserve(count);
+    _frames.reserve(count);
+    _normals.reserve(count);
+    _flags.reserve(count);
+    _colors.reserve(count);
+    _intensities.reserve(count);
+    _radii.reserve(count);
+    _pulses.reserve(count);
+    _sheets.reserve(count);
+    _normalSheets.reserve(count);
+    _names.reserve(count);
+    _owners.reserve(count);
+    _indices.reserve(count);
+    _generations.reserve(count);
+}
+
+/**
+ * Adds an item to the end of the store
+ *
+ * @param pos           The item position
+ * @param sheet         The sprite sheet (may be null)
+ * @param normalSheet   The normal map sprite sheet (may be null)
+ * @param offset        The angle that offsets the rotating sprite
+ * @param scale         The sprite scale
+ * @param name          The item name
+ *
+ * @return the handle of the new item
+ */
+ItemStore::Handle ItemStore::add(const Vec3& pos, const std::shared_ptr<SpriteSheet>& sheet,
+                                 const std::shared_ptr<SpriteSheet>& normalSheet,
+                                 float offset, float scale, const std::string& name) {
+    Uint32 slot;
+    if (_free.empty()) {
+        slot = (Uint32)_indices.size();
+        _indices.push_back(0);
+        _generations.push_back(0);
+    } else {
+        slot = _free.back();
+        _free.pop_back();
+    }
+    _indices[slot] = (Uint32)_positions.size();
+
+    _positions.push_back(pos);
+    _scales.push_back(scale);
+    _offsets.push_back(offset);
+    _frameCounts.push_back(sheet == nullptr ? 0 : sheet->getSize());
+    _frames.push_back(-1);
+    _normals.push_back(Vec3::ZERO);
+    _flags.push_back(normalSheet == nullptr ? EMISSIVE : 0);
+    _colors.push_back(Vec3::ZERO);
+    _intensities.push_back(0);
+    _radii.push_back(0);
+    _pulses.push_back(0);
+    _sheets.push_back(sheet);
+    _normalSheets.push_back(normalSheet);
+    _names.push_back(name);
+    _owners.push_back(slot);
+    return { slot, _generations[slot] };
+}
+
+/**
+ * Removes an item, moving the last item into its place
+ *
+ * @param handle    The item handle
+ *
+ * @return true if the handle referred to an item
+ */
+bool ItemStore::remove(Handle handle) {
+    int found = find(handle);
+    if (found < 0) {
+        return false;
+    }
+    size_t index = found;
+    size_t last = _positions.size() - 1;
+    if (index != last) {
+        _positions[index] = _positions[last];
+        _scales[index] = _scales[last];
+        _offsets[index] = _offsets[last];
+        _frameCounts[index] = _frameCounts[last];
+        _frames[index] = _frames[last];
+        _normals[index] = _normals[last];
+        _flags[index] = _flags[last];
+        _colors[index] = _colors[last];
+        _intensities[index] = _intensities[last];
+        _radii[index] = _radii[last];
+        _pulses[index] = _pulses[last];
+        _sheets[index] = std::move(_sheets[last]);
+        _normalSheets[index] = std::move(_normalSheets[last]);
+        _names[index] = std::move(_names[last]);
+        _owners[index] = _owners[last];
+        _indices[_owners[index]] = (Uint32)index;
+    }
+    _positions.pop_back();
+    _scales.pop_back();
+    _offsets.pop_back();
+    _frameCounts.pop_back();
+    _frames.pop_back();
+    _normals.pop_back();
+    _flags.pop_back();
+    _colors.pop_back();
+    _intensities.pop_back();
+    _radii.pop_back();
+    _pulses.pop_back();
+    _sheets.pop_back();
+    _normalSheets.pop_back();
+    _names.pop_back();
+    _owners.pop_back();
+
+    _generations[handle.slot]++;
+    _free.push_back(handle.slot);
+    return true;
+}
+
+/**
+ * Returns the index of an item (or -1 if the handle is stale)
+ *
+ * @param handle    The item handle
+ */
+int ItemStore::find(Handle handle) const {
+    if (handle.slot >= _generations.size() || _generations[handle.slot] != handle.generation) {
+        return -1;
+    }
+    return (int)_indices[handle.slot];
+}
+
+/**
+ * Turns every sprite to face the given plane angle
+ *
+ * @param angle The global plane angle in degrees
+ */
+void ItemStore::updateFrames(float angle) {
+    for (size_t ii = 0; ii < _positions.size(); ii++) {
+        if (_frameCounts[ii] == 0) {
+            continue;
+        }
+        // the same steps as GameItem::setRotationalSprite
+        float repeat = 360.0f / _frameCounts[ii];
+        int local = (int)(angle - _offsets[ii]) % 360;
+        local = local < 0 ? local + 360 : local;
+        int frame = (int)(local / repeat);
+        if (frame == _frames[ii]) {
+            continue;
+        }
+        _frames[ii] = frame;
+        _sheets[ii]->setFrame(frame);
+        if (!(_flags[ii] & EMISSIVE) && _normalSheets[ii] != nullptr) {
+            _normalSheets[ii]->setFrame(frame);
+        }
+    }
+}
+
+/**
+ * Makes an item cast a light
+ *
+ * @param index     The item index
+ * @param color     The light color
+ * @param intensity The light intensity
+ * @param radius    The light radius
+ * @param pulse     The light pulse period (0 for a steady light)
+ */
+void ItemStore::setLight(size_t index, const Vec3& color, float intensity, float radius, float pulse) {
+    _colors[index] = color;
+    _intensities[index] = intensity;
+    _radii[index] = radius;
+    _pulses[index] = pulse;
+    _flags[index] |= LIT;
+}
+
+/**
+ * Returns the approximate memory used by the store in bytes (not counting the sheets)
+ */
+size_t ItemStore::getMemoryUsage() const {
+    size_t bytes = sizeof(ItemStore);
+    bytes += _positions.capacity() * sizeof(Vec3) * 3;
+    bytes += _scales.capacity() * sizeof(float) * 5;
+    bytes += _frameCounts.capacity() * sizeof(int) * 2;
+    bytes += _flags.capacity() * sizeof(Uint8);
+    bytes += _sheets.capacity() * sizeof(std::shared_ptr<SpriteSheet>) * 2;
+    bytes += _names.capacity() * sizeof(std::string);
+    bytes += (_owners.capacity() + _indices.capacity() + _generations.capacity() + _free.capacity()) * sizeof(Uint32);
+    return bytes;
+}
@@ -0,0 +1,259 @@
+//
+//  ItemStore.h
+//  Pivot
+//
+//  Packed storage for the items of a level (collectibles, decorations, posters
+//  and glowsticks). Every attribute is kept in its own array, so the loops that
+//  run each frame (collecting, turning the sprites, building the billboards and
+//  gathering the lights) walk contiguous memory instead of copying maps or
+//  following a pointer per item.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef ItemStore_h
+#define ItemStore_h
+#include <cugl/cugl.h>
+#include <vector>
+
+using namespace cugl;
+
+/**
+ * A packed store of game items with generational handles.
+ *
+ * The items are kept dense, in the order they were added, with one array per
+ * attribute. Removing an item moves the last item into its place, so indices
+ * are only good until the next removal. A Handle stays good for as long as its
+ * item is in the store; once the item is removed (or the store is cleared) the
+ * handle no longer finds anything, even if its slot is reused by a new item.
+ *
+ * The sprite frames are computed from the arrays, and a sprite sheet is only
+ * told about its frame when the frame actually changes.
+ *
+ * This class does not touch OpenGL, so the items can be updated without a
+ * context (the sprite sheets are optional).
+ */
+class ItemStore {
+public:
+    /** A reference to an item that survives the removal of other items */
+    struct Handle {
+        /** The slot of the item */
+        Uint32 slot;
+        /** The generation of the slot when the item was added */
+        Uint32 generation;
+
+        bool operator==(const Handle& other) const { return slot == other.slot && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    /** The handle that refers to no item */
+    static const Handle NONE;
+
+private:
+    /** The item flags */
+    enum Flag : Uint8 {
+        /** The item has been collected */
+        COLLECTED = 1,
+        /** The item has no normal map */
+        EMISSIVE = 2,
+        /** The item casts a light */
+        LIT = 4
+    };
+
+    /** The item positions */
+    std::vector<Vec3> _positions;
+    /** The sprite scales */
+    std::vector<float> _scales;
+    /** The angles that offset the rotating sprites */
+    std::vector<float> _offsets;
+    /** The number of frames in each sprite sheet (0 if there is no sheet) */
+    std::vector<int> _frameCounts;
+    /** The current sprite frames (-1 before the first update) */
+    std::vector<int> _frames;
+    /** The poster normals (zero for billboards) */
+    std::vector<Vec3> _normals;
+    /** The item flags */
+    std::vector<Uint8> _flags;
+    /** The light colors */
+    std::vector<Vec3> _colors;
+    /** The light intensities */
+    std::vector<float> _intensities;
+    /** The light radii */
+    std::vector<float> _radii;
+    /** The light pulse periods (0 for a steady light) */
+    std::vector<float> _pulses;
+    /** The sprite sheets */
+    std::vector<std::shared_ptr<SpriteSheet>> _sheets;
+    /** The normal map sprite sheets */
+    std::vector<std::shared_ptr<SpriteSheet>> _normalSheets;
+    /** The item names */
+    std::vector<std::string> _names;
+    /** The slot of each item */
+    std::vector<Uint32> _owners;
+
+    /** The item index of each slot */
+    std::vector<Uint32> _indices;
+    /** The current generation of each slot */
+    std::vector<Uint32> _generations;
+    /** The slots without an item */
+    std::vector<Uint32> _free;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty store
+     */
+    ItemStore() {}
+
+    /**
+     * Removes every item, so that no earlier handle finds anything
+     */
+    void clear();
+
+    /**
+     * Makes room for the given number of items
+     *
+     * @param count The number of items
+     */
+    void reserve(size_t count);
+
+#pragma mark Items
+    /**
+     * Adds an item to the end of the store
+     *
+     * The item does not cast a light, and is emissive if it has no normal
+     * map sheet.
+     *
+     * @param pos           The item position
+     * @param sheet         The sprite sheet (may be null)
+     * @param normalSheet   The normal map sprite sheet (may be null)
+     * @param offset        The angle that offsets the rotating sprite
+     * @param scale         The sprite scale
+     * @param name          The item name
+     *
+     * @return the handle of the new item
+     */
+    Handle add(const Vec3& pos, const std::shared_ptr<SpriteSheet>& sheet, const std::shared_ptr<SpriteSheet>& normalSheet,
+               float offset, float scale, const std::string& name = "");
+
+    /**
+     * Removes an item, moving the last item into its place
+     *
+     * @param handle    The item handle
+     *
+     * @return true if the handle referred to an item
+     */
+    bool remove(Handle handle);
+
+    /**
+     * Returns the index of an item (or -1 if the handle is stale)
+     *
+     * @param handle    The item handle
+     */
+    int find(Handle handle) const;
+
+    /**
+     * Returns the handle of the item at the given index
+     *
+     * @param index The item index
+     */
+    Handle getHandle(size_t index) const { return { _owners[index], _generations[_owners[index]] }; }
+
+    /** Returns the number of items */
+    size_t size() const { return _positions.size(); }
+
+    /** Returns true if there are no items */
+    bool empty() const { return _positions.empty(); }
+
+#pragma mark Sprites
+    /**
+     * Turns every sprite to face the given plane angle
+     *
+     * This is GameItem::setRotationalSprite for the whole store. Sheets are
+     * only updated for the items whose frame changed.
+     *
+     * @param angle The global plane angle in degrees
+     */
+    void updateFrames(float angle);
+
+#pragma mark Attributes
+    /** Returns the item positions, in index order */
+    const std::vector<Vec3>& getPositions() const { return _positions; }
+
+    /** Returns the position of an item */
+    const Vec3& getPosition(size_t index) const { return _positions[index]; }
+
+    /** Returns the sprite scale of an item */
+    float getScale(size_t index) const { return _scales[index]; }
+
+    /** Returns the angle that offsets the rotating sprite of an item */
+    float getOffsetAngle(size_t index) const { return _offsets[index]; }
+
+    /** Returns the sprite frame of an item (-1 before the first update) */
+    int getFrame(size_t index) const { return _frames[index]; }
+
+    /** Returns the sprite sheet of an item */
+    const std::shared_ptr<SpriteSheet>& getSheet(size_t index) const { return _sheets[index]; }
+
+    /** Returns the normal map sprite sheet of an item */
+    const std::shared_ptr<SpriteSheet>& getNormalSheet(size_t index) const { return _normalSheets[index]; }
+
+    /** Returns the name of an item */
+    const std::string& getName(size_t index) const { return _names[index]; }
+
+    /** Returns the poster normal of an item (zero for billboards) */
+    const Vec3& getNormal(size_t index) const { return _normals[index]; }
+
+    /** Sets the poster normal of an item */
+    void setNormal(size_t index, const Vec3& normal) { _normals[index] = normal; }
+
+    /** Returns true if an item has no normal map */
+    bool isEmissive(size_t index) const { return _flags[index] & EMISSIVE; }
+
+    /** Sets whether an item has no normal map */
+    void setEmissive(size_t index, bool value) { setFlag(index, EMISSIVE, value); }
+
+    /** Returns true if an item has been collected */
+    bool isCollected(size_t index) const { return _flags[index] & COLLECTED; }
+
+    /** Sets whether an item has been collected */
+    void setCollected(size_t index, bool value) { setFlag(index, COLLECTED, value); }
+
+#pragma mark Lights
+    /**
+     * Makes an item cast a light
+     *
+     * @param index     The item index
+     * @param color     The light color
+     * @param intensity The light intensity
+     * @param radius    The light radius
+     * @param pulse     The light pulse period (0 for a steady light)
+     */
+    void setLight(size_t index, const Vec3& color, float intensity, float radius, float pulse);
+
+    /** Returns true if an item casts a light */
+    bool hasLight(size_t index) const { return _flags[index] & LIT; }
+
+    /** Returns the light color of an item */
+    const Vec3& getColor(size_t index) const { return _colors[index]; }
+
+    /** Returns the light intensity of an item */
+    float getIntensity(size_t index) const { return _intensities[index]; }
+
+    /** Returns the light radius of an item */
+    float getRadius(size_t index) const { return _radii[index]; }
+
+    /** Returns the light pulse period of an item */
+    float getPulse(size_t index) const { return _pulses[index]; }
+
+    /** Returns the approximate memory used by the store in bytes (not counting the sheets) */
+    size_t getMemoryUsage() const;
+
+private:
+    /** Sets or clears a flag of an item */
+    void setFlag(size_t index, Flag flag, bool value) {
+        _flags[index] = value ? (_flags[index] | flag) : (_flags[index] & ~flag);
+    }
+};
+
+#endif /* ItemStore_h */
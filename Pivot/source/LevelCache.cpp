@@ -0,0 +1,266 @@
+//
+//  LevelCache.cpp
+//  Pivot
+//
+//  LRU cache of loaded levels.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "LevelCache.h"
+#include "DataController.h"
+
+/**
+ * Drops every level and stops the cache thread
+ *
+ * This blocks until the prefetch that is running (if any) finishes.
+ */
+void LevelCache::dispose() {
+    // the pool joins its thread when it is deleted, and drops the queued prefetches
+    _pool = nullptr;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _prefetches.clear();
+    _entries.clear();
+    _order.clear();
+    _usage = 0;
+}
+
+/**
+ * Initializes an empty cache with the given budget
+ *
+ * @param budget    The memory budget in bytes
+ *
+ * @return true if the cache was initialized properly
+ */
+bool LevelCache::init(size_t budget) {
+    _pool = ThreadPool::alloc(1);
+    _budget = budget;
+    return _pool != nullptr;
+}
+
+/**
+ * Returns a level, reading it if it is not cached, and counts a hit or a miss
+ *
+ * @param level     The level name
+ * @param constants The level json
+ * @param hit       If not null, set to whether the level was already read
+ *
+ * @return the level data (or nullptr if the level could not be read)
+ */
+std::shared_ptr<LevelData> LevelCache::acquire(const std::string& level, const std::shared_ptr<JsonValue>& constants,
+                                               bool* hit) {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _prefetches.find(level);
+        if (it != _prefetches.end() && it->second == QUEUED) {
+            // do not wait behind other prefetches; the queued task will see it is gone
+            _prefetches.erase(it);
+        } else {
+            _ready.wait(lock, [&]() { return _prefetches.find(level) == _prefetches.end(); });
+        }
+
+        std::shared_ptr<LevelData> data = touch(level);
+        if (hit != nullptr) {
+            *hit = data != nullptr;
+        }
+        if (data != nullptr) {
+            _hits++;
+            return data;
+        }
+        _misses++;
+    }
+
+    std::shared_ptr<LevelData> data = DataController::readLevelData(level, constants);
+    if (data != nullptr) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        insert(level, data);
+    }
+    return data;
+}
+
+/**
+ * Starts reading a level on the cache thread, if it is not cached
+ *
+ * @param level     The level name
+ * @param constants The level json
+ */
+void LevelCache::prefetch(const std::string& level, const std::shared_ptr<JsonValue>& constants) {
+    if (constants == nullptr || _pool == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.find(level) != _entries.end() || _prefetches.find(level) != _prefetches.end()) {
+            return;
+        }
+        _prefetches[level] = QUEUED;
+    }
+    _pool->addTask([=]() {
+        runPrefetch(level, constants);
+    });
+}
+
+/**
+ * Reads a level on the cache thread
+ *
+ * @param level     The level name
+ * @param constants The level json
+ */
+void LevelCache::runPrefetch(const std::string& level, const std::shared_ptr<JsonValue>& constants) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _prefetches.find(level);
+        if (it == _prefetches.end() || it->second != QUEUED) {
+            // acquire got to it first
+            return;
+        }
+        it->second = READING;
+    }
+
+    Timestamp start;
+    std::shared_ptr<LevelData> data = DataController::readLevelData(level, constants);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _prefetches.erase(level);
+        if (data != nullptr) {
+            insert(level, data);
+            CULog("Prefetched level %s in %llu ms (%zu KB cached)", level.c_str(),
+                  (unsigned long long)Timestamp::ellapsedMillis(start, Timestamp()), _usage / 1024);
+        }
+    }
+    _ready.notify_all();
+}
+
+/**
+ * Returns true if the level is cached
+ *
+ * @param level The level name
+ */
+bool LevelCache::contains(const std::string& level) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.find(level) != _entries.end();
+}
+
+/**
+ * Returns the cached level and marks it as most recently used
+ *
+ * @param level The level name
+ *
+ * @return the cached level (or nullptr if it is not cached)
+ */
+std::shared_ptr<LevelData> LevelCache::touch(const std::string& level) {
+    auto it = _entries.find(level);
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+    // most recently used goes to the front
+    _order.splice(_order.begin(), _order, it->second.order);
+    return it->second.data;
+}
+
+/**
+ * Evicts the least recently used levels until the cache fits the budget
+ *
+ * @param bytes The room to leave for a new level in bytes
+ */
+void LevelCache::evict(size_t bytes) {
+    // a level the game still uses stays in memory until it is done with it
+    while (!_order.empty() && _usage + bytes > _budget) {
+        auto victim = _entries.find(_order.back());
+        _usage -= victim->second.bytes;
+        _entries.erase(victim);
+        _order.pop_back();
+        _evictions++;
+    }
+}
+
+/**
+ * Stores a level, evicting old levels to stay in budget
+ *
+ * @param level The level name
+ * @param data  The level data
+ */
+void LevelCache::insert(const std::string& level, const std::shared_ptr<LevelData>& data) {
+    size_t bytes = data->getMemoryUsage();
+    if (bytes > _budget) {
+        CULog("Level %s (%zu KB) is larger than the level cache", level.c_str(), bytes / 1024);
+        return;
+    }
+
+    auto it = _entries.find(level);
+    if (it != _entries.end()) {
+        _usage -= it->second.bytes;
+        _order.erase(it->second.order);
+        _entries.erase(it);
+    }
+
+    evict(bytes);
+    _order.push_front(level);
+    _entries[level] = { data, bytes, _order.begin() };
+    _usage += bytes;
+}
+
+/**
+ * Removes every level from the cache (the counters are kept)
+ */
+void LevelCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _order.clear();
+    _usage = 0;
+}
+
+#pragma mark Attributes
+/** Returns the number of cached levels */
+size_t LevelCache::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+/** Returns the approximate memory used by the cached levels in bytes */
+size_t LevelCache::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _usage;
+}
+
+/** Returns the memory budget in bytes */
+size_t LevelCache::getBudget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+/**
+ * Sets the memory budget, evicting old levels to stay within it
+ *
+ * @param budget    The memory budget in bytes
+ */
+void LevelCache::setBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = budget;
+    evict(0);
+}
+
+/** Returns the number of acquires that found the level read */
+Uint64 LevelCache::getHits() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+/** Returns the number of acquires that had to read the level */
+Uint64 LevelCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+/** Returns the number of levels dropped to stay within budget */
+Uint64 LevelCache::getEvictions() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _evictions;
+}
+
+/** Returns the fraction of acquires that found the level read */
+float LevelCache::getHitRate() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Uint64 total = _hits + _misses;
+    return total == 0 ? 0.0f : (float)_hits / total;
+}
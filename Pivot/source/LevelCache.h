@@ -0,0 +1,238 @@
+//
+//  LevelCache.h
+//  Pivot
+//
+//  LRU cache of loaded levels. Players go back and forth between the level
+//  select and a handful of levels, and almost always play the next level in
+//  the pack after finishing one, so levels are kept around (within a memory
+//  budget) and the likely next level is read in the background ahead of time.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef LevelCache_h
+#define LevelCache_h
+#include <cugl/cugl.h>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "LevelData.h"
+
+using namespace cugl;
+
+/** Default memory budget of the cache in megabytes (save.json may set level_cache_mb) */
+#define LEVEL_CACHE_BUDGET_MB   128
+
+/**
+ * A least-recently-used cache of level data, keyed by level name.
+ *
+ * An entry holds everything DataController::readLevelData makes of a level:
+ * the render and collision meshes with their slicer, the trigger regions with
+ * their volumes, and the sprite and light tables. Level data is never changed
+ * once it is read, so an entry can be shared by the cache and the game.
+ *
+ * Levels are read either on demand by acquire, or ahead of time by prefetch
+ * on the cache thread. If acquire asks for a level that is waiting to be
+ * prefetched, it reads the level itself rather than waiting behind other
+ * prefetches; if the prefetch has already started, it waits for it to finish.
+ *
+ * Unlike CutCache, this class is thread safe, as levels are acquired on the
+ * level loader thread and prefetched on the cache thread.
+ */
+class LevelCache {
+private:
+    /** A cached level */
+    struct Entry {
+        /** The level data */
+        std::shared_ptr<LevelData> data;
+        /** The approximate memory used by the level in bytes */
+        size_t bytes;
+        /** The position of this level in the usage order */
+        std::list<std::string>::iterator order;
+    };
+
+    /** The state of a prefetch */
+    enum Prefetch {
+        /** The prefetch is waiting for the cache thread */
+        QUEUED,
+        /** The cache thread is reading the level */
+        READING
+    };
+
+    /** The (single thread) pool that prefetches levels */
+    std::shared_ptr<ThreadPool> _pool;
+    /** Guards every attribute below */
+    mutable std::mutex _mutex;
+    /** Signals that a prefetch has finished */
+    std::condition_variable _ready;
+    /** The cached levels */
+    std::unordered_map<std::string, Entry> _entries;
+    /** The prefetches that have not finished */
+    std::unordered_map<std::string, Prefetch> _prefetches;
+    /** The level names, from most to least recently used */
+    std::list<std::string> _order;
+    /** The memory budget in bytes */
+    size_t _budget;
+    /** The memory currently used by the entries in bytes */
+    size_t _usage;
+
+    /** The number of acquires that found the level read */
+    Uint64 _hits;
+    /** The number of acquires that had to read the level */
+    Uint64 _misses;
+    /** The number of levels dropped to stay within budget */
+    Uint64 _evictions;
+
+    /**
+     * Evicts the least recently used levels until the cache fits the budget
+     *
+     * The mutex must be held by the caller.
+     *
+     * @param bytes The room to leave for a new level in bytes
+     */
+    void evict(size_t bytes);
+
+    /**
+     * Stores a level, evicting old levels to stay in budget
+     *
+     * A level larger than the whole budget is not stored. The mutex must be
+     * held by the caller.
+     *
+     * @param level The level name
+     * @param data  The level data
+     */
+    void insert(const std::string& level, const std::shared_ptr<LevelData>& data);
+
+    /**
+     * Returns the cached level and marks it as most recently used
+     *
+     * The mutex must be held by the caller.
+     *
+     * @param level The level name
+     *
+     * @return the cached level (or nullptr if it is not cached)
+     */
+    std::shared_ptr<LevelData> touch(const std::string& level);
+
+    /**
+     * Reads a level on the cache thread
+     *
+     * @param level     The level name
+     * @param constants The level json
+     */
+    void runPrefetch(const std::string& level, const std::shared_ptr<JsonValue>& constants);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty cache. You must call init before using it.
+     */
+    LevelCache() : _budget(0), _usage(0), _hits(0), _misses(0), _evictions(0) {}
+
+    /**
+     * Deletes this cache, waiting for the prefetch that is running (if any)
+     */
+    ~LevelCache() { dispose(); }
+
+    /**
+     * Drops every level and stops the cache thread
+     *
+     * This blocks until the prefetch that is running (if any) finishes.
+     */
+    void dispose();
+
+    /**
+     * Initializes an empty cache with the given budget
+     *
+     * @param budget    The memory budget in bytes
+     *
+     * @return true if the cache was initialized properly
+     */
+    bool init(size_t budget);
+
+    /**
+     * Returns a newly allocated cache with the given budget
+     *
+     * @param budget    The memory budget in bytes
+     *
+     * @return a newly allocated cache with the given budget
+     */
+    static std::shared_ptr<LevelCache> alloc(size_t budget) {
+        std::shared_ptr<LevelCache> result = std::make_shared<LevelCache>();
+        return (result->init(budget) ? result : nullptr);
+    }
+
+#pragma mark Cache Access
+    /**
+     * Returns a level, reading it if it is not cached, and counts a hit or a miss
+     *
+     * This may block while the level is read, so it should not be called on
+     * the main thread.
+     *
+     * @param level     The level name
+     * @param constants The level json
+     * @param hit       If not null, set to whether the level was already read
+     *
+     * @return the level data (or nullptr if the level could not be read)
+     */
+    std::shared_ptr<LevelData> acquire(const std::string& level, const std::shared_ptr<JsonValue>& constants,
+                                       bool* hit = nullptr);
+
+    /**
+     * Starts reading a level on the cache thread, if it is not cached
+     *
+     * This returns immediately, and does nothing if the level is cached or
+     * already being prefetched. Prefetches run in the order they are asked
+     * for.
+     *
+     * @param level     The level name
+     * @param constants The level json
+     */
+    void prefetch(const std::string& level, const std::shared_ptr<JsonValue>& constants);
+
+    /**
+     * Returns true if the level is cached
+     *
+     * This does not count towards the hit and miss counters.
+     *
+     * @param level The level name
+     */
+    bool contains(const std::string& level) const;
+
+    /**
+     * Removes every level from the cache (the counters are kept)
+     */
+    void clear();
+
+#pragma mark Attributes
+    /** Returns the number of cached levels */
+    size_t size() const;
+
+    /** Returns the approximate memory used by the cached levels in bytes */
+    size_t getMemoryUsage() const;
+
+    /** Returns the memory budget in bytes */
+    size_t getBudget() const;
+
+    /**
+     * Sets the memory budget, evicting old levels to stay within it
+     *
+     * @param budget    The memory budget in bytes
+     */
+    void setBudget(size_t budget);
+
+    /** Returns the number of acquires that found the level read */
+    Uint64 getHits() const;
+
+    /** Returns the number of acquires that had to read the level */
+    Uint64 getMisses() const;
+
+    /** Returns the number of levels dropped to stay within budget */
+    Uint64 getEvictions() const;
+
+    /** Returns the fraction of acquires that found the level read */
+    float getHitRate() const;
+};
+
+#endif /* LevelCache_h */
@@ -0,0 +1,579 @@
+//
+//  LevelData.cpp
+//  Pivot
+//
+//  Level loading from the exported files or a precompiled binary level.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "LevelData.h"
+#include "BinaryIO.h"
+
+/** The number of floats per sprite in the sprite table */
+#define SPRITE_FLOATS   13
+/** The number of floats per light in the light table */
+#define LIGHT_FLOATS    9
+/** The number of floats per emitter in the sound emitter table */
+#define EMITTER_FLOATS  4
+/** The FNV-1a offset basis */
+#define HASH_OFFSET     0xcbf29ce484222325ULL
+/** The FNV-1a prime */
+#define HASH_PRIME      0x100000001b3ULL
+/** The number of bytes hashed at a time */
+#define HASH_BLOCK      65536
+
+/** The asset directory override (empty to use the application's) */
+std::string LevelData::_assetDirectory;
+
+/**
+ * Reads a point from a JSON array
+ *
+ * @param json  The JSON array
+ */
+static Vec3 jsonVec3(const std::shared_ptr<JsonValue>& json) {
+    return Vec3(json->get(0)->asFloat(), json->get(1)->asFloat(), json->get(2)->asFloat());
+}
+
+/**
+ * Returns true if a JSON object has every one of the given keys
+ *
+ * @param json  The JSON object
+ * @param keys  The required keys
+ */
+static bool hasKeys(const std::shared_ptr<JsonValue>& json, std::initializer_list<const char*> keys) {
+    if (json == nullptr) {
+        return false;
+    }
+    for (const char* key : keys) {
+        if (!json->has(key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the absolute path of an asset
+ *
+ * @param path  The path relative to the asset directory
+ */
+static std::string assetPath(const std::string& path) {
+    std::string result = LevelData::getAssetDirectory();
+    result.append(path);
+    return filetool::normalize_path(result);
+}
+
+/**
+ * Adds the given bytes to an FNV-1a hash
+ *
+ * @param hash  The hash to update
+ * @param data  The bytes
+ * @param size  The number of bytes
+ */
+static void hashBytes(Uint64& hash, const Uint8* data, size_t size) {
+    for (size_t ii = 0; ii < size; ii++) {
+        hash ^= data[ii];
+        hash *= HASH_PRIME;
+    }
+}
+
+/**
+ * Returns the FNV-1a hash of the contents of an asset
+ *
+ * @param path  The path relative to the asset directory
+ *
+ * @return the hash of the contents, or 0 if the file could not be read
+ */
+static Uint64 fileHash(const std::string& path) {
+    std::string file = assetPath(path);
+    if (!filetool::file_exists(file)) {
+        return 0;
+    }
+    std::shared_ptr<BinaryReader> reader = BinaryReader::alloc(file);
+    if (reader == nullptr) {
+        return 0;
+    }
+    std::vector<Uint8> block(HASH_BLOCK);
+    Uint64 hash = HASH_OFFSET;
+    size_t read;
+    while ((read = reader->read(block.data(), block.size())) > 0) {
+        hashBytes(hash, block.data(), read);
+    }
+    reader->close();
+    // 0 is reserved for a missing file
+    return hash != 0 ? hash : 1;
+}
+
+#pragma mark Constructors
+/**
+ * Initializes the level from the exported JSON and OBJ files
+ *
+ * @param json  The level JSON
+ *
+ * @return true if the level was loaded properly
+ */
+bool LevelData::initWithJson(const std::shared_ptr<JsonValue>& json) {
+    if (json == nullptr) {
+        return false;
+    }
+    _renderMesh = PivotMesh::MeshFromOBJ(assetPath(json->getString("render_mesh")), PivotMesh::LOAD_RENDER);
+    if (_renderMesh == nullptr) {
+        return false;
+    }
+    // the render pipeline only draws the chunks it can see, so this chunks it now (before the upload)
+    _renderMesh->buildChunks();
+    // the collision mesh is cut every time the plane moves, so this builds its slicer now
+    _colMesh = PivotMesh::MeshFromOBJ(assetPath(json->getString("collision_mesh")), PivotMesh::LOAD_SLICE);
+    if (_colMesh == nullptr) {
+        return false;
+    }
+
+    _sprites.clear();
+    _lights.clear();
+    std::shared_ptr<JsonValue> sprites = json->get("sprites");
+    for (size_t i = 0; sprites != nullptr && i < sprites->size(); i++) {
+        std::shared_ptr<JsonValue> entry = sprites->get(std::to_string(i));
+        // levels exported by old versions of the exporter are missing fields
+        if (!hasKeys(entry, {"loc", "tex", "color"})) {
+            CULogError("Sprite %zu of %s is incomplete", i, json->getString("level_id").c_str());
+            return false;
+        }
+        float pulse = entry->get("pulse") != nullptr ? entry->get("pulse")->asFloat() : 0.0f;
+        std::string tex = entry->getString("tex");
+
+        if (tex == "") {
+            if (!hasKeys(entry, {"intense", "radius"})) {
+                CULogError("Light %zu of %s is incomplete", i, json->getString("level_id").c_str());
+                return false;
+            }
+            // its ONLY a light with no texture
+            Light light;
+            light.loc = jsonVec3(entry->get("loc"));
+            light.color = jsonVec3(entry->get("color"));
+            light.intensity = entry->get("intense")->asFloat();
+            light.falloff = entry->get("radius")->asFloat();
+            light.pulse = pulse;
+            _lights.push_back(light);
+            continue;
+        }
+
+        bool light = !entry->get("color")->isNull();
+        if (!hasKeys(entry, {"collectible", "billboard", "emissive", "norm", "scale"}) ||
+            (light && !hasKeys(entry, {"intense", "radius"}))) {
+            CULogError("Sprite %zu of %s is incomplete", i, json->getString("level_id").c_str());
+            return false;
+        }
+        Sprite sprite;
+        sprite.index = i;
+        sprite.flags = 0;
+        sprite.flags |= entry->get("collectible")->asBool() ? SPRITE_COLLECTIBLE : 0;
+        sprite.flags |= entry->get("billboard")->asBool() ? SPRITE_BILLBOARD : 0;
+        sprite.flags |= entry->get("emissive")->asBool() ? SPRITE_EMISSIVE : 0;
+        sprite.tex = tex;
+        sprite.loc = jsonVec3(entry->get("loc"));
+        sprite.norm = jsonVec3(entry->get("norm"));
+        sprite.scale = entry->get("scale")->asFloat();
+        sprite.intensity = sprite.radius = 0;
+        sprite.pulse = pulse;
+        if (light) {
+            sprite.flags |= SPRITE_LIGHT;
+            sprite.color = jsonVec3(entry->get("color"));
+            sprite.intensity = entry->get("intense")->asFloat();
+            sprite.radius = entry->get("radius")->asFloat();
+        }
+        _sprites.push_back(sprite);
+    }
+
+    _emitters.clear();
+    std::shared_ptr<JsonValue> sounds = json->get("sounds");
+    for (size_t i = 0; sounds != nullptr && i < sounds->size(); i++) {
+        std::shared_ptr<JsonValue> entry = sounds->get(std::to_string(i));
+        if (!hasKeys(entry, {"sound", "loc", "radius"})) {
+            CULogError("Sound %zu of %s is incomplete", i, json->getString("level_id").c_str());
+            return false;
+        }
+        Emitter emitter;
+        emitter.sound = entry->getString("sound");
+        emitter.loc = jsonVec3(entry->get("loc"));
+        emitter.radius = entry->get("radius")->asFloat();
+        _emitters.push_back(emitter);
+    }
+
+    _regions.clear();
+    std::shared_ptr<JsonValue> triggers = json->get("triggers");
+    for (size_t i = 0; triggers != nullptr && i < triggers->size(); i++) {
+        std::shared_ptr<JsonValue> entry = triggers->get(std::to_string(i));
+        Region region;
+        region.type = entry->getString("type");
+        region.image = entry->getString("image");
+        region.message = entry->getString("message");
+        region.mesh = PivotMesh::MeshFromOBJ(assetPath(entry->getString("mesh")), PivotMesh::LOAD_CONTAINMENT);
+        if (region.mesh == nullptr) {
+            return false;
+        }
+        _regions.push_back(region);
+    }
+    return true;
+}
+
+/**
+ * Initializes the level from a binary level
+ *
+ * @param file  The binary level, relative to the asset directory
+ * @param json  The level JSON (to check that the binary is up to date)
+ *
+ * @return true if the binary level was read properly
+ */
+bool LevelData::initWithBinary(const std::string& file, const std::shared_ptr<JsonValue>& json) {
+    if (json == nullptr) {
+        return false;
+    }
+    std::shared_ptr<BinaryReader> reader = BinaryReader::alloc(assetPath(file));
+    if (reader == nullptr || !reader->ready(8)) {
+        return false;
+    }
+    if (reader->readUint32() != LEVEL_BINARY_MAGIC || reader->readUint32() != LEVEL_BINARY_VERSION) {
+        CULog("Binary level %s is out of date", file.c_str());
+        return false;
+    }
+
+    // Source files that cannot be read (e.g. packaged assets) are not compared
+    std::vector<Uint64> stamp = sourceStamp(json);
+    Uint32 count;
+    if (!BinaryIO::readCount(reader, count) || count != stamp.size() || !reader->ready(8 * count)) {
+        return false;
+    }
+    for (Uint32 ii = 0; ii < count; ii++) {
+        Uint64 value = reader->readUint64();
+        if (stamp[ii] != 0 && stamp[ii] != value) {
+            CULog("Binary level %s no longer matches its level files", file.c_str());
+            return false;
+        }
+    }
+
+    if (!readRenderMesh(reader)) {
+        CULogError("Binary level %s has a bad render mesh", file.c_str());
+        return false;
+    }
+
+    std::shared_ptr<PlaneSlicer> slicer = PlaneSlicer::allocWithReader(reader);
+    if (slicer == nullptr) {
+        CULogError("Binary level %s has a bad collision mesh", file.c_str());
+        return false;
+    }
+    _colMesh = std::make_shared<PivotMesh>();
+    _colMesh->setSlicer(slicer);
+
+    _regions.clear();
+    if (!BinaryIO::readCount(reader, count)) {
+        return false;
+    }
+    _regions.resize(count);
+    for (Region& region : _regions) {
+        if (!BinaryIO::readString(reader, region.type) || !BinaryIO::readString(reader, region.image) ||
+            !BinaryIO::readString(reader, region.message)) {
+            return false;
+        }
+        std::shared_ptr<RegionVolume> volume = RegionVolume::allocWithReader(reader);
+        if (volume == nullptr) {
+            CULogError("Binary level %s has a bad trigger region", file.c_str());
+            return false;
+        }
+        region.mesh = std::make_shared<PivotMesh>();
+        region.mesh->setVolume(volume);
+    }
+
+    if (!readTables(reader)) {
+        CULogError("Binary level %s has a bad sprite table", file.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the render mesh section
+ *
+ * @param reader    The stream positioned at the render mesh
+ */
+bool LevelData::readRenderMesh(const std::shared_ptr<BinaryReader>& reader) {
+    std::vector<Vec3> positions;
+    std::vector<Uint32> colors;
+    std::vector<Vec2> texcoords;
+    std::vector<Vec3> normals;
+    _renderMesh = std::make_shared<PivotMesh>();
+    if (!BinaryIO::readVec3s(reader, positions) || !BinaryIO::readUints(reader, colors) ||
+        !BinaryIO::readArray<Vec2, float>(reader, texcoords, 2) || !BinaryIO::readVec3s(reader, normals) ||
+        !BinaryIO::readUints(reader, _renderMesh->indices)) {
+        return false;
+    }
+    size_t count = positions.size();
+    if (colors.size() != count || texcoords.size() != count || normals.size() != count) {
+        return false;
+    }
+    for (Uint32 index : _renderMesh->indices) {
+        if (index >= count) {
+            return false;
+        }
+    }
+
+    _renderMesh->vertices.resize(count);
+    for (size_t ii = 0; ii < count; ii++) {
+        PivotVertex3& vert = _renderMesh->vertices[ii];
+        vert.position = positions[ii];
+        vert.color = colors[ii];
+        vert.texcoord = texcoords[ii];
+        vert.normal = normals[ii];
+    }
+    _renderMesh->buildChunks();
+    return _renderMesh->getChunks() != nullptr;
+}
+
+/**
+ * Reads the sprite, light and sound emitter tables
+ *
+ * @param reader    The stream positioned at the sprite table
+ */
+bool LevelData::readTables(const std::shared_ptr<BinaryReader>& reader) {
+    std::vector<Uint32> ids;
+    std::vector<float> values;
+    if (!BinaryIO::readUints(reader, ids) || !BinaryIO::readArray<float, float>(reader, values)) {
+        return false;
+    }
+    size_t count = ids.size() / 2;
+    if (ids.size() != count * 2 || values.size() != count * SPRITE_FLOATS) {
+        return false;
+    }
+    _sprites.resize(count);
+    for (size_t ii = 0; ii < count; ii++) {
+        Sprite& sprite = _sprites[ii];
+        const float* v = &values[ii * SPRITE_FLOATS];
+        sprite.index = ids[ii * 2];
+        sprite.flags = ids[ii * 2 + 1];
+        sprite.loc.set(v[0], v[1], v[2]);
+        sprite.norm.set(v[3], v[4], v[5]);
+        sprite.scale = v[6];
+        sprite.color.set(v[7], v[8], v[9]);
+        sprite.intensity = v[10];
+        sprite.radius = v[11];
+        sprite.pulse = v[12];
+        if (!BinaryIO::readString(reader, sprite.tex)) {
+            return false;
+        }
+    }
+
+    if (!BinaryIO::readArray<float, float>(reader, values) || values.size() % LIGHT_FLOATS != 0) {
+        return false;
+    }
+    _lights.resize(values.size() / LIGHT_FLOATS);
+    for (size_t ii = 0; ii < _lights.size(); ii++) {
+        Light& light = _lights[ii];
+        const float* v = &values[ii * LIGHT_FLOATS];
+        light.loc.set(v[0], v[1], v[2]);
+        light.color.set(v[3], v[4], v[5]);
+        light.intensity = v[6];
+        light.falloff = v[7];
+        light.pulse = v[8];
+    }
+
+    if (!BinaryIO::readArray<float, float>(reader, values) || values.size() % EMITTER_FLOATS != 0) {
+        return false;
+    }
+    _emitters.resize(values.size() / EMITTER_FLOATS);
+    for (size_t ii = 0; ii < _emitters.size(); ii++) {
+        Emitter& emitter = _emitters[ii];
+        const float* v = &values[ii * EMITTER_FLOATS];
+        emitter.loc.set(v[0], v[1], v[2]);
+        emitter.radius = v[3];
+        if (!BinaryIO::readString(reader, emitter.sound)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#pragma mark Conversion
+/**
+ * Returns the header values that tie a binary level to its sources
+ *
+ * These are content hashes of the level JSON, then of the render and
+ * collision OBJ files and then of the OBJ file of each trigger region, in
+ * order. Any edit to a source changes its hash, even one that keeps the file
+ * size. A hash of 0 means the file could not be read.
+ *
+ * @param json  The level JSON
+ */
+std::vector<Uint64> LevelData::sourceStamp(const std::shared_ptr<JsonValue>& json) {
+    std::vector<Uint64> result;
+    std::string text = json->toString(false);
+    Uint64 hash = HASH_OFFSET;
+    hashBytes(hash, reinterpret_cast<const Uint8*>(text.data()), text.size());
+    result.push_back(hash);
+    result.push_back(fileHash(json->getString("render_mesh")));
+    result.push_back(fileHash(json->getString("collision_mesh")));
+    std::shared_ptr<JsonValue> triggers = json->get("triggers");
+    for (size_t ii = 0; triggers != nullptr && ii < triggers->size(); ii++) {
+        std::shared_ptr<JsonValue> entry = triggers->get(std::to_string(ii));
+        result.push_back(entry != nullptr ? fileHash(entry->getString("mesh")) : 0);
+    }
+    return result;
+}
+
+/**
+ * Writes this level as a binary level
+ *
+ * @param file  The absolute path of the binary level
+ * @param json  The level JSON this level was loaded from
+ *
+ * @return true if the level was written
+ */
+bool LevelData::write(const std::string& file, const std::shared_ptr<JsonValue>& json) const {
+    if (_renderMesh == nullptr || _colMesh == nullptr || _colMesh->getSlicer() == nullptr) {
+        CULogError("Level for %s is missing a mesh", file.c_str());
+        return false;
+    }
+    for (const Region& region : _regions) {
+        if (region.mesh == nullptr || region.mesh->getVolume() == nullptr) {
+            CULogError("Level for %s is missing a trigger region", file.c_str());
+            return false;
+        }
+    }
+    std::shared_ptr<BinaryWriter> writer = BinaryWriter::alloc(file);
+    if (writer == nullptr) {
+        CULogError("Could not write %s", file.c_str());
+        return false;
+    }
+
+    writer->writeUint32(LEVEL_BINARY_MAGIC);
+    writer->writeUint32(LEVEL_BINARY_VERSION);
+    std::vector<Uint64> stamp = sourceStamp(json);
+    writer->writeUint32((Uint32)stamp.size());
+    for (Uint64 value : stamp) {
+        writer->writeUint64(value);
+    }
+
+    // Render mesh, one array per attribute
+    std::vector<Vec3> positions;
+    std::vector<Uint32> colors;
+    std::vector<Vec2> texcoords;
+    std::vector<Vec3> normals;
+    for (const PivotVertex3& vert : _renderMesh->vertices) {
+        positions.push_back(vert.position);
+        colors.push_back(vert.color);
+        texcoords.push_back(vert.texcoord);
+        normals.push_back(vert.normal);
+    }
+    BinaryIO::writeVec3s(writer, positions);
+    BinaryIO::writeUints(writer, colors);
+    BinaryIO::writeArray<Vec2, float>(writer, texcoords, 2);
+    BinaryIO::writeVec3s(writer, normals);
+    BinaryIO::writeUints(writer, _renderMesh->indices);
+
+    _colMesh->getSlicer()->write(writer);
+
+    writer->writeUint32((Uint32)_regions.size());
+    for (const Region& region : _regions) {
+        BinaryIO::writeString(writer, region.type);
+        BinaryIO::writeString(writer, region.image);
+        BinaryIO::writeString(writer, region.message);
+        region.mesh->getVolume()->write(writer);
+    }
+
+    std::vector<Uint32> ids;
+    std::vector<float> values;
+    for (const Sprite& sprite : _sprites) {
+        ids.push_back(sprite.index);
+        ids.push_back(sprite.flags);
+        values.insert(values.end(), { sprite.loc.x, sprite.loc.y, sprite.loc.z, sprite.norm.x, sprite.norm.y,
+            sprite.norm.z, sprite.scale, sprite.color.x, sprite.color.y, sprite.color.z, sprite.intensity,
+            sprite.radius, sprite.pulse });
+    }
+    BinaryIO::writeUints(writer, ids);
+    BinaryIO::writeArray<float, float>(writer, values);
+    for (const Sprite& sprite : _sprites) {
+        BinaryIO::writeString(writer, sprite.tex);
+    }
+
+    values.clear();
+    for (const Light& light : _lights) {
+        values.insert(values.end(), { light.loc.x, light.loc.y, light.loc.z, light.color.x, light.color.y,
+            light.color.z, light.intensity, light.falloff, light.pulse });
+    }
+    BinaryIO::writeArray<float, float>(writer, values);
+
+    values.clear();
+    for (const Emitter& emitter : _emitters) {
+        values.insert(values.end(), { emitter.loc.x, emitter.loc.y, emitter.loc.z, emitter.radius });
+    }
+    BinaryIO::writeArray<float, float>(writer, values);
+    for (const Emitter& emitter : _emitters) {
+        BinaryIO::writeString(writer, emitter.sound);
+    }
+    writer->close();
+    return true;
+}
+
+/**
+ * Returns the approximate memory used by the level in bytes
+ *
+ * @return the approximate memory used by the level in bytes
+ */
+size_t LevelData::getMemoryUsage() const {
+    size_t total = sizeof(LevelData);
+    total += _renderMesh == nullptr ? 0 : _renderMesh->getMemoryUsage();
+    total += _colMesh == nullptr ? 0 : _colMesh->getMemoryUsage();
+    total += _sprites.capacity() * sizeof(Sprite) + _lights.capacity() * sizeof(Light);
+    for (const Sprite& sprite : _sprites) {
+        total += sprite.tex.capacity();
+    }
+    total += _emitters.capacity() * sizeof(Emitter);
+    for (const Emitter& emitter : _emitters) {
+        total += emitter.sound.capacity();
+    }
+    total += _regions.capacity() * sizeof(Region);
+    for (const Region& region : _regions) {
+        total += region.type.capacity() + region.image.capacity() + region.message.capacity();
+        total += region.mesh == nullptr ? 0 : region.mesh->getMemoryUsage();
+    }
+    return total;
+}
+
+/**
+ * Converts every level listed in json/assets.json into a binary level
+ *
+ * @return the number of levels converted
+ */
+int LevelData::convertAll() {
+    std::shared_ptr<JsonReader> reader = JsonReader::alloc(assetPath("json/assets.json"));
+    std::shared_ptr<JsonValue> assets = reader == nullptr ? nullptr : reader->readJson();
+    if (assets == nullptr || !assets->has("jsons")) {
+        CULogError("Could not read the asset directory");
+        return 0;
+    }
+
+    std::string dir = assetPath(LEVEL_BINARY_DIR);
+    if (!filetool::is_dir(dir)) {
+        filetool::dir_create(dir);
+    }
+
+    int converted = 0;
+    std::shared_ptr<JsonValue> jsons = assets->get("jsons");
+    for (size_t i = 0; i < jsons->size(); i++) {
+        std::shared_ptr<JsonValue> entry = jsons->get((int)i);
+        std::shared_ptr<JsonReader> levelReader = JsonReader::alloc(assetPath(entry->asString()));
+        std::shared_ptr<JsonValue> json = levelReader == nullptr ? nullptr : levelReader->readJson();
+        if (json == nullptr || !json->has("render_mesh") || !json->has("collision_mesh")) {
+            continue;
+        }
+
+        Timestamp start;
+        std::shared_ptr<LevelData> level = LevelData::allocWithJson(json);
+        std::string file = assetPath(getBinaryPath(entry->key()));
+        if (level != nullptr && level->write(file, json)) {
+            converted++;
+            CULog("Converted %s in %llu ms (%zu KB)", entry->key().c_str(),
+                  (unsigned long long)Timestamp::ellapsedMillis(start, Timestamp()), filetool::file_size(file) / 1024);
+        }
+    }
+    return converted;
+}
@@ -0,0 +1,273 @@
+//
+//  LevelData.h
+//  Pivot
+//
+//  Everything a level needs from disk: the meshes (with their slicing and
+//  containment engines) and the sprite, light, sound and trigger tables. It can be
+//  read from the exported level JSON and OBJ files, or from a precompiled
+//  binary level that loads with a handful of bulk reads.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef LevelData_h
+#define LevelData_h
+#include <cugl/cugl.h>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+using namespace cugl;
+
+/** The first four bytes of a binary level ("PVLD") */
+#define LEVEL_BINARY_MAGIC      0x50564C44
+/** The binary level version; bump it whenever the layout changes */
+#define LEVEL_BINARY_VERSION    3
+/** The asset folder holding the binary levels */
+#define LEVEL_BINARY_DIR        "levels"
+/** The file suffix of a binary level */
+#define LEVEL_BINARY_SUFFIX     ".pvl"
+
+/**
+ * The loaded contents of a level.
+ *
+ * The binary layout is, in order: a header (magic, version, the sizes of the
+ * source OBJ files and the table sizes of the source JSON), the render mesh
+ * as separate position, color, texcoord, normal and index arrays, the
+ * collision mesh slicer, the trigger regions with their volumes, and the
+ * sprite, light and sound emitter tables as flat arrays. All values are in network order,
+ * as written by BinaryWriter.
+ *
+ * A binary level is rejected (and the caller should fall back to the JSON)
+ * if it is damaged, from another version, or no longer matches the files it
+ * was converted from.
+ */
+class LevelData {
+public:
+    /** The sprite flags */
+    enum Flags {
+        SPRITE_COLLECTIBLE  = 1,
+        SPRITE_BILLBOARD    = 2,
+        SPRITE_EMISSIVE     = 4,
+        SPRITE_LIGHT        = 8
+    };
+
+    /** A textured sprite (collectible, decoration or poster) */
+    struct Sprite {
+        /** The position of the sprite in the level JSON */
+        Uint32 index;
+        /** The sprite flags */
+        Uint32 flags;
+        /** The texture key */
+        std::string tex;
+        /** The sprite location */
+        Vec3 loc;
+        /** The sprite normal */
+        Vec3 norm;
+        /** The sprite scale */
+        float scale;
+        /** The light color (if SPRITE_LIGHT is set) */
+        Vec3 color;
+        /** The light intensity (if SPRITE_LIGHT is set) */
+        float intensity;
+        /** The light falloff (if SPRITE_LIGHT is set) */
+        float radius;
+        /** The light pulse */
+        float pulse;
+
+        /** Returns true if the given flag is set */
+        bool is(Flags flag) const { return (flags & flag) != 0; }
+    };
+
+    /** A light without a sprite */
+    struct Light {
+        Vec3 loc;
+        Vec3 color;
+        float intensity;
+        float falloff;
+        float pulse;
+    };
+
+    /** A looping sound placed in the level */
+    struct Emitter {
+        /** The sound key */
+        std::string sound;
+        /** The emitter location */
+        Vec3 loc;
+        /** The distance within which the sound plays at full volume */
+        float radius;
+    };
+
+    /** A trigger region */
+    struct Region {
+        /** The trigger type (DEATH, POPUP, MESSAGE or EXITREGION) */
+        std::string type;
+        /** The popup image */
+        std::string image;
+        /** The message text */
+        std::string message;
+        /** The region mesh (containment only) */
+        std::shared_ptr<PivotMesh> mesh;
+    };
+
+private:
+    /** The render mesh */
+    std::shared_ptr<PivotMesh> _renderMesh;
+    /** The collision mesh (slicing only) */
+    std::shared_ptr<PivotMesh> _colMesh;
+    /** The textured sprites */
+    std::vector<Sprite> _sprites;
+    /** The lights without a sprite */
+    std::vector<Light> _lights;
+    /** The sound emitters */
+    std::vector<Emitter> _emitters;
+    /** The trigger regions */
+    std::vector<Region> _regions;
+
+    /** The asset directory override (empty to use the application's) */
+    static std::string _assetDirectory;
+
+    /**
+     * Returns the header values that tie a binary level to its sources
+     *
+     * @param json  The level JSON
+     */
+    static std::vector<Uint64> sourceStamp(const std::shared_ptr<JsonValue>& json);
+
+    /**
+     * Reads the render mesh section
+     *
+     * @param reader    The stream positioned at the render mesh
+     */
+    bool readRenderMesh(const std::shared_ptr<BinaryReader>& reader);
+
+    /**
+     * Reads the sprite, light and sound emitter tables
+     *
+     * @param reader    The stream positioned at the sprite table
+     */
+    bool readTables(const std::shared_ptr<BinaryReader>& reader);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates empty level data. You must call an init method before using it.
+     */
+    LevelData() {}
+
+    /**
+     * Initializes the level from the exported JSON and OBJ files
+     *
+     * @param json  The level JSON
+     *
+     * @return true if the level was loaded properly
+     */
+    bool initWithJson(const std::shared_ptr<JsonValue>& json);
+
+    /**
+     * Initializes the level from a binary level
+     *
+     * @param file  The binary level, relative to the asset directory
+     * @param json  The level JSON (to check that the binary is up to date)
+     *
+     * @return true if the binary level was read properly
+     */
+    bool initWithBinary(const std::string& file, const std::shared_ptr<JsonValue>& json);
+
+    /**
+     * Returns a level loaded from the exported JSON and OBJ files
+     *
+     * @param json  The level JSON
+     *
+     * @return a level loaded from the exported files (or nullptr on failure)
+     */
+    static std::shared_ptr<LevelData> allocWithJson(const std::shared_ptr<JsonValue>& json) {
+        std::shared_ptr<LevelData> result = std::make_shared<LevelData>();
+        return (result->initWithJson(json) ? result : nullptr);
+    }
+
+    /**
+     * Returns a level read from a binary level
+     *
+     * @param file  The binary level, relative to the asset directory
+     * @param json  The level JSON (to check that the binary is up to date)
+     *
+     * @return a level read from the binary (or nullptr on failure)
+     */
+    static std::shared_ptr<LevelData> allocWithBinary(const std::string& file, const std::shared_ptr<JsonValue>& json) {
+        std::shared_ptr<LevelData> result = std::make_shared<LevelData>();
+        return (result->initWithBinary(file, json) ? result : nullptr);
+    }
+
+#pragma mark Conversion
+    /**
+     * Writes this level as a binary level
+     *
+     * @param file  The absolute path of the binary level
+     * @param json  The level JSON this level was loaded from
+     *
+     * @return true if the level was written
+     */
+    bool write(const std::string& file, const std::shared_ptr<JsonValue>& json) const;
+
+    /**
+     * Returns the binary level path for a level, relative to the asset directory
+     *
+     * @param level The level key (as in assets.json)
+     */
+    static std::string getBinaryPath(const std::string& level) {
+        return std::string(LEVEL_BINARY_DIR) + "/" + level + LEVEL_BINARY_SUFFIX;
+    }
+
+    /**
+     * Converts every level listed in json/assets.json into a binary level
+     *
+     * The binary levels are written to the LEVEL_BINARY_DIR folder of the
+     * asset directory. This must be rerun whenever a level is exported again;
+     * until then that level falls back to the JSON.
+     *
+     * @return the number of levels converted
+     */
+    static int convertAll();
+
+    /**
+     * Sets the directory that level files are read from
+     *
+     * By default this is the asset directory of the running application.
+     * Tools that run without an application (such as the headless simulation)
+     * must set it before loading a level. Setting it to the empty string
+     * restores the default.
+     *
+     * @param dir   The asset directory, ending in a path separator
+     */
+    static void setAssetDirectory(const std::string& dir) { _assetDirectory = dir; }
+
+    /** Returns the directory that level files are read from */
+    static std::string getAssetDirectory() {
+        return _assetDirectory.empty() ? Application::get()->getAssetDirectory() : _assetDirectory;
+    }
+
+#pragma mark Attributes
+    /** Returns the render mesh */
+    std::shared_ptr<PivotMesh> getRenderMesh() const { return _renderMesh; }
+
+    /** Returns the collision mesh */
+    std::shared_ptr<PivotMesh> getColMesh() const { return _colMesh; }
+
+    /** Returns the textured sprites, in level order */
+    const std::vector<Sprite>& getSprites() const { return _sprites; }
+
+    /** Returns the lights without a sprite, in level order */
+    const std::vector<Light>& getLights() const { return _lights; }
+
+    /** Returns the sound emitters, in level order */
+    const std::vector<Emitter>& getEmitters() const { return _emitters; }
+
+    /** Returns the trigger regions, in level order */
+    const std::vector<Region>& getRegions() const { return _regions; }
+
+    /** Returns the approximate memory used by the level in bytes */
+    size_t getMemoryUsage() const;
+};
+
+#endif /* LevelData_h */
@@ -0,0 +1,145 @@
+//
+//  LevelLoader.cpp
+//  Pivot
+//
+//  Runs the stages of loading a level in order, some on a worker thread and
+//  the rest on the main thread, a little every frame.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "LevelLoader.h"
+
+/**
+ * Abandons the current load and stops the worker thread
+ *
+ * This blocks until the worker stage that is running (if any) finishes.
+ */
+void LevelLoader::dispose() {
+    _stages.clear();
+    _job = nullptr;
+    _next = 0;
+    _waiting = false;
+    _status = IDLE;
+    // the pool joins its thread when it is deleted
+    _pool = nullptr;
+}
+
+/**
+ * Initializes the loader, starting its worker thread
+ *
+ * @return true if the loader was initialized properly
+ */
+bool LevelLoader::init() {
+    _pool = ThreadPool::alloc(1);
+    return _pool != nullptr;
+}
+
+/**
+ * Abandons the current load and starts a new one with no stages
+ *
+ * @param name  The name of the load, for the log
+ */
+void LevelLoader::start(const std::string& name) {
+    // a worker stage of the old load may still be running; it keeps the old job
+    _job = std::make_shared<Job>();
+    _stages.clear();
+    _next = 0;
+    _waiting = false;
+    _name = name;
+    _status = LOADING;
+    _start.mark();
+}
+
+/**
+ * Moves past the current stage
+ *
+ * @param success   Whether the stage succeeded
+ * @param millis    The time the stage took, in milliseconds
+ */
+void LevelLoader::finishStage(bool success, Uint64 millis) {
+    const Stage& stage = _stages[_next];
+    if (!success) {
+        CULogError("Loading %s failed at the %s stage", _name.c_str(), stage.name.c_str());
+        _status = FAILED;
+        return;
+    }
+
+    CULog("Loaded the %s of %s in %llu ms (%s)", stage.name.c_str(), _name.c_str(),
+          (unsigned long long)millis, stage.worker ? "worker" : "main");
+    _next++;
+    if (_next == _stages.size()) {
+        _status = DONE;
+        CULog("Loaded %s in %llu ms", _name.c_str(),
+              (unsigned long long)Timestamp::ellapsedMillis(_start, Timestamp()));
+    }
+}
+
+/**
+ * Runs the load for one frame
+ *
+ * @return the state of the load after this frame
+ */
+LevelLoader::Status LevelLoader::update() {
+    if (_status != LOADING) {
+        return _status;
+    }
+    if (_next == _stages.size()) {
+        _status = DONE;
+        return _status;
+    }
+
+    // pick up the worker stage once it finishes
+    if (_waiting) {
+        if (!_job->finished) {
+            return _status;
+        }
+        _waiting = false;
+        finishStage(_job->success, _job->millis);
+        if (_status != LOADING) {
+            return _status;
+        }
+    }
+
+    const Stage& stage = _stages[_next];
+    if (stage.worker) {
+        auto job = _job;
+        auto work = stage.work;
+        job->finished = false;
+        _waiting = true;
+        _pool->addTask([=]() {
+            Timestamp start;
+            job->success = work();
+            job->millis = Timestamp::ellapsedMillis(start, Timestamp());
+            job->finished = true;
+        });
+    } else {
+        Timestamp start;
+        bool success = stage.work();
+        finishStage(success, Timestamp::ellapsedMillis(start, Timestamp()));
+    }
+    return _status;
+}
+
+/**
+ * Returns the fraction of the current load that is done
+ *
+ * @return the fraction of the current load that is done
+ */
+float LevelLoader::getProgress() const {
+    if (_status == IDLE) {
+        return 0.0f;
+    } else if (_status != LOADING) {
+        return 1.0f;
+    }
+
+    float total = 0;
+    float done = 0;
+    for (size_t i = 0; i < _stages.size(); i++) {
+        total += _stages[i].weight;
+        if (i < _next) {
+            done += _stages[i].weight;
+        }
+    }
+    return total > 0 ? done / total : 0.0f;
+}
@@ -0,0 +1,209 @@
+//
+//  LevelLoader.h
+//  Pivot
+//
+//  Runs the stages of loading a level in order, some on a worker thread and
+//  the rest on the main thread, a little every frame, so that the game keeps
+//  drawing while a level loads.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef LevelLoader_h
+#define LevelLoader_h
+#include <cugl/cugl.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace cugl;
+
+/**
+ * A staged, asynchronous loader.
+ *
+ * A load is a list of stages that run in the order they were added. A worker
+ * stage runs on the background thread of the loader, and must not touch
+ * anything the main thread uses until the load is done; it should only fill
+ * in state that the later stages pick up. A main stage runs on the main
+ * thread during update, at most one per frame, so each of them should fit in
+ * a frame (the GL uploads and the scene setup). A stage fails the whole load
+ * by returning false.
+ *
+ * Starting a new load abandons the current one. A worker stage that is still
+ * running cannot be interrupted, but it finishes on its own and its result is
+ * ignored, so the stages of a load should only write to state that belongs to
+ * that load.
+ */
+class LevelLoader {
+public:
+    /** The state of the current load */
+    enum Status {
+        /** Nothing has been loaded yet */
+        IDLE,
+        /** The load has stages left to run */
+        LOADING,
+        /** Every stage has run */
+        DONE,
+        /** A stage failed, and the rest were skipped */
+        FAILED
+    };
+
+    /** The work of a stage; it returns false if the load failed */
+    typedef std::function<bool()> Work;
+
+private:
+    /** A single step of a load */
+    struct Stage {
+        /** The stage name, for the log */
+        std::string name;
+        /** The share of the progress bar this stage fills */
+        float weight;
+        /** Whether this stage runs on the worker thread */
+        bool worker;
+        /** The work of this stage */
+        Work work;
+    };
+
+    /**
+     * The state shared with the worker.
+     *
+     * Every load has its own, so a worker stage of an abandoned load can
+     * never report to the load that replaced it.
+     */
+    struct Job {
+        /** Whether the worker stage has finished (set last, once the rest is written) */
+        std::atomic<bool> finished;
+        /** Whether the worker stage succeeded */
+        std::atomic<bool> success;
+        /** The time the worker stage took, in milliseconds */
+        std::atomic<Uint64> millis;
+
+        Job() : finished(false), success(false), millis(0) {}
+    };
+
+    /** The (single thread) pool that runs the worker stages */
+    std::shared_ptr<ThreadPool> _pool;
+    /** The state shared with the worker for the current load */
+    std::shared_ptr<Job> _job;
+    /** The stages of the current load */
+    std::vector<Stage> _stages;
+    /** The next stage to run (or the worker stage that is running) */
+    size_t _next;
+    /** Whether the stage at _next has been handed to the worker */
+    bool _waiting;
+    /** The name of the current load, for the log */
+    std::string _name;
+    /** The state of the current load */
+    Status _status;
+    /** The time the current load started */
+    Timestamp _start;
+
+    /**
+     * Moves past the current stage
+     *
+     * @param success   Whether the stage succeeded
+     * @param millis    The time the stage took, in milliseconds
+     */
+    void finishStage(bool success, Uint64 millis);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an idle loader. You must call init before using it.
+     */
+    LevelLoader() : _next(0), _waiting(false), _status(IDLE) {}
+
+    /**
+     * Deletes this loader, waiting for the worker to finish
+     */
+    ~LevelLoader() { dispose(); }
+
+    /**
+     * Abandons the current load and stops the worker thread
+     *
+     * This blocks until the worker stage that is running (if any) finishes.
+     */
+    void dispose();
+
+    /**
+     * Initializes the loader, starting its worker thread
+     *
+     * @return true if the loader was initialized properly
+     */
+    bool init();
+
+    /**
+     * Returns a newly allocated loader
+     *
+     * @return a newly allocated loader
+     */
+    static std::shared_ptr<LevelLoader> alloc() {
+        std::shared_ptr<LevelLoader> result = std::make_shared<LevelLoader>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark Loading
+    /**
+     * Abandons the current load and starts a new one with no stages
+     *
+     * The stages are added with addWorkerStage and addMainStage, and start
+     * running at the next update.
+     *
+     * @param name  The name of the load, for the log
+     */
+    void start(const std::string& name);
+
+    /**
+     * Adds a stage that runs on the worker thread
+     *
+     * @param name      The stage name, for the log
+     * @param weight    The share of the progress bar this stage fills
+     * @param work      The work of the stage
+     */
+    void addWorkerStage(const std::string& name, float weight, const Work& work) {
+        _stages.push_back({name, weight, true, work});
+    }
+
+    /**
+     * Adds a stage that runs on the main thread
+     *
+     * @param name      The stage name, for the log
+     * @param weight    The share of the progress bar this stage fills
+     * @param work      The work of the stage
+     */
+    void addMainStage(const std::string& name, float weight, const Work& work) {
+        _stages.push_back({name, weight, false, work});
+    }
+
+    /**
+     * Runs the load for one frame
+     *
+     * This picks up the worker stage if it has finished, and then either
+     * hands the next worker stage to the worker or runs the next main stage.
+     * It never waits for the worker.
+     *
+     * @return the state of the load after this frame
+     */
+    Status update();
+
+    /** Returns the name of the current load */
+    const std::string& getName() const { return _name; }
+
+    /** Returns the state of the current load */
+    Status getStatus() const { return _status; }
+
+    /** Returns true if the current load has stages left to run */
+    bool isLoading() const { return _status == LOADING; }
+
+    /**
+     * Returns the fraction of the current load that is done
+     *
+     * This is the weight of the finished stages over the total weight, so it
+     * only moves when a stage finishes. It is 1 when the load is done or has
+     * failed, and 0 when nothing has been loaded.
+     */
+    float getProgress() const;
+};
+
+#endif /* LevelLoader_h */
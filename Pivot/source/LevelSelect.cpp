@@ -249,6 +249,23 @@ std::string LevelSelect::getNextLevelString(){
     return toLevelString(_choice, packToString(_pack));
 }
 
+std::string LevelSelect::peekNextLevelString(){
+    if (_choice < Choice::LEVEL1 || _choice > Choice::LEVEL4 || isLast()){
+        return "";
+    } else if (_choice == inPackNum(_pack) - 1){ // the next level starts the next pack
+        return toLevelString(Choice::LEVEL1, packToString(static_cast<LevelSelect::Pack>(_pack + 1)));
+    }
+    return toLevelString(_choice + 1, packToString(_pack));
+}
+
+std::string LevelSelect::getLikelyLevelString(){
+    int last = std::min(_maxLevel, prePackNum(_pack) + inPackNum(_pack) - 1);
+    if (last < prePackNum(_pack)){
+        return "";
+    }
+    return toLevelString(last - prePackNum(_pack), packToString(_pack));
+}
+
 void LevelSelect::nextLevel(){
     if( _choice == inPackNum(_pack) - 1){ // reached the end of the pack
         _choice = Choice::LEVEL1;
@@ -184,6 +184,21 @@ public:
      * Returns a level name string that is the first level in the current pack and sets to that level
      */
     std::string getFirstInPackString();
+
+    /**
+     * Returns the name of the level after the selected one, without selecting it
+     *
+     * Returns the empty string if no level is selected or the selected level is the last one.
+     */
+    std::string peekNextLevelString();
+
+    /**
+     * Returns the name of the level the player is most likely to pick on this page
+     *
+     * This is the highest unlocked level in the current pack, or the empty string if the
+     * whole pack is locked.
+     */
+    std::string getLikelyLevelString();
     
     /**
      * Updates the choice and pack to the next level
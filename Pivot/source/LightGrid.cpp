@@ -0,0 +1,188 @@
+//
+//  LightGrid.cpp
+//  Pivot
+//
+//  Screen space light culling.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "LightGrid.h"
+#include <algorithm>
+
+/**
+ * Initializes an empty grid for the given screen
+ *
+ * @param screen    The size of the screen in pixels
+ * @param tileSize  The width and height of a tile in pixels
+ *
+ * @return true if the grid was initialized properly
+ */
+bool LightGrid::init(const Size& screen, int tileSize) {
+    if (tileSize <= 0 || screen.width <= 0 || screen.height <= 0) {
+        CULogError("Light grid needs a positive screen and tile size");
+        return false;
+    }
+    _screen = screen;
+    _tileSize = tileSize;
+    _cols = (int)std::ceil(screen.width / tileSize);
+    _rows = (int)std::ceil(screen.height / tileSize);
+    _counts.assign(_cols * _rows, 0);
+    clear();
+    return true;
+}
+
+/**
+ * Removes all lights from the grid
+ */
+void LightGrid::clear() {
+    _positions.clear();
+    _radii.clear();
+    _lightTexels.clear();
+    _tileTexels.clear();
+    _indexCount = 0;
+    _dropped = 0;
+}
+
+/**
+ * Adds a light to the grid
+ *
+ * If the grid is full, the light replaces the dimmest light in the grid
+ * instead, provided that it is brighter. The radius grows with the peak
+ * power, so it doubles as the brightness.
+ *
+ * @param pos       The light position
+ * @param color     The light color
+ * @param strength  The light power (including any pulsing)
+ *
+ * @return false if the light is too dim to matter or the grid is full of brighter lights
+ */
+bool LightGrid::addLight(const Vec3& pos, const Vec3& color, float strength) {
+    float radius = radiusFor(std::max({ color.x, color.y, color.z }) * strength);
+    if (radius <= 0) {
+        return false;
+    }
+    float texels[8] = { pos.x, pos.y, pos.z, 0,
+        color.x * strength, color.y * strength, color.z * strength, 0 };
+    if (_positions.size() < LIGHT_MAX) {
+        _positions.push_back(pos);
+        _radii.push_back(radius);
+        _lightTexels.insert(_lightTexels.end(), texels, texels + 8);
+        return true;
+    }
+
+    // Full, so one light is lost either way
+    _dropped++;
+    size_t dimmest = std::min_element(_radii.begin(), _radii.end()) - _radii.begin();
+    if (_radii[dimmest] >= radius) {
+        return false;
+    }
+    _positions[dimmest] = pos;
+    _radii[dimmest] = radius;
+    std::copy(texels, texels + 8, _lightTexels.begin() + dimmest * 8);
+    return true;
+}
+
+/**
+ * Returns the radius of influence of a light with the given peak power
+ *
+ * The brightest a pixel can get from the light is
+ * power * LIGHT_POWER_MULT / (LIGHT_CONST_ATTEN + d^2), so this solves for the
+ * distance d where that drops to LIGHT_CUTOFF.
+ *
+ * @param power     The brightest color component times the strength
+ */
+float LightGrid::radiusFor(float power) {
+    float sq = power * LIGHT_POWER_MULT / LIGHT_CUTOFF - LIGHT_CONST_ATTEN;
+    return sq > 0 ? std::sqrt(sq) : 0;
+}
+
+/**
+ * Bins the lights into the tiles and packs the texels
+ *
+ * @param combined  The combined camera matrix
+ * @param right     The camera right vector
+ * @param up        The camera up vector
+ */
+void LightGrid::bin(const Mat4& combined, const Vec3& right, const Vec3& up) {
+    size_t tiles = _counts.size();
+    std::fill(_counts.begin(), _counts.end(), 0);
+    if (_dropped > 0 && !_warned) {
+        CULogError("Light grid is full: dropped the %zu dimmest lights (the limit is %d)", _dropped, LIGHT_MAX);
+        _warned = true;
+    }
+
+    // First pass: the tile span of each light
+    _spans.resize(_positions.size() * 4);
+    for (size_t ii = 0; ii < _positions.size(); ii++) {
+        Vec4 center(_positions[ii], 1);
+        Vec4 dx(right * _radii[ii], 0);
+        Vec4 dy(up * _radii[ii], 0);
+        center *= combined;
+        dx *= combined;
+        dy *= combined;
+
+        // Screen space bounding box of the projected sphere
+        float hx = (std::abs(dx.x) + std::abs(dy.x)) / center.w;
+        float hy = (std::abs(dx.y) + std::abs(dy.y)) / center.w;
+        float cx = center.x / center.w;
+        float cy = center.y / center.w;
+        float x0 = (cx - hx + 1) / 2 * _screen.width;
+        float x1 = (cx + hx + 1) / 2 * _screen.width;
+        float y0 = (cy - hy + 1) / 2 * _screen.height;
+        float y1 = (cy + hy + 1) / 2 * _screen.height;
+
+        int* span = &_spans[ii * 4];
+        if (x1 < 0 || y1 < 0 || x0 >= _screen.width || y0 >= _screen.height) {
+            span[0] = span[1] = span[2] = span[3] = -1;
+            continue;
+        }
+        span[0] = std::max(0, (int)(x0 / _tileSize));
+        span[1] = std::min(_cols - 1, (int)(x1 / _tileSize));
+        span[2] = std::max(0, (int)(y0 / _tileSize));
+        span[3] = std::min(_rows - 1, (int)(y1 / _tileSize));
+        for (int row = span[2]; row <= span[3]; row++) {
+            for (int col = span[0]; col <= span[1]; col++) {
+                _counts[row * _cols + col]++;
+            }
+        }
+    }
+
+    // Headers (the offsets are running sums of the counts)
+    _indexCount = 0;
+    for (Uint32 count : _counts) {
+        _indexCount += count;
+    }
+    size_t texels = tiles + (_indexCount + 3) / 4;
+    texels = (texels + LIGHT_TEX_WIDTH - 1) / LIGHT_TEX_WIDTH * LIGHT_TEX_WIDTH;
+    _tileTexels.assign(texels * 4, 0);
+    Uint32 offset = 0;
+    for (size_t tile = 0; tile < tiles; tile++) {
+        _tileTexels[tile * 4] = (float)offset;
+        _tileTexels[tile * 4 + 1] = (float)_counts[tile];
+        offset += _counts[tile];
+    }
+
+    // Second pass: write the indices
+    _cursors.resize(tiles);
+    for (size_t tile = 0; tile < tiles; tile++) {
+        _cursors[tile] = (Uint32)_tileTexels[tile * 4];
+    }
+    float* indices = _tileTexels.data() + tiles * 4;
+    for (size_t ii = 0; ii < _positions.size(); ii++) {
+        const int* span = &_spans[ii * 4];
+        for (int row = span[2]; span[0] >= 0 && row <= span[3]; row++) {
+            for (int col = span[0]; col <= span[1]; col++) {
+                indices[_cursors[row * _cols + col]++] = (float)ii;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the number of texel rows needed for the largest possible grid
+ */
+int LightGrid::getTileTexRows() const {
+    size_t texels = _counts.size() + (_counts.size() * LIGHT_MAX + 3) / 4;
+    return (int)((texels + LIGHT_TEX_WIDTH - 1) / LIGHT_TEX_WIDTH);
+}
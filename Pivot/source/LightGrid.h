@@ -0,0 +1,185 @@
+//
+//  LightGrid.h
+//  Pivot
+//
+//  Screen space light culling. The screen is split into tiles, and every point
+//  light is binned into the tiles its radius of influence covers, so that the
+//  lighting pass only has to loop over the lights that can reach a pixel.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef LightGrid_h
+#define LightGrid_h
+#include <cugl/cugl.h>
+#include <vector>
+
+using namespace cugl;
+
+/** The width and height of a light tile in pixels */
+#define LIGHT_TILE_SIZE     64
+/** The maximum number of lights in the grid (only the brightest are kept) */
+#define LIGHT_MAX           256
+/** Contributions below this (one 8-bit color step) are culled */
+#define LIGHT_CUTOFF        (1.0f / 255.0f)
+/** The light power multiplier (must match powerMult in pointlight.frag) */
+#define LIGHT_POWER_MULT    10000.0f
+/** The constant attenuation (must match constAtten in pointlight.frag) */
+#define LIGHT_CONST_ATTEN   2000.0f
+/** The width of the tile texture in texels */
+#define LIGHT_TEX_WIDTH     256
+
+/**
+ * A screen space grid of per-tile light lists.
+ *
+ * The lights are attenuated by the inverse square of the distance, so they
+ * never quite reach zero. The radius of a light is where its brightest
+ * possible contribution drops below LIGHT_CUTOFF. As the camera is
+ * orthographic, the distance in the screen plane is never more than the world
+ * distance, so binning by the projected radius is conservative.
+ *
+ * The light texture holds at most LIGHT_MAX lights. Once the grid is full, a
+ * new light replaces the dimmest one if it is brighter, so the lights that are
+ * lost are the ones that matter least. The first frame that loses any lights
+ * logs an error.
+ *
+ * The grid is packed into two float (RGBA) texel arrays for the lighting
+ * shader. The light texels hold two texels per light: (position, 0) and
+ * (color * strength, 0). The tile texels start with one header texel per tile,
+ * (offset, count, 0, 0), followed by the light indices, four per texel. The
+ * tile texels are padded to whole rows of LIGHT_TEX_WIDTH texels.
+ *
+ * This class does not touch OpenGL, so the binning can run without a context.
+ */
+class LightGrid {
+private:
+    /** The size of the screen in pixels */
+    Size _screen;
+    /** The size of a tile in pixels */
+    int _tileSize;
+    /** The number of tile columns */
+    int _cols;
+    /** The number of tile rows */
+    int _rows;
+
+    /** The positions of the lights */
+    std::vector<Vec3> _positions;
+    /** The radius of influence of each light */
+    std::vector<float> _radii;
+    /** The light texels, two per light */
+    std::vector<float> _lightTexels;
+    /** The tile texels, a header per tile and then the light indices */
+    std::vector<float> _tileTexels;
+    /** The number of light indices in the tile texels */
+    size_t _indexCount;
+    /** The number of lights lost since the last clear, because the grid was full */
+    size_t _dropped;
+    /** Whether the grid has logged that it was full */
+    bool _warned;
+
+    /** The tile range covered by each light (for the second binning pass) */
+    std::vector<int> _spans;
+    /** The number of lights in each tile */
+    std::vector<Uint32> _counts;
+    /** The next free index of each tile (for the second binning pass) */
+    std::vector<Uint32> _cursors;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty grid. You must call init before using it.
+     */
+    LightGrid() : _tileSize(0), _cols(0), _rows(0), _indexCount(0), _dropped(0), _warned(false) {}
+
+    /**
+     * Initializes an empty grid for the given screen
+     *
+     * @param screen    The size of the screen in pixels
+     * @param tileSize  The width and height of a tile in pixels
+     *
+     * @return true if the grid was initialized properly
+     */
+    bool init(const Size& screen, int tileSize = LIGHT_TILE_SIZE);
+
+    /**
+     * Returns a newly allocated grid for the given screen
+     *
+     * @param screen    The size of the screen in pixels
+     * @param tileSize  The width and height of a tile in pixels
+     *
+     * @return a newly allocated grid for the given screen
+     */
+    static std::shared_ptr<LightGrid> alloc(const Size& screen, int tileSize = LIGHT_TILE_SIZE) {
+        std::shared_ptr<LightGrid> result = std::make_shared<LightGrid>();
+        return (result->init(screen, tileSize) ? result : nullptr);
+    }
+
+#pragma mark Binning
+    /**
+     * Removes all lights from the grid
+     */
+    void clear();
+
+    /**
+     * Adds a light to the grid
+     *
+     * If the grid is full, the light replaces the dimmest light in the grid
+     * instead, provided that it is brighter.
+     *
+     * @param pos       The light position
+     * @param color     The light color
+     * @param strength  The light power (including any pulsing)
+     *
+     * @return false if the light is too dim to matter or the grid is full of brighter lights
+     */
+    bool addLight(const Vec3& pos, const Vec3& color, float strength);
+
+    /**
+     * Bins the lights into the tiles and packs the texels
+     *
+     * @param combined  The combined camera matrix
+     * @param right     The camera right vector
+     * @param up        The camera up vector
+     */
+    void bin(const Mat4& combined, const Vec3& right, const Vec3& up);
+
+    /**
+     * Returns the radius of influence of a light with the given peak power
+     *
+     * @param power     The brightest color component times the strength
+     */
+    static float radiusFor(float power);
+
+#pragma mark Attributes
+    /** Returns the number of tile columns */
+    int getCols() const { return _cols; }
+
+    /** Returns the number of tile rows */
+    int getRows() const { return _rows; }
+
+    /** Returns the size of a tile in pixels */
+    int getTileSize() const { return _tileSize; }
+
+    /** Returns the number of lights in the grid */
+    size_t getLightCount() const { return _positions.size(); }
+
+    /** Returns the number of lights lost since the last clear, because the grid was full */
+    size_t getDroppedCount() const { return _dropped; }
+
+    /** Returns the number of lights in the given tile (after binning) */
+    Uint32 getTileCount(int col, int row) const { return _counts[row * _cols + col]; }
+
+    /** Returns the total number of tile entries (after binning) */
+    size_t getIndexCount() const { return _indexCount; }
+
+    /** Returns the light texels (RGBA floats, two texels per light) */
+    const std::vector<float>& getLightTexels() const { return _lightTexels; }
+
+    /** Returns the tile texels (RGBA floats, headers then indices, padded to whole rows) */
+    const std::vector<float>& getTileTexels() const { return _tileTexels; }
+
+    /** Returns the number of texel rows needed for the largest possible grid */
+    int getTileTexRows() const;
+};
+
+#endif /* LightGrid_h */
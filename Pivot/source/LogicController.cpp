@@ -0,0 +1,317 @@
+//
+//  LogicController.cpp
+//  Pivot
+//
+//  The rules of play that GameplayController and the headless Simulation
+//  share.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "LogicController.h"
+
+#pragma mark Constructors
+/**
+ * Releases the model, plane and physics world of this controller
+ */
+void LogicController::dispose() {
+    _model = nullptr;
+    _plane = nullptr;
+    _physics = nullptr;
+    _debugScene = nullptr;
+    _rotating = false;
+}
+
+/**
+ * Initializes the controller on the given model, plane and physics world
+ *
+ * The player must already be in the model.
+ *
+ * @param model     The gameplay state
+ * @param plane     The plane and its cuts
+ * @param physics   The physics world
+ *
+ * @return true if the controller was initialized properly
+ */
+bool LogicController::init(const std::shared_ptr<GameModel>& model, const std::shared_ptr<PlaneController>& plane,
+                           const std::shared_ptr<PhysicsController>& physics) {
+    if (model == nullptr || model->_player == nullptr || plane == nullptr || physics == nullptr) {
+        return false;
+    }
+    _model = model;
+    _plane = plane;
+    _physics = physics;
+    _rotating = false;
+    reset();
+    return true;
+}
+
+/**
+ * Starts the player over from where it is now
+ *
+ * This is where the player respawns, and where the 3D location is
+ * measured from. Call it once the player is placed in a new level.
+ */
+void LogicController::reset() {
+    _prevPos = _model->_player->getPosition();
+    _safePos = _prevPos;
+}
+
+#pragma mark Player
+/**
+ * Counts another frame if the player is hanging in the air
+ *
+ * This runs every frame, even before the level is playing.
+ */
+void LogicController::trackStuck() {
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    if (player->getVY() > -5.0f && player->getVY() < 5.0f && !player->isGrounded()) {
+        player->timeStuckAtZeroYvelocity++;
+    }
+}
+
+/**
+ * Returns the player to safety if it died
+ *
+ * @return true if the player died
+ */
+bool LogicController::respawnIfDead() {
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    if (!player->isDead()) {
+        return false;
+    }
+    player->setPosition(_safePos);
+    player->setDead(false);
+    return true;
+}
+
+/**
+ * Returns the player to safety if it hung in the air too long
+ *
+ * @return true if the player was stuck
+ */
+bool LogicController::respawnIfStuck() {
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    if (player->timeStuckAtZeroYvelocity <= STUCK_FRAMES) {
+        return false;
+    }
+    player->setPosition(_safePos);
+    player->timeStuckAtZeroYvelocity = 0;
+    return true;
+}
+
+/**
+ * Sets the player input for the coming physics steps
+ *
+ * A jump waits for the next step to take it, so it is never lost on a
+ * frame with no steps and never applied twice.
+ *
+ * @param horizontal    The horizontal input (-1 to 1)
+ * @param jump          Whether the player pressed jump this frame
+ * @param run           Whether the player is running
+ * @param physics       Whether the physics runs this frame
+ */
+void LogicController::setInput(float horizontal, bool jump, bool run, bool physics) {
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    player->setMovement(horizontal * player->getForce());
+    player->setJumping(physics && (player->isJumping() || jump));
+    player->setRunning(run);
+}
+
+/**
+ * Applies the player input before a physics step
+ *
+ * Box2D clears the forces after every step, so this must precede each.
+ */
+void LogicController::applyInput() {
+    _model->_player->applyForce();
+    // the jump has been applied
+    _model->_player->setJumping(false);
+}
+
+/**
+ * Moves the player in 3D by the distance it moved in the plane
+ *
+ * Call this after every physics step.
+ */
+void LogicController::updatePlayer3DLoc() {
+    Vec2 pos = _model->_player->getPosition();
+    _model->setPlayer3DLoc(_model->getPlayer3DLoc() + getDisplacement3D(pos - _prevPos));
+    _prevPos = pos;
+}
+
+/**
+ * Returns the 3D displacement of a 2D displacement in the plane
+ *
+ * @param displacement  The displacement in the plane
+ */
+Vec3 LogicController::getDisplacement3D(Vec2 displacement) const {
+    Vec3 right = displacement.x * _plane->getBasisRight();
+    return Vec3(right.x, right.y, displacement.y);
+}
+
+#pragma mark Plane
+/**
+ * Rotates the plane, if the player is standing
+ *
+ * The physics should pause while the plane turns. The new cut is computed
+ * in the background and taken up by finishRotation.
+ *
+ * @param angle The angle to turn the plane by (in radians)
+ *
+ * @return true if the plane turned
+ */
+bool LogicController::rotate(float angle) {
+    if (!_model->_player->isGrounded()) {
+        return false;
+    }
+    _plane->rotateNorm(angle);
+    _plane->publishCut();
+    _plane->requestCut();
+    _model->_player->isRotating = true;
+    _rotating = true;
+    return true;
+}
+
+/**
+ * Rebuilds the physics world from the new cut if a rotation just ended
+ *
+ * The player starts over at the origin of the new plane, which is moved to
+ * where the player stood.
+ *
+ * @return true if a rotation ended
+ */
+bool LogicController::finishRotation() {
+    if (!_rotating) {
+        return false;
+    }
+    _rotating = false;
+    _physics->clear();
+    _model->_player->setPosition(Vec2::ZERO);
+    _prevPos = Vec2::ZERO;
+    _physics->getWorld()->addObstacle(_model->_player);
+    _model->_player->isRotating = false;
+    _plane->movePlaneToPlayer();
+    _plane->finishCut();
+    createCutObstacles();
+    return true;
+}
+
+/**
+ * Adds the obstacle for the current cut of the model to the physics world
+ *
+ * Each contour becomes one chain fixture. The contour orientation is not
+ * reliable, so the chains collide on both sides. Their radius makes the
+ * cut CUT_WIDTH thick.
+ */
+void LogicController::createCutObstacles() {
+    std::shared_ptr<physics2::ChainObstacle> obstacle = physics2::ChainObstacle::alloc(_model->getCutPaths());
+    if (obstacle == nullptr || obstacle->getChainCount() == 0) {
+        return;
+    }
+    obstacle->setTwoSided(true);
+    obstacle->setRadius(CUT_RADIUS);
+    obstacle->setBodyType(b2_staticBody);
+    _physics->getWorld()->addObstacle(obstacle);
+    if (_debugScene != nullptr) {
+        obstacle->setDebugColor(_debugColor);
+        obstacle->setDebugScene(_debugScene);
+    }
+}
+
+#pragma mark Items
+/**
+ * Picks up the glowsticks next to the player, or places one if there are none
+ *
+ * A glowstick is placed beside the player, on the side it is facing,
+ * while the level has any left.
+ *
+ * @return what the press did
+ */
+LogicController::Glowstick LogicController::useGlowstick() {
+    Vec3 player3DLoc = _model->getPlayer3DLoc();
+    ItemStore& glowsticks = _model->_glowsticks;
+    bool pickup = false;
+    for (size_t ii = 0; ii < glowsticks.size();) {
+        if (glowsticks.getPosition(ii).distance(player3DLoc) <= PICKING_DIST) {
+            // the last glowstick moves into this index, so test it next
+            glowsticks.remove(glowsticks.getHandle(ii));
+            pickup = true;
+        } else {
+            ++ii;
+        }
+    }
+    if (pickup) {
+        return PICKED_UP;
+    }
+    if (_model->_numGlowsticks <= 0 || glowsticks.size() >= (size_t)_model->_numGlowsticks) {
+        return NONE;
+    }
+
+    Vec3 side = _plane->getBasisRight()*10;
+    Vec3 pos = _model->_player->isFacingRight() ? player3DLoc + side : player3DLoc - side;
+    int num = _model->_glowstickOrder % 4;
+    _model->addGlowstick(pos - _model->getPlaneNorm(), _model->_glowstickSprites[num], _model->_glowstickColors[num]);
+    _model->_glowstickOrder++;
+    return PLACED;
+}
+
+/**
+ * Updates the triggers near the player
+ */
+void LogicController::updateTriggers() {
+    Vec3 player3DLoc = _model->getPlayer3DLoc();
+    if (_model->_triggerIndex != nullptr) {
+        _model->_triggerIndex->update(player3DLoc);
+    } else {
+        for (auto trig : _model->_triggers) {
+            trig->update(player3DLoc);
+        }
+    }
+}
+
+/**
+ * Collects the items the player reached
+ *
+ * If the navigator pointed at a collected item, it moves on to another
+ * item, or to the exit once there are none left.
+ *
+ * @return the number of items collected
+ */
+Uint32 LogicController::collect() {
+    Vec3 player3DLoc = _model->getPlayer3DLoc();
+    ItemStore& collectibles = _model->_collectibles;
+    Uint32 count = 0;
+    for (size_t ii = 0; ii < collectibles.size(); ii++) {
+        if (collectibles.isCollected(ii) || player3DLoc.distance(collectibles.getPosition(ii)) > COLLECTING_DIST) {
+            continue;
+        }
+        collectibles.setCollected(ii, true);
+        _model->_backpack.insert(collectibles.getName(ii));
+        count++;
+        if (_model->_nav_target == collectibles.getPosition(ii)) {
+            // need a new nav target, the exit unless there are collectibles left
+            Vec3 target = _model->_exit->getPosition();
+            for (size_t jj = 0; jj < collectibles.size(); jj++) {
+                if (!collectibles.isCollected(jj)) {
+                    target = collectibles.getPosition(jj);
+                }
+            }
+            _model->_nav_target = target;
+        }
+    }
+    return count;
+}
+
+/**
+ * Ends the level if the player reached the exit with every collectible
+ *
+ * @return true if the player is at the exit with every collectible
+ */
+bool LogicController::checkExit() {
+    if (_model->getPlayer3DLoc().distance(_model->_exit->getPosition()) > EXITING_DIST || !_model->checkBackpack()) {
+        return false;
+    }
+    _model->_endOfGame = true;
+    return true;
+}
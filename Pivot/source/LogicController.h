@@ -0,0 +1,257 @@
+//
+//  LogicController.h
+//  Pivot
+//
+//  The rules of play that GameplayController and the headless Simulation
+//  share: respawning, rotating the plane and rebuilding the cut, the player
+//  input and 3D location, collecting, glowsticks and the exit. Anything that
+//  is only seen or heard (sounds, UI, sprites) is left to the caller, which
+//  learns what happened from the return values.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef LogicController_h
+#define LogicController_h
+#include <cugl/cugl.h>
+#include "GameModel.h"
+#include "PlaneController.h"
+#include "PhysicsController.h"
+
+/** The frames the player may hang in the air before being reset */
+#define STUCK_FRAMES    50
+
+/**
+ * The gameplay of a level, on a model, plane and physics world it shares
+ * with its owner.
+ *
+ * A frame runs respawnIfDead and respawnIfStuck, then rotate (or
+ * finishRotation if the player stopped rotating), useGlowstick and setInput.
+ * Each physics step is then bracketed by applyInput and updatePlayer3DLoc,
+ * after which updateTriggers, collect and checkExit see where the player
+ * ended up.
+ */
+class LogicController {
+public:
+    /** What a glowstick press did */
+    enum Glowstick {
+        /** Nothing (there were no glowsticks left to place) */
+        NONE,
+        /** Picked up the glowsticks next to the player */
+        PICKED_UP,
+        /** Placed a glowstick beside the player */
+        PLACED
+    };
+
+private:
+    /** The gameplay state */
+    std::shared_ptr<GameModel> _model;
+    /** The plane and its cuts */
+    std::shared_ptr<PlaneController> _plane;
+    /** The physics world */
+    std::shared_ptr<PhysicsController> _physics;
+    /** The scene to draw the cut obstacles in when debugging (may be null) */
+    std::shared_ptr<scene2::SceneNode> _debugScene;
+    /** The color of the cut obstacles when debugging */
+    Color4 _debugColor;
+    /** Whether the player was rotating the plane last frame */
+    bool _rotating;
+    /** The player position in the plane when the 3D location was last updated */
+    Vec2 _prevPos;
+    /** The position the player returns to on death */
+    Vec2 _safePos;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty controller. You must call init before using it.
+     */
+    LogicController() : _rotating(false) {}
+
+    /**
+     * Deletes this controller, disposing all resources
+     */
+    ~LogicController() { dispose(); }
+
+    /**
+     * Releases the model, plane and physics world of this controller
+     */
+    void dispose();
+
+    /**
+     * Initializes the controller on the given model, plane and physics world
+     *
+     * The player must already be in the model.
+     *
+     * @param model     The gameplay state
+     * @param plane     The plane and its cuts
+     * @param physics   The physics world
+     *
+     * @return true if the controller was initialized properly
+     */
+    bool init(const std::shared_ptr<GameModel>& model, const std::shared_ptr<PlaneController>& plane,
+              const std::shared_ptr<PhysicsController>& physics);
+
+    /**
+     * Returns a controller on the given model, plane and physics world
+     *
+     * @param model     The gameplay state
+     * @param plane     The plane and its cuts
+     * @param physics   The physics world
+     *
+     * @return a controller on the given model, plane and physics world (or nullptr on failure)
+     */
+    static std::shared_ptr<LogicController> alloc(const std::shared_ptr<GameModel>& model,
+                                                  const std::shared_ptr<PlaneController>& plane,
+                                                  const std::shared_ptr<PhysicsController>& physics) {
+        std::shared_ptr<LogicController> result = std::make_shared<LogicController>();
+        return (result->init(model, plane, physics) ? result : nullptr);
+    }
+
+    /**
+     * Starts the player over from where it is now
+     *
+     * This is where the player respawns, and where the 3D location is
+     * measured from. Call it once the player is placed in a new level.
+     */
+    void reset();
+
+    /**
+     * Sets the scene to draw the cut obstacles in when debugging
+     *
+     * @param scene The debug scene (or null for none)
+     * @param color The color of the cut obstacles
+     */
+    void setDebugScene(const std::shared_ptr<scene2::SceneNode>& scene, Color4 color) {
+        _debugScene = scene;
+        _debugColor = color;
+    }
+
+#pragma mark Player
+    /**
+     * Counts another frame if the player is hanging in the air
+     *
+     * This runs every frame, even before the level is playing.
+     */
+    void trackStuck();
+
+    /**
+     * Returns the player to safety if it died
+     *
+     * @return true if the player died
+     */
+    bool respawnIfDead();
+
+    /**
+     * Returns the player to safety if it hung in the air too long
+     *
+     * @return true if the player was stuck
+     */
+    bool respawnIfStuck();
+
+    /**
+     * Sets the player input for the coming physics steps
+     *
+     * A jump waits for the next step to take it, so it is never lost on a
+     * frame with no steps and never applied twice.
+     *
+     * @param horizontal    The horizontal input (-1 to 1)
+     * @param jump          Whether the player pressed jump this frame
+     * @param run           Whether the player is running
+     * @param physics       Whether the physics runs this frame
+     */
+    void setInput(float horizontal, bool jump, bool run, bool physics);
+
+    /**
+     * Applies the player input before a physics step
+     *
+     * Box2D clears the forces after every step, so this must precede each.
+     */
+    void applyInput();
+
+    /**
+     * Moves the player in 3D by the distance it moved in the plane
+     *
+     * Call this after every physics step.
+     */
+    void updatePlayer3DLoc();
+
+    /**
+     * Returns the player position in the plane the 3D location was last updated from
+     */
+    Vec2 getSyncedPosition() const { return _prevPos; }
+
+    /**
+     * Returns the 3D displacement of a 2D displacement in the plane
+     *
+     * @param displacement  The displacement in the plane
+     */
+    Vec3 getDisplacement3D(Vec2 displacement) const;
+
+#pragma mark Plane
+    /**
+     * Rotates the plane, if the player is standing
+     *
+     * The physics should pause while the plane turns. The new cut is computed
+     * in the background and taken up by finishRotation.
+     *
+     * @param angle The angle to turn the plane by (in radians)
+     *
+     * @return true if the plane turned
+     */
+    bool rotate(float angle);
+
+    /**
+     * Rebuilds the physics world from the new cut if a rotation just ended
+     *
+     * @return true if a rotation ended
+     */
+    bool finishRotation();
+
+    /** Returns true if the player is rotating the plane */
+    bool isRotating() const { return _rotating; }
+
+    /**
+     * Adds the obstacle for the current cut of the model to the physics world
+     *
+     * Each contour becomes one chain fixture. The contour orientation is not
+     * reliable, so the chains collide on both sides. Their radius makes the
+     * cut CUT_WIDTH thick.
+     */
+    void createCutObstacles();
+
+#pragma mark Items
+    /**
+     * Picks up the glowsticks next to the player, or places one if there are none
+     *
+     * A glowstick is placed beside the player, on the side it is facing,
+     * while the level has any left.
+     *
+     * @return what the press did
+     */
+    Glowstick useGlowstick();
+
+    /**
+     * Updates the triggers near the player
+     */
+    void updateTriggers();
+
+    /**
+     * Collects the items the player reached
+     *
+     * If the navigator pointed at a collected item, it moves on to another
+     * item, or to the exit once there are none left.
+     *
+     * @return the number of items collected
+     */
+    Uint32 collect();
+
+    /**
+     * Ends the level if the player reached the exit with every collectible
+     *
+     * @return true if the player is at the exit with every collectible
+     */
+    bool checkExit();
+};
+
+#endif /* LogicController_h */
@@ -9,12 +9,11 @@
 
 #include "Mesh.h"
 #include <cugl/cugl.h>
-#include <igl/per_vertex_normals.h>
 #include <igl/isolines.h>
 #include <igl/ray_mesh_intersect.h>
 
 /**Static Method To create a pivot mesh object from an .obj file path*/
-std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path) {
+std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path, LoadMode mode) {
 
     //make an empty mesh
     auto mesh = std::make_shared<PivotMesh>();
@@ -27,17 +26,20 @@ std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path) {
     auto FTC = Eigen::MatrixXi();
     auto FN = Eigen::MatrixXi();
 
-    //read obj into those matrices
-    bool success = igl::readOBJ(path, V, TC, CN, F, FTC, FN);
+    //read obj into those matrices (the engines only need the positions and faces)
+    bool render = mode == LOAD_ALL || mode == LOAD_RENDER;
+    bool success = render ? igl::readOBJ(path, V, TC, CN, F, FTC, FN) : igl::readOBJ(path, V, F);
 
-    if (success) {
+    if (!success) {
+        CULogError("The mesh %s could not be read", path.c_str());
+        return nullptr;
+    }
 
+    if (render) {
         Color4f color = { Color4f::BLACK };
 
-        //calculate vertex normals
-        auto N = Eigen::MatrixXd();
-        igl::per_vertex_normals(V, F, N);
-
+        mesh->vertices.reserve(F.rows() * F.cols());
+        mesh->indices.reserve(F.rows() * 3);
         for (int fi = 0; fi < F.rows(); fi++) {
             for (int vi = 0; vi < F.cols(); vi++) {
                 PivotVertex3 temp;
@@ -45,7 +47,6 @@ std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path) {
                 temp.position = Vec3(V(i, 0), V(i, 1), V(i, 2));
                 temp.color = color.getPacked();
                 temp.normal = Vec3(CN(FN(fi,vi),0), CN(FN(fi,vi),1), CN(FN(fi, vi),2));
-                //temp.normal = Vec3(N(i, 0), N(i, 1), N(i, 2));
                 // CULog("%f, %f, %f", temp.normal.x, temp.normal.y, temp.normal.z);
                 //temp.texcoord = Vec2(.45, .45);
                 temp.texcoord = Vec2(TC(FTC(fi,vi),0), 1-TC(FTC(fi, vi), 1));
@@ -61,47 +62,47 @@ std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path) {
             mesh->indices.push_back(fi*3 + 1);
             mesh->indices.push_back(fi*3 + 2);
         }
+    }
 
-        //// convert everything into cugl friendly types and assign it to the mesh
-        //for (int i = 0; i < V.rows(); i++) {
-        //    PivotVertex3 temp;
-        //    temp.position = Vec3(V(i, 0), V(i, 1), V(i, 2));
-        //    temp.color = color.getPacked();
-        //    temp.normal = Vec3(N(i, 0), N(i, 1), N(i, 2));
-        //    // CULog("%f, %f, %f", temp.normal.x, temp.normal.y, temp.normal.z);
-        //    temp.texcoord = Vec2(TC(i, 0), TC(i, 1));
-        //    // Below 3 lines have been added by Matt to support texture tiling (for now)
-        //    //const int numTexOneSide = 14;
-        //    //temp.texcoord.x = fmod(temp.texcoord.x * numTexOneSide, 1.0);
-        //    //temp.texcoord.y = fmod(temp.texcoord.y * numTexOneSide, 1.0);
-        //    // End what Matt has added
-        //    mesh->vertices.push_back(temp);
-        //}
-
-        /*auto test = F.rows();
-        for (int i = 0; i < F.rows(); i ++) {
-            mesh->indices.push_back(F(i,0));
-            mesh->indices.push_back(F(i,1));
-            mesh->indices.push_back(F(i,2));
-        }*/
-
-
+    if (mode == LOAD_ALL) {
         //Make the vertices list two longer to hold superverts for domain control
         //If this is confusing as Jack about it bc it is confusing
         V.conservativeResize(V.rows() + 2, V.cols()); 
         mesh->Everts = V;
         mesh->Einds = F;
-
-        CULog("Mesh was loaded successfully");
-
-        
     }
-    else { CULog("THE MESH WAS NOT LOADED PROPERLY"); }
+    else if (mode == LOAD_SLICE) {
+        mesh->_slicer = PlaneSlicer::alloc(V, F);
+        if (mesh->_slicer == nullptr) {
+            CULogError("The slicer for %s could not be built", path.c_str());
+            return nullptr;
+        }
+    }
+    else if (mode == LOAD_CONTAINMENT) {
+        mesh->_volume = RegionVolume::alloc(V, F);
+        if (mesh->_volume == nullptr) {
+            CULogError("The volume for %s could not be built", path.c_str());
+            return nullptr;
+        }
+    }
 
+    CULog("Mesh was loaded successfully");
     return mesh;
 
 }
 
+/**Get the approximate memory held by this mesh in bytes (including the engines)*/
+size_t PivotMesh::getMemoryUsage() const {
+    size_t total = sizeof(PivotMesh);
+    total += vertices.capacity() * sizeof(PivotVertex3);
+    total += indices.capacity() * sizeof(Uint32);
+    total += Everts.size() * sizeof(double) + Einds.size() * sizeof(int);
+    if (_slicer != nullptr) { total += _slicer->getMemoryUsage(); }
+    if (_volume != nullptr) { total += _volume->getMemoryUsage(); }
+    if (_chunks != nullptr) { total += _chunks->getMemoryUsage(); }
+    return total;
+}
+
 /**Slice the mesh with a plane
     *
     * @param origin the origin of the plane
@@ -111,6 +112,9 @@ std::shared_ptr<PivotMesh> PivotMesh::MeshFromOBJ(std::string path) {
 
 std::tuple<Eigen::MatrixXd, Eigen::MatrixXi> PivotMesh::intersectPlane(Vec3 origin, Vec3 normal) {
 
+    //meshes loaded for a single engine do not keep the matrices
+    if (Everts.rows() < 2) { return std::tuple<Eigen::MatrixXd, Eigen::MatrixXi>(); }
+
     //add super verts at the end to recenter the cut to the plane
     //if the min and max values are sysmetrical around the plane the isocut will be on the plane
     //this is a genius hack!!!
@@ -152,12 +156,72 @@ std::tuple<Eigen::MatrixXd, Eigen::MatrixXi> PivotMesh::intersectPlane(Vec3 orig
     //return std::vector<Path2>{Path2(std::vector<Vec2>{Vec2(-1.5, -1.5), Vec2(1.5, -1.5), Vec2(1.5, 1.5), Vec2(-1.5, 1.5)})};
 }
 
+/**Build the slicing engine for this mesh*/
+bool PivotMesh::buildSlicer() {
+    //leave off the two superverts at the end, they are only for intersectPlane
+    if (Everts.rows() > 2) {
+        _slicer = PlaneSlicer::alloc(Everts.topRows(Everts.rows() - 2), Einds);
+    }
+    if (_slicer == nullptr) {
+        CULogError("The slicer could not be built");
+        return false;
+    }
+    return true;
+}
+
+/**Slice the mesh with a plane using the prebuilt slicing engine
+    *
+    * @param origin the origin of the plane
+    * @param normal the normal of the plane
+    * */
+
+std::vector<PlaneSlicer::Contour> PivotMesh::slice(Vec3 origin, Vec3 normal) {
+    if (_slicer == nullptr && !buildSlicer()) {
+        return std::vector<PlaneSlicer::Contour>();
+    }
+    return _slicer->slice(origin, normal);
+}
+
+/**Build the containment engine for this mesh
+    *
+    * This should be called once at load time for any mesh that will be queried with containsPoint()
+    */
+
+bool PivotMesh::buildVolume() {
+    if (Einds.rows() > 0) {
+        _volume = RegionVolume::alloc(Everts, Einds);
+    }
+    if (_volume == nullptr) {
+        CULogError("The volume could not be built");
+        return false;
+    }
+    return true;
+}
+
+/**Build the spatial chunks of this mesh
+    *
+    * This reorders the indices so that every chunk is a contiguous range
+    */
+
+void PivotMesh::buildChunks() {
+    std::vector<Vec3> positions;
+    positions.reserve(vertices.size());
+    for (const PivotVertex3& vert : vertices) {
+        positions.push_back(vert.position);
+    }
+    _chunks = MeshChunks::alloc(positions, indices);
+    if (_chunks == nullptr) { CULog("THE CHUNKS WERE NOT BUILT PROPERLY"); }
+}
+
 /**Check if a point is in the mesh
     *
     * @param point
     * */
 
 bool PivotMesh::containsPoint(Vec3 point) {
+    if (_volume != nullptr) {
+        return _volume->contains(point);
+    }
 
     auto source = Eigen::Vector3d();
     source(0) = point.x;
@@ -13,6 +13,9 @@
 #include <igl/isolines.h>
 #include <igl/readOBJ.h>
 #include <igl/readPLY.h>
+#include "PlaneSlicer.h"
+#include "RegionVolume.h"
+#include "MeshChunks.h"
 
 using namespace cugl;
 
@@ -20,6 +23,23 @@ class PivotVertex3 : public cugl::SpriteVertex3 {
 
 public:
     Vec3 normal;
+
+    /**
+     * Returns the byte offset of the given attribute in a vertex
+     *
+     * This class is not standard-layout (it adds a member to SpriteVertex3),
+     * so offsetof is not defined for it. This measures the offset on an
+     * actual vertex instead.
+     *
+     * @param member    The attribute, as a member pointer
+     *
+     * @return the byte offset of the given attribute in a vertex
+     */
+    template <typename T, typename C>
+    static GLsizei offset(T C::*member) {
+        PivotVertex3 vertex;
+        return (GLsizei)((const char*)&(vertex.*member) - (const char*)&vertex);
+    }
 };
 
 /**
@@ -33,10 +53,31 @@ private:
 
     /**Eigen representation of face indices*/
     Eigen::MatrixXi Einds;
+
+    /**Slicing engine, only built for meshes that get cut (see buildSlicer)*/
+    std::shared_ptr<PlaneSlicer> _slicer;
+
+    /**Containment engine, only built for meshes used as regions (see buildVolume)*/
+    std::shared_ptr<RegionVolume> _volume;
+
+    /**Spatial chunks, only built for meshes that get drawn (see buildChunks)*/
+    std::shared_ptr<MeshChunks> _chunks;
     
     
 #pragma mark Main Functions
 public:
+    /**What a mesh is loaded for, which decides what data is built*/
+    enum LoadMode {
+        /**Everything (render vertices, Eigen matrices and nothing prebuilt)*/
+        LOAD_ALL,
+        /**Render vertices only, for drawing*/
+        LOAD_RENDER,
+        /**The slicing engine only (the Eigen matrices are dropped), for the collision mesh*/
+        LOAD_SLICE,
+        /**The containment engine only, for trigger regions*/
+        LOAD_CONTAINMENT
+    };
+
     /**
      * Creates an empty mesh object. Recommended that you use MeshFromOBJ() to create Meshes instead
      */
@@ -46,9 +87,19 @@ public:
     
     /**Static Method To create a pivot mesh object from an .obj file path
     *
+    * Only LOAD_ALL and LOAD_RENDER expand the faces into render vertices. LOAD_SLICE and
+    * LOAD_CONTAINMENT build their engine right away and then drop the Eigen matrices, so
+    * intersectPlane() only works on LOAD_ALL meshes.
+    *
     *@param path the filepath to the desired .obj file
+    *@param mode what the mesh will be used for
+    *
+    *@return the mesh, or nullptr if the file could not be read or the engine could not be built
     */
-    static std::shared_ptr<PivotMesh> MeshFromOBJ(std::string path);
+    static std::shared_ptr<PivotMesh> MeshFromOBJ(std::string path, LoadMode mode = LOAD_ALL);
+
+    /**Get the approximate memory held by this mesh in bytes (including the engines)*/
+    size_t getMemoryUsage() const;
 
 
     /**Slice the mesh with a plane
@@ -60,9 +111,61 @@ public:
 
     std::tuple<Eigen::MatrixXd, Eigen::MatrixXi> intersectPlane(Vec3 origin, Vec3 normal);
 
+    /**Build the slicing engine for this mesh
+    *
+    * This should be called once at load time for any mesh that will be cut with slice()
+    *
+    * @return true if the slicing engine was built
+    */
+    bool buildSlicer();
+
+    /**Slice the mesh with a plane using the prebuilt slicing engine
+    *
+    * Unlike intersectPlane this only visits the faces near the plane and returns the cut as ordered polylines.
+    * If buildSlicer() has not been called, it is called first.
+    *
+    * @param origin the origin of the plane
+    * @param normal the normal of the plane
+    */
+    std::vector<PlaneSlicer::Contour> slice(Vec3 origin, Vec3 normal);
+
+    /**Get the slicing engine (nullptr if it has not been built)*/
+    std::shared_ptr<PlaneSlicer> getSlicer() { return _slicer; }
+
+    /**Set a slicing engine built elsewhere (e.g. read from a level binary)*/
+    void setSlicer(const std::shared_ptr<PlaneSlicer>& slicer) { _slicer = slicer; }
+
+
+    /**Build the containment engine for this mesh
+    *
+    * This should be called once at load time for any mesh that will be queried with containsPoint()
+    *
+    * @return true if the containment engine was built
+    */
+    bool buildVolume();
+
+    /**Get the containment engine (nullptr if it has not been built)*/
+    std::shared_ptr<RegionVolume> getVolume() { return _volume; }
+
+    /**Set a containment engine built elsewhere (e.g. read from a level binary)*/
+    void setVolume(const std::shared_ptr<RegionVolume>& volume) { _volume = volume; }
+
+
+    /**Build the spatial chunks of this mesh
+    *
+    * This reorders the indices so that every chunk is a contiguous range, so it should be called
+    * once at load time, before the mesh is uploaded, for any mesh that will be drawn
+    */
+    void buildChunks();
+
+    /**Get the spatial chunks (nullptr if they have not been built)*/
+    std::shared_ptr<MeshChunks> getChunks() const { return _chunks; }
+
 
     /**Check if a point is in the mesh
     *
+    * Uses the containment engine if buildVolume() has been called, and tests every face otherwise.
+    *
     * @param point
     * */
 
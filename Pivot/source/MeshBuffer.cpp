@@ -0,0 +1,92 @@
+//
+//  MeshBuffer.cpp
+//  Pivot
+//
+//  Persistent GPU copy of a static mesh.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "MeshBuffer.h"
+
+/**
+ * Replaces the buffer data with the given vertices and indices
+ *
+ * @param verts     The vertices to upload
+ * @param vcount    The number of vertices
+ * @param inds      The indices to upload
+ * @param icount    The number of indices
+ */
+void VertexBufferDevice::load(const PivotVertex3* verts, size_t vcount, const Uint32* inds, size_t icount) {
+    _buffer->bind();
+    _buffer->loadVertexData(verts, (GLsizei)vcount, GL_STATIC_DRAW);
+    _buffer->loadIndexData(inds, (GLsizei)icount, GL_STATIC_DRAW);
+    _buffer->unbind();
+}
+
+/**
+ * Initializes an empty buffer on the given device
+ *
+ * @param device    The device receiving the uploads
+ *
+ * @return true if the buffer was initialized properly
+ */
+bool MeshBuffer::init(const std::shared_ptr<MeshDevice>& device) {
+    if (device == nullptr) {
+        CULogError("Mesh buffer needs a device");
+        return false;
+    }
+    _device = device;
+    return true;
+}
+
+/**
+ * Makes the given mesh resident, uploading it only if needed
+ *
+ * @param mesh  The mesh to draw
+ *
+ * @return true if the mesh was uploaded
+ */
+bool MeshBuffer::setMesh(const std::shared_ptr<PivotMesh>& mesh) {
+    if (mesh != _mesh) {
+        _mesh = mesh;
+        _dirty = true;
+    }
+    return sync();
+}
+
+/**
+ * Uploads the current mesh again if it was marked dirty
+ *
+ * A change in the size of the mesh counts as an edit, even if it was not
+ * marked dirty.
+ *
+ * @return true if the mesh was uploaded
+ */
+bool MeshBuffer::sync() {
+    if (_mesh != nullptr && (_mesh->vertices.size() != _vertexCount || _mesh->indices.size() != _indexCount)) {
+        _dirty = true;
+    }
+    if (!_dirty) {
+        return false;
+    }
+    upload();
+    return true;
+}
+
+/**
+ * Uploads the current mesh to the device
+ */
+void MeshBuffer::upload() {
+    _dirty = false;
+    if (_mesh == nullptr) {
+        _device->load(nullptr, 0, nullptr, 0);
+        _vertexCount = _indexCount = 0;
+        return;
+    }
+    _device->load(_mesh->vertices.data(), _mesh->vertices.size(), _mesh->indices.data(), _mesh->indices.size());
+    _vertexCount = _mesh->vertices.size();
+    _indexCount = _mesh->indices.size();
+    _uploads++;
+    _uploadBytes += _vertexCount * sizeof(PivotVertex3) + _indexCount * sizeof(Uint32);
+}
@@ -0,0 +1,167 @@
+//
+//  MeshBuffer.h
+//  Pivot
+//
+//  Persistent GPU copy of a static mesh. The level geometry never changes
+//  while a level is played, so it is uploaded once (as GL_STATIC_DRAW) and
+//  only uploaded again when a different (or edited) mesh is set.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef MeshBuffer_h
+#define MeshBuffer_h
+#include <cugl/cugl.h>
+#include "Mesh.h"
+
+using namespace cugl;
+
+/**
+ * The GL calls made by a MeshBuffer.
+ *
+ * All of the upload bookkeeping in MeshBuffer goes through this interface, so
+ * a mock device that just records the calls can stand in for a GL context.
+ */
+class MeshDevice {
+public:
+    /** Deletes this device */
+    virtual ~MeshDevice() {}
+
+    /**
+     * Replaces the device data with the given vertices and indices
+     *
+     * @param verts     The vertices to upload
+     * @param vcount    The number of vertices
+     * @param inds      The indices to upload
+     * @param icount    The number of indices
+     */
+    virtual void load(const PivotVertex3* verts, size_t vcount, const Uint32* inds, size_t icount) = 0;
+};
+
+/**
+ * A device that uploads to a cugl vertex buffer with GL_STATIC_DRAW
+ */
+class VertexBufferDevice : public MeshDevice {
+private:
+    /** The vertex buffer receiving the data */
+    std::shared_ptr<VertexBuffer> _buffer;
+
+public:
+    /**
+     * Creates a device for the given vertex buffer
+     *
+     * @param buffer    The vertex buffer receiving the data
+     */
+    VertexBufferDevice(const std::shared_ptr<VertexBuffer>& buffer) : _buffer(buffer) {}
+
+    /**
+     * Replaces the buffer data with the given vertices and indices
+     *
+     * @param verts     The vertices to upload
+     * @param vcount    The number of vertices
+     * @param inds      The indices to upload
+     * @param icount    The number of indices
+     */
+    void load(const PivotVertex3* verts, size_t vcount, const Uint32* inds, size_t icount) override;
+};
+
+/**
+ * Tracks which mesh is resident in a persistent GPU buffer.
+ *
+ * The buffer keeps a reference to the mesh it last uploaded. Setting the same
+ * mesh again is free unless it was marked dirty (or its size changed), so
+ * callers can set the mesh every time a level is (re)loaded without paying
+ * for an upload.
+ */
+class MeshBuffer {
+private:
+    /** The device receiving the uploads */
+    std::shared_ptr<MeshDevice> _device;
+    /** The mesh currently on the device */
+    std::shared_ptr<PivotMesh> _mesh;
+    /** The number of vertices on the device */
+    size_t _vertexCount;
+    /** The number of indices on the device */
+    size_t _indexCount;
+    /** Whether the mesh was edited since the last upload */
+    bool _dirty;
+
+    /** The number of uploads so far */
+    Uint64 _uploads;
+    /** The number of bytes uploaded so far */
+    Uint64 _uploadBytes;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty buffer. You must call init before using it.
+     */
+    MeshBuffer() : _vertexCount(0), _indexCount(0), _dirty(false), _uploads(0), _uploadBytes(0) {}
+
+    /**
+     * Initializes an empty buffer on the given device
+     *
+     * @param device    The device receiving the uploads
+     *
+     * @return true if the buffer was initialized properly
+     */
+    bool init(const std::shared_ptr<MeshDevice>& device);
+
+    /**
+     * Returns a newly allocated empty buffer on the given device
+     *
+     * @param device    The device receiving the uploads
+     *
+     * @return a newly allocated empty buffer on the given device
+     */
+    static std::shared_ptr<MeshBuffer> alloc(const std::shared_ptr<MeshDevice>& device) {
+        std::shared_ptr<MeshBuffer> result = std::make_shared<MeshBuffer>();
+        return (result->init(device) ? result : nullptr);
+    }
+
+#pragma mark Uploading
+    /**
+     * Makes the given mesh resident, uploading it only if needed
+     *
+     * @param mesh  The mesh to draw
+     *
+     * @return true if the mesh was uploaded
+     */
+    bool setMesh(const std::shared_ptr<PivotMesh>& mesh);
+
+    /**
+     * Uploads the current mesh again if it was marked dirty
+     *
+     * @return true if the mesh was uploaded
+     */
+    bool sync();
+
+    /**
+     * Marks the current mesh as edited, so the next sync uploads it
+     */
+    void markDirty() { _dirty = true; }
+
+#pragma mark Attributes
+    /** Returns the mesh currently on the device */
+    const std::shared_ptr<PivotMesh>& getMesh() const { return _mesh; }
+
+    /** Returns the number of vertices on the device */
+    size_t getVertexCount() const { return _vertexCount; }
+
+    /** Returns the number of indices on the device (for drawing) */
+    size_t getIndexCount() const { return _indexCount; }
+
+    /** Returns the number of uploads so far */
+    Uint64 getUploads() const { return _uploads; }
+
+    /** Returns the number of bytes uploaded so far */
+    Uint64 getUploadBytes() const { return _uploadBytes; }
+
+private:
+    /**
+     * Uploads the current mesh to the device
+     */
+    void upload();
+};
+
+#endif /* MeshBuffer_h */
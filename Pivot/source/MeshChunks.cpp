@@ -0,0 +1,139 @@
+//
+//  MeshChunks.cpp
+//  Pivot
+//
+//  Spatial chunks of a render mesh.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "MeshChunks.h"
+#include <algorithm>
+
+/**
+ * Initializes the chunks of a triangle mesh, reordering its indices
+ *
+ * @param positions The vertex positions
+ * @param indices   The triangle indices, reordered by this method
+ * @param target    The number of triangles a chunk should hold on average
+ *
+ * @return true if the chunks were initialized properly
+ */
+bool MeshChunks::init(const std::vector<Vec3>& positions, std::vector<Uint32>& indices, size_t target) {
+    if (indices.size() % 3 != 0 || target == 0) {
+        CULogError("Mesh chunks need whole triangles and a positive chunk size");
+        return false;
+    }
+    for (Uint32 index : indices) {
+        if (index >= positions.size()) {
+            CULogError("Mesh chunks were given an index past the vertices");
+            return false;
+        }
+    }
+    _chunks.clear();
+    _triangles = indices.size() / 3;
+    std::fill(_dims, _dims + 3, 1);
+    if (_triangles == 0) {
+        return true;
+    }
+
+    // Bound the centroids, as they decide the cells
+    std::vector<Vec3> centers(_triangles);
+    Vec3 lo(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vec3 hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t tri = 0; tri < _triangles; tri++) {
+        Vec3 center = positions[indices[3 * tri]] + positions[indices[3 * tri + 1]] + positions[indices[3 * tri + 2]];
+        centers[tri] = center / 3;
+        lo.set(std::min(lo.x, centers[tri].x), std::min(lo.y, centers[tri].y), std::min(lo.z, centers[tri].z));
+        hi.set(std::max(hi.x, centers[tri].x), std::max(hi.y, centers[tri].y), std::max(hi.z, centers[tri].z));
+    }
+
+    // Size the cells for the target, treating flat meshes as a little thick
+    Vec3 size = hi - lo;
+    float side = std::max({ size.x, size.y, size.z });
+    if (side > 0) {
+        float extent[3] = { size.x, size.y, size.z };
+        float volume = 1;
+        for (int axis = 0; axis < 3; axis++) {
+            extent[axis] = std::max(extent[axis], side / CHUNK_MAX_DIM);
+            volume *= extent[axis];
+        }
+        float cells = std::max(1.0f, (float)_triangles / target);
+        float cell = std::cbrt(volume / cells);
+        for (int axis = 0; axis < 3; axis++) {
+            _dims[axis] = std::min(CHUNK_MAX_DIM, std::max(1, (int)std::ceil(extent[axis] / cell)));
+        }
+    }
+
+    // Sort the triangles by cell (a stable counting sort)
+    float lower[3] = { lo.x, lo.y, lo.z };
+    float range[3] = { size.x, size.y, size.z };
+    size_t cellCount = (size_t)_dims[0] * _dims[1] * _dims[2];
+    std::vector<Uint32> cells(_triangles);
+    std::vector<Uint32> starts(cellCount + 1, 0);
+    for (size_t tri = 0; tri < _triangles; tri++) {
+        float coord[3] = { centers[tri].x, centers[tri].y, centers[tri].z };
+        int cell[3];
+        for (int axis = 0; axis < 3; axis++) {
+            cell[axis] = range[axis] > 0 ? (int)((coord[axis] - lower[axis]) / range[axis] * _dims[axis]) : 0;
+            cell[axis] = std::min(_dims[axis] - 1, std::max(0, cell[axis]));
+        }
+        cells[tri] = (Uint32)((cell[0] * _dims[1] + cell[1]) * _dims[2] + cell[2]);
+        starts[cells[tri] + 1]++;
+    }
+    for (size_t ii = 0; ii < cellCount; ii++) {
+        starts[ii + 1] += starts[ii];
+    }
+
+    std::vector<Uint32> cursors(starts.begin(), starts.end() - 1);
+    std::vector<Uint32> sorted(indices.size());
+    for (size_t tri = 0; tri < _triangles; tri++) {
+        Uint32 slot = cursors[cells[tri]]++;
+        std::copy(indices.begin() + 3 * tri, indices.begin() + 3 * tri + 3, sorted.begin() + 3 * slot);
+    }
+    indices.swap(sorted);
+
+    // Every cell with triangles is a chunk, bounded by its triangles
+    for (size_t ii = 0; ii < cellCount; ii++) {
+        if (starts[ii + 1] == starts[ii]) {
+            continue;
+        }
+        Chunk chunk;
+        chunk.offset = 3 * starts[ii];
+        chunk.count = 3 * (starts[ii + 1] - starts[ii]);
+        chunk.min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+        chunk.max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (Uint32 jj = chunk.offset; jj < chunk.offset + chunk.count; jj++) {
+            const Vec3& pos = positions[indices[jj]];
+            chunk.min.set(std::min(chunk.min.x, pos.x), std::min(chunk.min.y, pos.y), std::min(chunk.min.z, pos.z));
+            chunk.max.set(std::max(chunk.max.x, pos.x), std::max(chunk.max.y, pos.y), std::max(chunk.max.z, pos.z));
+        }
+        _chunks.push_back(chunk);
+    }
+    return true;
+}
+
+/**
+ * Collects the index ranges of the chunks that can be seen
+ *
+ * @param visible   The visibility test for the chunk bounds
+ * @param result    The list to replace with the ranges to draw
+ *
+ * @return the number of triangles in the ranges
+ */
+size_t MeshChunks::cull(const Visibility& visible, std::vector<Range>& result) const {
+    result.clear();
+    size_t triangles = 0;
+    for (const Chunk& chunk : _chunks) {
+        if (!visible(chunk.min, chunk.max)) {
+            continue;
+        }
+        triangles += chunk.count / 3;
+        if (!result.empty() && result.back().offset + result.back().count == chunk.offset) {
+            result.back().count += chunk.count;
+        } else {
+            result.push_back({ chunk.offset, chunk.count });
+        }
+    }
+    return triangles;
+}
@@ -0,0 +1,137 @@
+//
+//  MeshChunks.h
+//  Pivot
+//
+//  Spatial chunks of a render mesh. The triangles are sorted into a uniform
+//  grid when the level is loaded, and the index list is reordered so that the
+//  triangles of every chunk are contiguous. A frame then only draws the index
+//  ranges of the chunks that can be seen.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef MeshChunks_h
+#define MeshChunks_h
+#include <cugl/cugl.h>
+#include <functional>
+#include <vector>
+
+using namespace cugl;
+
+/** The number of triangles a chunk should hold on average */
+#define CHUNK_TRIANGLES     256
+/** The most cells the grid may have along one axis */
+#define CHUNK_MAX_DIM       32
+
+/**
+ * A render mesh split into spatial chunks.
+ *
+ * Each triangle goes to the grid cell holding its centroid, and every cell
+ * with triangles becomes a chunk with the bounds of those triangles (which may
+ * stick out of the cell). The cells are sized so that a chunk holds about
+ * CHUNK_TRIANGLES triangles, so a mesh of any scale gets a sensible number of
+ * chunks. The chunks are kept in grid order, so neighboring chunks along the
+ * last axis are neighbors in the index list too, and their ranges can be
+ * drawn with one call.
+ *
+ * This class does not touch OpenGL, and only knows the vertex positions, so
+ * the chunking and the culling can run without a context.
+ */
+class MeshChunks {
+public:
+    /** A chunk of the mesh */
+    struct Chunk {
+        /** The lower corner of the chunk bounds */
+        Vec3 min;
+        /** The upper corner of the chunk bounds */
+        Vec3 max;
+        /** The first index of the chunk */
+        Uint32 offset;
+        /** The number of indices in the chunk */
+        Uint32 count;
+    };
+
+    /** A range of the index list to draw */
+    struct Range {
+        /** The first index of the range */
+        Uint32 offset;
+        /** The number of indices in the range */
+        Uint32 count;
+    };
+
+    /** Returns true if a box (given by its lower and upper corner) can be seen */
+    typedef std::function<bool(const Vec3&, const Vec3&)> Visibility;
+
+private:
+    /** The chunks, in grid order */
+    std::vector<Chunk> _chunks;
+    /** The number of grid cells along each axis */
+    int _dims[3];
+    /** The number of triangles in the mesh */
+    size_t _triangles;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty set of chunks. You must call init before using it.
+     */
+    MeshChunks() : _dims{0, 0, 0}, _triangles(0) {}
+
+    /**
+     * Initializes the chunks of a triangle mesh, reordering its indices
+     *
+     * The indices are rearranged (three at a time, so every triangle stays
+     * whole) so that each chunk is a contiguous range of them.
+     *
+     * @param positions The vertex positions
+     * @param indices   The triangle indices, reordered by this method
+     * @param target    The number of triangles a chunk should hold on average
+     *
+     * @return true if the chunks were initialized properly
+     */
+    bool init(const std::vector<Vec3>& positions, std::vector<Uint32>& indices, size_t target = CHUNK_TRIANGLES);
+
+    /**
+     * Returns the newly allocated chunks of a triangle mesh, reordering its indices
+     *
+     * @param positions The vertex positions
+     * @param indices   The triangle indices, reordered by this method
+     * @param target    The number of triangles a chunk should hold on average
+     *
+     * @return the newly allocated chunks of a triangle mesh
+     */
+    static std::shared_ptr<MeshChunks> alloc(const std::vector<Vec3>& positions, std::vector<Uint32>& indices,
+                                             size_t target = CHUNK_TRIANGLES) {
+        std::shared_ptr<MeshChunks> result = std::make_shared<MeshChunks>();
+        return (result->init(positions, indices, target) ? result : nullptr);
+    }
+
+#pragma mark Culling
+    /**
+     * Collects the index ranges of the chunks that can be seen
+     *
+     * Visible chunks that are next to each other in the index list are merged
+     * into a single range.
+     *
+     * @param visible   The visibility test for the chunk bounds
+     * @param result    The list to replace with the ranges to draw
+     *
+     * @return the number of triangles in the ranges
+     */
+    size_t cull(const Visibility& visible, std::vector<Range>& result) const;
+
+#pragma mark Attributes
+    /** Returns the chunks, in grid order */
+    const std::vector<Chunk>& getChunks() const { return _chunks; }
+
+    /** Returns the number of triangles in the mesh */
+    size_t getTriangleCount() const { return _triangles; }
+
+    /** Returns the number of grid cells along the given axis (0 to 2) */
+    int getDimension(int axis) const { return _dims[axis]; }
+
+    /** Returns the approximate memory used by the chunks in bytes */
+    size_t getMemoryUsage() const { return sizeof(MeshChunks) + _chunks.capacity() * sizeof(Chunk); }
+};
+
+#endif /* MeshChunks_h */
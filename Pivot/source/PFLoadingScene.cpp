@@ -34,6 +34,21 @@ using namespace cugl;
  * @return true if the controller is initialized properly, false otherwise.
  */
 bool PFLoadingScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
+    return init(assets, nullptr);
+}
+
+/**
+ * Initializes the controller contents to follow the given progress
+ *
+ * The progress is read every update, and should go from 0 to 1.  The
+ * loading assets are reused if another loading screen has loaded them.
+ *
+ * @param assets    The (loaded) assets for this game mode
+ * @param source    The progress to display
+ *
+ * @return true if the controller is initialized properly, false otherwise.
+ */
+bool PFLoadingScene::init(const std::shared_ptr<cugl::AssetManager>& assets, const std::function<float()>& source) {
     // Initialize the scene to a locked width
     Size dimen = Application::get()->getDisplaySize();
     // Lock the scene to a reasonable resolution
@@ -48,10 +63,14 @@ bool PFLoadingScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
         return false;
     }
 
-    // IMMEDIATELY load the splash screen assets
+    // IMMEDIATELY load the splash screen assets (unless another loading screen has)
     _assets = assets;
-    _assets->loadDirectory("json/loading.json");
+    _source = source;
+    if (_assets->get<scene2::SceneNode>("load") == nullptr) {
+        _assets->loadDirectory("json/loading.json");
+    }
     auto layer = assets->get<scene2::SceneNode>("load");
+    layer->removeFromParent();
     layer->setContentSize(dimen);
     layer->doLayout(); // This rearranges the children to fit the screen
     
@@ -61,8 +80,13 @@ bool PFLoadingScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
     _button->addListener([=](const std::string& name, bool down) {
         this->_active = down;
     });
+    if (_source != nullptr) {
+        _button->setVisible(false);
+    } else {
+        Application::get()->setClearColor(Color4(192,192,192,255));
+    }
+    restart();
     
-    Application::get()->setClearColor(Color4(192,192,192,255));
     addChild(layer);
     return true;
 }
@@ -79,9 +103,19 @@ void PFLoadingScene::dispose() {
     _brand = nullptr;
     _bar = nullptr;
     _assets = nullptr;
+    _source = nullptr;
     _progress = 0.0f;
 }
 
+/**
+ * Empties the progress bar for a new load of the progress source
+ */
+void PFLoadingScene::restart() {
+    _progress = 0.0f;
+    _bar->setVisible(true);
+    _bar->setProgress(_progress);
+}
+
 
 #pragma mark -
 #pragma mark Progress Monitoring
@@ -93,7 +127,10 @@ void PFLoadingScene::dispose() {
  * @param timestep  The amount of time (in seconds) since the last frame
  */
 void PFLoadingScene::update(float progress) {
-    if (_progress < 1) {
+    if (_source != nullptr) {
+        _progress = std::min(_source(), 1.0f);
+        _bar->setProgress(_progress);
+    } else if (_progress < 1) {
         _progress = _assets->progress();
         if (_progress >= 1) {
             _progress = 1.0f;
@@ -15,6 +15,7 @@
 #ifndef __PF_LOADING_SCENE_H__
 #define __PF_LOADING_SCENE_H__
 #include <cugl/cugl.h>
+#include <functional>
 
 #pragma mark -
 #pragma mark GameController
@@ -28,6 +29,10 @@
  *
  * Once asset loading is completed, it will display a play button.  Clicking
  * this button will inform the application root to switch to the gameplay mode.
+ *
+ * The screen can also follow any other progress value (such as a level that
+ * is loading in the background) instead of the asset manager.  In that case
+ * there is no play button, and the screen can be restarted for each load.
  */
 class PFLoadingScene : public cugl::Scene2 {
 protected:
@@ -47,6 +52,8 @@ protected:
     // MODEL
     /** The progress displayed on the screen */
     float _progress;
+    /** The progress to display (or nullptr for the asset manager progress) */
+    std::function<float()> _source;
     /** Whether or not the player has pressed play to continue */
     bool  _completed;
 
@@ -95,6 +102,24 @@ public:
      */
     bool init(const std::shared_ptr<cugl::AssetManager>& assets);
 
+    /**
+     * Initializes the controller contents to follow the given progress
+     *
+     * The progress is read every update, and should go from 0 to 1.  The
+     * loading assets are reused if another loading screen has loaded them.
+     *
+     * @param assets    The (loaded) assets for this game mode
+     * @param source    The progress to display
+     *
+     * @return true if the controller is initialized properly, false otherwise.
+     */
+    bool init(const std::shared_ptr<cugl::AssetManager>& assets, const std::function<float()>& source);
+
+    /**
+     * Empties the progress bar for a new load of the progress source
+     */
+    void restart();
+
     
 #pragma mark -
 #pragma mark Progress Monitoring
@@ -36,59 +36,179 @@ void PlaneController::movePlaneToPlayer() {
 
 
 void PlaneController::calculateCut() {
-
-	// set the origin and normal
-	//auto origin = Vec3(0, 0, 0);
     auto origin = _model->getPlaneOrigin();
-	//auto normal = Vec3(-1, 0, 0);
     auto normal = _model->getPlaneNorm();
 
+    // anything still in flight is now out of date
+    cancelCuts();
+
+    _front.origin = origin;
+    _front.normal = normal;
+    auto cache = _model->getCutCache();
+    if (cache == nullptr || !cache->find(origin, normal, _front.paths)) {
+        _front.paths = computeCut(_model->getColMesh(), origin, normal);
+        if (cache != nullptr) {
+            cache->insert(origin, normal, _front.paths);
+        }
+    }
+    _model->setCutPaths(_front.paths);
+}
+
+std::vector<Path2> PlaneController::computeCut(const std::shared_ptr<PivotMesh>& mesh,
+    Vec3 origin, Vec3 normal, Uint64 request, const std::atomic<Uint64>* latest) {
+
 	// need the plane basis vectors to do plane projection
 	auto upvec = Vec3(0,0,1);
-	auto rightvec = getBasisRight();
+	auto rightvec = upvec.getCross(normal).normalize();
 
-	// how much to extrude the cut
-	float width = 1;
+	// init the cut list
+	std::vector<Path2> cut;
 
-	// init the extruder
-	std::shared_ptr<SimpleExtruder> extruder = std::make_shared<SimpleExtruder>();
+	//do the cut; the slicer is built at load time and is safe to share between threads
+	auto slicer = mesh->getSlicer();
+	if (slicer == nullptr) {
+		return cut;
+	}
+	auto contours = slicer->slice(origin, normal);
+
+	//dot every contour point with the basis vectors to get its plane projection
+	for (auto& contour : contours) {
+		// give up as soon as a newer plane has been requested
+		if (latest != nullptr && latest->load() != request) {
+			break;
+		}
+
+		std::vector<Vec2> projected;
+		projected.reserve(contour.points.size());
+		for (auto& p : contour.points) {
+			auto rel = p - origin;
+			projected.push_back(Vec2(rightvec.dot(rel), upvec.dot(rel)));
+		}
+
+		Path2 path(projected);
+		path.closed = contour.closed;
+		cut.push_back(std::move(path));
+	}
 
-	// init the cut list
-	std::vector<std::shared_ptr<Poly2>> cut;
+	return cut;
+}
+
+void PlaneController::requestCut() {
+	auto origin = _model->getPlayer3DLoc();
+	auto normal = _model->getPlaneNorm();
+	auto cache = _model->getCutCache();
+	if (_request == _worker->latest && origin == _requestOrigin && normal == _requestNormal) {
+		return;
+	}
 
-	//do the cut
-	auto cutdata = _model->getColMesh()->intersectPlane(origin, normal);
-	auto Vcut = std::get<0>(cutdata);
-	auto Ecut = std::get<1>(cutdata);
+	// Bumping the request number cancels every older task
+	Uint64 request = ++_worker->latest;
+	_request = request;
+	_requestOrigin = origin;
+	_requestNormal = normal;
+
+	// Revisited angles skip the worker entirely
+	CutResult cached;
+	if (cache != nullptr && cache->find(origin, normal, cached.paths)) {
+		cached.request = request;
+		cached.origin = origin;
+		cached.normal = normal;
+		std::lock_guard<std::mutex> lock(_worker->mutex);
+		_worker->back = std::move(cached);
+		return;
+	}
 
-	//make origin at the player origin
+	auto worker = _worker;
+	auto mesh = _model->getColMesh();
+	_pool->addTask([=]() {
+		if (worker->latest != request) {
+			return;
+		}
+		CU_PROFILE_SCOPE("PlaneController::computeCut");
+		CutResult result;
+		result.request = request;
+		result.origin = origin;
+		result.normal = normal;
+		result.paths = computeCut(mesh, origin, normal, request, &worker->latest);
+		if (worker->latest != request) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		if (request > worker->back.request) {
+			worker->back = std::move(result);
+		}
+	});
+}
+
+bool PlaneController::publishCut() {
+	{
+		std::lock_guard<std::mutex> lock(_worker->mutex);
+		if (_worker->back.request <= _front.request) {
+			return false;
+		}
+		std::swap(_front, _worker->back);
+	}
+	auto cache = _model->getCutCache();
+	if (cache != nullptr && !cache->contains(_front.origin, _front.normal)) {
+		cache->insert(_front.origin, _front.normal, _front.paths);
+	}
+	_model->setCutPaths(_front.paths);
+	return true;
+}
 
-	//for each edge get the corresponding start and end vertices
-	//dot them with the basis vectors to get their plane projection
-	for (int i = 0; i < Ecut.rows(); i++) {
+void PlaneController::finishCut() {
+	auto origin = _model->getPlaneOrigin();
+	auto normal = _model->getPlaneNorm();
+	publishCut();
+	if (_front.request == 0 || _front.origin != origin || _front.normal != normal) {
+		CULog("Cut worker fell behind, computing the cut in this frame");
+		calculateCut();
+	}
+}
 
-		// Dot the first point to the x axis then the y axis;
-		auto x0 = rightvec.x * (Vcut(Ecut(i,0), 0)-origin.x) + rightvec.y * (Vcut(Ecut(i, 0), 1)-origin.y) + rightvec.z * (Vcut(Ecut(i, 0), 2)-origin.z);
-		auto y0 = upvec.x * (Vcut(Ecut(i, 0), 0)-origin.x) + upvec.y * (Vcut(Ecut(i, 0), 1) - origin.y) + upvec.z * (Vcut(Ecut(i, 0), 2)-origin.z);
+void PlaneController::cancelCuts() {
+	Uint64 request = ++_worker->latest;
+	std::lock_guard<std::mutex> lock(_worker->mutex);
+	_worker->back = CutResult();
+	_front.request = request;
+	_front.paths.clear();
+}
 
-		// Dot the second point to the x axis then the y axis;
-		auto x1 = rightvec.x * (Vcut(Ecut(i, 1), 0) - origin.x) + rightvec.y * (Vcut(Ecut(i, 1), 1) - origin.y) + rightvec.z * (Vcut(Ecut(i, 1), 2) - origin.z);
-		auto y1 = upvec.x * (Vcut(Ecut(i, 1), 0) - origin.x) + upvec.y * (Vcut(Ecut(i, 1), 1) - origin.y) + upvec.z * (Vcut(Ecut(i, 1), 2) - origin.z);
+void PlaneController::prewarmCuts() {
+	prewarmCuts(_model->getCutCache(), _model->getColMesh(), _model->getInitPlayerLoc());
+}
 
-		// Make Vec2 Objects, make a path, add the path to segments
-		auto v0 = Vec2(x0, y0);
-		auto v1 = Vec2(x1, y1);
-		auto verts = std::vector<Vec2>{ v0, v1 };
-		extruder->set(Path2(verts));
-		extruder->calculate(width);
-		cut.push_back(std::make_shared<Poly2>(extruder->getPolygon()));
+void PlaneController::prewarmCuts(const std::shared_ptr<CutCache>& cache, const std::shared_ptr<PivotMesh>& mesh, Vec3 origin) {
+	if (cache == nullptr || !cache->getPrewarm()) {
+		return;
+	}
 
-		//CULog("v%f,%f,%f", v0.x, v0.y, 0.0f);
-		//CULog("v%f,%f,%f", v1.x, v1.y, 0.0f);
+	Timestamp start;
+	for (int deg = 0; deg < 360; deg++) {
+		float rad = deg * M_PI / 180.0f;
+		auto normal = cache->snap(Vec3(cos(rad), sin(rad), 0));
+		if (!cache->contains(origin, normal)) {
+			cache->insert(origin, normal, computeCut(mesh, origin, normal));
+		}
 	}
+	Timestamp done;
+	CULog("Prewarmed %zu cuts (%zu KB) in %llu ms", cache->size(), cache->getMemoryUsage() / 1024,
+		(unsigned long long)Timestamp::ellapsedMillis(start, done));
+}
 
-	_model->setCut(cut);
-	return;
+void PlaneController::setCut(Vec3 origin, Vec3 normal, std::vector<Path2> paths) {
+	// anything still in flight is now out of date
+	cancelCuts();
+
+	_front.origin = origin;
+	_front.normal = normal;
+	_front.paths = std::move(paths);
+	auto cache = _model->getCutCache();
+	if (cache != nullptr && !cache->contains(origin, normal)) {
+		cache->insert(origin, normal, _front.paths);
+	}
+	_model->setCutPaths(_front.paths);
 }
 
 /**Debugging with crazy cuts is hard, so this sets the cut to be a box with given size
@@ -97,14 +217,6 @@ void PlaneController::calculateCut() {
 	*/
 void PlaneController::debugCut(float size) {
 
-	// init the cut list
-	std::vector<std::shared_ptr<Poly2>> cut;
-
-	auto width = 1;
-
-	// init the extruder
-	std::shared_ptr<SimpleExtruder> extruder = std::make_shared<SimpleExtruder>();
-
 	auto verts = std::vector<Vec2>{
 		Vec2(-size/2, -size/2),
 		Vec2(size / 2, -size / 2),
@@ -113,11 +225,7 @@ void PlaneController::debugCut(float size) {
 	};
     auto path = Path2(verts);
     path.closed = true;
-	extruder->set(path);
-	extruder->calculate(width);
-	cut.push_back(std::make_shared<Poly2>(extruder->getPolygon()));
-
-	_model->setCut(cut);
+	_model->setCutPaths({ path });
 
 }
 
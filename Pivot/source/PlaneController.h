@@ -10,8 +10,15 @@
 #ifndef PlaneController_h
 #define PlaneController_h
 #include <cugl/cugl.h>
+#include <atomic>
+#include <mutex>
 #include "GameModel.h"
 
+/** The thickness of the cut obstacle (centered on the cut contours) */
+#define CUT_WIDTH   1.0f
+/** The radius of the cut chains; this includes the skin the extruded cut polygons had */
+#define CUT_RADIUS  (CUT_WIDTH/2 + b2_polygonRadius)
+
 /**
  * Have functions that take in the GameModel and do the following:
  *  - Update the plane info to rotate plane a specified amount of degrees then update the cut info to reflect the new plane
@@ -19,12 +26,56 @@
 
 class PlaneController {
 
+	/** A cut through the collision mesh, tagged with the plane it was computed for */
+	struct CutResult {
+		/** The request number of this cut (0 if none) */
+		Uint64 request;
+		/** The plane origin of the cut */
+		Vec3 origin;
+		/** The plane normal of the cut */
+		Vec3 normal;
+		/** The projected cut contours */
+		std::vector<Path2> paths;
+
+		CutResult() : request(0) {}
+	};
+
+	/**
+	 * The state shared with the cut worker.
+	 *
+	 * This is held by a shared pointer so that a task that is still running
+	 * when the controller goes away never touches freed memory.
+	 */
+	struct CutWorker {
+		/** The newest request; any task with an older number is stale */
+		std::atomic<Uint64> latest;
+		/** Guards the back buffer */
+		std::mutex mutex;
+		/** The newest finished cut that has not been published yet */
+		CutResult back;
+
+		CutWorker() : latest(0) {}
+	};
+
 	std::shared_ptr<GameModel> _model;
 
+	/** The (single thread) pool that computes cuts in the background */
+	std::shared_ptr<ThreadPool> _pool;
+	/** The state shared with the pool */
+	std::shared_ptr<CutWorker> _worker;
+	/** The cut currently published to the model (the front buffer) */
+	CutResult _front;
+	/** The number of the last asynchronous request */
+	Uint64 _request;
+	/** The origin of the last asynchronous request */
+	Vec3 _requestOrigin;
+	/** The normal of the last asynchronous request */
+	Vec3 _requestNormal;
+
 public:
 	/**Constructor for an empty Plane Controller Object, must call init to allocate properties
 	* */
-	PlaneController() {}
+	PlaneController() : _worker(std::make_shared<CutWorker>()), _request(0) {}
 
 	/**set up the properties of the plane controller
 	* @param gamemodel the game model which is begin manipulated by this controller
@@ -32,6 +83,10 @@ public:
 	void init(std::shared_ptr<GameModel> gamemodel) 
 	{
 		_model = gamemodel;
+		if (_pool == nullptr) {
+			_pool = ThreadPool::alloc(1);
+		}
+		cancelCuts();
 		setPlane(_model->getInitPlayerLoc(), _model->getInitPlaneNorm());
 		//calculateCut();
 	}
@@ -49,12 +104,77 @@ public:
 	/**Move the planes origin to the location of the player*/
 	void movePlaneToPlayer();
 
-	/**Gets a vector of Poly2 objects which represent a CUT throught the map at the given angle
+	/**Computes the CUT through the map at the current plane and stores its contours in the model
 	* @param origin the origin of the cut plane
 	* @param normal the normal vector of the cut plane
 	*/
 	void calculateCut();
 
+	/**Computes the cut of a mesh by a plane, projected into the plane
+	*
+	* This does not touch the controller or the model, so it is safe to call from a worker thread.
+	*
+	* @param mesh the collision mesh to cut
+	* @param origin the origin of the cut plane
+	* @param normal the normal vector of the cut plane
+	* @param request the request number of this cut, or 0 if it cannot be cancelled
+	* @param latest the newest request number; the cut is abandoned once it moves past request
+	*
+	* @return the projected cut contours (possibly incomplete if it was cancelled)
+	*/
+	static std::vector<Path2> computeCut(const std::shared_ptr<PivotMesh>& mesh,
+		Vec3 origin, Vec3 normal, Uint64 request = 0, const std::atomic<Uint64>* latest = nullptr);
+
+	/**Starts computing the cut at the player location and the current plane normal in the background
+	*
+	* Cached cuts are published without using the worker.
+	* Any request that is still pending is cancelled. Nothing happens if the plane has not
+	* changed since the last request.
+	*/
+	void requestCut();
+
+	/**Publishes the newest finished background cut to the model, if there is one
+	*
+	* This must be called from the main thread.
+	*
+	* @return true if a new cut was published
+	*/
+	bool publishCut();
+
+	/**Makes sure the model cut matches the current plane
+	*
+	* This publishes the background cut if it was computed for the current plane, and only
+	* falls back to calculateCut if the worker has not caught up.
+	*/
+	void finishCut();
+
+	/**Cancels all pending background cuts*/
+	void cancelCuts();
+
+	/**Fills the cut cache with the whole degree angles through the start point, if the level asks for it*/
+	void prewarmCuts();
+
+	/**Fills a cut cache with the whole degree angles through a point, if the cache asks for it
+	*
+	* This does not touch the controller or the model, so it is safe to call from a worker thread
+	* on a cache that has not been given to the model yet.
+	*
+	* @param cache the cut cache to fill
+	* @param mesh the collision mesh to cut
+	* @param origin the point every cut goes through
+	*/
+	static void prewarmCuts(const std::shared_ptr<CutCache>& cache, const std::shared_ptr<PivotMesh>& mesh, Vec3 origin);
+
+	/**Publishes a cut that was computed elsewhere (such as by the level loader) to the model
+	*
+	* Any pending background cut is cancelled, and the cut is added to the cut cache.
+	*
+	* @param origin the origin of the cut plane
+	* @param normal the normal of the cut plane
+	* @param paths the projected cut contours
+	*/
+	void setCut(Vec3 origin, Vec3 normal, std::vector<Path2> paths);
+
 	/**Debugging with crazy cuts is hard, so this sets the cut to be a box with given size
 	* 
 	* @param float size the length of the edge of the square
@@ -0,0 +1,502 @@
+//
+//  PlaneSlicer.cpp
+//  Pivot
+//
+//  Incremental slicing engine for the collision mesh.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "PlaneSlicer.h"
+#include "BinaryIO.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+/** Normals with a larger z-component than this skip the angle index */
+#define HORIZONTAL_EPSILON  0.00001
+/** Edges covering more buckets than this are tested on every query */
+#define MAX_EDGE_BUCKETS    8
+
+#pragma mark Constructors
+/**
+ * Builds the adjacency and the angle index for the given mesh.
+ *
+ * @param V     The mesh vertices (one per row)
+ * @param F     The mesh triangles (one per row)
+ * @param bins  The number of angle bins over the half circle
+ *
+ * @return true if the slicer was initialized properly
+ */
+bool PlaneSlicer::init(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, int bins) {
+    if (V.rows() == 0 || F.rows() == 0 || F.cols() != 3 || bins <= 0) {
+        return false;
+    }
+
+    // copy the vertices and find the horizontal bounds
+    _verts.resize(V.rows());
+    double minx = V(0, 0), maxx = V(0, 0), miny = V(0, 1), maxy = V(0, 1);
+    for (int i = 0; i < V.rows(); i++) {
+        _verts[i] = Vec3(V(i, 0), V(i, 1), V(i, 2));
+        minx = std::min(minx, V(i, 0));
+        maxx = std::max(maxx, V(i, 0));
+        miny = std::min(miny, V(i, 1));
+        maxy = std::max(maxy, V(i, 1));
+    }
+    _center = Vec3((minx + maxx) / 2, (miny + maxy) / 2, 0);
+
+    // collect the unique edges of every face
+    std::unordered_map<Uint64, Uint32> lookup;
+    lookup.reserve(F.rows() * 2);
+    _edges.clear();
+    _faceVerts.resize(F.rows() * 3);
+    _faceEdges.resize(F.rows() * 3);
+    for (int fi = 0; fi < F.rows(); fi++) {
+        for (int k = 0; k < 3; k++) {
+            Uint32 a = F(fi, k);
+            Uint32 b = F(fi, (k + 1) % 3);
+            Uint64 key = ((Uint64)std::min(a, b) << 32) | std::max(a, b);
+            auto it = lookup.find(key);
+            if (it == lookup.end()) {
+                it = lookup.emplace(key, (Uint32)_edges.size()).first;
+                _edges.push_back(std::make_pair(a, b));
+            }
+            _faceVerts[3 * fi + k] = a;
+            _faceEdges[3 * fi + k] = it->second;
+        }
+    }
+
+    // edge to face adjacency
+    _edgeFaceStart.assign(_edges.size() + 1, 0);
+    for (Uint32 e : _faceEdges) {
+        _edgeFaceStart[e + 1]++;
+    }
+    for (size_t e = 0; e < _edges.size(); e++) {
+        _edgeFaceStart[e + 1] += _edgeFaceStart[e];
+    }
+    _edgeFaces.resize(_faceEdges.size());
+    std::vector<Uint32> fill(_edgeFaceStart.begin(), _edgeFaceStart.end() - 1);
+    for (size_t i = 0; i < _faceEdges.size(); i++) {
+        _edgeFaces[fill[_faceEdges[i]]++] = (Uint32)(i / 3);
+    }
+
+    // A normal within half a bin of the bin center moves by at most this
+    // angle, so a distance measured from the center moves by at most radius*angle
+    double radius = 0;
+    for (const Vec3& v : _verts) {
+        double dx = v.x - _center.x;
+        double dy = v.y - _center.y;
+        radius = std::max(radius, std::sqrt(dx * dx + dy * dy));
+    }
+    double halfbin = M_PI / (2.0 * bins);
+    _binError = radius * halfbin * 1.001 + 0.001;
+
+    // bucket the edges for each angle bin
+    _bins.clear();
+    _bins.resize(bins);
+    std::vector<double> dists(_verts.size());
+    for (int b = 0; b < bins; b++) {
+        AngleBin& bin = _bins[b];
+        double theta = (2 * b + 1) * halfbin;
+        bin.normal = Vec3(std::cos(theta), std::sin(theta), 0);
+
+        double dmin = 0, dmax = 0;
+        for (size_t i = 0; i < _verts.size(); i++) {
+            dists[i] = (double)bin.normal.x * (_verts[i].x - _center.x) + (double)bin.normal.y * (_verts[i].y - _center.y);
+            dmin = i ? std::min(dmin, dists[i]) : dists[i];
+            dmax = i ? std::max(dmax, dists[i]) : dists[i];
+        }
+        dmin -= _binError;
+        dmax += _binError;
+
+        // buckets are sized so that a typical (padded) edge spans about two
+        double extent = 0;
+        for (auto& e : _edges) {
+            extent += std::abs(dists[e.first] - dists[e.second]) + 2 * _binError;
+        }
+        extent /= _edges.size();
+        size_t count = (size_t)((dmax - dmin) / extent) + 1;
+        count = std::min(count, 4 * _edges.size() + 1);
+        bin.dmin = dmin;
+        bin.width = (dmax - dmin) / count;
+
+        // two passes: count the bucket sizes, then fill them
+        bin.start.assign(count + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            std::vector<Uint32> cursor;
+            if (pass == 1) {
+                for (size_t k = 0; k < count; k++) {
+                    bin.start[k + 1] += bin.start[k];
+                }
+                bin.edges.resize(bin.start[count]);
+                cursor.assign(bin.start.begin(), bin.start.end() - 1);
+            }
+            for (Uint32 e = 0; e < _edges.size(); e++) {
+                double d0 = dists[_edges[e].first];
+                double d1 = dists[_edges[e].second];
+                size_t lo = (size_t)std::max(0.0, (std::min(d0, d1) - _binError - dmin) / bin.width);
+                size_t hi = (size_t)std::max(0.0, (std::max(d0, d1) + _binError - dmin) / bin.width);
+                hi = std::min(hi, count - 1);
+                if (hi - lo + 1 > MAX_EDGE_BUCKETS) {
+                    if (pass == 1) {
+                        bin.wide.push_back(e);
+                    }
+                    continue;
+                }
+                for (size_t k = lo; k <= hi; k++) {
+                    if (pass == 0) {
+                        bin.start[k + 1]++;
+                    } else {
+                        bin.edges[cursor[k]++] = e;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+#pragma mark Slicing
+/**
+ * Appends the edges that may cross the plane to the candidate list
+ *
+ * @param normal    The (unit) normal of the plane
+ * @param offset    The plane offset (normal.dot(origin))
+ * @param result    The list to store the candidates
+ */
+void PlaneSlicer::gatherCandidates(const Vec3& normal, double offset, std::vector<Uint32>& result) const {
+    if (_bins.empty() || std::abs(normal.z) > HORIZONTAL_EPSILON) {
+        result.resize(_edges.size());
+        for (Uint32 e = 0; e < _edges.size(); e++) {
+            result[e] = e;
+        }
+        return;
+    }
+
+    // normals in [pi, 2pi) share the bins of their opposite direction
+    double theta = std::atan2(normal.y, normal.x);
+    double sign = 1;
+    if (theta < 0) {
+        theta += 2 * M_PI;
+    }
+    if (theta >= M_PI) {
+        theta -= M_PI;
+        sign = -1;
+    }
+    size_t b = std::min(_bins.size() - 1, (size_t)(theta * _bins.size() / M_PI));
+    const AngleBin& bin = _bins[b];
+
+    double q = sign * (offset - ((double)normal.x * _center.x + (double)normal.y * _center.y));
+    double k = std::floor((q - bin.dmin) / bin.width);
+    if (k >= 0 && k < bin.start.size() - 1) {
+        size_t bucket = (size_t)k;
+        result.insert(result.end(), bin.edges.begin() + bin.start[bucket], bin.edges.begin() + bin.start[bucket + 1]);
+    }
+    result.insert(result.end(), bin.wide.begin(), bin.wide.end());
+}
+
+/**
+ * Returns the contours of the mesh cut by the given plane.
+ *
+ * This method does not modify the slicer, so it is safe to call from
+ * several threads at once.
+ *
+ * @param origin    A point on the plane
+ * @param normal    The normal of the plane
+ *
+ * @return the ordered contours of the cut
+ */
+std::vector<PlaneSlicer::Contour> PlaneSlicer::slice(const Vec3& origin, const Vec3& normal) const {
+    std::vector<Contour> result;
+    Vec3 n = normal.getNormalization();
+    double offset = (double)n.x * origin.x + (double)n.y * origin.y + (double)n.z * origin.z;
+
+    // A vertex on the plane counts as being in front of it. This keeps the
+    // classification consistent, so every face is crossed by zero or two edges.
+    auto front = [&](Uint32 v) {
+        const Vec3& p = _verts[v];
+        return (double)n.x * p.x + (double)n.y * p.y + (double)n.z * p.z - offset >= 0;
+    };
+
+    std::vector<Uint32> candidates;
+    gatherCandidates(n, offset, candidates);
+
+    // find the edges that actually cross
+    std::vector<Uint32> crossEdges;
+    std::vector<Vec3> crossPoints;
+    std::unordered_map<Uint32, Uint32> crossIndex;
+    for (Uint32 e : candidates) {
+        const Vec3& p0 = _verts[_edges[e].first];
+        const Vec3& p1 = _verts[_edges[e].second];
+        double s0 = (double)n.x * p0.x + (double)n.y * p0.y + (double)n.z * p0.z - offset;
+        double s1 = (double)n.x * p1.x + (double)n.y * p1.y + (double)n.z * p1.z - offset;
+        if ((s0 >= 0) != (s1 >= 0) && crossIndex.find(e) == crossIndex.end()) {
+            float t = (float)(s0 / (s0 - s1));
+            crossIndex.emplace(e, (Uint32)crossEdges.size());
+            crossEdges.push_back(e);
+            crossPoints.push_back(p0 + (p1 - p0) * t);
+        }
+    }
+
+    // the other crossing edge of a face (or -1 if there is none)
+    auto across = [&](Uint32 face, Uint32 from) {
+        for (int k = 0; k < 3; k++) {
+            Uint32 e = _faceEdges[3 * face + k];
+            if (e != from) {
+                auto it = crossIndex.find(e);
+                if (it != crossIndex.end()) {
+                    return (int)it->second;
+                }
+            }
+        }
+        return -1;
+    };
+
+    std::vector<bool> visited(crossEdges.size(), false);
+    std::unordered_set<Uint32> usedFaces;
+    usedFaces.reserve(crossEdges.size() * 2);
+
+    // walks from a crossing through the given face, returning the crossings passed
+    auto walk = [&](Uint32 start, Uint32 face, bool& closed) {
+        std::vector<Uint32> chain;
+        Uint32 cur = start;
+        closed = false;
+        while (usedFaces.insert(face).second) {
+            int next = across(face, crossEdges[cur]);
+            if (next < 0) {
+                break;
+            } else if ((Uint32)next == start) {
+                closed = true;
+                break;
+            } else if (visited[next]) {
+                // another contour already passed here (an edge shared by more than
+                // two faces), so end on the shared point to keep this segment
+                chain.push_back(next);
+                break;
+            }
+            visited[next] = true;
+            chain.push_back(next);
+            cur = next;
+
+            // continue into an unused neighbor
+            Uint32 e = crossEdges[cur];
+            bool found = false;
+            for (Uint32 k = _edgeFaceStart[e]; !found && k < _edgeFaceStart[e + 1]; k++) {
+                if (usedFaces.find(_edgeFaces[k]) == usedFaces.end()) {
+                    face = _edgeFaces[k];
+                    found = true;
+                }
+            }
+            if (!found) {
+                break;
+            }
+        }
+        return chain;
+    };
+
+    for (Uint32 c = 0; c < crossEdges.size(); c++) {
+        if (visited[c]) {
+            continue;
+        }
+        visited[c] = true;
+
+        // Orient the walk using the face winding: we leave an edge through the
+        // face where the edge goes from the front to the back of the plane.
+        Uint32 e = crossEdges[c];
+        std::vector<Uint32> faces;
+        for (Uint32 k = _edgeFaceStart[e]; k < _edgeFaceStart[e + 1]; k++) {
+            Uint32 f = _edgeFaces[k];
+            if (usedFaces.find(f) != usedFaces.end()) {
+                continue;
+            }
+            for (int j = 0; j < 3; j++) {
+                if (_faceEdges[3 * f + j] == e) {
+                    bool forward = front(_faceVerts[3 * f + j]) && !front(_faceVerts[3 * f + (j + 1) % 3]);
+                    faces.insert(forward ? faces.begin() : faces.end(), f);
+                    break;
+                }
+            }
+        }
+
+        Contour contour;
+        std::vector<Uint32> ahead;
+        if (!faces.empty()) {
+            ahead = walk(c, faces[0], contour.closed);
+        }
+
+        // open chains also need to be extended behind the start
+        std::vector<Uint32> behind;
+        bool looped = false;
+        if (!contour.closed) {
+            for (size_t k = 1; k < faces.size() && behind.empty(); k++) {
+                behind = walk(c, faces[k], looped);
+            }
+        }
+
+        // a loop behind the start (that the walk ahead left) begins at the start
+        contour.points.reserve(behind.size() + ahead.size() + 2);
+        if (looped) {
+            contour.points.push_back(crossPoints[c]);
+        }
+        for (auto it = behind.rbegin(); it != behind.rend(); ++it) {
+            contour.points.push_back(crossPoints[*it]);
+        }
+        contour.points.push_back(crossPoints[c]);
+        for (Uint32 k : ahead) {
+            contour.points.push_back(crossPoints[k]);
+        }
+        if (contour.points.size() > 1) {
+            result.push_back(std::move(contour));
+        }
+    }
+
+    // Where more than two faces meet at an edge, the walks only pass through
+    // two of them. Any crossed face they skipped is a segment of its own.
+    for (Uint32 c = 0; c < crossEdges.size(); c++) {
+        Uint32 e = crossEdges[c];
+        for (Uint32 k = _edgeFaceStart[e]; k < _edgeFaceStart[e + 1]; k++) {
+            Uint32 f = _edgeFaces[k];
+            int other = across(f, e);
+            if (other < 0 || !usedFaces.insert(f).second) {
+                continue;
+            }
+            Contour contour;
+            for (int j = 0; j < 3; j++) {
+                if (_faceEdges[3 * f + j] == e) {
+                    bool forward = front(_faceVerts[3 * f + j]) && !front(_faceVerts[3 * f + (j + 1) % 3]);
+                    contour.points.push_back(crossPoints[forward ? c : other]);
+                    contour.points.push_back(crossPoints[forward ? other : c]);
+                    break;
+                }
+            }
+            result.push_back(std::move(contour));
+        }
+    }
+
+    return result;
+}
+
+#pragma mark Serialization
+/**
+ * Returns true if every entry is a valid index into an array of the given size
+ *
+ * @param indices   The indices to check
+ * @param size      The size of the array they refer to
+ */
+static bool inRange(const std::vector<Uint32>& indices, size_t size) {
+    for (Uint32 index : indices) {
+        if (index >= size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns true if the CSR starts are ascending and end within the given size
+ *
+ * @param start     The start of each row
+ * @param size      The size of the array the rows index
+ */
+static bool validStarts(const std::vector<Uint32>& start, size_t size) {
+    for (size_t i = 1; i < start.size(); i++) {
+        if (start[i] < start[i - 1]) {
+            return false;
+        }
+    }
+    return start.empty() || start.back() <= size;
+}
+
+/**
+ * Reads a slicer previously saved with write().
+ *
+ * @param reader    The stream positioned at the slicer data
+ *
+ * @return true if the slicer was read properly
+ */
+bool PlaneSlicer::initWithReader(const std::shared_ptr<BinaryReader>& reader) {
+    if (!BinaryIO::readVec3s(reader, _verts) ||
+        !BinaryIO::readArray<std::pair<Uint32, Uint32>, Uint32>(reader, _edges, 2) ||
+        !BinaryIO::readUints(reader, _faceVerts) || !BinaryIO::readUints(reader, _faceEdges) ||
+        !BinaryIO::readUints(reader, _edgeFaceStart) || !BinaryIO::readUints(reader, _edgeFaces) ||
+        !BinaryIO::readVec3(reader, _center) || !reader->ready(12)) {
+        return false;
+    }
+    _binError = reader->readDouble();
+    Uint32 bins = reader->readUint32();
+    if (bins == 0 || bins > BINARY_MAX_COUNT) {
+        return false;
+    }
+
+    // Check the adjacency before anything can index with it
+    size_t faces = _faceVerts.size() / 3;
+    for (auto& edge : _edges) {
+        if (edge.first >= _verts.size() || edge.second >= _verts.size()) {
+            return false;
+        }
+    }
+    if (_faceVerts.size() % 3 != 0 || _faceEdges.size() != _faceVerts.size() ||
+        _edgeFaceStart.size() != _edges.size() + 1 || !validStarts(_edgeFaceStart, _edgeFaces.size()) ||
+        !inRange(_faceVerts, _verts.size()) || !inRange(_faceEdges, _edges.size()) || !inRange(_edgeFaces, faces)) {
+        return false;
+    }
+
+    _bins.resize(bins);
+    for (AngleBin& bin : _bins) {
+        if (!BinaryIO::readVec3(reader, bin.normal) || !reader->ready(16)) {
+            return false;
+        }
+        bin.dmin = reader->readDouble();
+        bin.width = reader->readDouble();
+        if (!BinaryIO::readUints(reader, bin.start) || !BinaryIO::readUints(reader, bin.edges) ||
+            !BinaryIO::readUints(reader, bin.wide)) {
+            return false;
+        }
+        if (bin.start.empty() || !validStarts(bin.start, bin.edges.size()) || !inRange(bin.edges, _edges.size()) ||
+            !inRange(bin.wide, _edges.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Writes the adjacency and the angle index, so they need not be rebuilt
+ *
+ * @param writer    The stream to write to
+ */
+void PlaneSlicer::write(const std::shared_ptr<BinaryWriter>& writer) const {
+    BinaryIO::writeVec3s(writer, _verts);
+    BinaryIO::writeArray<std::pair<Uint32, Uint32>, Uint32>(writer, _edges, 2);
+    BinaryIO::writeUints(writer, _faceVerts);
+    BinaryIO::writeUints(writer, _faceEdges);
+    BinaryIO::writeUints(writer, _edgeFaceStart);
+    BinaryIO::writeUints(writer, _edgeFaces);
+    BinaryIO::writeVec3(writer, _center);
+    writer->writeDouble(_binError);
+    writer->writeUint32((Uint32)_bins.size());
+    for (const AngleBin& bin : _bins) {
+        BinaryIO::writeVec3(writer, bin.normal);
+        writer->writeDouble(bin.dmin);
+        writer->writeDouble(bin.width);
+        BinaryIO::writeUints(writer, bin.start);
+        BinaryIO::writeUints(writer, bin.edges);
+        BinaryIO::writeUints(writer, bin.wide);
+    }
+}
+
+#pragma mark Attributes
+/** Returns the approximate memory used by the slicer in bytes */
+size_t PlaneSlicer::getMemoryUsage() const {
+    size_t total = sizeof(PlaneSlicer);
+    total += _verts.capacity() * sizeof(Vec3);
+    total += _edges.capacity() * sizeof(std::pair<Uint32, Uint32>);
+    total += (_faceVerts.capacity() + _faceEdges.capacity()) * sizeof(Uint32);
+    total += (_edgeFaceStart.capacity() + _edgeFaces.capacity()) * sizeof(Uint32);
+    for (const AngleBin& bin : _bins) {
+        total += sizeof(AngleBin);
+        total += (bin.start.capacity() + bin.edges.capacity() + bin.wide.capacity()) * sizeof(Uint32);
+    }
+    return total;
+}
@@ -0,0 +1,190 @@
+//
+//  PlaneSlicer.h
+//  Pivot
+//
+//  Incremental slicing engine for the collision mesh. All of the adjacency and
+//  the per-angle edge index are built once when the level is loaded, so that a
+//  cut only visits the edges (and faces) that are close to the cut plane.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef PlaneSlicer_h
+#define PlaneSlicer_h
+#include <cugl/cugl.h>
+#include <Eigen/Core>
+#include <vector>
+
+using namespace cugl;
+
+/** Default number of angle bins over the half circle [0, pi) */
+#define SLICER_ANGLE_BINS   32
+
+/**
+ * A class for repeatedly slicing a static triangle mesh with a plane.
+ *
+ * The cut plane in Pivot always rotates around the world z-axis, so its
+ * normal lies in the xy-plane. For each of a fixed set of normal directions
+ * (the angle bins) we bucket every mesh edge by its signed distance interval
+ * along that direction. The interval is padded by the largest error that any
+ * normal inside the bin can introduce, so a query at an arbitrary angle only
+ * has to exactly test the edges in a single bucket.
+ *
+ * Normals that are not horizontal fall back to testing every edge, which is
+ * still cheaper than re-running the isoline extraction over the full mesh.
+ *
+ * Slices are returned as ordered polylines. Each polyline is closed unless it
+ * runs into a boundary edge of the mesh, or an edge shared by more than two
+ * faces (where the cut branches).
+ */
+class PlaneSlicer {
+public:
+    /** A single connected component of the cut */
+    struct Contour {
+        /** The ordered points of the contour (in world space) */
+        std::vector<Vec3> points;
+        /** Whether the last point connects back to the first */
+        bool closed;
+
+        Contour() : closed(false) {}
+    };
+
+private:
+    /** Vertex positions (world space) */
+    std::vector<Vec3> _verts;
+    /** The two vertices of each (undirected) edge */
+    std::vector<std::pair<Uint32, Uint32>> _edges;
+    /** The three vertices of each face */
+    std::vector<Uint32> _faceVerts;
+    /** The three edges of each face */
+    std::vector<Uint32> _faceEdges;
+    /** Start of the faces adjacent to each edge in _edgeFaces (CSR layout) */
+    std::vector<Uint32> _edgeFaceStart;
+    /** The faces adjacent to each edge, see _edgeFaceStart */
+    std::vector<Uint32> _edgeFaces;
+
+    /** The edge buckets for a single angle bin */
+    struct AngleBin {
+        /** The (horizontal) normal at the center of the bin */
+        Vec3 normal;
+        /** The signed distance of the first bucket */
+        double dmin;
+        /** The width of a bucket */
+        double width;
+        /** Start of each bucket in the edges list (CSR layout) */
+        std::vector<Uint32> start;
+        /** The edges registered with each bucket */
+        std::vector<Uint32> edges;
+        /** Edges spanning too many buckets; these are always tested */
+        std::vector<Uint32> wide;
+    };
+
+    /** The angle bins, covering the normal directions in [0, pi) */
+    std::vector<AngleBin> _bins;
+    /** The reference point that bin distances are measured from */
+    Vec3 _center;
+    /** The largest error of a bin distance for any normal inside the bin */
+    double _binError;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty slicer. You must call init before slicing.
+     */
+    PlaneSlicer() : _binError(0) {}
+
+    /**
+     * Builds the adjacency and the angle index for the given mesh.
+     *
+     * @param V     The mesh vertices (one per row)
+     * @param F     The mesh triangles (one per row)
+     * @param bins  The number of angle bins over the half circle
+     *
+     * @return true if the slicer was initialized properly
+     */
+    bool init(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, int bins = SLICER_ANGLE_BINS);
+
+    /**
+     * Returns a newly allocated slicer for the given mesh.
+     *
+     * @param V     The mesh vertices (one per row)
+     * @param F     The mesh triangles (one per row)
+     * @param bins  The number of angle bins over the half circle
+     *
+     * @return a newly allocated slicer for the given mesh
+     */
+    static std::shared_ptr<PlaneSlicer> alloc(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, int bins = SLICER_ANGLE_BINS) {
+        std::shared_ptr<PlaneSlicer> result = std::make_shared<PlaneSlicer>();
+        return (result->init(V, F, bins) ? result : nullptr);
+    }
+
+    /**
+     * Reads a slicer previously saved with write().
+     *
+     * Every index is checked against the array it refers to, so a damaged
+     * file fails here rather than in slice().
+     *
+     * @param reader    The stream positioned at the slicer data
+     *
+     * @return true if the slicer was read properly
+     */
+    bool initWithReader(const std::shared_ptr<BinaryReader>& reader);
+
+    /**
+     * Returns a slicer read from data previously saved with write().
+     *
+     * @param reader    The stream positioned at the slicer data
+     *
+     * @return a slicer read from the stream (or nullptr on failure)
+     */
+    static std::shared_ptr<PlaneSlicer> allocWithReader(const std::shared_ptr<BinaryReader>& reader) {
+        std::shared_ptr<PlaneSlicer> result = std::make_shared<PlaneSlicer>();
+        return (result->initWithReader(reader) ? result : nullptr);
+    }
+
+    /**
+     * Writes the adjacency and the angle index, so they need not be rebuilt
+     *
+     * @param writer    The stream to write to
+     */
+    void write(const std::shared_ptr<BinaryWriter>& writer) const;
+
+#pragma mark Slicing
+    /**
+     * Returns the contours of the mesh cut by the given plane.
+     *
+     * This method does not modify the slicer, so it is safe to call from
+     * several threads at once.
+     *
+     * @param origin    A point on the plane
+     * @param normal    The normal of the plane
+     *
+     * @return the ordered contours of the cut
+     */
+    std::vector<Contour> slice(const Vec3& origin, const Vec3& normal) const;
+
+#pragma mark Attributes
+    /** Returns the number of vertices in the mesh */
+    size_t getVertexCount() const { return _verts.size(); }
+
+    /** Returns the number of unique edges in the mesh */
+    size_t getEdgeCount() const { return _edges.size(); }
+
+    /** Returns the number of faces in the mesh */
+    size_t getFaceCount() const { return _faceVerts.size()/3; }
+
+    /** Returns the approximate memory used by the slicer in bytes */
+    size_t getMemoryUsage() const;
+
+private:
+    /**
+     * Appends the edges that may cross the plane to the candidate list
+     *
+     * @param normal    The (unit) normal of the plane
+     * @param offset    The plane offset (normal.dot(origin))
+     * @param result    The list to store the candidates
+     */
+    void gatherCandidates(const Vec3& normal, double offset, std::vector<Uint32>& result) const;
+};
+
+#endif /* PlaneSlicer_h */
@@ -10,6 +10,7 @@
 #include <cugl/scene2/graph/CUPolygonNode.h>
 #include <cugl/scene2/graph/CUTexturedNode.h>
 #include <cugl/assets/CUAssetManager.h>
+#include <box2d/b2_contact.h>
 
 #define SIGNUM(x)  ((x > 0) - (x < 0))
 
@@ -505,6 +506,70 @@ void PlayerModel::update(float dt) {
     }
 }
 
+/**
+ * Processes the start of a collision involving this character
+ *
+ * This grounds the character when its foot sensor touches something, and
+ * starts the landing animation when the landing sensor does. Collisions
+ * that do not involve this character are ignored.
+ *
+ * @param  contact  The two bodies that collided
+ */
+void PlayerModel::beginContact(b2Contact* contact) {
+    b2Fixture* fix1 = contact->GetFixtureA();
+    b2Fixture* fix2 = contact->GetFixtureB();
+
+    std::string* fd1 = reinterpret_cast<std::string*>(fix1->GetUserData().pointer);
+    std::string* fd2 = reinterpret_cast<std::string*>(fix2->GetUserData().pointer);
+
+    Obstacle* bd1 = reinterpret_cast<Obstacle*>(fix1->GetBody()->GetUserData().pointer);
+    Obstacle* bd2 = reinterpret_cast<Obstacle*>(fix2->GetBody()->GetUserData().pointer);
+
+    // See if we have landed on the ground.
+    if ((&_sensorName == fd2 && this != bd1) || (&_sensorName == fd1 && this != bd2)) {
+        setGrounded(true);
+        startTrackingAirTime = false;
+        timeStuckAtZeroYvelocity = 0.0f;
+        // Could have more than one ground
+        _sensorFixtures.emplace(this == bd1 ? fix2 : fix1);
+    }
+
+    if ((&_landSensorName == fd2 && this != bd1) || (&_landSensorName == fd1 && this != bd2)) {
+        if (getVY() < 0.0f) {
+            setLanding(true);
+        }
+    }
+}
+
+/**
+ * Processes the end of a collision involving this character
+ *
+ * The character is no longer grounded once its foot sensor touches
+ * nothing. This is what prevents double jumping.
+ *
+ * @param  contact  The two bodies that collided
+ */
+void PlayerModel::endContact(b2Contact* contact) {
+    b2Fixture* fix1 = contact->GetFixtureA();
+    b2Fixture* fix2 = contact->GetFixtureB();
+
+    std::string* fd1 = reinterpret_cast<std::string*>(fix1->GetUserData().pointer);
+    std::string* fd2 = reinterpret_cast<std::string*>(fix2->GetUserData().pointer);
+
+    Obstacle* bd1 = reinterpret_cast<Obstacle*>(fix1->GetBody()->GetUserData().pointer);
+    Obstacle* bd2 = reinterpret_cast<Obstacle*>(fix2->GetBody()->GetUserData().pointer);
+
+    if ((&_sensorName == fd2 && this != bd1) || (&_sensorName == fd1 && this != bd2)) {
+        auto it = _sensorFixtures.find(this == bd1 ? fix2 : fix1);
+        if (it != _sensorFixtures.end()) {
+            _sensorFixtures.erase(it);
+        }
+        if (_sensorFixtures.empty()) {
+            setGrounded(false);
+        }
+    }
+}
+
 
 #pragma mark -
 #pragma mark Scene Graph Methods
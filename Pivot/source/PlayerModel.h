@@ -31,6 +31,7 @@
 #include <cugl/physics2/CUBoxObstacle.h>
 #include <cugl/physics2/CUCapsuleObstacle.h>
 #include <cugl/scene2/graph/CUWireNode.h>
+#include <unordered_set>
 
 #pragma mark -
 #pragma mark Drawing Constants
@@ -140,6 +141,8 @@ protected:
     std::string _sensorName;
     /** Reference to the sensor name (since a constant cannot have a pointer) */
     std::string _landSensorName;
+    /** The fixtures under the ground sensor (one entry per contact, as chain fixtures touch with several edges) */
+    std::unordered_multiset<b2Fixture*> _sensorFixtures;
     /** The node for debugging the sensor */
     std::shared_ptr<cugl::scene2::WireNode> _sensorNode;
 
@@ -624,7 +627,26 @@ public:
      */
     void applyForce();
 
+    /**
+     * Processes the start of a collision involving this character
+     *
+     * This grounds the character when its foot sensor touches something, and
+     * starts the landing animation when the landing sensor does. Collisions
+     * that do not involve this character are ignored.
+     *
+     * @param  contact  The two bodies that collided
+     */
+    void beginContact(b2Contact* contact);
 
+    /**
+     * Processes the end of a collision involving this character
+     *
+     * The character is no longer grounded once its foot sensor touches
+     * nothing. This is what prevents double jumping.
+     *
+     * @param  contact  The two bodies that collided
+     */
+    void endContact(b2Contact* contact);
     
 };
 
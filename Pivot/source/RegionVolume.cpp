@@ -0,0 +1,253 @@
+//
+//  RegionVolume.cpp
+//  Pivot
+//
+//  Fast point containment for closed triangle meshes.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "RegionVolume.h"
+#include "BinaryIO.h"
+#include <algorithm>
+
+/** Triangles this close to vertical (in the xy-plane) cannot be hit */
+#define VOLUME_EPSILON  1e-9f
+
+/**
+ * Initializes the volume from a triangle mesh
+ *
+ * @param verts The vertex positions (one per row)
+ * @param faces The vertex indices of each triangle (one per row)
+ *
+ * @return true if the volume was initialized properly
+ */
+bool RegionVolume::init(const Eigen::MatrixXd& verts, const Eigen::MatrixXi& faces) {
+    if (faces.rows() == 0 || faces.cols() != 3 || verts.cols() != 3) {
+        CULogError("Region volume needs a triangle mesh");
+        return false;
+    }
+
+    Uint32 count = (Uint32)faces.rows();
+    std::vector<Vec3> corners(count * 3);
+    std::vector<Vec3> centers(count);
+    for (Uint32 ii = 0; ii < count; ii++) {
+        for (int jj = 0; jj < 3; jj++) {
+            int vert = faces(ii, jj);
+            if (vert < 0 || vert >= verts.rows()) {
+                CULogError("Region volume face %d has an invalid vertex", ii);
+                return false;
+            }
+            corners[ii * 3 + jj] = Vec3(verts(vert, 0), verts(vert, 1), verts(vert, 2));
+        }
+        centers[ii] = (corners[ii * 3] + corners[ii * 3 + 1] + corners[ii * 3 + 2]) / 3;
+    }
+
+    std::vector<Uint32> tris(count);
+    for (Uint32 ii = 0; ii < count; ii++) {
+        tris[ii] = ii;
+    }
+    _nodes.clear();
+    _nodes.reserve(2 * (count / VOLUME_LEAF_SIZE + 1));
+    _corners = std::move(corners);
+    build(tris, centers, 0, count);
+
+    // Reorder the corners so that every leaf is a contiguous range
+    std::vector<Vec3> ordered(count * 3);
+    for (Uint32 ii = 0; ii < count; ii++) {
+        for (int jj = 0; jj < 3; jj++) {
+            ordered[ii * 3 + jj] = _corners[tris[ii] * 3 + jj];
+        }
+    }
+    _corners = std::move(ordered);
+    return true;
+}
+
+/**
+ * Reads a volume previously saved with write()
+ *
+ * The hierarchy is checked so that a damaged file cannot send a query out of
+ * bounds.
+ *
+ * @param reader    The stream positioned at the volume data
+ *
+ * @return true if the volume was read properly
+ */
+bool RegionVolume::initWithReader(const std::shared_ptr<BinaryReader>& reader) {
+    std::vector<Vec3> bounds;
+    std::vector<Uint32> ranges;
+    if (!BinaryIO::readVec3s(reader, _corners) || !BinaryIO::readVec3s(reader, bounds) ||
+        !BinaryIO::readUints(reader, ranges)) {
+        return false;
+    }
+    size_t count = bounds.size() / 2;
+    if (_corners.empty() || _corners.size() % 3 != 0 || count == 0 ||
+        bounds.size() != count * 2 || ranges.size() != count * 2) {
+        return false;
+    }
+
+    // Children always follow their parent, so depths can be found in order
+    std::vector<Uint32> depth(count, 0);
+    _nodes.resize(count);
+    for (size_t ii = 0; ii < count; ii++) {
+        Node& node = _nodes[ii];
+        node.min = bounds[ii * 2];
+        node.max = bounds[ii * 2 + 1];
+        node.start = ranges[ii * 2];
+        node.count = ranges[ii * 2 + 1];
+        bool valid = node.count > 0 ? (size_t)node.start + node.count <= getTriangleCount()
+                                    : node.start > ii + 1 && node.start < count;
+        if (!valid || depth[ii] >= VOLUME_MAX_DEPTH) {
+            return false;
+        }
+        if (node.count == 0) {
+            depth[ii + 1] = depth[node.start] = depth[ii] + 1;
+        }
+    }
+    return true;
+}
+
+/**
+ * Writes the triangles and the hierarchy, so they need not be rebuilt
+ *
+ * @param writer    The stream to write to
+ */
+void RegionVolume::write(const std::shared_ptr<BinaryWriter>& writer) const {
+    std::vector<Vec3> bounds;
+    std::vector<Uint32> ranges;
+    bounds.reserve(_nodes.size() * 2);
+    ranges.reserve(_nodes.size() * 2);
+    for (const Node& node : _nodes) {
+        bounds.push_back(node.min);
+        bounds.push_back(node.max);
+        ranges.push_back(node.start);
+        ranges.push_back(node.count);
+    }
+    BinaryIO::writeVec3s(writer, _corners);
+    BinaryIO::writeVec3s(writer, bounds);
+    BinaryIO::writeUints(writer, ranges);
+}
+
+/**
+ * Builds the subtree over the given triangles
+ *
+ * Internal nodes split at the median centroid along their longest axis.
+ *
+ * @param tris      The triangle order being partitioned
+ * @param centers   The centroid of every triangle
+ * @param begin     The first triangle of the subtree
+ * @param end       One past the last triangle of the subtree
+ *
+ * @return the index of the subtree root
+ */
+Uint32 RegionVolume::build(std::vector<Uint32>& tris, const std::vector<Vec3>& centers, Uint32 begin, Uint32 end) {
+    Uint32 index = (Uint32)_nodes.size();
+    _nodes.emplace_back();
+
+    Vec3 lo = _corners[tris[begin] * 3];
+    Vec3 hi = lo;
+    Vec3 clo = centers[tris[begin]];
+    Vec3 chi = clo;
+    for (Uint32 ii = begin; ii < end; ii++) {
+        for (int jj = 0; jj < 3; jj++) {
+            const Vec3& p = _corners[tris[ii] * 3 + jj];
+            lo.set(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+            hi.set(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+        }
+        const Vec3& c = centers[tris[ii]];
+        clo.set(std::min(clo.x, c.x), std::min(clo.y, c.y), std::min(clo.z, c.z));
+        chi.set(std::max(chi.x, c.x), std::max(chi.y, c.y), std::max(chi.z, c.z));
+    }
+    _nodes[index].min = lo;
+    _nodes[index].max = hi;
+
+    if (end - begin <= VOLUME_LEAF_SIZE) {
+        _nodes[index].start = begin;
+        _nodes[index].count = end - begin;
+        return index;
+    }
+
+    Vec3 extent = chi - clo;
+    int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    Uint32 mid = begin + (end - begin) / 2;
+    std::nth_element(tris.begin() + begin, tris.begin() + mid, tris.begin() + end, [&](Uint32 a, Uint32 b) {
+        const Vec3& ca = centers[a];
+        const Vec3& cb = centers[b];
+        return axis == 0 ? ca.x < cb.x : (axis == 1 ? ca.y < cb.y : ca.z < cb.z);
+    });
+
+    build(tris, centers, begin, mid);
+    Uint32 right = build(tris, centers, mid, end);
+    _nodes[index].start = right;
+    _nodes[index].count = 0;
+    return index;
+}
+
+/**
+ * Returns true if the point is inside the mesh
+ *
+ * @param point The point to test
+ */
+bool RegionVolume::contains(const Vec3& point) const {
+    const Node& root = _nodes.front();
+    if (point.x < root.min.x || point.x > root.max.x || point.y < root.min.y ||
+        point.y > root.max.y || point.z < root.min.z || point.z > root.max.z) {
+        return false;
+    }
+
+    // The tree depth is logarithmic, so a small fixed stack is plenty
+    Uint32 stack[VOLUME_MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    bool inside = false;
+    while (top > 0) {
+        const Node& node = _nodes[stack[--top]];
+        if (point.x < node.min.x || point.x > node.max.x || point.y < node.min.y ||
+            point.y > node.max.y || point.z > node.max.z) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (Uint32 tri = node.start; tri < node.start + node.count; tri++) {
+                if (crosses(point, tri)) {
+                    inside = !inside;
+                }
+            }
+        } else {
+            Uint32 left = (Uint32)(&node - _nodes.data()) + 1;
+            stack[top++] = node.start;
+            stack[top++] = left;
+        }
+    }
+    return inside;
+}
+
+/**
+ * Returns true if the vertical ray from the point crosses the triangle
+ *
+ * This is the Moller-Trumbore test with the direction fixed to +z.
+ *
+ * @param point The ray origin
+ * @param tri   The triangle index
+ */
+bool RegionVolume::crosses(const Vec3& point, Uint32 tri) const {
+    const Vec3& v0 = _corners[tri * 3];
+    Vec3 e1 = _corners[tri * 3 + 1] - v0;
+    Vec3 e2 = _corners[tri * 3 + 2] - v0;
+    // p = (0,0,1) x e2
+    float det = e1.y * e2.x - e1.x * e2.y;
+    if (std::abs(det) < VOLUME_EPSILON) {
+        return false;
+    }
+    float inv = 1.0f / det;
+    Vec3 s = point - v0;
+    float u = (s.y * e2.x - s.x * e2.y) * inv;
+    if (u < 0 || u > 1) {
+        return false;
+    }
+    Vec3 q = s.getCross(e1);
+    float v = q.z * inv;
+    if (v < 0 || u + v > 1) {
+        return false;
+    }
+    return e2.dot(q) * inv >= 0;
+}
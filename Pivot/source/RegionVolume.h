@@ -0,0 +1,160 @@
+//
+//  RegionVolume.h
+//  Pivot
+//
+//  Fast point containment for closed triangle meshes. The triangles are put in
+//  a bounding volume hierarchy when the level is loaded, so that a query only
+//  visits the triangles that sit directly above the point.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef RegionVolume_h
+#define RegionVolume_h
+#include <cugl/cugl.h>
+#include <Eigen/Core>
+#include <vector>
+
+using namespace cugl;
+
+/** The most triangles kept in a single leaf of the hierarchy */
+#define VOLUME_LEAF_SIZE    4
+/** The deepest hierarchy a volume may have (far more than any mesh needs) */
+#define VOLUME_MAX_DEPTH    48
+
+/**
+ * A closed triangle mesh prepared for point containment queries.
+ *
+ * A point is inside if a ray cast from it along +z crosses the surface an odd
+ * number of times (the same parity test as PivotMesh::containsPoint). As the
+ * ray is vertical, a node of the hierarchy can only be hit if the point lies
+ * inside its xy bounds and below its top, so most of the tree is never
+ * visited. Points outside the bounding box are rejected before the tree.
+ *
+ * The nodes are stored in a flat array in depth first order. An internal node
+ * is always followed by its left child, so only the right child is recorded.
+ */
+class RegionVolume {
+private:
+    /** A node of the hierarchy */
+    struct Node {
+        /** The lower corner of the node bounds */
+        Vec3 min;
+        /** The upper corner of the node bounds */
+        Vec3 max;
+        /** The first triangle (leaf) or the right child (internal) */
+        Uint32 start;
+        /** The number of triangles (0 for an internal node) */
+        Uint32 count;
+    };
+
+    /** The three corners of each triangle, reordered to match the leaves */
+    std::vector<Vec3> _corners;
+    /** The nodes of the hierarchy (the root is first) */
+    std::vector<Node> _nodes;
+
+    /**
+     * Builds the subtree over the given triangles
+     *
+     * @param tris      The triangle order being partitioned
+     * @param centers   The centroid of every triangle
+     * @param begin     The first triangle of the subtree
+     * @param end       One past the last triangle of the subtree
+     *
+     * @return the index of the subtree root
+     */
+    Uint32 build(std::vector<Uint32>& tris, const std::vector<Vec3>& centers, Uint32 begin, Uint32 end);
+
+    /**
+     * Returns true if the vertical ray from the point crosses the triangle
+     *
+     * @param point The ray origin
+     * @param tri   The triangle index
+     */
+    bool crosses(const Vec3& point, Uint32 tri) const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty volume. You must call init before using it.
+     */
+    RegionVolume() {}
+
+    /**
+     * Initializes the volume from a triangle mesh
+     *
+     * @param verts The vertex positions (one per row)
+     * @param faces The vertex indices of each triangle (one per row)
+     *
+     * @return true if the volume was initialized properly
+     */
+    bool init(const Eigen::MatrixXd& verts, const Eigen::MatrixXi& faces);
+
+    /**
+     * Returns a newly allocated volume for the triangle mesh
+     *
+     * @param verts The vertex positions (one per row)
+     * @param faces The vertex indices of each triangle (one per row)
+     *
+     * @return a newly allocated volume for the triangle mesh
+     */
+    static std::shared_ptr<RegionVolume> alloc(const Eigen::MatrixXd& verts, const Eigen::MatrixXi& faces) {
+        std::shared_ptr<RegionVolume> result = std::make_shared<RegionVolume>();
+        return (result->init(verts, faces) ? result : nullptr);
+    }
+
+    /**
+     * Reads a volume previously saved with write()
+     *
+     * @param reader    The stream positioned at the volume data
+     *
+     * @return true if the volume was read properly
+     */
+    bool initWithReader(const std::shared_ptr<BinaryReader>& reader);
+
+    /**
+     * Returns a volume read from data previously saved with write()
+     *
+     * @param reader    The stream positioned at the volume data
+     *
+     * @return a volume read from the stream (or nullptr on failure)
+     */
+    static std::shared_ptr<RegionVolume> allocWithReader(const std::shared_ptr<BinaryReader>& reader) {
+        std::shared_ptr<RegionVolume> result = std::make_shared<RegionVolume>();
+        return (result->initWithReader(reader) ? result : nullptr);
+    }
+
+    /**
+     * Writes the triangles and the hierarchy, so they need not be rebuilt
+     *
+     * @param writer    The stream to write to
+     */
+    void write(const std::shared_ptr<BinaryWriter>& writer) const;
+
+#pragma mark Queries
+    /**
+     * Returns true if the point is inside the mesh
+     *
+     * @param point The point to test
+     */
+    bool contains(const Vec3& point) const;
+
+    /** Returns the lower corner of the mesh bounds */
+    const Vec3& getMin() const { return _nodes.front().min; }
+
+    /** Returns the upper corner of the mesh bounds */
+    const Vec3& getMax() const { return _nodes.front().max; }
+
+    /** Returns the number of triangles in the mesh */
+    size_t getTriangleCount() const { return _corners.size() / 3; }
+
+    /** Returns the number of nodes in the hierarchy */
+    size_t getNodeCount() const { return _nodes.size(); }
+
+    /** Returns the approximate memory used by the volume in bytes */
+    size_t getMemoryUsage() const {
+        return sizeof(RegionVolume) + _corners.capacity() * sizeof(Vec3) + _nodes.capacity() * sizeof(Node);
+    }
+};
+
+#endif /* RegionVolume_h */
@@ -12,12 +12,31 @@
 
 using namespace cugl;
 
+/** The profiler names of the timed passes, in drawing order */
+static const char* PASS_NAMES[RenderPipeline::PASS_COUNT] = {
+    "RenderPipeline::visibility", "RenderPipeline::textures", "RenderPipeline::mesh", "RenderPipeline::billboard",
+    "RenderPipeline::position", "RenderPipeline::pointlights", "RenderPipeline::cut", "RenderPipeline::fog",
+    "RenderPipeline::behind", "RenderPipeline::screen"
+};
+
 RenderPipeline::RenderPipeline(int screenWidth, const Size& displaySize, const std::shared_ptr<AssetManager>& assets) : screenSize(displaySize* (screenWidth / displaySize.width)) {
 
     // For cut texture transform
     storePlayerPos = Vec2(0, 0);
     prevPlayerPos = Vec2(0, 0);
 
+    // Pass timing
+    profiling = false;
+    passFrames = 0;
+    std::fill(passMicros, passMicros + PASS_COUNT, 0);
+    std::fill(passCulled, passCulled + PASS_COUNT, 0);
+    passTriangles = 0;
+
+    // Level mesh culling
+    _meshTriangles = 0;
+    _levelTriangles = 0;
+    _levelFrames = 0;
+
     // FBO setup
     fbo = std::make_shared<RenderTarget>();
     fbofinal = std::make_shared<RenderTarget>();
@@ -29,6 +48,15 @@ RenderPipeline::RenderPipeline(int screenWidth, const Size& displaySize, const s
     fbopos->init(screenSize.width, screenSize.height, {cugl::Texture::PixelFormat::RGBA16F});
     fbopos->setClearColor(Color4f::WHITE);
 
+    // Light culling setup
+    _lightGrid = LightGrid::alloc(screenSize);
+    _lightTex = Texture::alloc(2 * LIGHT_MAX, 1, Texture::PixelFormat::RGBA32F);
+    _tileTex = Texture::alloc(LIGHT_TEX_WIDTH, _lightGrid->getTileTexRows(), Texture::PixelFormat::RGBA32F);
+    for (auto& tex : { _lightTex, _tileTex }) {
+        tex->setMinFilter(GL_NEAREST);
+        tex->setMagFilter(GL_NEAREST);
+    }
+
     // Camera setup
 	_camera = OrthographicCamera::alloc(screenSize);
     _camera->setFar(farPlaneDist);
@@ -60,82 +88,98 @@ void RenderPipeline::constructShaders() {
     _shader->setUniformMat4("uPerspective", _camera->getCombined());
     _vertbuff = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuff->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuff->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuff->setupAttribute("aNormal", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, normal));
+        PivotVertex3::offset(&PivotVertex3::normal));
     _vertbuff->attach(_shader);
+    _meshBuffer = MeshBuffer::alloc(std::make_shared<VertexBufferDevice>(_vertbuff));
 
     // Billboard shader
     _shaderBill = Shader::alloc(SHADER(billboardVert), SHADER(billboardFrag));
     _shaderBill->setUniformMat4("uPerspective", _camera->getCombined());
     _vertbuffBill = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffBill->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffBill->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffBill->attach(_shaderBill);
 
     // Position shader
     _shaderPosition = Shader::alloc(SHADER(positionVert), SHADER(positionFrag));
-    _vertbuffPosition = VertexBuffer::alloc(sizeof(PivotVertex3));
+    _vertbuffPosition = VertexBuffer::allocWithBuffer(_vertbuffBill);
     _vertbuffPosition->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffPosition->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffPosition->attach(_shaderPosition);
 
+    // Position shader on the level geometry (no second upload)
+    _vertbuffPositionMesh = VertexBuffer::allocWithBuffer(_vertbuff);
+    _vertbuffPositionMesh->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
+        PivotVertex3::offset(&PivotVertex3::position));
+    _vertbuffPositionMesh->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
+        PivotVertex3::offset(&PivotVertex3::texcoord));
+    _vertbuffPositionMesh->attach(_shaderPosition);
+
     // Pointlight shader
     _shaderPointlight = Shader::alloc(SHADER(pointlightVert), SHADER(pointlightFrag));
     _vertbuffPointlight = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffPointlight->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffPointlight->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffPointlight->attach(_shaderPointlight);
 
     // Cut shader
     _shaderCut = Shader::alloc(SHADER(cutVert), SHADER(cutFrag));
     _vertbuffCut = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffCut->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffCut->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffCut->attach(_shaderCut);
 
     // Fog shader
     _shaderFog = Shader::alloc(SHADER(fogVert), SHADER(fogFrag));
     _vertbuffFog = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffFog->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffFog->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffFog->attach(_shaderFog);
 
     // Behind shader
     _shaderBehind = Shader::alloc(SHADER(behindVert), SHADER(behindFrag));
     _vertbuffBehind = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffBehind->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffBehind->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffBehind->attach(_shaderBehind);
 
     // Screen shader
     _shaderScreen = Shader::alloc(SHADER(screenVert), SHADER(screenFrag));
     _vertbuffScreen = VertexBuffer::alloc(sizeof(PivotVertex3));
     _vertbuffScreen->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, position));
+        PivotVertex3::offset(&PivotVertex3::position));
     _vertbuffScreen->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-        offsetof(PivotVertex3, texcoord));
+        PivotVertex3::offset(&PivotVertex3::texcoord));
     _vertbuffScreen->attach(_shaderScreen);
 }
 
 void RenderPipeline::sceneSetup(const std::shared_ptr<GameModel>& model) {
 
-    // Get mesh
-    _mesh = *model->getRenderMesh();
+    // Upload mesh (only if the level geometry changed)
+    if (model->getRenderMesh() != _meshBuffer->getMesh()) {
+        reportMeshCulling();
+    }
+    std::shared_ptr<MeshChunks> chunks = model->getRenderMesh() == nullptr ? nullptr : model->getRenderMesh()->getChunks();
+    if (_meshBuffer->setMesh(model->getRenderMesh()) && chunks != nullptr) {
+        CULog("Level mesh has %zu triangles in %zu chunks (%dx%dx%d grid)", chunks->getTriangleCount(), chunks->getChunks().size(),
+              chunks->getDimension(0), chunks->getDimension(1), chunks->getDimension(2));
+    }
 
     // Add all FSQ-like vertices
     _meshFsq.clear();
@@ -156,6 +200,14 @@ void RenderPipeline::sceneSetup(const std::shared_ptr<GameModel>& model) {
             _meshFsq.indices.push_back(tri + i);
         }
     }
+
+    // Upload FSQ to the screen space passes
+    for (auto& buff : { _vertbuffPointlight, _vertbuffCut, _vertbuffFog, _vertbuffScreen }) {
+        buff->bind();
+        buff->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size(), GL_STATIC_DRAW);
+        buff->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size(), GL_STATIC_DRAW);
+        buff->unbind();
+    }
 }
 
 void RenderPipeline::billboardSetup(const std::shared_ptr<GameModel>& model) {
@@ -164,33 +216,33 @@ void RenderPipeline::billboardSetup(const std::shared_ptr<GameModel>& model) {
 
     // Player and exit
     std::shared_ptr<Texture> charSheet = model->_player->currentSpriteSheet->getTexture();
-    drawables.push_back(DrawObject(model->getPlayer3DLoc(), charSheet, model->_player->currentNormalSpriteSheet->getTexture(), true, model->_player->currentSpriteSheet, false, 1.0));
+    drawables.push_back(DrawObject(model->getPlayerRenderLoc(), charSheet, model->_player->currentNormalSpriteSheet->getTexture(), true, model->_player->currentSpriteSheet, false, 1.0));
     drawables.push_back(DrawObject(model->_exit->getPosition(), model->_exit->rotateSpriteSheet->getTexture(), NULL, false, model->_exit->rotateSpriteSheet, true, 1.0));
 
     // Collectibles
-    std::map<std::string, Collectible> colls = model->getCollectibles();
-    for (std::pair<std::string, Collectible> c : colls) {
-        if (!c.second.getCollected()) {
-            drawables.push_back(DrawObject(c.second.getPosition(), c.second.rotateSpriteSheet->getTexture(), NULL, false, c.second.rotateSpriteSheet, true, c.second.getScale()));
+    const ItemStore& colls = model->_collectibles;
+    for (size_t ii = 0; ii < colls.size(); ii++) {
+        if (!colls.isCollected(ii)) {
+            const std::shared_ptr<SpriteSheet>& sheet = colls.getSheet(ii);
+            drawables.push_back(DrawObject(colls.getPosition(ii), sheet->getTexture(), NULL, false, sheet, true, colls.getScale(ii)));
         }
     }
 
     // Glowsticks
-    for (Glowstick g : model->_glowsticks) {
-        drawables.push_back(DrawObject(g.getPosition(), g.rotateSpriteSheet->getTexture(), g.getNorm(), false, g.rotateSpriteSheet, true, 1.0));
+    const ItemStore& glows = model->_glowsticks;
+    for (size_t ii = 0; ii < glows.size(); ii++) {
+        const std::shared_ptr<SpriteSheet>& sheet = glows.getSheet(ii);
+        drawables.push_back(DrawObject(glows.getPosition(ii), sheet->getTexture(), NULL, false, sheet, true, 1.0));
     }
 
-    // Decorations
-    auto decor = model->getDecorations();
-     for (auto d : decor) {
-         drawables.push_back(DrawObject(d->getPosition(), d->rotateSpriteSheet->getTexture(), d->isEmissive() ? NULL : d->rotateNormalSpriteSheet->getTexture(), false, d->rotateSpriteSheet, false, d->getScale()));
-     }
-
-     // Posters
-     auto posters = model->_posters;
-     for (auto p : posters) {
-         drawables.push_back(DrawObject(p->getPosition(), p->rotateSpriteSheet->getTexture(), p->isEmissive() ? NULL : p->rotateNormalSpriteSheet->getTexture(), false, p->rotateSpriteSheet, false, p->getScale(), p->getNormal()));
-     }
+    // Decorations and posters (posters are oriented by their normal)
+    for (const ItemStore* items : { &model->_decorations, &model->_posters }) {
+        for (size_t ii = 0; ii < items->size(); ii++) {
+            const std::shared_ptr<SpriteSheet>& sheet = items->getSheet(ii);
+            std::shared_ptr<Texture> normal = items->isEmissive(ii) ? NULL : items->getNormalSheet(ii)->getTexture();
+            drawables.push_back(DrawObject(items->getPosition(ii), sheet->getTexture(), normal, false, sheet, false, items->getScale(ii), items->getNormal(ii)));
+        }
+    }
 
     // Set bind points
     const int bindStart = 9;
@@ -210,47 +262,62 @@ void RenderPipeline::billboardSetup(const std::shared_ptr<GameModel>& model) {
     }
 }
 
-bool RenderPipeline::constructBillMesh(const std::shared_ptr<GameModel>& model, const RenderPipeline::DrawObject& dro) {
+void RenderPipeline::constructBillMesh(const DrawObject& dro) {
 
     _meshBill.vertices.clear();
-    Size sz = dro.tex->getSize();
-    int div = 4;
-    PivotVertex3 tempV;
-    bool visible = false;
-    for (float i = -sz.width / (2 * div); i <= sz.width / (2 * div); i += sz.width / div) {
-        for (float j = -sz.height / (2 * div); j <= sz.height / (2 * div); j += sz.height / div) {
-            Vec3 addOn;
-            if (dro.isPoster) {
-                Vec3 newBasisRight = dro.posterNormal.getCross(basisUp);
-                addOn = (i * newBasisRight + j * basisUp) * dro.scale;
-            } else {
-                addOn = (i * basisRight + j * basisUp) * dro.scale;
-            }
-            tempV.texcoord = Vec2(i > 0 ? 1 : 0, j > 0 ? 0 : 1);
-            if (dro.sheet != NULL) {
-                // assuming the spritesheet has square dimensions
-                addOn /= dro.sheet->getDimen().first;
-                tempV.texcoord.x += dro.sheet->getFrameCoords().first - 1;
-                tempV.texcoord.y += dro.sheet->getFrameCoords().second - 1;
-                tempV.texcoord.x /= dro.sheet->getDimen().first;
-                tempV.texcoord.y /= dro.sheet->getDimen().second;
-            }
-            tempV.position = dro.pos + addOn;
-            Vec3 windowCoords = _camera->project(tempV.position);
-            if (windowCoords.x > 0.0f && windowCoords.x < 2.5 * screenSize.width) {
-                visible = true;
-            }
-            _meshBill.vertices.push_back(tempV);
+    BillboardBatch::buildQuad(dro, basisRight, basisUp, _meshBill.vertices);
+}
+
+void RenderPipeline::cullSetup(const std::shared_ptr<GameModel>& model) {
+
+    // The slab runs from the faded billboards behind the plane to the far plane,
+    // and the orthographic camera sees its viewport shrunk by the zoom
+    Size extent = _camera->getViewport().size / _camera->getZoom();
+    _visibility.setView(model->getPlayerRenderLoc(), _camera->getDirection(), basisRight, basisUp, extent, cutoff, farPlaneDist);
+    _visibility.cull(drawables);
+
+    // The camera clips the level mesh at its own position, just in front of the plane
+    std::shared_ptr<MeshChunks> chunks = _meshBuffer->getMesh() == nullptr ? nullptr : _meshBuffer->getMesh()->getChunks();
+    if (chunks != nullptr) {
+        _meshTriangles = chunks->cull([this](const Vec3& min, const Vec3& max) {
+            return _visibility.intersects(min, max, -epsilon, farPlaneDist);
+        }, _meshRanges);
+    } else {
+        _meshRanges.clear();
+        _meshRanges.push_back({ 0, (Uint32)_meshBuffer->getIndexCount() });
+        _meshTriangles = _meshBuffer->getIndexCount() / 3;
+    }
+    _levelTriangles += _meshTriangles;
+    _levelFrames++;
+    CU_PROFILE_COUNT("RenderPipeline::mesh triangles", _meshTriangles);
+    CU_PROFILE_COUNT("RenderPipeline::culled billboards", _visibility.getCulled(FrameVisibility::FRONT));
+
+    if (profiling) {
+        for (int pass = 0; pass < PASS_COUNT; pass++) {
+            passCulled[pass] += getCulledCount((Pass)pass);
         }
+        passTriangles += _meshTriangles;
     }
-    return visible;
+}
+
+void RenderPipeline::reportMeshCulling() {
+    if (_levelFrames > 0 && _meshBuffer->getIndexCount() > 0) {
+        size_t total = _meshBuffer->getIndexCount() / 3;
+        double drawn = (double)_levelTriangles / _levelFrames;
+        CULog("Level mesh drew %.0f of %zu triangles per frame over %d frames (%.1f%% culled)",
+              drawn, total, _levelFrames, 100.0 * (1.0 - drawn / total));
+    }
+    _levelTriangles = 0;
+    _levelFrames = 0;
 }
 
 void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
+    CU_PROFILE_SCOPE("RenderPipeline::render");
+    passStart.mark();
 
     // Update camera
     Vec3 n = model->getPlaneNorm();
-    const Vec3 charPos = model->getPlayer3DLoc();
+    const Vec3 charPos = model->getPlayerRenderLoc();
     const Vec3 camPos = charPos + (epsilon * n);
     _camera->setPosition(camPos);
     _camera->setDirection(-n);
@@ -261,8 +328,13 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     basisUp = _camera->getUp();
     basisRight = model->getPlaneNorm().cross(basisUp);
 
-    // Setup billboards
+    // --------------- Visibility --------------- //
+    // Setup billboards, and cull them once for every pass
     billboardSetup(model);
+    cullSetup(model);
+    _billBatch.build(drawables, _visibility.getList(FrameVisibility::FRONT), basisRight, basisUp, !model->_player->isFacingRight());
+
+    endPass(PASS_VISIBILITY);
 
     // --------------- Pass 0: Textures --------------- //
     // Calculate voronoi angle
@@ -290,6 +362,8 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     fbofinal->getTexture()->setBindPoint(6);
     fbopos->getTexture(0)->setBindPoint(7);
     model->backgroundPic->setBindPoint(8);
+    _lightTex->setBindPoint(11);
+    _tileTex->setBindPoint(12);
 
     // Cut texture translation
     if (model->_justFinishRotating) {
@@ -300,6 +374,8 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     transOffset.x /= (screenSize.width / 2);
     transOffset.y /= (screenSize.height / 2);
 
+    endPass(PASS_TEXTURES);
+
     // --------------- Pass 1: Mesh --------------- //
     // OpenGL Blending
     glBlendFunc(GL_ONE, GL_ZERO);
@@ -314,87 +390,100 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     _shader->setUniform1i("uTexture", cobbleTex->getBindPoint());
     _shader->setUniformVec3("uDirection", n);
     _shader->setUniform1f("farPlaneDist", farPlaneDist);
-    _vertbuff->loadVertexData(_mesh.vertices.data(), (int)_mesh.vertices.size());
-    _vertbuff->loadIndexData(_mesh.indices.data(), (int)_mesh.indices.size());
-    _vertbuff->draw(GL_TRIANGLES, (int)_mesh.indices.size(), 0);
+    for (const MeshChunks::Range& range : _meshRanges) {
+        _vertbuff->draw(GL_TRIANGLES, range.count, range.offset);
+    }
 
     // Unbinding
     cobbleTex->unbind();
     _vertbuff->unbind();
 
+    endPass(PASS_MESH);
+
     // --------------- Pass 2: Billboard --------------- //
 
     // Binding
     _vertbuffBill->bind();
+    _vertbuffBill->loadVertexData(_billBatch.getVertices().data(), (int)_billBatch.getVertices().size());
+    _vertbuffBill->loadIndexData(_billBatch.getIndices().data(), (int)_billBatch.getIndices().size());
 
-    for (DrawObject dro : drawables) {
-        // Construct vertices to be placed in the mesh
-        if (!constructBillMesh(model, dro)) continue;
-
-        // Set uniforms and draw individual billboard
-        dro.tex->bind();
-        if (dro.normalMap != NULL) dro.normalMap->bind();
-        _shaderBill->setUniformMat4("uPerspective", _camera->getCombined());
-        _shaderBill->setUniform1i("flipXvert", dro.isPlayer && !model->_player->isFacingRight() ? 1 : 0);
-        _shaderBill->setUniform1f("farPlaneDist", farPlaneDist);
-        _shaderBill->setUniform1i("billTex", dro.tex->getBindPoint());
-        _shaderBill->setUniform1i("flipXfrag", dro.isPlayer && !model->_player->isFacingRight() ? 1 : 0);
-        _shaderBill->setUniformVec3("uDirection", n);
-        _shaderBill->setUniformVec3("campos", _camera->getPosition());
+    // Set shared uniforms
+    _shaderBill->setUniformMat4("uPerspective", _camera->getCombined());
+    _shaderBill->setUniform1f("farPlaneDist", farPlaneDist);
+    _shaderBill->setUniformVec3("uDirection", n);
+    _shaderBill->setUniformVec3("campos", _camera->getPosition());
+
+    // Draw one group at a time, only binding textures that changed
+    std::shared_ptr<Texture> boundTex;
+    std::shared_ptr<Texture> boundNorm;
+    for (const BillboardBatch::Group& group : _billBatch.getGroups()) {
+        if (group.tex != boundTex) {
+            group.tex->bind();
+            boundTex = group.tex;
+        }
+        if (group.normalMap != NULL && group.normalMap != boundNorm) {
+            group.normalMap->bind();
+            boundNorm = group.normalMap;
+        }
+        _shaderBill->setUniform1i("flipXvert", group.flip ? 1 : 0);
+        _shaderBill->setUniform1i("billTex", group.tex->getBindPoint());
+        _shaderBill->setUniform1i("flipXfrag", group.flip ? 1 : 0);
         _shaderBill->setUniform1i("useNormTex", 0);
-        _shaderBill->setUniform1i("doLighting", dro.emission ? 0 : 1);
-        if (dro.normalMap != NULL) {
-            _shaderBill->setUniform1i("normTex", dro.normalMap->getBindPoint());
+        _shaderBill->setUniform1i("doLighting", group.emission() ? 0 : 1);
+        if (group.normalMap != NULL) {
+            _shaderBill->setUniform1i("normTex", group.normalMap->getBindPoint());
             _shaderBill->setUniform1i("useNormTex", 1);
         }
-        _vertbuffBill->loadVertexData(_meshBill.vertices.data(), (int)_meshBill.vertices.size());
-        _vertbuffBill->loadIndexData(_meshBill.indices.data(), (int)_meshBill.indices.size());
-        _vertbuffBill->draw(GL_TRIANGLES, (int)_meshBill.indices.size(), 0);
-        if (dro.normalMap != NULL) dro.normalMap->unbind();
-        dro.tex->unbind();
+        _vertbuffBill->draw(GL_TRIANGLES, group.count, group.offset);
     }
+    if (boundNorm != NULL) boundNorm->unbind();
+    if (boundTex != NULL) boundTex->unbind();
 
     // Unbinding
     fbo->end();
     _vertbuffBill->unbind();
 
+    endPass(PASS_BILLBOARD);
+
     // --------------- Pass 3: Position --------------- //
     // OpenGL Blending
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Binding
-    _vertbuffPosition->bind();
+    _vertbuffPositionMesh->bind();
     fbopos->begin();
 
     // Set uniforms and draw mesh
     _shaderPosition->setUniform1i("isBillboard", 0);
     _shaderPosition->setUniformMat4("uPerspective", _camera->getCombined());
     _shaderPosition->setUniform1i("flipXvert", 0);
-    _vertbuffPosition->loadVertexData(_mesh.vertices.data(), (int)_mesh.vertices.size());
-    _vertbuffPosition->loadIndexData(_mesh.indices.data(), (int)_mesh.indices.size());
-    _vertbuffPosition->draw(GL_TRIANGLES, (int)_mesh.indices.size(), 0);
-
-    for (DrawObject dro : drawables) {
-        if (dro.emission) continue;
-        // Construct vertices to be placed in the mesh
-        if (!constructBillMesh(model, dro)) continue;
+    for (const MeshChunks::Range& range : _meshRanges) {
+        _vertbuffPositionMesh->draw(GL_TRIANGLES, range.count, range.offset);
+    }
+    _vertbuffPositionMesh->unbind();
 
-        // Set uniforms and draw individual billboard
-        dro.tex->bind();
-        _shaderPosition->setUniform1i("isBillboard", 1);
-        _shaderPosition->setUniformMat4("uPerspective", _camera->getCombined());
-        _shaderPosition->setUniform1i("billTex", dro.tex->getBindPoint());
-        _shaderPosition->setUniform1i("flipXvert", dro.isPlayer && !model->_player->isFacingRight() ? 1 : 0);
-        _vertbuffPosition->loadVertexData(_meshBill.vertices.data(), (int)_meshBill.vertices.size());
-        _vertbuffPosition->loadIndexData(_meshBill.indices.data(), (int)_meshBill.indices.size());
-        _vertbuffPosition->draw(GL_TRIANGLES, (int)_meshBill.indices.size(), 0);
-        dro.tex->unbind();
+    // Draw billboards (already uploaded by the billboard pass)
+    _vertbuffPosition->bind();
+    _shaderPosition->setUniform1i("isBillboard", 1);
+    boundTex = nullptr;
+    for (const BillboardBatch::Group& group : _billBatch.getGroups()) {
+        if (group.emission()) continue;
+        if (group.tex != boundTex) {
+            group.tex->bind();
+            boundTex = group.tex;
+        }
+        _shaderPosition->setUniform1i("billTex", group.tex->getBindPoint());
+        _shaderPosition->setUniform1i("flipXvert", group.flip ? 1 : 0);
+        _vertbuffPosition->draw(GL_TRIANGLES, group.count, group.offset);
     }
+    if (boundTex != NULL) boundTex->unbind();
 
     // Unbinding
     fbopos->end();
     _vertbuffPosition->unbind();
 
+    endPass(PASS_POSITION);
+
     // --------------- Pass 4: Pointlights --------------- //
     // OpenGL Blending
     glDisable(GL_DEPTH_TEST);
@@ -408,60 +497,67 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     fbo->getTexture(fboNormal)->bind();
     fbopos->getTexture()->bind();
 
-    // Set uniforms and draw
-    const float numLights = model->_lights.size() + model->_lightsFromItems.size();
-    _shaderPointlight->setUniform1f("numLights", numLights);
-    _shaderPointlight->setUniform1i("albedoTexture", fbo->getTexture(fboAlbedo)->getBindPoint());
-    _shaderPointlight->setUniform1i("replaceTexture", fbo->getTexture(fboReplace)->getBindPoint());
-    _shaderPointlight->setUniform1i("normalTexture", fbo->getTexture(fboNormal)->getBindPoint());
-    _shaderPointlight->setUniform1i("posTexture", fbopos->getTexture()->getBindPoint());
-    _shaderPointlight->setUniform3f("vpos", _camera->getPosition().x, _camera->getPosition().y, _camera->getPosition().z); // for specular only
-    _shaderPointlight->setUniformMat4("Mv", _camera->getView()); // for specular only
-    for (GameModel::Light &l : model->_lights) {
-        _shaderPointlight->setUniform3f("color", l.color.x, l.color.y, l.color.z);
-        _shaderPointlight->setUniform3f("lpos", l.loc.x, l.loc.y, l.loc.z);
+    // Bin lights into screen tiles
+    _lightGrid->clear();
+    float time = model->_currentTime->ellapsedMillis(*model->_pixelInTime);
+    auto addLight = [&](const GameModel::Light& l) {
         float effectivePower = 1.0;
         if (l.pulse > 0.0) {
             const float minEff = .4;
             float xFac = 2 * M_PI / l.pulse;
-            float time = model->_currentTime->ellapsedMillis(*model->_pixelInTime);
             effectivePower = (std::cos(xFac * time) + 1.0) / 2.0;
             effectivePower = effectivePower * (1.0 - minEff) + minEff;
         }
-        _shaderPointlight->setUniform1f("effectivePower", effectivePower);
-        _shaderPointlight->setUniform1f("power", l.intensity);
-        _shaderPointlight->setUniform1f("attenuation", l.falloff);
-        _vertbuffPointlight->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size());
-        _vertbuffPointlight->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size());
-        _vertbuffPointlight->draw(GL_TRIANGLES, (int)_meshFsq.indices.size(), 0);
+        _lightGrid->addLight(l.loc, l.color, l.intensity * effectivePower);
+    };
+    for (const GameModel::Light& l : model->_lights) {
+        addLight(l);
     }
-    for (auto p : model->_lightsFromItems) {
-        GameModel::Light &l = p.second;
-        _shaderPointlight->setUniform3f("color", l.color.x, l.color.y, l.color.z);
-        _shaderPointlight->setUniform3f("lpos", l.loc.x, l.loc.y, l.loc.z);
-        float effectivePower = 1.0;
-        if (l.pulse > 0.0) {
-            const float minEff = .4;
-            float xFac = 2 * M_PI / l.pulse;
-            float time = model->_currentTime->ellapsedMillis(*model->_pixelInTime);
-            effectivePower = (std::cos(xFac * time) + 1.0) / 2.0;
-            effectivePower = effectivePower * (1.0 - minEff) + minEff;
+    const ItemStore& glows = model->_glowsticks;
+    for (size_t ii = 0; ii < glows.size(); ii++) {
+        if (glows.hasLight(ii)) {
+            addLight(GameModel::Light(glows.getColor(ii), glows.getIntensity(ii), glows.getPosition(ii), glows.getRadius(ii), glows.getPulse(ii)));
         }
-        _shaderPointlight->setUniform1f("effectivePower", effectivePower);
-        _shaderPointlight->setUniform1f("power", l.intensity);
-        _shaderPointlight->setUniform1f("attenuation", l.falloff);
-        _vertbuffPointlight->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size());
-        _vertbuffPointlight->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size());
+    }
+    _lightGrid->bin(_camera->getCombined(), basisRight, basisUp);
+
+    // Upload the light lists (only the rows in use)
+    _lightTex->bind();
+    _tileTex->bind();
+    if (_lightGrid->getLightCount() > 0) {
+        glActiveTexture(GL_TEXTURE0 + _lightTex->getBindPoint());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)_lightGrid->getLightCount() * 2, 1, GL_RGBA, GL_FLOAT, _lightGrid->getLightTexels().data());
+    }
+    glActiveTexture(GL_TEXTURE0 + _tileTex->getBindPoint());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_TEX_WIDTH, (GLsizei)_lightGrid->getTileTexels().size() / (4 * LIGHT_TEX_WIDTH), GL_RGBA, GL_FLOAT, _lightGrid->getTileTexels().data());
+
+    // Set uniforms and draw all lights at once (emissive pixels need at least one light)
+    _shaderPointlight->setUniform1i("albedoTexture", fbo->getTexture(fboAlbedo)->getBindPoint());
+    _shaderPointlight->setUniform1i("replaceTexture", fbo->getTexture(fboReplace)->getBindPoint());
+    _shaderPointlight->setUniform1i("normalTexture", fbo->getTexture(fboNormal)->getBindPoint());
+    _shaderPointlight->setUniform1i("posTexture", fbopos->getTexture()->getBindPoint());
+    _shaderPointlight->setUniform1i("lightTexture", _lightTex->getBindPoint());
+    _shaderPointlight->setUniform1i("tileTexture", _tileTex->getBindPoint());
+    _shaderPointlight->setUniform1i("tileSize", _lightGrid->getTileSize());
+    _shaderPointlight->setUniform1i("tileCols", _lightGrid->getCols());
+    _shaderPointlight->setUniform1i("tileCount", _lightGrid->getCols() * _lightGrid->getRows());
+    _shaderPointlight->setUniform3f("vpos", _camera->getPosition().x, _camera->getPosition().y, _camera->getPosition().z); // for specular only
+    _shaderPointlight->setUniformMat4("Mv", _camera->getView()); // for specular only
+    if (!model->_lights.empty() || !model->_glowsticks.empty()) {
         _vertbuffPointlight->draw(GL_TRIANGLES, (int)_meshFsq.indices.size(), 0);
     }
 
     // Unbinding
+    _tileTex->unbind();
+    _lightTex->unbind();
     fbopos->getTexture()->unbind();
     fbo->getTexture(fboAlbedo)->unbind();
     fbo->getTexture(fboReplace)->unbind();
     fbo->getTexture(fboNormal)->unbind();
     _vertbuffPointlight->unbind();
 
+    endPass(PASS_POINTLIGHTS);
+
     // --------------- Pass 5: Cut --------------- //
     // OpenGL Blending
     glDisable(GL_DEPTH_TEST);
@@ -503,8 +599,6 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     _shaderCut->setUniform4f("ambientLight", model->ambientLight.r, model->ambientLight.g, model->ambientLight.b, model->ambientLight.a);
     _shaderCut->setUniform3f("cutColor", model->cutFillColor.r, model->cutFillColor.g, model->cutFillColor.b);
     _shaderCut->setUniform3f("outlineColor", model->cutLineColor.r, model->cutLineColor.g, model->cutLineColor.b);
-    _vertbuffCut->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size());
-    _vertbuffCut->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size());
     _vertbuffCut->draw(GL_TRIANGLES, (int)_meshFsq.indices.size(), 0);
 
     // Unbinding
@@ -515,6 +609,8 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     fbo->getTexture(fboDepth)->unbind();
     _vertbuffCut->unbind();
 
+    endPass(PASS_CUT);
+
     // --------------- Pass 6: Fog --------------- //
 
     // Binding
@@ -528,8 +624,6 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     _shaderFog->setUniform1i("depthTexture", fbo->getTexture(fboDepth)->getBindPoint());
     _shaderFog->setUniform3f("fadeCol", model->shadeColor.r, model->shadeColor.g, model->shadeColor.b);
     _shaderFog->setUniform1f("severity", model->shadeDepth);
-    _vertbuffFog->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size());
-    _vertbuffFog->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size());
     _vertbuffFog->draw(GL_TRIANGLES, (int)_meshFsq.indices.size(), 0);
 
     // Unbinding
@@ -537,30 +631,27 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     fbo->getTexture(fboDepth)->unbind();
     _vertbuffFog->unbind();
 
+    endPass(PASS_FOG);
+
     // --------------- Pass 7: Stripped Billboards --------------- //
 
     // Binding
     _vertbuffBehind->bind();
     fbo->getTexture(fboReplace)->bind();
 
-    // Stripped Billboards
+    // Stripped Billboards (only those between cutoff and the plane, see FrameVisibility)
     fbo->getTexture(fboReplace)->bind();
-    for (DrawObject dro : drawables) {
-        if (dro.isPlayer || !dro.fade) continue;
+    for (Uint32 ii : _visibility.getList(FrameVisibility::BEHIND)) {
+        DrawObject dro = drawables[ii];
         // Calculate distance from plane
-        float distance = -n.dot(dro.pos - charPos);
-
-        // If 0 < distance <= -c, then we will want to draw
-        if (distance >= 0 || distance <= cutoff) continue;
+        float distance = _visibility.getDepth(dro.pos);
         float alpha = (1.0 - (distance / cutoff)) * .75;
 
         // Change the drawObject position to be reflected along the plane
-        Vec3 oldPos = dro.pos;
         dro.pos = dro.pos + ((1 + epsilon) * distance * n);
 
         // Construct vertices to be placed in the mesh
-        if (!constructBillMesh(model, dro)) continue;
-        dro.pos = oldPos;
+        constructBillMesh(dro);
 
         // Set uniforms and draw individual billboard
         dro.tex->bind();
@@ -581,6 +672,8 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
 
     fbofinal->end();
 
+    endPass(PASS_BEHIND);
+
     // --------------- Pass 8: Screen --------------- //
     // OpenGL Blending
     glEnable(GL_DEPTH_TEST);
@@ -615,11 +708,74 @@ void RenderPipeline::render(const std::shared_ptr<GameModel>& model) {
     _shaderScreen->setUniform1f("pixelFrac", pixelFrac);
     _shaderScreen->setUniform1f("tr", tr);
     _shaderScreen->setUniformVec2("screenSize", Vec2(screenSize.width, screenSize.height));
-    _vertbuffScreen->loadVertexData(_meshFsq.vertices.data(), (int)_meshFsq.vertices.size());
-    _vertbuffScreen->loadIndexData(_meshFsq.indices.data(), (int)_meshFsq.indices.size());
     _vertbuffScreen->draw(GL_TRIANGLES, (int)_meshFsq.indices.size(), 0);
 
     // Unbinding
     fbofinal->getTexture()->unbind();
     _vertbuffScreen->unbind();
+    endPass(PASS_SCREEN);
+}
+
+void RenderPipeline::setProfiling(bool value) {
+    profiling = value;
+    passFrames = 0;
+    std::fill(passMicros, passMicros + PASS_COUNT, 0);
+    std::fill(passCulled, passCulled + PASS_COUNT, 0);
+    passTriangles = 0;
+}
+
+double RenderPipeline::getPassTime(Pass pass) const {
+    return passFrames > 0 ? (double)passMicros[pass] / passFrames : 0;
+}
+
+size_t RenderPipeline::getCulledCount(Pass pass) const {
+    switch (pass) {
+        case PASS_BILLBOARD:
+        case PASS_POSITION:
+            return _visibility.getCulled(FrameVisibility::FRONT);
+        case PASS_BEHIND:
+            return _visibility.getCulled(FrameVisibility::BEHIND);
+        default:
+            return 0;
+    }
+}
+
+size_t RenderPipeline::getCulledTriangles() const {
+    return _meshBuffer->getIndexCount() / 3 - std::min(_meshTriangles, _meshBuffer->getIndexCount() / 3);
+}
+
+void RenderPipeline::endPass(Pass pass) {
+#ifdef CU_PROFILING
+    // The frame profiler sees the submission times unless the passes are profiled too
+    if (!profiling) {
+        Timestamp now;
+        CU_PROFILE_SPAN(PASS_NAMES[pass], passStart, now);
+        passStart = now;
+        return;
+    }
+#endif
+    if (!profiling) return;
+
+    // Wait for the GPU, otherwise we only time the command submission
+    glFinish();
+    Timestamp now;
+    passMicros[pass] += Timestamp::ellapsedMicros(passStart, now);
+    CU_PROFILE_SPAN(PASS_NAMES[pass], passStart, now);
+    passStart = now;
+    if (pass != PASS_SCREEN) return;
+
+    // Report the averages once the window is full
+    if (++passFrames < passReportFrames) return;
+    CULog("Pass us: visibility %.1f, textures %.1f, mesh %.1f, billboard %.1f, position %.1f, pointlights %.1f, cut %.1f, fog %.1f, behind %.1f, screen %.1f (mesh uploads %llu)",
+          getPassTime(PASS_VISIBILITY), getPassTime(PASS_TEXTURES), getPassTime(PASS_MESH), getPassTime(PASS_BILLBOARD),
+          getPassTime(PASS_POSITION), getPassTime(PASS_POINTLIGHTS), getPassTime(PASS_CUT), getPassTime(PASS_FOG),
+          getPassTime(PASS_BEHIND), getPassTime(PASS_SCREEN), (unsigned long long)_meshBuffer->getUploads());
+    CULog("Pass culled billboards: billboard %.1f, position %.1f, behind %.1f (of %zu); mesh triangles drawn %.0f (of %zu)",
+          (double)passCulled[PASS_BILLBOARD] / passFrames, (double)passCulled[PASS_POSITION] / passFrames,
+          (double)passCulled[PASS_BEHIND] / passFrames, drawables.size(),
+          (double)passTriangles / passFrames, _meshBuffer->getIndexCount() / 3);
+    passFrames = 0;
+    std::fill(passMicros, passMicros + PASS_COUNT, 0);
+    std::fill(passCulled, passCulled + PASS_COUNT, 0);
+    passTriangles = 0;
 }
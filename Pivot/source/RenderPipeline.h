@@ -12,37 +12,28 @@
 #include <cugl/cugl.h>
 #include "GameModel.h"
 #include "Mesh.h"
+#include "MeshBuffer.h"
+#include "BillboardBatch.h"
+#include "FrameVisibility.h"
+#include "LightGrid.h"
 
 class RenderPipeline {
 public:
-	// An abstraction to draw billboards
-	struct DrawObject {
-		Vec3 pos;
-		std::shared_ptr<cugl::Texture> tex;
-		std::shared_ptr<cugl::Texture> normalMap;
-		std::shared_ptr<cugl::SpriteSheet> sheet;
-		bool isPlayer;
-		bool emission;
-		bool fade;
-		bool isPoster;
-		float scale;
-		Vec3 posterNormal;
-
-		DrawObject(Vec3 pos, std::shared_ptr<cugl::Texture> tex, std::shared_ptr<cugl::Texture> normalMap, bool isPlayer, std::shared_ptr<cugl::SpriteSheet> sheet, bool fade, float scale,  Vec3 posterNormal = Vec3(0, 0, 0)) {
-			this->pos = pos;
-			this->tex = tex;
-			this->normalMap = normalMap;
-			this->isPlayer = isPlayer;
-			this->emission = normalMap == NULL;
-			this->sheet = sheet;
-			this->fade = fade;
-			this->isPoster = posterNormal != Vec3(0, 0, 0);
-			this->scale = scale;
-			this->posterNormal = posterNormal;
-		}
+	// The timed passes, in drawing order
+	enum Pass {
+		PASS_VISIBILITY,
+		PASS_TEXTURES,
+		PASS_MESH,
+		PASS_BILLBOARD,
+		PASS_POSITION,
+		PASS_POINTLIGHTS,
+		PASS_CUT,
+		PASS_FOG,
+		PASS_BEHIND,
+		PASS_SCREEN,
+		PASS_COUNT
 	};
 
-public:
 	const std::string meshVert =
 #include "shaders/mesh.vert"
 	;
@@ -101,6 +92,7 @@ public:
 	const int fboDepth = 3;
 	const Size screenSize;
 	const float cutoff = -30.0; // negative number, more negative = further behind can be shown
+	const int passReportFrames = 300; // frames averaged per pass timing report
 
 	// Camera
 	std::shared_ptr<cugl::OrthographicCamera> _camera;
@@ -118,7 +110,8 @@ public:
 	// Buffers
 	std::shared_ptr<cugl::VertexBuffer> _vertbuff;
 	std::shared_ptr<cugl::VertexBuffer> _vertbuffBill;
-	std::shared_ptr<cugl::VertexBuffer> _vertbuffPosition;
+	std::shared_ptr<cugl::VertexBuffer> _vertbuffPosition; // shares the data of _vertbuffBill
+	std::shared_ptr<cugl::VertexBuffer> _vertbuffPositionMesh; // shares the data of _vertbuff
 	std::shared_ptr<cugl::VertexBuffer> _vertbuffPointlight;
 	std::shared_ptr<cugl::VertexBuffer> _vertbuffCut;
 	std::shared_ptr<cugl::VertexBuffer> _vertbuffFog;
@@ -126,7 +119,8 @@ public:
 	std::shared_ptr<cugl::VertexBuffer> _vertbuffScreen;
 
 	// Meshes
-	cugl::Mesh<PivotVertex3> _mesh;
+	std::shared_ptr<MeshBuffer> _meshBuffer; // level geometry, resident in _vertbuff
+	BillboardBatch _billBatch; // billboards of the current frame, streamed to _vertbuffBill
 	cugl::Mesh<PivotVertex3> _meshBill;
 	cugl::Mesh<PivotVertex3> _meshFsq;
 
@@ -138,9 +132,21 @@ public:
 	// Textures
 	std::shared_ptr<Texture> cobbleTex;
 	std::shared_ptr<Texture> earthTex;
+	std::shared_ptr<Texture> _lightTex; // light data for the lighting pass
+	std::shared_ptr<Texture> _tileTex; // per-tile light lists for the lighting pass
 	std::vector<DrawObject> drawables;
 	std::vector<std::shared_ptr<Texture>> backgrounds;
 
+	// Light culling
+	std::shared_ptr<LightGrid> _lightGrid;
+
+	// Billboard and level mesh culling, shared by every pass
+	FrameVisibility _visibility;
+	std::vector<MeshChunks::Range> _meshRanges; // index ranges of the level mesh to draw this frame
+	size_t _meshTriangles; // triangles of the level mesh drawn this frame
+	Uint64 _levelTriangles; // triangles drawn since the level mesh was set
+	int _levelFrames; // frames drawn since the level mesh was set
+
 	// Replace texture translation variables
 	Vec2 prevPlayerPos;
 	Vec2 storePlayerPos;
@@ -149,6 +155,14 @@ public:
 	Vec3 basisUp;
 	Vec3 basisRight;
 
+	// Pass timing
+	bool profiling;
+	Timestamp passStart;
+	Uint64 passMicros[PASS_COUNT];
+	Uint64 passCulled[PASS_COUNT];
+	Uint64 passTriangles;
+	int passFrames;
+
 	/**
 	 * Construct the RenderPipeline
 	 */
@@ -170,14 +184,56 @@ public:
 	void billboardSetup(const std::shared_ptr<GameModel>& model);
 
 	/**
-	 * Sets up the mesh to draw one drawable. Returns true if the billboard is visible on-screen (regardless of depth), and false otherwise.
+	 * Sets up the mesh to draw one drawable
+	 */
+	void constructBillMesh(const DrawObject& dro);
+
+	/**
+	 * Sets the view of the visibility stage and culls the billboards and level mesh chunks against it
 	 */
-	bool constructBillMesh(const std::shared_ptr<GameModel>& model, const DrawObject& dro);
+	void cullSetup(const std::shared_ptr<GameModel>& model);
 	
 	/**
 	 * Renders a given gamemodel
 	 */
 	void render(const std::shared_ptr<GameModel>& model);
+
+	/**
+	 * Sets whether to time each pass. While profiling, every pass waits for the GPU
+	 * to finish so the times include the GPU work, and the averages are logged
+	 * every passReportFrames frames.
+	 */
+	void setProfiling(bool value);
+
+	/**
+	 * Returns the average time of the given pass in microseconds over the current
+	 * report window (0 if not profiling)
+	 */
+	double getPassTime(Pass pass) const;
+
+	/**
+	 * Returns the number of billboards the visibility stage culled from the given
+	 * pass in the last frame (0 for the passes that do not draw billboards)
+	 */
+	size_t getCulledCount(Pass pass) const;
+
+	/**
+	 * Returns the number of level mesh triangles the visibility stage culled from the
+	 * mesh and position passes in the last frame
+	 */
+	size_t getCulledTriangles() const;
+
+private:
+	/**
+	 * Ends the timing of the given pass, and starts the timing of the next one.
+	 * The pass is also recorded as a span of the frame profiler (if compiled in).
+	 */
+	void endPass(Pass pass);
+
+	/**
+	 * Logs how much of the current level mesh the chunks culled on average, and starts counting again
+	 */
+	void reportMeshCulling();
 };
 
 #endif /* RenderPipeline_h */
@@ -0,0 +1,477 @@
+//
+//  Simulation.cpp
+//  Pivot
+//
+//  A headless run of the gameplay, driven by recorded input.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "Simulation.h"
+#include "DataController.h"
+#include <algorithm>
+
+/** The FNV-1a offset basis */
+#define HASH_OFFSET 0xcbf29ce484222325ULL
+/** The FNV-1a prime */
+#define HASH_PRIME  0x100000001b3ULL
+
+/**
+ * Reads a point from a JSON array
+ *
+ * @param json  The JSON array
+ */
+static Vec3 jsonVec3(const std::shared_ptr<JsonValue>& json) {
+    return Vec3(json->get(0)->asFloat(), json->get(1)->asFloat(), json->get(2)->asFloat());
+}
+
+/**
+ * Adds the bytes of a value to an FNV-1a hash
+ *
+ * @param hash  The hash to update
+ * @param data  The value
+ * @param size  The size of the value in bytes
+ */
+static void hashBytes(Uint64& hash, const void* data, size_t size) {
+    const Uint8* bytes = static_cast<const Uint8*>(data);
+    for (size_t ii = 0; ii < size; ii++) {
+        hash ^= bytes[ii];
+        hash *= HASH_PRIME;
+    }
+}
+
+/** Adds a plain value to an FNV-1a hash */
+template <typename T>
+static void hashValue(Uint64& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(T));
+}
+
+/** Adds a string to an FNV-1a hash */
+static void hashString(Uint64& hash, const std::string& value) {
+    hashValue(hash, (Uint32)value.size());
+    hashBytes(hash, value.data(), value.size());
+}
+
+/**
+ * Returns the directory with a trailing path separator
+ *
+ * @param dir   The directory (or empty)
+ */
+static std::string asDirectory(const std::string& dir) {
+    if (dir.empty() || dir.back() == '/' || dir.back() == '\\') {
+        return dir;
+    }
+    return dir + "/";
+}
+
+#pragma mark Constructors
+/**
+ * Disposes the model, plane and physics of this simulation
+ */
+void Simulation::dispose() {
+    if (_plane != nullptr) {
+        _plane->cancelCuts();
+    }
+    _logic = nullptr;
+    _plane = nullptr;
+    _physics = nullptr;
+    _model = nullptr;
+    _data = nullptr;
+    _json = nullptr;
+    _timings.clear();
+}
+
+/**
+ * Initializes the simulation at the start of a level
+ *
+ * This sets up the model as DataController and GameplayController::load do,
+ * but without any textures or scene graph nodes.
+ *
+ * @param level The level key (as in assets.json)
+ * @param json  The level JSON
+ * @param data  The loaded level
+ * @param step  The length of a physics step in seconds
+ *
+ * @return true if the simulation was initialized properly
+ */
+bool Simulation::init(const std::string& level, const std::shared_ptr<JsonValue>& json,
+                      const std::shared_ptr<LevelData>& data, float step) {
+    if (json == nullptr || data == nullptr || step <= 0) {
+        return false;
+    }
+    _level = level;
+    _json = json;
+    _data = data;
+    _step = step;
+    _deaths = 0;
+    _timings.clear();
+
+    _model = std::make_shared<GameModel>();
+    _model->setName(json->getString("level_id"));
+    _model->_colMesh = data->getColMesh();
+    DataController::loadCutCache(json, _model);
+
+    float height = SIM_PLAYER_HEIGHT/CAP_SCALE;
+    _model->setPlayer(PlayerModel::alloc(Vec2::ZERO, Size(height/WIDTH_SCALE, height)));
+
+    Vec3 playerLoc = jsonVec3(json->get("player_loc"));
+    _model->setInitPlayerLoc(playerLoc);
+    _model->setPlayer3DLoc(playerLoc);
+    _model->setInitPlaneNorm(jsonVec3(json->get("norm")));
+    _model->setExit(std::make_shared<GameItem>(jsonVec3(json->get("exit")), "exit"));
+    _model->_numGlowsticks = json->getInt("glowsticks");
+
+    std::unordered_set<std::string> expected;
+    for (const LevelData::Sprite& sprite : data->getSprites()) {
+        if (sprite.is(LevelData::SPRITE_COLLECTIBLE)) {
+            std::string key = std::to_string(expected.size());
+            _model->_collectibles.add(sprite.loc, nullptr, nullptr, 0, 1, key);
+            expected.insert(key);
+        }
+    }
+    _model->setExpectedCol(expected);
+    DataController::loadTriggers(data, _model);
+
+    _physics = std::make_shared<PhysicsController>();
+    _physics->init(Size(DEFAULT_WIDTH, DEFAULT_HEIGHT), Rect(0, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT), DEFAULT_WIDTH);
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    _physics->getWorld()->onBeginContact = [=](b2Contact* contact) {
+        player->beginContact(contact);
+    };
+    _physics->getWorld()->onEndContact = [=](b2Contact* contact) {
+        player->endContact(contact);
+    };
+    _physics->getWorld()->addObstacle(player);
+
+    _plane = std::make_shared<PlaneController>();
+    _logic = LogicController::alloc(_model, _plane, _physics);
+    _plane->init(_model);
+    _plane->prewarmCuts();
+    _plane->calculateCut();
+    _logic->createCutObstacles();
+    _physics->update(0);
+    return true;
+}
+
+#pragma mark Gameplay
+/**
+ * Plays one frame of input
+ *
+ * Frames played after the level is complete are ignored, as the game
+ * stops taking input once the player reaches the exit.
+ *
+ * @param frame The frame input
+ */
+void Simulation::step(const InputFrame& frame) {
+    if (isComplete()) {
+        return;
+    }
+
+    FrameTiming timing;
+    timing.fill(0);
+    _logic->trackStuck();
+
+    bool physics = true;
+    if (frame.playing) {
+        Timestamp start;
+        _deaths += _logic->respawnIfDead() ? 1 : 0;
+        _deaths += _logic->respawnIfStuck() ? 1 : 0;
+        Timestamp alive;
+        physics = updatePlane(frame);
+        Timestamp plane;
+        updateLogic(frame, physics);
+        Timestamp logic;
+        timing[PLANE] = Timestamp::ellapsedMicros(alive, plane);
+        timing[LOGIC] = Timestamp::ellapsedMicros(start, alive) + Timestamp::ellapsedMicros(plane, logic);
+    }
+
+    // As in GameplayController::fixedUpdate, the input forces go in before
+    // every step and the position is read back after it
+    for (Uint32 ii = 0; physics && ii < frame.steps; ii++) {
+        Timestamp start;
+        if (frame.playing) {
+            _logic->applyInput();
+        }
+        _physics->update(_step);
+        Timestamp stepped;
+        _logic->updatePlayer3DLoc();
+        if (frame.playing) {
+            _logic->updateTriggers();
+        }
+        Timestamp triggers;
+        if (frame.playing) {
+            _logic->collect();
+            _logic->checkExit();
+        }
+        Timestamp collected;
+        timing[PHYSICS] += Timestamp::ellapsedMicros(start, stepped);
+        timing[TRIGGERS] += Timestamp::ellapsedMicros(stepped, triggers);
+        timing[LOGIC] += Timestamp::ellapsedMicros(triggers, collected);
+    }
+    _timings.push_back(timing);
+}
+
+/**
+ * Rotates the plane, or recuts the level when a rotation ends
+ *
+ * The player can only rotate the plane while grounded. The physics pauses
+ * while the plane turns, and the world is rebuilt from the new cut (computed
+ * in the background where possible) once the rotation ends.
+ *
+ * @param frame The frame input
+ *
+ * @return true if the physics should run this frame
+ */
+bool Simulation::updatePlane(const InputFrame& frame) {
+    if (frame.rotating && _logic->rotate(frame.rotate)) {
+        return false;
+    }
+    _logic->finishRotation();
+    return true;
+}
+
+/**
+ * Applies the frame input to the player and the glowsticks
+ *
+ * This follows the order of GameplayController::update, so that a death or
+ * a glowstick are handled on the same frame as in the game. The player
+ * forces are only applied by the physics steps.
+ *
+ * @param frame     The frame input
+ * @param physics   Whether the physics runs this frame
+ */
+void Simulation::updateLogic(const InputFrame& frame, bool physics) {
+    if (frame.glowstick) {
+        _logic->useGlowstick();
+    }
+    _logic->setInput(frame.horizontal, frame.jump, frame.run, physics);
+}
+
+/**
+ * Returns a hash of the gameplay state
+ *
+ * This covers the player position, velocity and 3D location, the plane,
+ * the collected items, the glowsticks, the death count, the trigger
+ * popups and messages, and whether the level is complete.
+ */
+Uint64 Simulation::getStateHash() const {
+    Uint64 hash = HASH_OFFSET;
+    if (_model == nullptr) {
+        return hash;
+    }
+    std::shared_ptr<PlayerModel> player = _model->_player;
+    hashValue(hash, player->getPosition());
+    hashValue(hash, player->getLinearVelocity());
+    hashValue(hash, _model->getPlayer3DLoc());
+    hashValue(hash, _model->getPlaneNorm());
+    hashValue(hash, _model->getPlaneOrigin());
+
+    // The backpack is unordered, so hash it in key order
+    std::vector<std::string> backpack(_model->_backpack.begin(), _model->_backpack.end());
+    std::sort(backpack.begin(), backpack.end());
+    hashValue(hash, (Uint32)backpack.size());
+    for (const std::string& key : backpack) {
+        hashString(hash, key);
+    }
+
+    hashValue(hash, (Uint32)_model->_glowsticks.size());
+    for (const Vec3& pos : _model->_glowsticks.getPositions()) {
+        hashValue(hash, pos);
+    }
+    hashValue(hash, _deaths);
+    hashValue(hash, (Uint32)_model->_popup->getState());
+    hashValue(hash, (Uint32)_model->_messages->getState());
+    hashString(hash, _model->_messages->getText());
+    hashValue(hash, (Uint8)isComplete());
+    return hash;
+}
+
+/**
+ * Returns the name of a subsystem
+ *
+ * @param system    The subsystem
+ */
+const char* Simulation::getSubsystemName(Subsystem system) {
+    switch (system) {
+        case PLANE:
+            return "plane";
+        case LOGIC:
+            return "logic";
+        case TRIGGERS:
+            return "triggers";
+        case PHYSICS:
+            return "physics";
+        default:
+            return "unknown";
+    }
+}
+
+#pragma mark Harness
+/**
+ * Returns the input of a scripted run, for levels with no recording
+ *
+ * The player walks and runs back and forth, jumping regularly, turns the
+ * plane a little every few seconds and drops a glowstick now and then.
+ * The physics steps follow SIM_FIXED_RATE at SIM_FRAME_RATE frames a
+ * second.
+ *
+ * @param frames    The number of frames to play
+ */
+std::vector<InputFrame> Simulation::scriptInput(Uint32 frames) {
+    std::vector<InputFrame> result(frames);
+    for (Uint32 ii = 0; ii < frames; ii++) {
+        InputFrame& frame = result[ii];
+        frame.steps = ((ii + 1) * SIM_FIXED_RATE) / SIM_FRAME_RATE - (ii * SIM_FIXED_RATE) / SIM_FRAME_RATE;
+        if (ii < SIM_SCRIPT_SETTLE) {
+            frame.playing = false;
+            continue;
+        }
+
+        Uint32 time = ii - SIM_SCRIPT_SETTLE;
+        Uint32 phase = time % (4 * SIM_FRAME_RATE);
+        if (phase < SIM_FRAME_RATE / 2) {
+            // turn the plane a quarter of a degree a frame for half a second
+            frame.rotating = true;
+            frame.rotate = (time / (4 * SIM_FRAME_RATE)) % 2 ? -M_PI/720 : M_PI/720;
+        } else {
+            frame.horizontal = (time / (2 * SIM_FRAME_RATE)) % 2 ? -1.0f : 1.0f;
+            frame.run = (time / (8 * SIM_FRAME_RATE)) % 2 == 1;
+            frame.jump = time % SIM_FRAME_RATE == SIM_FRAME_RATE / 2;
+        }
+        frame.glowstick = time % (10 * SIM_FRAME_RATE) == 5 * SIM_FRAME_RATE;
+    }
+    return result;
+}
+
+/**
+ * Plays every level listed in json/assets.json twice and checks that both
+ * runs end in the same state
+ *
+ * @param assetDir  The asset directory, ending in a path separator
+ * @param replayDir The recording directory (or empty for none)
+ * @param timingDir The directory to write the timings to (or empty for none)
+ *
+ * @return the number of levels that failed to load or diverged
+ */
+int Simulation::runAll(const std::string& assetDir, const std::string& replayDir, const std::string& timingDir) {
+    LevelData::setAssetDirectory(asDirectory(assetDir));
+    std::shared_ptr<JsonReader> reader = JsonReader::alloc(filetool::normalize_path(asDirectory(assetDir) + "json/assets.json"));
+    std::shared_ptr<JsonValue> assets = reader == nullptr ? nullptr : reader->readJson();
+    if (assets == nullptr || !assets->has("jsons")) {
+        CULogError("Could not read the asset directory %s", assetDir.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    int levels = 0;
+    std::shared_ptr<JsonValue> jsons = assets->get("jsons");
+    for (size_t i = 0; i < jsons->size(); i++) {
+        std::shared_ptr<JsonValue> entry = jsons->get(i);
+        std::string level = entry->key();
+        std::shared_ptr<JsonReader> levelReader = JsonReader::alloc(filetool::normalize_path(asDirectory(assetDir) + entry->asString()));
+        std::shared_ptr<JsonValue> json = levelReader == nullptr ? nullptr : levelReader->readJson();
+        if (json == nullptr || !json->has("render_mesh") || !json->has("collision_mesh")) {
+            continue;
+        }
+        levels++;
+
+        std::shared_ptr<LevelData> data = LevelData::allocWithBinary(LevelData::getBinaryPath(level), json);
+        if (data == nullptr) {
+            data = LevelData::allocWithJson(json);
+        }
+
+        std::shared_ptr<InputRecording> recording;
+        if (!replayDir.empty()) {
+            std::string file = filetool::normalize_path(asDirectory(replayDir) + InputRecording::getFileName(level));
+            if (filetool::file_exists(file)) {
+                recording = InputRecording::allocWithFile(file);
+            }
+        }
+        std::vector<InputFrame> frames = recording != nullptr ? recording->getFrames() : scriptInput(SIM_SCRIPT_FRAMES);
+        float step = recording != nullptr ? recording->getStepSize() : 1.0f/SIM_FIXED_RATE;
+
+        // Play it twice; any difference means the gameplay is not deterministic
+        Uint64 hashes[2] = { 0, 0 };
+        std::shared_ptr<Simulation> sim;
+        for (int run = 0; run < 2; run++) {
+            sim = Simulation::alloc(level, json, data, step);
+            if (sim == nullptr) {
+                break;
+            }
+            for (const InputFrame& frame : frames) {
+                sim->step(frame);
+            }
+            hashes[run] = sim->getStateHash();
+        }
+        if (sim == nullptr) {
+            CULogError("%s: could not start the level", level.c_str());
+            failures++;
+            continue;
+        }
+
+        bool same = hashes[0] == hashes[1];
+        if (!same) {
+            failures++;
+        }
+        CULog("%s: %zu %s frames, hash %016llx%s, %u deaths%s", level.c_str(), frames.size(),
+              recording != nullptr ? "recorded" : "scripted", (unsigned long long)hashes[1],
+              same ? "" : " (DIVERGED)", sim->getDeaths(), sim->isComplete() ? ", complete" : "");
+
+        const std::vector<FrameTiming>& timings = sim->getTimings();
+        for (int system = 0; system < SUBSYSTEM_COUNT; system++) {
+            Uint64 total = 0;
+            Uint64 worst = 0;
+            for (const FrameTiming& timing : timings) {
+                total += timing[system];
+                worst = std::max(worst, timing[system]);
+            }
+            CULog("  %-8s mean %7.1f us, max %7llu us", getSubsystemName((Subsystem)system),
+                  timings.empty() ? 0.0 : (double)total / timings.size(), (unsigned long long)worst);
+        }
+
+        if (!timingDir.empty()) {
+            std::string file = filetool::normalize_path(asDirectory(timingDir) + level + ".csv");
+            std::shared_ptr<TextWriter> writer = TextWriter::alloc(file);
+            if (writer == nullptr) {
+                CULogError("Could not write %s", file.c_str());
+                continue;
+            }
+            std::string line = "frame";
+            for (int system = 0; system < SUBSYSTEM_COUNT; system++) {
+                line += std::string(",") + getSubsystemName((Subsystem)system);
+            }
+            writer->writeLine(line);
+            for (size_t ii = 0; ii < timings.size(); ii++) {
+                line = std::to_string(ii);
+                for (int system = 0; system < SUBSYSTEM_COUNT; system++) {
+                    line += "," + std::to_string(timings[ii][system]);
+                }
+                writer->writeLine(line);
+            }
+            writer->close();
+        }
+    }
+    CULog("Simulated %d levels, %d failed", levels, failures);
+    return failures;
+}
+
+/**
+ * Runs the harness from the command line
+ *
+ * The arguments are the asset directory, then optionally the replay
+ * directory and the timing directory.
+ *
+ * @param argc  The number of arguments
+ * @param argv  The arguments (the first is the program)
+ *
+ * @return 0 if every level replayed deterministically, 1 otherwise
+ */
+int Simulation::main(int argc, char* argv[]) {
+    if (argc < 2) {
+        CULogError("usage: %s <asset dir> [replay dir] [timing dir]", argc > 0 ? argv[0] : "pivot");
+        return 1;
+    }
+    std::string replayDir = argc > 2 ? argv[2] : "";
+    std::string timingDir = argc > 3 ? argv[3] : "";
+    return runAll(argv[1], replayDir, timingDir) == 0 ? 0 : 1;
+}
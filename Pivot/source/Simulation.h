@@ -0,0 +1,238 @@
+//
+//  Simulation.h
+//  Pivot
+//
+//  A headless run of the gameplay: the model, plane, physics, collectibles,
+//  glowsticks and triggers, driven by recorded input, with no graphics, sound
+//  or scene graph. When the game is built with PIVOT_HEADLESS, main runs this
+//  over every level instead of starting the application, so it can time the
+//  gameplay systems and check that a replay always ends in the same state.
+//  The CMake build makes this as the PivotSim target (see README.md).
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef Simulation_h
+#define Simulation_h
+#include <cugl/cugl.h>
+#include <array>
+#include <string>
+#include <vector>
+#include "GameModel.h"
+#include "LevelData.h"
+#include "PlaneController.h"
+#include "PhysicsController.h"
+#include "LogicController.h"
+#include "InputRecording.h"
+
+/** The number of frames played on a level with no recording */
+#define SIM_SCRIPT_FRAMES   1800
+/** The number of frames a scripted run lets the player fall before playing */
+#define SIM_SCRIPT_SETTLE   30
+/** The frame rate of a scripted run */
+#define SIM_FRAME_RATE      60
+/** The physics rate of a scripted run (as set by PivotApp) */
+#define SIM_FIXED_RATE      80
+/** The height of the player image, which sizes the player capsule */
+#define SIM_PLAYER_HEIGHT   128.0f
+
+/**
+ * The gameplay of a single level, without an application.
+ *
+ * Each call to step plays one frame the way GameplayController::update and
+ * fixedUpdate do once the level has faded in, through the LogicController
+ * they share: the plane rotation and cut, the player input and glowsticks,
+ * and then the recorded physics steps, each followed by the triggers and
+ * collectibles. Everything that only affects what is drawn or heard is left
+ * out.
+ *
+ * Each subsystem is timed every frame, and getStateHash summarizes the end
+ * state. As the input is recorded rather than polled, the same recording must
+ * always produce the same hash.
+ */
+class Simulation {
+public:
+    /** The timed parts of a frame */
+    enum Subsystem {
+        /** Rotating the plane and cutting the level */
+        PLANE,
+        /** Player control, collectibles, the exit and glowsticks */
+        LOGIC,
+        /** Trigger regions */
+        TRIGGERS,
+        /** The physics steps */
+        PHYSICS,
+        /** The number of subsystems */
+        SUBSYSTEM_COUNT
+    };
+
+    /** The time spent in each subsystem during a frame, in microseconds */
+    typedef std::array<Uint64, SUBSYSTEM_COUNT> FrameTiming;
+
+private:
+    /** The level key (as in assets.json) */
+    std::string _level;
+    /** The level JSON */
+    std::shared_ptr<JsonValue> _json;
+    /** The loaded level */
+    std::shared_ptr<LevelData> _data;
+    /** The gameplay state */
+    std::shared_ptr<GameModel> _model;
+    /** The plane and its cuts */
+    std::shared_ptr<PlaneController> _plane;
+    /** The physics world */
+    std::shared_ptr<PhysicsController> _physics;
+    /** The rules of play (shared with GameplayController) */
+    std::shared_ptr<LogicController> _logic;
+    /** The length of a physics step in seconds */
+    float _step;
+    /** The number of times the player died or got stuck */
+    Uint32 _deaths;
+    /** The subsystem times of every frame played */
+    std::vector<FrameTiming> _timings;
+
+    /**
+     * Rotates the plane, or recuts the level when a rotation ends
+     *
+     * @param frame The frame input
+     *
+     * @return true if the physics should run this frame
+     */
+    bool updatePlane(const InputFrame& frame);
+
+    /**
+     * Applies the frame input to the player and the glowsticks
+     *
+     * @param frame     The frame input
+     * @param physics   Whether the physics runs this frame
+     */
+    void updateLogic(const InputFrame& frame, bool physics);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty simulation. You must call init before using it.
+     */
+    Simulation() : _step(0), _deaths(0) {}
+
+    /**
+     * Deletes this simulation, disposing all resources
+     */
+    ~Simulation() { dispose(); }
+
+    /**
+     * Disposes the model, plane and physics of this simulation
+     */
+    void dispose();
+
+    /**
+     * Initializes the simulation at the start of a level
+     *
+     * @param level The level key (as in assets.json)
+     * @param json  The level JSON
+     * @param data  The loaded level
+     * @param step  The length of a physics step in seconds
+     *
+     * @return true if the simulation was initialized properly
+     */
+    bool init(const std::string& level, const std::shared_ptr<JsonValue>& json,
+              const std::shared_ptr<LevelData>& data, float step);
+
+    /**
+     * Returns a simulation at the start of a level
+     *
+     * @param level The level key (as in assets.json)
+     * @param json  The level JSON
+     * @param data  The loaded level
+     * @param step  The length of a physics step in seconds
+     *
+     * @return a simulation at the start of a level (or nullptr on failure)
+     */
+    static std::shared_ptr<Simulation> alloc(const std::string& level, const std::shared_ptr<JsonValue>& json,
+                                             const std::shared_ptr<LevelData>& data, float step) {
+        std::shared_ptr<Simulation> result = std::make_shared<Simulation>();
+        return (result->init(level, json, data, step) ? result : nullptr);
+    }
+
+#pragma mark Gameplay
+    /**
+     * Plays one frame of input
+     *
+     * Frames played after the level is complete are ignored, as the game
+     * stops taking input once the player reaches the exit.
+     *
+     * @param frame The frame input
+     */
+    void step(const InputFrame& frame);
+
+    /**
+     * Returns a hash of the gameplay state
+     *
+     * This covers the player position, velocity and 3D location, the plane,
+     * the collected items, the glowsticks, the death count, the trigger
+     * popups and messages, and whether the level is complete.
+     */
+    Uint64 getStateHash() const;
+
+    /** Returns true if the player has reached the exit with every collectible */
+    bool isComplete() const { return _model != nullptr && _model->_endOfGame; }
+
+    /** Returns the number of times the player died or got stuck */
+    Uint32 getDeaths() const { return _deaths; }
+
+    /** Returns the subsystem times of every frame played */
+    const std::vector<FrameTiming>& getTimings() const { return _timings; }
+
+    /**
+     * Returns the name of a subsystem
+     *
+     * @param system    The subsystem
+     */
+    static const char* getSubsystemName(Subsystem system);
+
+#pragma mark Harness
+    /**
+     * Returns the input of a scripted run, for levels with no recording
+     *
+     * The player walks and runs back and forth, jumping regularly, turns the
+     * plane a little every few seconds and drops a glowstick now and then.
+     * The physics steps follow SIM_FIXED_RATE at SIM_FRAME_RATE frames a
+     * second.
+     *
+     * @param frames    The number of frames to play
+     */
+    static std::vector<InputFrame> scriptInput(Uint32 frames);
+
+    /**
+     * Plays every level listed in json/assets.json twice and checks that both
+     * runs end in the same state
+     *
+     * A level is played from its recording in the replay directory if there
+     * is one (as saved by a PIVOT_RECORD_INPUT build), and from scriptInput
+     * otherwise. The mean and worst time of each subsystem is logged for
+     * every level. If a timing directory is given, the per-frame times of
+     * each level are also written there as a CSV file.
+     *
+     * @param assetDir  The asset directory, ending in a path separator
+     * @param replayDir The recording directory (or empty for none)
+     * @param timingDir The directory to write the timings to (or empty for none)
+     *
+     * @return the number of levels that failed to load or diverged
+     */
+    static int runAll(const std::string& assetDir, const std::string& replayDir, const std::string& timingDir);
+
+    /**
+     * Runs the harness from the command line
+     *
+     * The arguments are the asset directory, then optionally the replay
+     * directory and the timing directory.
+     *
+     * @param argc  The number of arguments
+     * @param argv  The arguments (the first is the program)
+     *
+     * @return 0 if every level replayed deterministically, 1 otherwise
+     */
+    static int main(int argc, char* argv[]);
+};
+
+#endif /* Simulation_h */
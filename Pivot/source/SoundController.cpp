@@ -13,6 +13,8 @@
 #define DEFAULT_FADE  0.15
 /** The crossfade duration */
 #define CROSS_FADE    0.25
+/** The fade when an emitter gains or loses its voice */
+#define EMITTER_FADE  0.2
 
 bool SoundController::init(std::shared_ptr<cugl::AssetManager> assets){
     cugl::AudioEngine::get()->getMusicQueue()->setOverlap(CROSS_FADE);
@@ -365,3 +367,52 @@ void SoundController::setSpinnerPan(float angle, float lowest){
     _panner->setPan(1,1,right);
     //CULog("pan L R: %f, %f ", left, right);
 }
+
+/**
+ * Updates the level emitters and plays the ones that should be heard
+ * @param emitters  the emitters of the level
+ * @param dt        the time since the last update in seconds
+ * @param listener  the player position
+ * @param right     the right vector of the plane
+ */
+void SoundController::updateEmitters(SoundEmitters& emitters, float dt, const cugl::Vec3& listener, const cugl::Vec3& right){
+    emitters.update(dt, listener, right);
+    auto engine = cugl::AudioEngine::get();
+    for (const std::string& key : emitters.takeStopped()){
+        engine->clear(key, EMITTER_FADE);
+    }
+    for (Uint32 index : emitters.getStarted()){
+        const SoundEmitters::Emitter& emitter = emitters.getEmitter(index);
+        std::shared_ptr<cugl::Sound> source = _assets->get<cugl::Sound>(emitter.sound);
+        if (source == nullptr || !engine->play(emitter.key, source, true, emitter.gain * _masterVolume)){
+            // out of slots (or no such sound), so try again next frame
+            emitters.markVirtual(index);
+            continue;
+        }
+        engine->setTimeElapsed(emitter.key, emitter.elapsed);
+    }
+    for (size_t ii = 0; ii < emitters.size(); ii++){
+        const SoundEmitters::Emitter& emitter = emitters.getEmitter(ii);
+        if (emitter.voiced){
+            engine->setVolume(emitter.key, emitter.gain * _masterVolume);
+            engine->setPanFactor(emitter.key, emitter.pan);
+        }
+    }
+}
+
+/**
+ * Stops every emitter voice (they start again on the next update)
+ * @param emitters  the emitters of the level
+ */
+void SoundController::stopEmitters(SoundEmitters& emitters){
+    auto engine = cugl::AudioEngine::get();
+    for (size_t ii = 0; ii < emitters.size(); ii++){
+        if (emitters.getEmitter(ii).voiced){
+            engine->clear(emitters.getEmitter(ii).key, EMITTER_FADE);
+            emitters.markVirtual(ii);
+        }
+    }
+    for (const std::string& key : emitters.takeStopped()){
+        engine->clear(key, EMITTER_FADE);
+    }
+}
@@ -11,6 +11,7 @@
 #define SoundController_h
 #include <cugl/cugl.h>
 #include "GameSound.h"
+#include "SoundEmitters.h"
 
 /**
  *  Include functions that play music for different states
@@ -183,6 +184,27 @@ public:
      */
     void setSpinnerPan(float angle, float lowest);
     
+#pragma mark sound emitters
+    /**
+     * Updates the level emitters and plays the ones that should be heard
+     *
+     * Emitters that lose their voice are stopped, emitters that gain one
+     * start at their tracked playback position, and every voice is set to
+     * the gain and pan of its emitter (scaled by the master volume).
+     *
+     * @param emitters  the emitters of the level
+     * @param dt        the time since the last update in seconds
+     * @param listener  the player position
+     * @param right     the right vector of the plane
+     */
+    void updateEmitters(SoundEmitters& emitters, float dt, const cugl::Vec3& listener, const cugl::Vec3& right);
+
+    /**
+     * Stops every emitter voice (they start again on the next update)
+     * @param emitters  the emitters of the level
+     */
+    void stopEmitters(SoundEmitters& emitters);
+
     /**
      * fades in selected audio
      */
@@ -0,0 +1,111 @@
+//
+//  SoundEmitters.cpp
+//  Pivot
+//
+//  The looping sounds placed in a level.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "SoundEmitters.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Removes every emitter
+ *
+ * The voices of the emitters that were playing are listed as stopped.
+ */
+void SoundEmitters::clear() {
+    for (const Emitter& emitter : _emitters) {
+        if (emitter.voiced) {
+            _stopped.push_back(emitter.key);
+        }
+    }
+    _emitters.clear();
+    _started.clear();
+}
+
+/**
+ * Adds an emitter that is silent until the next update
+ *
+ * @param sound     The sound key
+ * @param loc       The emitter location
+ * @param radius    The distance within which the sound plays at full volume
+ * @param duration  The length of the sound in seconds (0 if unknown)
+ */
+void SoundEmitters::add(const std::string& sound, const Vec3& loc, float radius, float duration) {
+    Emitter emitter;
+    emitter.sound = sound;
+    emitter.key = "emitter_" + std::to_string(_emitters.size());
+    emitter.loc = loc;
+    emitter.radius = std::max(radius, 1.0f);
+    emitter.duration = std::max(duration, 0.0f);
+    emitter.elapsed = 0;
+    emitter.gain = 0;
+    emitter.pan = 0;
+    emitter.voiced = false;
+    _emitters.push_back(emitter);
+}
+
+/**
+ * Attenuates and pans every emitter and picks the ones to hear
+ *
+ * @param dt        The time since the last update in seconds
+ * @param listener  The player position
+ * @param right     The right vector of the plane
+ */
+void SoundEmitters::update(float dt, const Vec3& listener, const Vec3& right) {
+    _started.clear();
+    _order.clear();
+    for (Uint32 ii = 0; ii < _emitters.size(); ii++) {
+        Emitter& emitter = _emitters[ii];
+        if (emitter.duration > 0) {
+            emitter.elapsed = std::fmod(emitter.elapsed + dt, emitter.duration);
+        }
+
+        Vec3 offset = emitter.loc - listener;
+        float dist = offset.length();
+        emitter.gain = dist <= emitter.radius ? 1.0f : emitter.radius / dist;
+        // inside the radius the sound is all around the player, so it centers
+        float side = right.dot(offset) / std::max(dist, emitter.radius);
+        emitter.pan = std::max(-1.0f, std::min(1.0f, side)) * EMITTER_PAN_WIDTH;
+        if (emitter.gain >= EMITTER_MIN_GAIN) {
+            _order.push_back(ii);
+        }
+    }
+
+    // The loudest emitters win, with playing ones given the benefit of the doubt
+    auto score = [&](Uint32 index) {
+        const Emitter& emitter = _emitters[index];
+        return emitter.voiced ? emitter.gain * EMITTER_HYSTERESIS : emitter.gain;
+    };
+    size_t heard = std::min(_budget, _order.size());
+    std::partial_sort(_order.begin(), _order.begin() + heard, _order.end(), [&](Uint32 a, Uint32 b) {
+        float sa = score(a);
+        float sb = score(b);
+        return sa != sb ? sa > sb : a < b;
+    });
+
+    std::vector<bool> wanted(_emitters.size(), false);
+    for (size_t ii = 0; ii < heard; ii++) {
+        wanted[_order[ii]] = true;
+    }
+    for (Uint32 ii = 0; ii < _emitters.size(); ii++) {
+        Emitter& emitter = _emitters[ii];
+        if (emitter.voiced && !wanted[ii]) {
+            emitter.voiced = false;
+            _stopped.push_back(emitter.key);
+        } else if (!emitter.voiced && wanted[ii]) {
+            emitter.voiced = true;
+            _started.push_back(ii);
+        }
+    }
+}
+
+/**
+ * Returns the number of emitters with a voice
+ */
+size_t SoundEmitters::getVoiceCount() const {
+    return std::count_if(_emitters.begin(), _emitters.end(), [](const Emitter& emitter) { return emitter.voiced; });
+}
@@ -0,0 +1,159 @@
+//
+//  SoundEmitters.h
+//  Pivot
+//
+//  The looping sounds placed in a level. Every emitter is attenuated and
+//  panned from the player each frame, but only the most audible few are given
+//  a voice in the AudioEngine; the rest are virtual, and keep their playback
+//  position so that they pick up where they would have been when they are
+//  heard again.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef SoundEmitters_h
+#define SoundEmitters_h
+#include <cugl/cugl.h>
+#include <string>
+#include <vector>
+
+using namespace cugl;
+
+/** Default number of emitters that may play at once (save.json may set emitter_voices) */
+#define EMITTER_VOICES      4
+/** Emitters quieter than this are never given a voice */
+#define EMITTER_MIN_GAIN    0.05f
+/** How much louder a virtual emitter must be to take a voice from a playing one */
+#define EMITTER_HYSTERESIS  1.25f
+/** The largest pan of an emitter (so that both ears always hear it a little) */
+#define EMITTER_PAN_WIDTH   0.8f
+
+/**
+ * The sound emitters of a level with a fixed voice budget.
+ *
+ * The gain of an emitter is 1 within its radius, and falls off with the
+ * inverse of the distance beyond it. The pan is the share of the direction
+ * to the emitter along the right vector of the plane, so an emitter to the
+ * right of the player on screen is heard on the right.
+ *
+ * Each update picks the emitters that should be heard: the loudest ones, up
+ * to the voice budget, that are above EMITTER_MIN_GAIN. A playing emitter
+ * keeps its voice unless a virtual one is EMITTER_HYSTERESIS times louder, so
+ * that emitters at about the same distance do not trade voices every frame.
+ * The emitters that gained or lost a voice are listed until the next update,
+ * for the SoundController to start and stop.
+ *
+ * This class does not touch the AudioEngine, so the emitters can be updated
+ * without an audio device.
+ */
+class SoundEmitters {
+public:
+    /** A sound emitter */
+    struct Emitter {
+        /** The sound key */
+        std::string sound;
+        /** The AudioEngine key of the voice */
+        std::string key;
+        /** The emitter location */
+        Vec3 loc;
+        /** The distance within which the sound plays at full volume */
+        float radius;
+        /** The length of the sound in seconds (0 if unknown) */
+        float duration;
+        /** The playback position in seconds */
+        float elapsed;
+        /** The gain at the player (0 to 1) */
+        float gain;
+        /** The stereo pan at the player (-1 to 1) */
+        float pan;
+        /** Whether the emitter has a voice */
+        bool voiced;
+    };
+
+private:
+    /** The emitters */
+    std::vector<Emitter> _emitters;
+    /** The number of emitters that may play at once */
+    size_t _budget;
+    /** The emitters given a voice by the last update */
+    std::vector<Uint32> _started;
+    /** The keys of the voices to stop (as of the last update or clear) */
+    std::vector<std::string> _stopped;
+    /** The emitters ordered by score (kept to avoid reallocating) */
+    std::vector<Uint32> _order;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty set of emitters with the default voice budget
+     */
+    SoundEmitters() : _budget(EMITTER_VOICES) {}
+
+    /**
+     * Removes every emitter
+     *
+     * The voices of the emitters that were playing are listed as stopped.
+     */
+    void clear();
+
+    /**
+     * Adds an emitter that is silent until the next update
+     *
+     * @param sound     The sound key
+     * @param loc       The emitter location
+     * @param radius    The distance within which the sound plays at full volume
+     * @param duration  The length of the sound in seconds (0 if unknown)
+     */
+    void add(const std::string& sound, const Vec3& loc, float radius, float duration);
+
+#pragma mark Update
+    /**
+     * Attenuates and pans every emitter and picks the ones to hear
+     *
+     * This also advances the playback position of every emitter, so a
+     * virtual emitter is in step with where it would have been.
+     *
+     * @param dt        The time since the last update in seconds
+     * @param listener  The player position
+     * @param right     The right vector of the plane
+     */
+    void update(float dt, const Vec3& listener, const Vec3& right);
+
+    /**
+     * Takes the voice from an emitter, without listing it as stopped
+     *
+     * This is for voices that could not be started; the emitter is tried
+     * again on the next update.
+     *
+     * @param index The emitter index
+     */
+    void markVirtual(size_t index) { _emitters[index].voiced = false; }
+
+    /** Returns the emitters that were given a voice by the last update */
+    const std::vector<Uint32>& getStarted() const { return _started; }
+
+    /** Returns the keys of the voices to stop, and forgets them */
+    std::vector<std::string> takeStopped() {
+        std::vector<std::string> result;
+        result.swap(_stopped);
+        return result;
+    }
+
+#pragma mark Attributes
+    /** Returns the number of emitters */
+    size_t size() const { return _emitters.size(); }
+
+    /** Returns an emitter */
+    const Emitter& getEmitter(size_t index) const { return _emitters[index]; }
+
+    /** Returns the number of emitters that may play at once */
+    size_t getVoiceBudget() const { return _budget; }
+
+    /** Sets the number of emitters that may play at once (from the next update) */
+    void setVoiceBudget(size_t budget) { _budget = budget; }
+
+    /** Returns the number of emitters with a voice */
+    size_t getVoiceCount() const;
+};
+
+#endif /* SoundEmitters_h */
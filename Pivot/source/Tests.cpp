@@ -0,0 +1,1322 @@
+//
+//  Tests.cpp
+//  Pivot
+//
+//  Checks of the game systems that can run without a window or GL context.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifdef PIVOT_TESTS
+#include "Tests.h"
+#include "MeshBuffer.h"
+#include "LightGrid.h"
+#include "BillboardBatch.h"
+#include "MeshChunks.h"
+#include "FrameVisibility.h"
+#include "Mesh.h"
+#include <igl/isolines.h>
+#include <igl/readOBJ.h>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <climits>
+#include <future>
+#include <thread>
+
+using namespace cugl;
+
+/**
+ * Returns 0 if the check passed, and logs it and returns 1 otherwise
+ *
+ * @param passed    Whether the check passed
+ * @param test      The test making the check
+ * @param what      What was checked
+ *
+ * @return 0 if the check passed, 1 otherwise
+ */
+static int check(bool passed, const char* test, const char* what) {
+    if (!passed) {
+        CULogError("%s: %s", test, what);
+    }
+    return passed ? 0 : 1;
+}
+
+#pragma mark -
+#pragma mark Mesh Buffer
+/**
+ * A mesh device that records each load instead of calling GL
+ */
+class RecordingDevice : public MeshDevice {
+public:
+    /** The number of loads so far */
+    int loads = 0;
+    /** The vertices of the last load */
+    std::vector<PivotVertex3> vertices;
+    /** The indices of the last load */
+    std::vector<Uint32> indices;
+
+    /**
+     * Records the given vertices and indices as the device data
+     *
+     * @param verts     The vertices to upload
+     * @param vcount    The number of vertices
+     * @param inds      The indices to upload
+     * @param icount    The number of indices
+     */
+    void load(const PivotVertex3* verts, size_t vcount, const Uint32* inds, size_t icount) override {
+        loads++;
+        vertices.assign(verts, verts + vcount);
+        indices.assign(inds, inds + icount);
+    }
+};
+
+/**
+ * Returns a mesh of the given number of triangles
+ *
+ * Each vertex has its index as its x coordinate and the tag as its y
+ * coordinate, so a test can tell which mesh was uploaded.
+ *
+ * @param triangles The number of triangles
+ * @param tag       The tag of the mesh
+ *
+ * @return a mesh of the given number of triangles
+ */
+static std::shared_ptr<PivotMesh> makeMesh(size_t triangles, float tag) {
+    std::shared_ptr<PivotMesh> mesh = std::make_shared<PivotMesh>();
+    for (size_t ii = 0; ii < 3*triangles; ii++) {
+        PivotVertex3 vert;
+        vert.position = Vec3((float)ii, tag, 0);
+        mesh->vertices.push_back(vert);
+        mesh->indices.push_back((Uint32)ii);
+    }
+    return mesh;
+}
+
+/**
+ * Returns true if the device holds the given mesh
+ *
+ * @param device    The recording device
+ * @param mesh      The mesh to compare
+ *
+ * @return true if the device holds the given mesh
+ */
+static bool holds(const RecordingDevice& device, const std::shared_ptr<PivotMesh>& mesh) {
+    if (device.vertices.size() != mesh->vertices.size() || device.indices != mesh->indices) {
+        return false;
+    }
+    for (size_t ii = 0; ii < device.vertices.size(); ii++) {
+        if (device.vertices[ii].position != mesh->vertices[ii].position) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks that a MeshBuffer only uploads when the mesh changes
+ *
+ * The buffer runs on a mock device that records each load, so this covers
+ * the upload bookkeeping without a GL context.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testMeshBuffer() {
+    const char* name = "MeshBuffer";
+    int failed = 0;
+    failed += check(MeshBuffer::alloc(nullptr) == nullptr, name, "a buffer without a device was allocated");
+
+    std::shared_ptr<RecordingDevice> device = std::make_shared<RecordingDevice>();
+    std::shared_ptr<MeshBuffer> buffer = MeshBuffer::alloc(device);
+    if (buffer == nullptr) {
+        return check(false, name, "the buffer could not be allocated");
+    }
+    failed += check(!buffer->sync() && device->loads == 0, name, "an empty buffer uploaded on sync");
+
+    // The first set uploads, and setting it again is free
+    std::shared_ptr<PivotMesh> first = makeMesh(4, 1);
+    failed += check(buffer->setMesh(first) && device->loads == 1, name, "the first mesh was not uploaded");
+    failed += check(holds(*device, first), name, "the device does not hold the first mesh");
+    failed += check(buffer->getVertexCount() == 12 && buffer->getIndexCount() == 12, name, "the counts do not match the first mesh");
+    failed += check(buffer->getUploadBytes() == 12*sizeof(PivotVertex3)+12*sizeof(Uint32), name, "the upload size is wrong");
+    failed += check(!buffer->setMesh(first) && device->loads == 1, name, "setting the same mesh uploaded again");
+    failed += check(!buffer->sync() && device->loads == 1, name, "a clean mesh uploaded on sync");
+
+    // Edits only upload on the next sync
+    first->vertices[0].position = Vec3(-1, 1, 0);
+    buffer->markDirty();
+    failed += check(device->loads == 1, name, "marking the mesh dirty uploaded it");
+    failed += check(buffer->sync() && device->loads == 2 && holds(*device, first), name, "a dirty mesh was not uploaded on sync");
+    failed += check(!buffer->sync() && device->loads == 2, name, "a synced mesh uploaded again");
+
+    // A change in size counts as an edit
+    PivotVertex3 vert;
+    for (int ii = 0; ii < 3; ii++) {
+        first->vertices.push_back(vert);
+        first->indices.push_back((Uint32)first->indices.size());
+    }
+    failed += check(buffer->sync() && device->loads == 3 && holds(*device, first), name, "a resized mesh was not uploaded on sync");
+    failed += check(buffer->getIndexCount() == 15, name, "the index count was not updated after a resize");
+
+    // A different mesh uploads, even with the same size
+    std::shared_ptr<PivotMesh> second = makeMesh(5, 2);
+    failed += check(buffer->setMesh(second) && device->loads == 4 && holds(*device, second), name, "a new mesh was not uploaded");
+    failed += check(buffer->getMesh() == second, name, "the buffer does not track the new mesh");
+
+    // Clearing empties the device without counting an upload
+    Uint64 uploads = buffer->getUploads();
+    failed += check(buffer->setMesh(nullptr) && device->loads == 5, name, "clearing the mesh did not reach the device");
+    failed += check(device->vertices.empty() && device->indices.empty(), name, "the device was not emptied");
+    failed += check(buffer->getIndexCount() == 0 && buffer->getUploads() == uploads, name, "clearing was counted as an upload");
+    failed += check(!buffer->setMesh(nullptr) && device->loads == 5, name, "clearing twice reached the device");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Light Grid
+/**
+ * Returns the strength of a white light with the given radius of influence
+ *
+ * This inverts LightGrid::radiusFor.
+ *
+ * @param radius    The radius of influence
+ *
+ * @return the strength of a white light with the given radius of influence
+ */
+static float strengthFor(float radius) {
+    return (radius * radius + LIGHT_CONST_ATTEN) * LIGHT_CUTOFF / LIGHT_POWER_MULT;
+}
+
+/**
+ * Returns the lights binned into the given tile, in order
+ *
+ * This reads the packed tile texels, the same way the lighting shader does.
+ *
+ * @param grid  The binned grid
+ * @param col   The tile column
+ * @param row   The tile row
+ *
+ * @return the lights binned into the given tile, in order
+ */
+static std::vector<int> tileLights(const LightGrid& grid, int col, int row) {
+    const std::vector<float>& texels = grid.getTileTexels();
+    size_t tiles = grid.getCols() * grid.getRows();
+    size_t tile = row * grid.getCols() + col;
+    std::vector<int> result;
+    for (int ii = 0; ii < (int)texels[tile * 4 + 1]; ii++) {
+        result.push_back((int)texels[tiles * 4 + (size_t)texels[tile * 4] + ii]);
+    }
+    return result;
+}
+
+/**
+ * Checks that a LightGrid bins each light into the tiles it reaches
+ *
+ * The grid covers a 256x128 screen with 64 pixel tiles, under a camera that
+ * maps world units to pixels, so the expected tiles can be worked out by hand.
+ * This also checks the packed tile texels and that a full grid keeps the
+ * brightest lights.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testLightGrid() {
+    const char* name = "LightGrid";
+    int failed = 0;
+    failed += check(LightGrid::alloc(Size(256, 128), 0) == nullptr, name, "a grid without tiles was allocated");
+
+    std::shared_ptr<LightGrid> grid = LightGrid::alloc(Size(256, 128), 64);
+    if (grid == nullptr) {
+        return check(false, name, "the grid could not be allocated");
+    }
+    failed += check(grid->getCols() == 4 && grid->getRows() == 2, name, "the grid is not 4x2 tiles");
+
+    Mat4 camera = Mat4::createOrthographicOffCenter(0, 256, 0, 128, -1, 1);
+    Vec3 right(1, 0, 0);
+    Vec3 up(0, 1, 0);
+    Vec3 white(1, 1, 1);
+    failed += check(std::abs(LightGrid::radiusFor(strengthFor(20)) - 20) < 0.01f, name, "the test strengths do not give the test radii");
+    failed += check(!grid->addLight(Vec3(32, 32, 0), white, 0), name, "a dark light was added");
+
+    // A light inside one tile, one on a tile corner and one off screen
+    failed += check(grid->addLight(Vec3(32, 32, 0), white, strengthFor(20)), name, "the first light was not added");
+    failed += check(grid->addLight(Vec3(64, 64, 0), white, strengthFor(10)), name, "the corner light was not added");
+    failed += check(grid->addLight(Vec3(-100, -100, 0), white, strengthFor(10)), name, "the offscreen light was not added");
+    grid->bin(camera, right, up);
+    failed += check(tileLights(*grid, 0, 0) == std::vector<int>({ 0, 1 }), name, "the first tile does not hold the first and corner lights");
+    failed += check(tileLights(*grid, 1, 0) == std::vector<int>({ 1 }), name, "the corner light is missing from the tile to its right");
+    failed += check(tileLights(*grid, 0, 1) == std::vector<int>({ 1 }), name, "the corner light is missing from the tile above it");
+    failed += check(tileLights(*grid, 1, 1) == std::vector<int>({ 1 }), name, "the corner light is missing from the tile diagonal to it");
+    int empty = 0;
+    for (int row = 0; row < grid->getRows(); row++) {
+        for (int col = 2; col < grid->getCols(); col++) {
+            empty += grid->getTileCount(col, row) == 0;
+        }
+    }
+    failed += check(empty == 4, name, "lights were binned into tiles they do not reach");
+    failed += check(grid->getIndexCount() == 5, name, "the offscreen light was binned");
+    failed += check(grid->getTileTexels().size() % (4 * LIGHT_TEX_WIDTH) == 0, name, "the tile texels are not whole rows");
+    failed += check(grid->getLightTexels().size() == 3 * 8 && grid->getLightTexels()[8] == 64, name, "the light texels are wrong");
+
+    // Clearing empties the grid, and binning it again empties the tiles
+    grid->clear();
+    grid->bin(camera, right, up);
+    failed += check(grid->getLightCount() == 0 && grid->getIndexCount() == 0, name, "clearing left lights in the grid");
+    failed += check(grid->getTileCount(0, 0) == 0, name, "clearing left lights in the tiles");
+
+    // A full grid swaps out its dimmest light, and only for a brighter one
+    for (int ii = 0; ii < LIGHT_MAX; ii++) {
+        grid->addLight(Vec3(200, 100, 0), white, strengthFor(ii == 7 ? 2.0f : 5.0f));
+    }
+    failed += check(grid->getLightCount() == LIGHT_MAX && grid->getDroppedCount() == 0, name, "the grid did not fill up");
+    failed += check(grid->addLight(Vec3(32, 32, 0), white, strengthFor(20)), name, "a bright light was not added to a full grid");
+    failed += check(!grid->addLight(Vec3(32, 32, 0), white, strengthFor(1)), name, "a dim light was added to a full grid");
+    failed += check(grid->getLightCount() == LIGHT_MAX && grid->getDroppedCount() == 2, name, "the lost lights were not counted");
+    grid->bin(camera, right, up);
+    failed += check(tileLights(*grid, 0, 0) == std::vector<int>({ 7 }), name, "the bright light did not replace the dimmest light");
+    grid->clear();
+    failed += check(grid->getDroppedCount() == 0, name, "clearing did not reset the lost lights");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Billboard Batch
+/**
+ * Checks the grouping, order and quads of a BillboardBatch
+ *
+ * The textures are never initialized, so they need no GL context. They have
+ * no size, which puts every vertex of a batched quad on its billboard, and
+ * shows which billboard each quad came from. The quad layout is checked
+ * separately with an explicit texture size.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testBillboardBatch() {
+    const char* name = "BillboardBatch";
+    int failed = 0;
+    auto texA = std::make_shared<Texture>();
+    auto texB = std::make_shared<Texture>();
+    auto texC = std::make_shared<Texture>();
+    auto normal = std::make_shared<Texture>();
+
+    // B is seen first, so it is drawn first even though it was allocated later
+    std::vector<DrawObject> drawables;
+    drawables.push_back(DrawObject(Vec3(0, 0, 0), texB, normal, false, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(1, 0, 0), texA, nullptr, false, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(2, 0, 0), texB, normal, false, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(3, 0, 0), texA, nullptr, true, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(4, 0, 0), texB, nullptr, false, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(5, 0, 0), texA, nullptr, false, nullptr, false, 1));
+    drawables.push_back(DrawObject(Vec3(6, 0, 0), texC, nullptr, false, nullptr, false, 1));
+
+    BillboardBatch batch;
+    Vec3 right(1, 0, 0);
+    Vec3 up(0, 0, 1);
+    batch.build(drawables, { 0, 1, 2, 3, 4, 5 }, right, up, true);
+    failed += check(batch.size() == 6 && batch.getIndices().size() == 36, name, "the batch does not hold exactly the visible billboards");
+
+    // Grouped by texture, then normal map, then flip, keeping the drawing order within a group
+    std::vector<int> order = { 0, 2, 4, 1, 5, 3 };
+    bool ordered = batch.size() == order.size();
+    for (size_t ii = 0; ordered && ii < order.size(); ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            ordered = ordered && batch.getVertices()[ii * 4 + jj].position == drawables[order[ii]].pos;
+        }
+    }
+    failed += check(ordered, name, "the quads are not in group order");
+
+    const std::vector<BillboardBatch::Group>& groups = batch.getGroups();
+    failed += check(groups.size() == 4, name, "the batch does not have four groups");
+    if (groups.size() == 4) {
+        failed += check(groups[0].tex == texB && groups[0].normalMap == normal && !groups[0].flip, name, "the first group is not the lit B billboards");
+        failed += check(groups[1].tex == texB && groups[1].emission(), name, "the second group is not the emissive B billboard");
+        failed += check(groups[2].tex == texA && groups[2].emission() && !groups[2].flip, name, "the third group is not the unflipped A billboards");
+        failed += check(groups[3].tex == texA && groups[3].flip, name, "the last group is not the flipped player");
+        Uint32 offsets[] = { 0, 12, 18, 30 };
+        Uint32 counts[] = { 12, 6, 12, 6 };
+        bool ranges = true;
+        for (int ii = 0; ii < 4; ii++) {
+            ranges = ranges && groups[ii].offset == offsets[ii] && groups[ii].count == counts[ii];
+        }
+        failed += check(ranges, name, "the group index ranges are wrong");
+    }
+
+    // Each quad is two triangles over its own four vertices
+    bool indexed = true;
+    for (Uint32 quad = 0; quad < batch.size(); quad++) {
+        const Uint32* indices = batch.getIndices().data() + quad * 6;
+        Uint32 base = quad * 4;
+        indexed = indexed && indices[0] == base && indices[1] == base + 1 && indices[2] == base + 2;
+        indexed = indexed && indices[3] == base + 1 && indices[4] == base + 2 && indices[5] == base + 3;
+    }
+    failed += check(indexed, name, "the quad indices are wrong");
+
+    // The player only gets its own group when it is flipped
+    batch.build(drawables, { 5, 3 }, right, up, false);
+    failed += check(batch.getGroups().size() == 1 && batch.getGroups()[0].count == 12, name, "the unflipped player was not batched with its texture");
+    batch.build(drawables, {}, right, up, true);
+    failed += check(batch.size() == 0 && batch.getGroups().empty(), name, "an empty build left quads behind");
+
+    // An 8x16 texture at scale 2 is a 4x8 quad
+    std::vector<PivotVertex3> quad;
+    DrawObject dro(Vec3(10, 20, 30), texA, nullptr, false, nullptr, false, 2);
+    BillboardBatch::buildQuad(dro, Size(8, 16), right, up, quad);
+    Vec3 positions[] = { Vec3(8, 20, 26), Vec3(8, 20, 34), Vec3(12, 20, 26), Vec3(12, 20, 34) };
+    Vec2 texcoords[] = { Vec2(0, 1), Vec2(0, 0), Vec2(1, 1), Vec2(1, 0) };
+    bool layout = quad.size() == 4;
+    for (size_t ii = 0; layout && ii < 4; ii++) {
+        layout = quad[ii].position == positions[ii] && quad[ii].texcoord == texcoords[ii];
+    }
+    failed += check(layout, name, "the quad vertices are not in the expected layout");
+
+    // A poster faces along its normal instead of the camera
+    quad.clear();
+    DrawObject poster(Vec3(10, 20, 30), texA, nullptr, false, nullptr, false, 2, Vec3(1, 0, 0));
+    BillboardBatch::buildQuad(poster, Size(8, 16), right, up, quad);
+    failed += check(quad.size() == 4 && quad[0].position == Vec3(10, 22, 26) && quad[3].position == Vec3(10, 18, 34),
+                    name, "the poster quad does not face along its normal");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Mesh Chunks
+/**
+ * Returns the x coordinate of the centroid of every triangle in the ranges
+ *
+ * @param positions The vertex positions
+ * @param indices   The (reordered) triangle indices
+ * @param ranges    The index ranges to read
+ *
+ * @return the rounded x coordinates of the centroids, sorted
+ */
+static std::vector<int> rangeCentroids(const std::vector<Vec3>& positions, const std::vector<Uint32>& indices,
+                                       const std::vector<MeshChunks::Range>& ranges) {
+    std::vector<int> result;
+    for (const MeshChunks::Range& range : ranges) {
+        for (Uint32 ii = range.offset; ii < range.offset + range.count; ii += 3) {
+            float x = positions[indices[ii]].x + positions[indices[ii + 1]].x + positions[indices[ii + 2]].x;
+            result.push_back((int)std::round(x / 3));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * Checks that MeshChunks splits a mesh into disjoint chunks and culls them
+ *
+ * A scattered mesh checks that every triangle ends up in exactly one chunk,
+ * whole, and inside the chunk bounds. A row of four triangles, one to a
+ * chunk, is then culled against a known FrameVisibility view, including the
+ * triangles that just touch the screen rectangle or the slab.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testMeshChunks() {
+    const char* name = "MeshChunks";
+    int failed = 0;
+    std::vector<Vec3> positions = { Vec3::ZERO, Vec3::UNIT_X, Vec3::UNIT_Y };
+    std::vector<Uint32> broken = { 0, 1 };
+    failed += check(MeshChunks::alloc(positions, broken) == nullptr, name, "a partial triangle was chunked");
+    broken = { 0, 1, 3 };
+    failed += check(MeshChunks::alloc(positions, broken) == nullptr, name, "an index past the vertices was chunked");
+    broken.clear();
+    std::shared_ptr<MeshChunks> chunks = MeshChunks::alloc(positions, broken, 1);
+    failed += check(chunks != nullptr && chunks->getChunks().empty(), name, "an empty mesh has chunks");
+
+    // Scatter triangles with a fixed generator, so the run is repeatable
+    Uint32 seed = 12345;
+    auto random = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (1 << 24);
+    };
+    positions.clear();
+    std::vector<Uint32> indices;
+    for (Uint32 tri = 0; tri < 3000; tri++) {
+        Vec3 corner(random() * 400 - 200, random() * 50, random() * 100);
+        for (int ii = 0; ii < 3; ii++) {
+            positions.push_back(corner + Vec3(random() * 4, random() * 4, random() * 4));
+            indices.push_back((Uint32)positions.size() - 1);
+        }
+    }
+    // share some vertices, as a real mesh does
+    for (size_t ii = 3; ii < indices.size(); ii += 7) {
+        indices[ii] = indices[ii - 3];
+    }
+    std::vector<std::array<Uint32, 3>> before;
+    for (size_t ii = 0; ii < indices.size(); ii += 3) {
+        before.push_back({ indices[ii], indices[ii + 1], indices[ii + 2] });
+    }
+
+    chunks = MeshChunks::alloc(positions, indices, 64);
+    if (chunks == nullptr) {
+        return failed + check(false, name, "the scattered mesh could not be chunked");
+    }
+    failed += check(chunks->getTriangleCount() == 3000 && indices.size() == 9000, name, "chunking changed the triangle count");
+    failed += check(chunks->getChunks().size() > 1, name, "the scattered mesh is a single chunk");
+
+    std::vector<std::array<Uint32, 3>> after;
+    for (size_t ii = 0; ii < indices.size(); ii += 3) {
+        after.push_back({ indices[ii], indices[ii + 1], indices[ii + 2] });
+    }
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    failed += check(before == after, name, "reordering did not keep every triangle whole exactly once");
+
+    // The chunks tile the index list in order, and bound their triangles
+    Uint32 next = 0;
+    bool tiled = true;
+    bool bounded = true;
+    for (const MeshChunks::Chunk& chunk : chunks->getChunks()) {
+        tiled = tiled && chunk.offset == next && chunk.count > 0 && chunk.count % 3 == 0;
+        next = chunk.offset + chunk.count;
+        for (Uint32 ii = chunk.offset; ii < chunk.offset + chunk.count && ii < indices.size(); ii++) {
+            const Vec3& pos = positions[indices[ii]];
+            bounded = bounded && pos.x >= chunk.min.x && pos.y >= chunk.min.y && pos.z >= chunk.min.z;
+            bounded = bounded && pos.x <= chunk.max.x && pos.y <= chunk.max.y && pos.z <= chunk.max.z;
+        }
+    }
+    failed += check(tiled && next == indices.size(), name, "the chunk ranges do not cover each triangle exactly once");
+    failed += check(bounded, name, "a chunk does not bound its triangles");
+
+    // Culling everything or nothing
+    std::vector<MeshChunks::Range> ranges;
+    size_t drawn = chunks->cull([](const Vec3&, const Vec3&) { return true; }, ranges);
+    failed += check(drawn == 3000 && ranges.size() == 1 && ranges[0].offset == 0 && ranges[0].count == 9000,
+                    name, "culling nothing did not draw the whole mesh in one range");
+    drawn = chunks->cull([](const Vec3&, const Vec3&) { return false; }, ranges);
+    failed += check(drawn == 0 && ranges.empty(), name, "culling everything drew something");
+
+    // A row of triangles 10 apart, centered on x = 0, 10, 20 and 30, the last one deeper
+    positions.clear();
+    indices.clear();
+    for (int tri = 0; tri < 4; tri++) {
+        float depth = tri == 3 ? 10.0f : 0.0f;
+        positions.push_back(Vec3(10.0f * tri - 1, depth, 0));
+        positions.push_back(Vec3(10.0f * tri + 1, depth, 0));
+        positions.push_back(Vec3(10.0f * tri, depth, 3));
+        indices.insert(indices.end(), { (Uint32)(3 * tri), (Uint32)(3 * tri + 1), (Uint32)(3 * tri + 2) });
+    }
+    chunks = MeshChunks::alloc(positions, indices, 1);
+    if (chunks == nullptr || chunks->getChunks().size() != 4) {
+        return failed + check(false, name, "the row was not chunked one triangle to a chunk");
+    }
+
+    // The camera looks along y from the origin, with x to the right and z up
+    FrameVisibility view;
+    auto visible = [&](const Vec3& min, const Vec3& max) {
+        return view.intersects(min, max, view.getNear(), view.getFar());
+    };
+    view.setView(Vec3::ZERO, Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(38, 20), -5, 20);
+    drawn = chunks->cull(visible, ranges);
+    failed += check(drawn == 3 && rangeCentroids(positions, indices, ranges) == std::vector<int>({ 0, 10, 20 }),
+                    name, "the triangle touching the screen edge was culled");
+    failed += check(ranges.size() == 1, name, "neighboring chunks were not merged into one range");
+    view.setView(Vec3::ZERO, Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(37.9f, 20), -5, 20);
+    chunks->cull(visible, ranges);
+    failed += check(rangeCentroids(positions, indices, ranges) == std::vector<int>({ 0, 10 }),
+                    name, "the triangle just past the screen edge was drawn");
+
+    // Move the screen over the whole row and narrow the slab
+    view.setView(Vec3(15, 0, 0), Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(100, 20), -5, 10);
+    chunks->cull(visible, ranges);
+    failed += check(rangeCentroids(positions, indices, ranges) == std::vector<int>({ 0, 10, 20, 30 }),
+                    name, "the triangle on the far side of the slab was culled");
+    view.setView(Vec3(15, 0, 0), Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(100, 20), -5, 9.9f);
+    chunks->cull(visible, ranges);
+    failed += check(rangeCentroids(positions, indices, ranges) == std::vector<int>({ 0, 10, 20 }),
+                    name, "the triangle past the far side of the slab was drawn");
+    view.setView(Vec3(15, 0, 0), Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(100, 20), 0.1f, 20);
+    chunks->cull(visible, ranges);
+    failed += check(rangeCentroids(positions, indices, ranges) == std::vector<int>({ 30 }),
+                    name, "the triangles in front of the near side of the slab were drawn");
+    view.setView(Vec3(15, 0, -2), Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(100, 4), -5, 20);
+    chunks->cull(visible, ranges);
+    failed += check(rangeCentroids(positions, indices, ranges) == std::vector<int>({ 0, 10, 20, 30 }),
+                    name, "the triangles touching the top of the screen were culled");
+    view.setView(Vec3(15, 0, -2.1f), Vec3::UNIT_Y, Vec3::UNIT_X, Vec3::UNIT_Z, Size(100, 4), -5, 20);
+    drawn = chunks->cull(visible, ranges);
+    failed += check(drawn == 0, name, "the triangles just above the screen were drawn");
+
+    // Chunks that are not neighbors are separate ranges
+    drawn = chunks->cull([](const Vec3& min, const Vec3&) { return min.x < 0 || (min.x > 15 && min.x < 25); }, ranges);
+    failed += check(drawn == 2 && ranges.size() == 2, name, "chunks with a gap between them were merged");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Materialize Queue
+/**
+ * An upload sink that records each call instead of calling GL
+ *
+ * Every band it uploads advances the test clock by its cost, so the queue
+ * budget can be checked without real work.
+ */
+class RecordingSink : public UploadSink {
+public:
+    /** The number of rows in the image */
+    Uint32 height;
+    /** The number of bytes in a row */
+    size_t rowBytes;
+    /** Whether begin succeeds */
+    bool creates = true;
+    /** The test clock, in microseconds */
+    Uint64* clock;
+    /** The microseconds a band takes to upload */
+    Uint64 cost;
+    /** The number of calls to begin */
+    int begins = 0;
+    /** The bands uploaded, as (first row, rows) pairs */
+    std::vector<std::pair<Uint32,Uint32>> bands;
+    /** The results passed to end, in order */
+    std::vector<bool> ends;
+
+    /**
+     * Creates a sink for an image of the given size
+     *
+     * @param height    The number of rows in the image
+     * @param rowBytes  The number of bytes in a row
+     * @param clock     The test clock, in microseconds
+     * @param cost      The microseconds a band takes to upload
+     */
+    RecordingSink(Uint32 height, size_t rowBytes, Uint64* clock, Uint64 cost) :
+    height(height), rowBytes(rowBytes), clock(clock), cost(cost) {}
+
+    Uint32 getHeight() const override { return height; }
+    size_t getRowBytes() const override { return rowBytes; }
+
+    bool begin() override {
+        begins++;
+        return creates;
+    }
+
+    void upload(Uint32 row, Uint32 rows) override {
+        bands.push_back(std::make_pair(row, rows));
+        *clock += cost;
+    }
+
+    void end(bool success) override {
+        ends.push_back(success);
+    }
+};
+
+/**
+ * Checks the order, budget and chunking of a MaterializeQueue
+ *
+ * The queue runs on a test clock that only moves when a job or a mock
+ * upload sink says so. This covers the priority order, a budget overrun by
+ * the last step, and splitting an upload into bands of rows, without GL.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testMaterializeQueue() {
+    const char* name = "MaterializeQueue";
+    int failed = 0;
+    Uint64 clock = 0;
+    std::vector<int> ran;
+    auto job = [&](int id, Uint64 cost) {
+        return [&ran, &clock, id, cost](void) {
+            ran.push_back(id);
+            clock += cost;
+        };
+    };
+
+    std::shared_ptr<MaterializeQueue> queue = MaterializeQueue::alloc(1000000);
+    if (queue == nullptr) {
+        return check(false, name, "the queue could not be allocated");
+    }
+    queue->setClock([&clock](void) { return clock; });
+    failed += check(queue->process() == 0 && queue->isEmpty(), name, "an empty queue ran a step");
+
+    // UI jobs go first, and jobs of the same priority keep their order
+    queue->push(job(1, 10), MATERIALIZE_NORMAL, 100);
+    queue->push(job(2, 10), MATERIALIZE_UI, 200);
+    queue->push(job(3, 10), MATERIALIZE_NORMAL, 300);
+    queue->push(job(4, 10), MATERIALIZE_UI, 400);
+    failed += check(queue->getBacklog() == 4 && queue->getBacklogBytes() == 1000, name, "the backlog does not count the pushed jobs");
+    failed += check(queue->process() == 4, name, "a large budget did not run every job");
+    failed += check(ran == std::vector<int>({ 2, 4, 1, 3 }), name, "the jobs did not run by priority and then push order");
+    failed += check(queue->isEmpty() && queue->getBacklogBytes() == 0, name, "the backlog was not emptied");
+    failed += check(queue->getSpent() == 40, name, "the time spent does not match the test clock");
+
+    // The budget stops process after the step that uses it up
+    ran.clear();
+    queue->setBudget(2500);
+    for (int id = 1; id <= 5; id++) {
+        queue->push(job(id, 1000));
+    }
+    failed += check(queue->process() == 3 && ran.size() == 3, name, "the budget did not stop after the step that used it up");
+    failed += check(queue->getSpent() == 3000, name, "the overrun of the last step was not reported");
+    failed += check(queue->getBacklog() == 2, name, "the backlog does not count the jobs left");
+    queue->setBudget(0);
+    failed += check(queue->process() == 1 && ran.size() == 4, name, "a spent budget did not still run one step");
+    queue->setBudget(1000000);
+    queue->process();
+    failed += check(ran == std::vector<int>({ 1, 2, 3, 4, 5 }), name, "the jobs did not run across frames in order");
+
+    // An upload is cut into bands of whole rows, one band a step
+    queue->setChunkSize(300);
+    queue->setBudget(0);
+    std::shared_ptr<RecordingSink> sink = std::make_shared<RecordingSink>(10, 100, &clock, 50);
+    queue->upload(sink);
+    failed += check(queue->getBacklogBytes() == 1000, name, "the backlog does not count the upload bytes");
+    queue->process();
+    failed += check(sink->begins == 1 && sink->bands.size() == 1 && sink->ends.empty(), name, "the first step did not upload exactly one band");
+    failed += check(queue->getBacklogBytes() == 700, name, "the backlog does not count the rows left");
+
+    // A UI job cuts in between the bands, and the upload keeps its place
+    ran.clear();
+    queue->push(job(6, 10), MATERIALIZE_UI);
+    queue->push(job(7, 10), MATERIALIZE_NORMAL);
+    queue->process();
+    failed += check(ran == std::vector<int>({ 6 }) && sink->bands.size() == 1, name, "a UI job did not cut in front of the upload");
+    queue->process();
+    failed += check(ran.size() == 1 && sink->bands.size() == 2, name, "a later job ran before the upload");
+    queue->setBudget(1000000);
+    queue->process();
+    std::vector<std::pair<Uint32,Uint32>> bands({ {0, 3}, {3, 3}, {6, 3}, {9, 1} });
+    failed += check(sink->bands == bands, name, "the upload was not split into bands of three rows");
+    failed += check(sink->begins == 1 && sink->ends == std::vector<bool>({ true }), name, "the upload did not begin and end once");
+    failed += check(ran == std::vector<int>({ 6, 7 }) && queue->isEmpty(), name, "the job after the upload did not run");
+
+    // A row larger than the chunk still uploads, a row at a time
+    std::shared_ptr<RecordingSink> wide = std::make_shared<RecordingSink>(2, 1000, &clock, 50);
+    queue->upload(wide);
+    failed += check(queue->process() == 2 && wide->bands.size() == 2, name, "a row wider than the chunk was not uploaded alone");
+
+    // A sink that cannot be created ends at once without uploading
+    std::shared_ptr<RecordingSink> broken = std::make_shared<RecordingSink>(10, 100, &clock, 50);
+    broken->creates = false;
+    queue->upload(broken);
+    failed += check(queue->process() == 1 && broken->bands.empty(), name, "a failed sink was uploaded to");
+    failed += check(broken->ends == std::vector<bool>({ false }) && queue->isEmpty(), name, "a failed sink did not end at once");
+    failed += check(queue->getBacklogBytes() == 0, name, "a failed sink left bytes in the backlog");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Thread Pool
+/** How long a thread pool check may take before it counts as deadlocked */
+#define POOL_TIMEOUT_MS 10000
+
+/**
+ * Returns true if the work finishes in time
+ *
+ * The work runs on its own thread, which is abandoned if it deadlocks. So
+ * the work must own (copy) everything it uses.
+ *
+ * @param work  The work to run
+ *
+ * @return true if the work finishes in time
+ */
+static bool finishes(const std::function<void()>& work) {
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> result = done->get_future();
+    std::thread([work, done]() {
+        work();
+        done->set_value();
+    }).detach();
+    return result.wait_for(std::chrono::milliseconds(POOL_TIMEOUT_MS)) == std::future_status::ready;
+}
+
+/**
+ * Returns true if the function throws a broken promise future_error
+ *
+ * @param func  The function to call
+ *
+ * @return true if the function throws a broken promise future_error
+ */
+static bool breaksPromise(const std::function<void()>& func) {
+    try {
+        func();
+    } catch (const std::future_error& e) {
+        return e.code() == std::future_errc::broken_promise;
+    } catch (...) {
+    }
+    return false;
+}
+
+/**
+ * Checks stealing, parallelFor, errors and cancelling in a ThreadPool
+ *
+ * Every index of a parallelFor must be covered exactly once, even when it
+ * is nested in tasks of the same pool. A worker that blocks must have its
+ * queued tasks stolen. A task group rethrows the first error of its tasks
+ * once, and reports tasks dropped by dispose as cancelled.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testThreadPool() {
+    const char* name = "ThreadPool";
+    int failed = 0;
+    std::shared_ptr<ThreadPool> pool = ThreadPool::alloc(4);
+    if (pool == nullptr) {
+        return check(false, name, "the pool could not be allocated");
+    }
+
+    // Every index exactly once, for ranges that do and do not split evenly
+    size_t ranges[][3] = { { 0, 10007, 64 }, { 5, 1000, 7 }, { 3, 4, 100 }, { 0, 256, 1 } };
+    for (auto& range : ranges) {
+        std::vector<std::atomic<int>> hits(range[1]);
+        pool->parallelFor(range[0], range[1], range[2], [&](size_t begin, size_t end) {
+            for (size_t ii = begin; ii < end; ii++) {
+                hits[ii]++;
+            }
+        });
+        bool once = true;
+        for (size_t ii = 0; ii < range[1]; ii++) {
+            once = once && hits[ii] == (ii >= range[0] ? 1 : 0);
+        }
+        failed += check(once, name, "parallelFor did not cover every index exactly once");
+    }
+    bool called = false;
+    pool->parallelFor(10, 10, 1, [&](size_t, size_t) { called = true; });
+    failed += check(!called, name, "parallelFor ran the body on an empty range");
+
+    // A worker blocked on its own queued tasks needs another worker to steal them
+    std::future<bool> stolen = pool->submit([pool]() {
+        auto done = std::make_shared<std::atomic<int>>(0);
+        std::thread::id self = std::this_thread::get_id();
+        auto elsewhere = std::make_shared<std::atomic<int>>(0);
+        for (int ii = 0; ii < 8; ii++) {
+            pool->addTask([=]() {
+                *elsewhere += std::this_thread::get_id() != self;
+                (*done)++;
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        while (*done < 8 && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(POOL_TIMEOUT_MS)) {
+            std::this_thread::yield();
+        }
+        return *done == 8 && *elsewhere == 8;
+    });
+    failed += check(stolen.get(), name, "the tasks queued by a busy worker were not stolen");
+
+    // Nested parallelFor calls from every worker at once
+    auto sums = std::make_shared<std::vector<std::atomic<size_t>>>(16);
+    bool nested = finishes([pool, sums]() {
+        TaskGroup group(pool);
+        for (size_t ii = 0; ii < sums->size(); ii++) {
+            group.run([pool, sums, ii]() {
+                pool->parallelFor(0, 1000, 10, [&](size_t begin, size_t end) {
+                    (*sums)[ii] += end - begin;
+                });
+            });
+        }
+        group.wait();
+    });
+    failed += check(nested, name, "a parallelFor nested in pool tasks deadlocked");
+    bool summed = true;
+    for (size_t ii = 0; nested && ii < sums->size(); ii++) {
+        summed = summed && (*sums)[ii] == 1000;
+    }
+    failed += check(summed, name, "a nested parallelFor did not cover its range");
+
+    // The first error is rethrown once (without a pool the tasks run in order)
+    int caught = 0;
+    std::string first;
+    TaskGroup inline_(nullptr);
+    inline_.run([]() { throw std::runtime_error("first"); });
+    inline_.run([]() { throw std::logic_error("second"); });
+    for (int ii = 0; ii < 2; ii++) {
+        try {
+            inline_.wait();
+        } catch (const std::exception& e) {
+            caught++;
+            first = e.what();
+        }
+    }
+    failed += check(caught == 1 && first == "first", name, "the first error was not rethrown exactly once");
+
+    // With errors on every worker, all tasks still run and one error comes back
+    std::atomic<int> ran(0);
+    caught = 0;
+    {
+        TaskGroup group(pool);
+        for (int ii = 0; ii < 100; ii++) {
+            group.run([&]() {
+                ran++;
+                throw std::runtime_error("task");
+            });
+        }
+        for (int ii = 0; ii < 2; ii++) {
+            try {
+                group.wait();
+            } catch (const std::runtime_error&) {
+                caught++;
+            }
+        }
+        group.run([&]() { ran++; });
+        try {
+            group.wait();
+        } catch (...) {
+            caught++;
+        }
+    }
+    failed += check(ran == 101 && caught == 1, name, "the errors of pool tasks were not rethrown exactly once");
+
+    // Tasks still queued when the pool is disposed are cancelled
+    std::shared_ptr<ThreadPool> single = ThreadPool::alloc(1);
+    std::atomic<bool> started(false);
+    std::atomic<bool> gate(false);
+    single->addTask([&]() {
+        started = true;
+        while (!gate) {
+            std::this_thread::yield();
+        }
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    ran = 0;
+    TaskGroup dropped(single);
+    for (int ii = 0; ii < 3; ii++) {
+        dropped.run([&]() { ran++; });
+    }
+    std::future<int> future = single->submit([]() { return 1; });
+    single->stop();
+    gate = true;
+    single->dispose();
+    failed += check(dropped.isDone() && ran == 0, name, "dispose ran or kept the queued tasks");
+    failed += check(breaksPromise([&]() { dropped.wait(); }), name, "the cancelled group tasks were not reported as a broken promise");
+    failed += check(breaksPromise([&]() { future.get(); }), name, "the cancelled future was not a broken promise");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Json Index
+/**
+ * Returns true if every key of the object finds the child with that key
+ *
+ * The object must not have duplicated keys.
+ *
+ * @param json  The JSON object
+ *
+ * @return true if every key of the object finds the child with that key
+ */
+static bool findsEveryKey(const std::shared_ptr<JsonValue>& json) {
+    for (const std::shared_ptr<JsonValue>& child : json->children()) {
+        if (json->get(child->key()) != child) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the keys of the children of an object, in order
+ *
+ * @param json  The JSON object
+ *
+ * @return the keys of the children of an object, in order
+ */
+static std::vector<std::string> childKeys(const std::shared_ptr<JsonValue>& json) {
+    std::vector<std::string> result;
+    for (const std::shared_ptr<JsonValue>& child : json->children()) {
+        result.push_back(child->key());
+    }
+    return result;
+}
+
+/**
+ * Checks that the key index of a JsonValue object follows every change
+ *
+ * The object has more than JSON_INDEX_MINIMUM children, so its lookups go
+ * through the index. Each change is made after a lookup has built the
+ * index, and the next lookups must see it.
+ *
+ * @return the number of failed checks
+ */
+int Tests::testJsonIndex() {
+    const char* name = "JsonIndex";
+    int failed = 0;
+    std::shared_ptr<JsonValue> json = JsonValue::allocObject();
+    std::vector<std::string> keys;
+    for (long ii = 0; ii < JSON_INDEX_MINIMUM + 4; ii++) {
+        keys.push_back("k" + std::to_string(ii));
+        json->appendChild(keys.back(), JsonValue::alloc(ii));
+    }
+    failed += check(json->get("k5") != nullptr && json->get("k5")->asLong() == 5, name, "the indexed lookup is wrong");
+    failed += check(findsEveryKey(json) && json->get("none") == nullptr, name, "the index does not match the children");
+
+    json->appendChild("last", JsonValue::alloc(100L));
+    keys.push_back("last");
+    failed += check(json->has("last") && json->get("last")->asLong() == 100, name, "the index missed an appended child");
+
+    json->insertChild(0, "first", JsonValue::alloc(200L));
+    keys.insert(keys.begin(), "first");
+    failed += check(json->get("first") != nullptr && json->get("first")->asLong() == 200, name, "the index missed an inserted child");
+    failed += check(json->get("k5")->asLong() == 5 && findsEveryKey(json), name, "the index did not follow an insertion");
+
+    json->removeChild(0);
+    keys.erase(keys.begin());
+    failed += check(!json->has("first") && json->get("k5")->asLong() == 5 && findsEveryKey(json), name, "the index did not follow a removal by position");
+
+    json->removeChild("k3");
+    keys.erase(std::find(keys.begin(), keys.end(), "k3"));
+    failed += check(!json->has("k3") && json->get("k4")->asLong() == 4 && findsEveryKey(json), name, "the index did not follow a removal by key");
+
+    json->get("k7")->setKey("seven");
+    *std::find(keys.begin(), keys.end(), "k7") = "seven";
+    failed += check(!json->has("k7") && json->get("seven") != nullptr && json->get("seven")->asLong() == 7, name, "the index did not follow a new key");
+
+    json->get("k9")->merge(JsonValue::alloc(std::string("nine")));
+    keys.erase(std::find(keys.begin(), keys.end(), "k9"));
+    keys.push_back("k9");
+    failed += check(json->get("k9") != nullptr && json->get("k9")->asString() == "nine" && findsEveryKey(json), name, "the index did not follow a merge");
+    failed += check(childKeys(json) == keys, name, "the children are not in insertion order");
+
+    // A duplicated key finds its first child, before and after the index is rebuilt
+    std::string text = "{";
+    for (int ii = 0; ii < JSON_INDEX_MINIMUM + 4; ii++) {
+        text += "\"k" + std::to_string(ii) + "\": " + std::to_string(ii) + ", ";
+    }
+    text += "\"k2\": -1}";
+    json = JsonValue::allocWithJson(text);
+    if (json == nullptr) {
+        return failed + check(false, name, "the object with a duplicated key could not be parsed");
+    }
+    failed += check(json->size() == JSON_INDEX_MINIMUM + 5 && json->get("k2")->asLong() == 2, name, "a duplicated key did not find its first child");
+    json->removeChild("k0");
+    failed += check(json->get("k2")->asLong() == 2 && json->get((int)json->size() - 1)->asLong() == -1, name, "a duplicated key did not find its first child after a change");
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Json Parser
+/**
+ * Returns the first difference between two JSON trees (empty if none)
+ *
+ * The trees must agree on the type, key and value of every node, and on the
+ * order of the children. cJSON scales its numbers by a power of ten, which
+ * is off by an ulp or two, so the numbers need only agree to within a few
+ * ulps. The long value is only compared within the range of an int, as
+ * cJSON clamps its integers to that range.
+ *
+ * @param a     The first tree
+ * @param b     The second tree
+ * @param path  The path to the trees, for the report
+ *
+ * @return the first difference between two JSON trees (empty if none)
+ */
+static std::string diffJson(const JsonValue* a, const JsonValue* b, const std::string& path) {
+    if (a->type() != b->type()) {
+        return path + ": the types differ";
+    }
+    if (a->key() != b->key()) {
+        return path + ": the keys differ (" + a->key() + ", " + b->key() + ")";
+    }
+    switch (a->type()) {
+        case JsonValue::Type::BoolType:
+            if (a->asBool() != b->asBool()) {
+                return path + ": the bools differ";
+            }
+            break;
+        case JsonValue::Type::NumberType:
+            if (std::abs(a->asDouble() - b->asDouble()) > 4 * DBL_EPSILON * std::abs(b->asDouble())) {
+                char buffer[64];
+                std::snprintf(buffer, sizeof(buffer), " (%.17g, %.17g)", a->asDouble(), b->asDouble());
+                return path + ": the numbers differ" + buffer;
+            }
+            if (std::abs(a->asDouble()) < INT_MAX && a->asLong() != b->asLong()) {
+                return path + ": the integers differ";
+            }
+            break;
+        case JsonValue::Type::StringType:
+            if (a->asString() != b->asString()) {
+                return path + ": the strings differ";
+            }
+            break;
+        default:
+            break;
+    }
+    if (a->size() != b->size()) {
+        return path + ": the child counts differ";
+    }
+    for (size_t ii = 0; ii < a->size(); ii++) {
+        const JsonValue* child = a->get((int)ii).get();
+        std::string name = child->key().empty() ? "[" + std::to_string(ii) + "]" : "." + child->key();
+        std::string diff = diffJson(child, b->get((int)ii).get(), path + name);
+        if (!diff.empty()) {
+            return diff;
+        }
+    }
+    return "";
+}
+
+/**
+ * Adds every JSON file under the given directory to the list
+ *
+ * @param dir   The directory to search
+ * @param files The list of JSON files
+ */
+static void findJson(const std::string& dir, std::vector<std::string>& files) {
+    for (const std::string& file : filetool::dir_contents(dir)) {
+        if (filetool::is_dir(file)) {
+            findJson(file, files);
+        } else if (file.size() > 5 && file.compare(file.size() - 5, 5, ".json") == 0) {
+            files.push_back(file);
+        }
+    }
+}
+
+/**
+ * Checks that JsonParser reads every JSON asset the way cJSON does
+ *
+ * Each file under the json directory is parsed both ways, and the trees
+ * are compared node by node.
+ *
+ * @param assetDir  The asset directory
+ *
+ * @return the number of failed checks
+ */
+int Tests::testJsonParser(const std::string& assetDir) {
+    const char* name = "JsonParser";
+    std::vector<std::string> files;
+    findJson(filetool::join_path({ assetDir, "json" }), files);
+    int failed = check(!files.empty(), name, "there are no JSON files in the asset directory");
+    for (const std::string& file : files) {
+        std::shared_ptr<TextReader> reader = TextReader::alloc(file);
+        std::string text = reader == nullptr ? "" : reader->readAll();
+        if (reader != nullptr) {
+            reader->close();
+        }
+
+        cJSON* node = cJSON_ParseWithOpts(text.c_str(), nullptr, 0);
+        std::shared_ptr<JsonValue> expected = node == nullptr ? nullptr : JsonValue::toJsonValue(node);
+        cJSON_Delete(node);
+        std::shared_ptr<JsonValue> parsed = JsonValue::allocWithJson(text);
+
+        std::string base = filetool::base_name(file);
+        if (expected == nullptr || parsed == nullptr) {
+            std::string what = base + ": " + (expected == nullptr ? "cJSON" : "the parser") + " could not read the file";
+            failed += check(expected == nullptr && parsed == nullptr, name, what.c_str());
+            continue;
+        }
+        std::string diff = diffJson(parsed.get(), expected.get(), base);
+        failed += check(diff.empty(), name, diff.c_str());
+    }
+    CULog("%s: compared %zu files", name, files.size());
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Slicer
+/** The number of plane angles each collision mesh is cut at */
+#define SLICER_ANGLES       72
+/** The number of plane origins each collision mesh is cut through */
+#define SLICER_ORIGINS      3
+/** The largest distance between matching cut points, as a fraction of the mesh size */
+#define SLICER_TOLERANCE    0.0001f
+
+/**
+ * Adds the collision meshes of every level pack to the list
+ *
+ * @param assetDir  The asset directory
+ * @param files     The list to add the mesh paths to
+ */
+static void findCollisionMeshes(const std::string& assetDir, std::vector<std::string>& files) {
+    static const std::string suffix = "_col.obj";
+    for (const std::string& pack : filetool::dir_contents(filetool::join_path({ assetDir, "meshes" }))) {
+        if (!filetool::is_dir(pack)) {
+            continue;
+        }
+        for (const std::string& file : filetool::dir_contents(pack)) {
+            if (file.size() >= suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                files.push_back(file);
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+}
+
+/**
+ * Returns the farthest any point of one cut is from the points of the other
+ *
+ * This is FLT_MAX if exactly one of the cuts is empty.
+ *
+ * @param a     The points of the first cut
+ * @param b     The points of the second cut
+ *
+ * @return the farthest any point of one cut is from the points of the other
+ */
+static float cutDistance(const std::vector<Vec3>& a, const std::vector<Vec3>& b) {
+    if (a.empty() || b.empty()) {
+        return a.empty() == b.empty() ? 0.0f : FLT_MAX;
+    }
+    auto farthest = [](const std::vector<Vec3>& from, const std::vector<Vec3>& to) {
+        float result = 0;
+        for (const Vec3& p : from) {
+            float nearest = FLT_MAX;
+            for (const Vec3& q : to) {
+                nearest = std::min(nearest, p.distanceSquared(q));
+            }
+            result = std::max(result, nearest);
+        }
+        return result;
+    };
+    return sqrtf(std::max(farthest(a, b), farthest(b, a)));
+}
+
+/**
+ * Returns the points of the libigl isoline cut of a mesh
+ *
+ * This does not use PivotMesh::intersectPlane, whose far away vertices are
+ * in single precision and move the cut off the plane. Two unused vertices
+ * at the same distance on either side instead put the middle isoline
+ * exactly on the plane.
+ *
+ * @param verts     The mesh vertices
+ * @param faces     The mesh faces
+ * @param origin    The origin of the plane
+ * @param normal    The normal of the plane
+ * @param segments  Set to the number of segments in the cut
+ *
+ * @return the points of the libigl isoline cut of a mesh
+ */
+static std::vector<Vec3> isolineCut(const Eigen::MatrixXd& verts, const Eigen::MatrixXi& faces,
+                                    const Vec3& origin, const Vec3& normal, size_t& segments) {
+    Eigen::MatrixXd padded(verts.rows() + 2, 3);
+    padded << verts, Eigen::MatrixXd::Zero(2, 3);
+    Eigen::VectorXd height(padded.rows());
+    double bound = 1;
+    for (int ii = 0; ii < verts.rows(); ii++) {
+        height(ii) = (verts(ii, 0) - origin.x) * normal.x + (verts(ii, 1) - origin.y) * normal.y +
+                     (verts(ii, 2) - origin.z) * normal.z;
+        bound = std::max(bound, 2 * std::abs(height(ii)));
+    }
+    height(verts.rows()) = -bound;
+    height(verts.rows() + 1) = bound;
+
+    Eigen::MatrixXd cutVerts;
+    Eigen::MatrixXi cutEdges;
+    igl::isolines(padded, faces, height, 2, cutVerts, cutEdges);
+    std::vector<Vec3> result;
+    for (int ii = 0; ii < cutVerts.rows(); ii++) {
+        result.push_back(Vec3(cutVerts(ii, 0), cutVerts(ii, 1), cutVerts(ii, 2)));
+    }
+    segments = cutEdges.rows();
+    return result;
+}
+
+/**
+ * Checks that PlaneSlicer cuts every level the way libigl isolines does
+ *
+ * Each collision mesh is cut at a sweep of angles through several origins.
+ * Both cuts must have the same number of segments, and every point of one
+ * must be on the other. The sweep skips the axis aligned angles, where the
+ * plane passes through vertices and libigl adds degenerate segments.
+ *
+ * @param assetDir  The asset directory
+ *
+ * @return the number of failed checks
+ */
+int Tests::testSlicer(const std::string& assetDir) {
+    const char* name = "Slicer";
+    std::vector<std::string> files;
+    findCollisionMeshes(assetDir, files);
+    int failed = check(!files.empty(), name, "there are no collision meshes in the asset directory");
+    int cuts = 0;
+    for (const std::string& file : files) {
+        std::string base = filetool::base_name(file);
+        Eigen::MatrixXd verts;
+        Eigen::MatrixXi faces;
+        std::shared_ptr<PivotMesh> mesh = PivotMesh::MeshFromOBJ(file, PivotMesh::LOAD_SLICE);
+        if (mesh == nullptr || !igl::readOBJ(file, verts, faces) || verts.rows() == 0) {
+            failed += check(false, name, (base + ": the mesh could not be sliced").c_str());
+            continue;
+        }
+
+        Eigen::Vector3d least = verts.colwise().minCoeff();
+        Eigen::Vector3d most = verts.colwise().maxCoeff();
+        Vec3 lo(least.x(), least.y(), least.z());
+        Vec3 hi(most.x(), most.y(), most.z());
+        float tolerance = SLICER_TOLERANCE * lo.distance(hi);
+
+        int mismatches = 0;
+        float error = 0;
+        for (int ii = 0; ii < SLICER_ORIGINS; ii++) {
+            Vec3 origin = lo + (hi - lo) * (ii + 1.0f) / (SLICER_ORIGINS + 1.0f);
+            for (int jj = 0; jj < SLICER_ANGLES; jj++) {
+                float angle = (jj + 0.5f) * 2 * M_PI / SLICER_ANGLES;
+                Vec3 normal(cosf(angle), sinf(angle), 0);
+
+                size_t expected = 0;
+                std::vector<Vec3> want = isolineCut(verts, faces, origin, normal, expected);
+                std::vector<Vec3> have;
+                size_t segments = 0;
+                for (const PlaneSlicer::Contour& contour : mesh->slice(origin, normal)) {
+                    have.insert(have.end(), contour.points.begin(), contour.points.end());
+                    segments += contour.points.size() - (contour.closed ? 0 : 1);
+                }
+
+                float dist = cutDistance(want, have);
+                error = std::max(error, dist);
+                mismatches += (dist > tolerance || segments != expected);
+                cuts++;
+            }
+        }
+        if (mismatches) {
+            std::string what = base + ": " + std::to_string(mismatches) + " of " +
+                               std::to_string(SLICER_ORIGINS * SLICER_ANGLES) + " cuts differ from libigl (the largest error is " +
+                               std::to_string(error) + ")";
+            failed += check(false, name, what.c_str());
+        }
+    }
+    CULog("%s: compared %d cuts of %zu meshes", name, cuts, files.size());
+    return failed;
+}
+
+#pragma mark -
+#pragma mark Running
+/**
+ * Runs every test
+ *
+ * The tests that read assets are skipped if there is no asset directory.
+ *
+ * @param assetDir  The asset directory (or empty for none)
+ *
+ * @return the number of failed checks
+ */
+int Tests::runAll(const std::string& assetDir) {
+    int failed = 0;
+    failed += testMeshBuffer();
+    failed += testLightGrid();
+    failed += testBillboardBatch();
+    failed += testMeshChunks();
+    failed += testMaterializeQueue();
+    failed += testThreadPool();
+    failed += testJsonIndex();
+    if (assetDir.empty()) {
+        CULog("Skipped the asset checks (there is no asset directory)");
+    } else {
+        failed += testJsonParser(assetDir);
+        failed += testSlicer(assetDir);
+    }
+    if (failed) {
+        CULogError("%d checks failed", failed);
+    } else {
+        CULog("All checks passed");
+    }
+    return failed;
+}
+
+/**
+ * Runs the tests from the command line
+ *
+ * The only argument is the asset directory, which may be left out to skip
+ * the tests that read assets.
+ *
+ * @param argc  The number of arguments
+ * @param argv  The arguments (the first is the program)
+ *
+ * @return 0 if every check passed, 1 otherwise
+ */
+int Tests::main(int argc, char* argv[]) {
+    if (argc > 2) {
+        CULogError("usage: %s [asset dir]", argv[0]);
+        return 1;
+    }
+    return runAll(argc > 1 ? argv[1] : "") == 0 ? 0 : 1;
+}
+
+#endif /* PIVOT_TESTS */
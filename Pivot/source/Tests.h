@@ -0,0 +1,143 @@
+//
+//  Tests.h
+//  Pivot
+//
+//  Checks of the game systems that can run without a window or GL context.
+//  They are only compiled into the game when PIVOT_TESTS is defined, in which
+//  case main runs them instead of starting the application. Each check logs
+//  what went wrong, and the exit status says whether any of them failed. The
+//  checks that read assets need the asset directory as an argument.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef Tests_h
+#define Tests_h
+#include <cugl/cugl.h>
+#include <string>
+
+/**
+ * The unit checks, run headless.
+ *
+ * Each test function returns the number of failed checks, after logging each
+ * of them. Anything that would need GL runs against a mock device instead.
+ */
+class Tests {
+public:
+    /**
+     * Checks that a MeshBuffer only uploads when the mesh changes
+     *
+     * The buffer runs on a mock device that records each load, so this
+     * covers the upload bookkeeping without a GL context.
+     *
+     * @return the number of failed checks
+     */
+    static int testMeshBuffer();
+
+    /**
+     * Checks that a LightGrid bins each light into the tiles it reaches
+     *
+     * This also checks the packed tile texels and that a full grid keeps
+     * the brightest lights.
+     *
+     * @return the number of failed checks
+     */
+    static int testLightGrid();
+
+    /**
+     * Checks the grouping, order and quads of a BillboardBatch
+     *
+     * The textures are never initialized, so this needs no GL context.
+     *
+     * @return the number of failed checks
+     */
+    static int testBillboardBatch();
+
+    /**
+     * Checks that MeshChunks splits a mesh into disjoint chunks and culls them
+     *
+     * The culling runs against a FrameVisibility view, with triangles that
+     * just touch the screen rectangle and the slab.
+     *
+     * @return the number of failed checks
+     */
+    static int testMeshChunks();
+
+    /**
+     * Checks the order, budget and chunking of a MaterializeQueue
+     *
+     * The uploads go to a mock sink, and the budget runs on a test clock.
+     *
+     * @return the number of failed checks
+     */
+    static int testMaterializeQueue();
+
+    /**
+     * Checks that the key index of a JsonValue object follows every change
+     *
+     * This covers appending, inserting, removing, renaming and merging
+     * children, duplicated keys and the order of the children.
+     *
+     * @return the number of failed checks
+     */
+    static int testJsonIndex();
+
+    /**
+     * Checks stealing, parallelFor, errors and cancelling in a ThreadPool
+     *
+     * A deadlock fails the check after a timeout, instead of hanging.
+     *
+     * @return the number of failed checks
+     */
+    static int testThreadPool();
+
+    /**
+     * Checks that JsonParser reads every JSON asset the way cJSON does
+     *
+     * Each file under the json directory is parsed both ways, and the first
+     * difference between the two trees is logged.
+     *
+     * @param assetDir  The asset directory
+     *
+     * @return the number of failed checks
+     */
+    static int testJsonParser(const std::string& assetDir);
+
+    /**
+     * Checks that PlaneSlicer cuts every level the way libigl isolines does
+     *
+     * Each collision mesh is cut at a sweep of angles and origins, and the
+     * meshes with cuts that differ are logged.
+     *
+     * @param assetDir  The asset directory
+     *
+     * @return the number of failed checks
+     */
+    static int testSlicer(const std::string& assetDir);
+
+    /**
+     * Runs every test
+     *
+     * The tests that read assets are skipped if there is no asset directory.
+     *
+     * @param assetDir  The asset directory (or empty for none)
+     *
+     * @return the number of failed checks
+     */
+    static int runAll(const std::string& assetDir);
+
+    /**
+     * Runs the tests from the command line
+     *
+     * The only argument is the asset directory, which may be left out to skip
+     * the tests that read assets.
+     *
+     * @param argc  The number of arguments
+     * @param argv  The arguments (the first is the program)
+     *
+     * @return 0 if every check passed, 1 otherwise
+     */
+    static int main(int argc, char* argv[]);
+};
+
+#endif /* Tests_h */
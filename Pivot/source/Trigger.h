@@ -116,12 +116,18 @@ private:
     std::shared_ptr<PivotMesh> _mesh;
 
 public:
-    /**construct a trigger object from a mesh*/
+    /**construct a trigger object from a mesh (this builds the containment engine of the mesh)*/
     Trigger(std::shared_ptr<PivotMesh> mesh) {
         _mesh = mesh;
         state = 0;
+        if (_mesh != nullptr && _mesh->getVolume() == nullptr) {
+            _mesh->buildVolume();
+        }
     }
 
+    /**get the region mesh of this trigger*/
+    std::shared_ptr<PivotMesh> getMesh() { return _mesh; }
+
 
     /**add a callback to run when the player enters the trigger region*/
     void registerEnterCallback(std::function<void(TriggerArgs)> cb, TriggerArgs args) {
@@ -0,0 +1,104 @@
+//
+//  TriggerIndex.cpp
+//  Pivot
+//
+//  Level-wide spatial hash of the trigger regions.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#include "TriggerIndex.h"
+#include <algorithm>
+
+/**
+ * Initializes the index over the given regions
+ *
+ * @param triggers  The trigger regions of the level
+ * @param cellSize  The width of a hash cell in world units
+ *
+ * @return true if the index was initialized properly
+ */
+bool TriggerIndex::init(const std::vector<std::shared_ptr<Trigger>>& triggers, float cellSize) {
+    if (cellSize <= 0) {
+        CULogError("Trigger index needs a positive cell size");
+        return false;
+    }
+    _triggers = triggers;
+    _cellSize = cellSize;
+    _cells.clear();
+    _always.clear();
+    _located = false;
+    _lookups = 0;
+
+    for (Uint32 ii = 0; ii < _triggers.size(); ii++) {
+        auto volume = _triggers[ii]->getMesh() == nullptr ? nullptr : _triggers[ii]->getMesh()->getVolume();
+        if (volume == nullptr) {
+            // No bounds to hash by, so fall back to testing it every frame
+            _always.push_back(ii);
+            continue;
+        }
+        int x0 = cellOf(volume->getMin().x), x1 = cellOf(volume->getMax().x);
+        int y0 = cellOf(volume->getMin().y), y1 = cellOf(volume->getMax().y);
+        int z0 = cellOf(volume->getMin().z), z1 = cellOf(volume->getMax().z);
+        if ((double)(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > TRIGGER_MAX_CELLS) {
+            _always.push_back(ii);
+            continue;
+        }
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) {
+                for (int z = z0; z <= z1; z++) {
+                    _cells[key(x, y, z)].push_back(ii);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the key of the cell with the given coordinates
+ *
+ * Each coordinate keeps its low 21 bits, which is far more cells than a level
+ * can span.
+ *
+ * @param x The cell column
+ * @param y The cell row
+ * @param z The cell layer
+ */
+Uint64 TriggerIndex::key(int x, int y, int z) {
+    const Uint64 mask = (1ULL << 21) - 1;
+    return ((Uint64)x & mask) | (((Uint64)y & mask) << 21) | (((Uint64)z & mask) << 42);
+}
+
+/**
+ * Updates the regions near the given location
+ *
+ * This has the same effect as calling Trigger::update on every region.
+ *
+ * @param location  The player location
+ */
+void TriggerIndex::update(const Vec3& location) {
+    Uint64 cell = key(cellOf(location.x), cellOf(location.y), cellOf(location.z));
+    if (!_located || cell != _cell) {
+        _cell = cell;
+        _located = true;
+        _lookups++;
+        _candidates = _always;
+        auto it = _cells.find(cell);
+        if (it != _cells.end()) {
+            _candidates.insert(_candidates.end(), it->second.begin(), it->second.end());
+        }
+        std::sort(_candidates.begin(), _candidates.end());
+    }
+
+    // Candidates plus anything still inside, in the original order
+    _active.clear();
+    std::set_union(_candidates.begin(), _candidates.end(), _inside.begin(), _inside.end(),
+                   std::back_inserter(_active));
+    _inside.clear();
+    for (Uint32 ii : _active) {
+        if (_triggers[ii]->update(location)) {
+            _inside.push_back(ii);
+        }
+    }
+}
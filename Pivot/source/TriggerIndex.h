@@ -0,0 +1,130 @@
+//
+//  TriggerIndex.h
+//  Pivot
+//
+//  Level-wide spatial hash of the trigger regions, so that each frame only the
+//  regions near the player are tested.
+//
+//  Created by the Pivot team on 10/17/26.
+//
+
+#ifndef TriggerIndex_h
+#define TriggerIndex_h
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <vector>
+#include "Trigger.h"
+
+using namespace cugl;
+
+/** Default width of a hash cell in world units */
+#define TRIGGER_CELL_SIZE   256.0f
+/** Regions covering more cells than this are tested every frame instead */
+#define TRIGGER_MAX_CELLS   4096
+
+/**
+ * A uniform grid over the trigger regions of a level.
+ *
+ * Every region is filed under each cell that its bounding box overlaps. The
+ * regions near the player are looked up again only when the player crosses a
+ * cell boundary; until then the same candidate list is reused, and every
+ * region outside of it is skipped without a test.
+ *
+ * A region the player is inside is always updated, even if it is not a
+ * candidate, so that its in-bounds callbacks keep firing and its exit
+ * callbacks fire when the player leaves. Regions are updated in the order
+ * they were added, just like updating every trigger in turn, so callbacks
+ * run in the same order as before.
+ */
+class TriggerIndex {
+private:
+    /** The regions, in the order they were added */
+    std::vector<std::shared_ptr<Trigger>> _triggers;
+    /** The regions under each cell */
+    std::unordered_map<Uint64, std::vector<Uint32>> _cells;
+    /** The regions too large to hash, tested every frame */
+    std::vector<Uint32> _always;
+    /** The width of a cell */
+    float _cellSize;
+
+    /** The cell the player was in last frame */
+    Uint64 _cell;
+    /** Whether _cell is valid */
+    bool _located;
+    /** The regions under the player cell (including _always) */
+    std::vector<Uint32> _candidates;
+    /** The regions the player was inside after the last update */
+    std::vector<Uint32> _inside;
+    /** The regions updated this frame */
+    std::vector<Uint32> _active;
+    /** The number of candidate lookups (cell crossings) */
+    Uint64 _lookups;
+
+    /**
+     * Returns the key of the cell with the given coordinates
+     *
+     * @param x The cell column
+     * @param y The cell row
+     * @param z The cell layer
+     */
+    static Uint64 key(int x, int y, int z);
+
+    /** Returns the cell coordinate of a world coordinate */
+    int cellOf(float value) const { return (int)std::floor(value / _cellSize); }
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty index. You must call init before using it.
+     */
+    TriggerIndex() : _cellSize(0), _cell(0), _located(false), _lookups(0) {}
+
+    /**
+     * Initializes the index over the given regions
+     *
+     * @param triggers  The trigger regions of the level
+     * @param cellSize  The width of a hash cell in world units
+     *
+     * @return true if the index was initialized properly
+     */
+    bool init(const std::vector<std::shared_ptr<Trigger>>& triggers, float cellSize = TRIGGER_CELL_SIZE);
+
+    /**
+     * Returns a newly allocated index over the given regions
+     *
+     * @param triggers  The trigger regions of the level
+     * @param cellSize  The width of a hash cell in world units
+     *
+     * @return a newly allocated index over the given regions
+     */
+    static std::shared_ptr<TriggerIndex> alloc(const std::vector<std::shared_ptr<Trigger>>& triggers,
+                                               float cellSize = TRIGGER_CELL_SIZE) {
+        std::shared_ptr<TriggerIndex> result = std::make_shared<TriggerIndex>();
+        return (result->init(triggers, cellSize) ? result : nullptr);
+    }
+
+#pragma mark Updating
+    /**
+     * Updates the regions near the given location
+     *
+     * This has the same effect as calling Trigger::update on every region.
+     *
+     * @param location  The player location
+     */
+    void update(const Vec3& location);
+
+#pragma mark Attributes
+    /** Returns the number of regions in the index */
+    size_t size() const { return _triggers.size(); }
+
+    /** Returns the number of non-empty cells */
+    size_t getCellCount() const { return _cells.size(); }
+
+    /** Returns the number of regions updated in the last frame */
+    size_t getActiveCount() const { return _active.size(); }
+
+    /** Returns the number of times the candidates were looked up again */
+    Uint64 getLookups() const { return _lookups; }
+};
+
+#endif /* TriggerIndex_h */
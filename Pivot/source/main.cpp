@@ -27,8 +27,16 @@
 //  Author: Walker White
 //  Version: 7/1/16
 
+#ifdef PIVOT_HEADLESS
+// The simulation is built without the application (see README.md)
+#include "Simulation.h"
+#else
 // Include your application class
 #include "App.h"
+#endif
+#ifdef PIVOT_TESTS
+#include "Tests.h"
+#endif
 
 using namespace cugl;
 
@@ -42,6 +50,15 @@ using namespace cugl;
  * @return the exit status of the application
  */
 int main(int argc, char * argv[]) {
+#ifdef PIVOT_HEADLESS
+    // Replay the levels without a window, graphics or sound
+    return Simulation::main(argc, argv);
+#else
+#ifdef PIVOT_TESTS
+    // Run the unit checks without a window or GL context
+    return Tests::main(argc, argv);
+#endif
+
     // Change this to your application class
     PivotApp app;
     
@@ -65,6 +82,7 @@ int main(int argc, char * argv[]) {
 
     exit(0);    // Necessary to quit on mobile devices
     return 0;   // This line is never reached
+#endif
 
     
 }
@@ -14,18 +14,22 @@ uniform sampler2D normalTexture;
 uniform sampler2D posTexture;
 uniform vec3 vpos; // for specular only
 uniform mat4 Mv; // for specular only
-uniform vec3 color;
-uniform vec3 lpos;
-uniform float power;
-uniform float numLights;
-uniform float attenuation;
-uniform float effectivePower;
-
-// Editable parameters for diffuse calculation
+uniform highp sampler2D lightTexture; // (position, 0) then (color * power, 0) per light
+uniform highp sampler2D tileTexture; // (offset, count) per tile, then light indices
+uniform int tileSize;
+uniform int tileCols;
+uniform int tileCount;
+
+// Editable parameters for diffuse calculation (must match LightGrid.h)
 const float powerMult = 10000.0;
 float constAtten = 2000.0; //usually attenuation
 const float linearAtten = 0.0;
 const float sqAtten = 1.0;
+const int tileTexWidth = 256;
+
+highp vec4 tileTexel(int texel) {
+    return texelFetch(tileTexture, ivec2(texel % tileTexWidth, texel / tileTexWidth), 0);
+}
 
 void main(void) {
     // Do not calculate if this area is cut
@@ -38,13 +42,30 @@ void main(void) {
 	vec3 norm = (texture(normalTexture, outTexCoord).xyz * 2.0) - vec3(1.0);
     float doLighting = texture(normalTexture, outTexCoord).a;
 	vec3 pos = texture(posTexture, outTexCoord).xyz;
+    if (doLighting == 0.0) {
+        frag_color = vec4(alb, 1.0);
+        return;
+    }
 
-    // Diffuse calculation
-    vec3 lightDir = normalize(lpos - pos);
-	float lightDist = distance(lpos, pos);
-    vec3 numerator = max(dot(norm, lightDir), 0.0) * alb * color * power * powerMult * effectivePower;
-    float denominator = constAtten + (linearAtten * lightDist) + (sqAtten * lightDist * lightDist);
-    vec3 diffuse = numerator / denominator;
+    // Only the lights binned into this tile can reach the pixel
+    ivec2 tile = ivec2(gl_FragCoord.xy) / tileSize;
+    highp vec4 header = tileTexel(tile.y * tileCols + tile.x);
+    int offset = int(header.x);
+    int count = int(header.y);
+
+    vec3 diffuse = vec3(0.0);
+    for (int i = offset; i < offset + count; i++) {
+        int light = int(tileTexel(tileCount + i / 4)[i % 4]);
+        highp vec3 lpos = texelFetch(lightTexture, ivec2(2 * light, 0), 0).xyz;
+        vec3 color = texelFetch(lightTexture, ivec2(2 * light + 1, 0), 0).xyz;
+
+        // Diffuse calculation
+        vec3 lightDir = normalize(lpos - pos);
+        float lightDist = distance(lpos, pos);
+        vec3 numerator = max(dot(norm, lightDir), 0.0) * alb * color * powerMult;
+        float denominator = constAtten + (linearAtten * lightDist) + (sqAtten * lightDist * lightDist);
+        diffuse += numerator / denominator;
+    }
 
     // Specular attempt
     //float specularStrength = 0.1;
@@ -55,9 +76,6 @@ void main(void) {
     //vec3 specular = specularStrength * spec * color; 
 
 	frag_color = vec4(diffuse, 1.0);
-    if (doLighting == 0.0) {
-        frag_color = vec4(alb / numLights, 1.0);
-    }
 }
 
 /////////// SHADER END //////////)"
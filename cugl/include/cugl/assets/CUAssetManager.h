@@ -50,9 +50,13 @@
 #include <cugl/util/CUThreadPool.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/assets/CULoader.h>
+#include <cugl/assets/CUMaterializeQueue.h>
 #include <typeinfo>
 #include <atomic>
 
+/** The most worker threads an asset manager starts by default */
+#define ASSET_MAX_WORKERS   4
+
 
 namespace cugl {
     
@@ -93,14 +97,42 @@ protected:
     std::unordered_map<std::string,size_t> _jsonKeys;
     /** The priorities for each JSON key */
     std::unordered_map<std::string,Uint32> _priority;
-    /** The central thread for managing all of the loaders */
+    /** The threads shared by all of the loaders */
     std::shared_ptr<ThreadPool> _workers;
+    /** The main thread work shared by all of the loaders */
+    std::shared_ptr<MaterializeQueue> _materializer;
 
-    /** State variable to manage reading JSON directories */
-    bool _preload;
-    
-    /** Wait variable to create a load barrier for directories. */
-    std::atomic<bool> _wait;
+    /** The number of asset directories still being read from a file */
+    Uint32 _preload;
+    /** The number of directory assets waiting on an earlier stage */
+    size_t _staged;
+
+    /**
+     * An asynchronous load of an asset directory
+     *
+     * A directory is loaded in stages, one for each loader priority. The
+     * assets of a stage are all queued at once, and load in parallel on the
+     * worker threads. The next stage is not queued until every loader in the
+     * current stage has materialized its assets, so an asset may depend on
+     * any asset of a higher priority (e.g. a scene graph on its textures).
+     *
+     * Assets of one stage may finish in any order. The results are buffered
+     * so that the callback sees them in the order of the directory.
+     */
+    struct DirectoryLoad {
+        /** The categories of each stage, as loader hashes and JSON children */
+        std::vector<std::vector<std::pair<size_t,std::shared_ptr<JsonValue>>>> stages;
+        /** The stage being loaded */
+        size_t stage;
+        /** The callback for each asset (may be nullptr) */
+        LoaderCallback callback;
+        /** The keys of the current stage, in directory order */
+        std::vector<std::string> keys;
+        /** The result of each key (-1 if not yet loaded, else a bool) */
+        std::vector<int> results;
+        /** The number of keys of the current stage passed to the callback */
+        size_t reported;
+    };
 
     /**
      * Synchronously reads an asset category from a JSON file
@@ -127,40 +159,45 @@ protected:
     bool readCategory(size_t hash, const std::shared_ptr<JsonValue>& json);
     
     /**
-     * Asynchronously reads an asset category from a JSON file
+     * Asynchronously reads the current stage of a directory load
      *
-     * JSON directories provide a robust way for us to load a collection of
-     * assets. Instead of having to define parameters like asset key, font
-     * size, or texture wrap in the code, we can specify them in a JSON file.
-     * This JSON file (called the asset directory) is read by the asset manager,
-     * and directs the various loaders to load in assets.
+     * Every asset of the stage is queued with its loader, which hands the
+     * work that is safe outside of the main thread to the worker threads.
+     * The loaders materialize the assets on the main thread, via the
+     * {@link Application#schedule} interface.
      *
-     * Currently JSON loading supports five types of assets, with the following
-     * names: "textures", "fonts", "music", "soundfx", and "jsons".  See the
-     * method {@link BaseLoader#read} in each of the individual loaders for a
-     * description of the suported JSON format. A loader must still be attached
-     * for the asset manager to read that type of asset.  If the asset directory
-     * contains an asset for which there is no attached asset manager, those
-     * specific assets will not be loaded.
+     * If a category has no attached loader, the callback is given the asset
+     * category name (e.g. "soundfx") as the asset key.
      *
-     * As an asynchronous read, all asset loading will take place outside of
-     * the main thread.  However, assets such as fonts and textures will need
-     * the OpenGL context to complete, so part of their asset loading may take
-     * place in the main thread via the {@link Application#schedule} interface.
-     * You may either poll this interface to determine when the assets are 
-     * loaded or use optional callbacks.
+     * @param load  The directory load
+     */
+    void readStage(const std::shared_ptr<DirectoryLoad>& load);
+
+    /**
+     * Returns true if the directory load still has a stage to finish
      *
-     * The optional callback function will be called each time an individual
-     * asset loads or fails to load.  However, if the entire category fails
-     * to load, the callback function will be given the asset category name 
-     * (e.g. "soundfx") as the asset key.
+     * This method is polled once an animation frame.  When every loader in
+     * the current stage has materialized its assets, it reports the rest of
+     * the stage to the callback and queues the next stage.
      *
-     * @param hash      The hash of the asset type
-     * @param json      The child of asset directory with these assets
-     * @param callback  An optional callback after each asset is loaded
+     * @param load  The directory load
+     *
+     * @return true if the directory load still has a stage to finish
+     */
+    bool advanceStage(const std::shared_ptr<DirectoryLoad>& load);
+
+    /**
+     * Passes the results of the current stage of a directory load to its callback
+     *
+     * The callback is given every result from the first unreported asset up
+     * to the first asset still loading. If the stage is finished, it is given
+     * all of the remaining results instead (assets with no result, such as
+     * duplicate keys, are skipped).
+     *
+     * @param load      The directory load
+     * @param finished  Whether the stage is finished
      */
-    void readCategory(size_t hash, const std::shared_ptr<JsonValue>& json,
-                      LoaderCallback callback);
+    void reportStage(const std::shared_ptr<DirectoryLoad>& load, bool finished);
     
     /**
      * Immediately removes an asset category previously loaded from the JSON file
@@ -176,34 +213,6 @@ protected:
      */
     bool purgeCategory(size_t hash, const std::shared_ptr<JsonValue>& json);
 
-    /**
-     * Synchronizes the asset manager to wait until all assets have finished.
-     *
-     * This method is necessary for assets whose construction depends on
-     * previously loaded assets (e.g. scene graphs).  In the current architecture,
-     * this method is only correct if the asset manager loads assets in a
-     * single thread.
-     */
-    void sync();
-    
-    /**
-     * Blocks the asset manager until the next animation frame.
-     *
-     * Any assets queued after a block will not be added to thread pool
-     * until at least one animation frame has passed.  This method is used
-     * to implement the {@link sync()} method.
-     */
-    void block();
-
-    /**
-     * Resumes a previously blocked the asset manager.
-     *
-     * Any assets queued after a block will not be added to thread pool
-     * until at least one animation frame has passed.  This method is used
-     * to implement the {@link sync()} method.
-     */
-    void resume();
-    
     
 #pragma mark -
 #pragma mark Constructors
@@ -214,7 +223,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an asset 
      * manager on the heap, use one of the static constructors instead.
      */
-    AssetManager() : _preload(false), _wait(false) {}
+    AssetManager() : _preload(0), _staged(0) {}
     
     /**
      * Deletes this asset manager, disposing of all resources.
@@ -233,10 +242,9 @@ public:
     /**
      * Initializes a new asset manager.
      *
-     * The asset manager has a single thread, as some of the asset loading
-     * operations (particularly fonts) cannot be run in multiple threads
-     * simultaneously. However, it will run in a distinct thread from the
-     * main application.
+     * The asset manager has one worker thread for each core not used by the
+     * main thread, up to ASSET_MAX_WORKERS. Assets of the same priority are
+     * loaded in parallel on these threads.
      *
      * This initializer does not attach any loaders.  It simply creates an 
      * object that is ready to accept loader objects.
@@ -245,27 +253,63 @@ public:
      */
     bool init();
 
+    /**
+     * Initializes a new asset manager with the given number of threads.
+     *
+     * Assets of the same priority are loaded in parallel on these threads.
+     * The threads have no effect on synchronous loading and will sleep when
+     * no assets are being loaded.
+     *
+     * The main thread half of asynchronous loading goes through a queue
+     * that is processed once an animation frame, within a budget of
+     * MATERIALIZE_BUDGET microseconds (see {@link getMaterializer}).
+     *
+     * This initializer does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param threads   The number of worker threads
+     *
+     * @return true if the asset manager was initialized successfully
+     */
+    bool init(Uint32 threads);
+
     
 #pragma mark -
 #pragma mark Static Constructors
     /**
      * Returns a newly allocated asset manager.
      *
-     * The asset manager has a single thread, as some of the asset loading
-     * operations (particularly fonts) cannot be run in multiple threads
-     * simultaneously. However, it will run in a distinct thread from the
-     * main application.
+     * The asset manager has one worker thread for each core not used by the
+     * main thread, up to ASSET_MAX_WORKERS. Assets of the same priority are
+     * loaded in parallel on these threads.
      *
      * This constructor does not attach any loaders.  It simply creates an
      * object that is ready to accept loader objects.
      *
-     * @return a newly allocated asset manager with two auxiliary threads.
+     * @return a newly allocated asset manager.
      */
     static std::shared_ptr<AssetManager> alloc() {
         std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
         return (result->init() ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated asset manager with the given number of threads.
+     *
+     * Assets of the same priority are loaded in parallel on these threads.
+     *
+     * This constructor does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param threads   The number of worker threads
+     *
+     * @return a newly allocated asset manager with the given number of threads.
+     */
+    static std::shared_ptr<AssetManager> alloc(Uint32 threads) {
+        std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
+        return (result->init(threads) ? result : nullptr);
+    }
+
 #pragma mark -
 #pragma mark Loader Management
     /**
@@ -296,6 +340,7 @@ public:
         }
         
         loader->setThreadPool(_workers);
+        loader->setMaterializer(_materializer);
         _handlers[hash] = loader;
         
         // Do not allow key collisions
@@ -344,6 +389,7 @@ public:
             return false;
         }
         it->second->setThreadPool(nullptr);
+        it->second->setMaterializer(nullptr);
         
         std::string key = it->second->getJsonKey();
         it->second = nullptr;
@@ -355,6 +401,19 @@ public:
         return true;
     }
     
+    /**
+     * Returns the materialization queue shared by the attached loaders
+     *
+     * The queue runs the main thread half of asynchronous loading (such as
+     * texture uploads).  It is processed once an animation frame, within its
+     * time budget.  Use this to change the budget, or to read the backlog.
+     *
+     * @return the materialization queue shared by the attached loaders
+     */
+    std::shared_ptr<MaterializeQueue> getMaterializer() const {
+        return _materializer;
+    }
+
     /**
      * Detaches all loaders from this asset manager
      *
@@ -412,7 +471,8 @@ public:
      * loading process has not yet finished. This method counts each asset
      * equally regardless of the memory requirements of each asset.
      *
-     * The value returned is the sum of the waitCount for all attached loaders.
+     * The value returned is the sum of the waitCount for all attached loaders,
+     * plus the assets of directories that are not yet queued with a loader.
      *
      * @return the number of assets waiting to load.
      */
@@ -675,10 +735,17 @@ public:
      * You may either poll this interface to determine when the assets are
      * loaded or use optional callbacks.
      *
+     * Assets of the same priority are loaded in parallel, on all of the
+     * worker threads of this manager.
+     *
      * The optional callback function will be called each time an individual
      * asset loads or fails to load.  However, if the entire category fails
      * to load, the callback function will be given the asset category name
-     * (e.g. "soundfx") as the asset key.
+     * (e.g. "soundfx") as the asset key.  The callback sees the assets in
+     * the order of the directory (by priority), no matter which thread
+     * finishes first.
+     *
+     * This method must be called on the main thread.
      *
      * @param json      The JSON asset directory
      * @param callback  An optional callback after each asset is loaded
@@ -714,10 +781,15 @@ public:
      * You may either poll this interface to determine when the assets are
      * loaded or use optional callbacks.
      *
+     * Assets of the same priority are loaded in parallel, on all of the
+     * worker threads of this manager.
+     *
      * The optional callback function will be called each time an individual
      * asset loads or fails to load.  However, if the entire category fails
      * to load, the callback function will be given the asset category name
-     * (e.g. "soundfx") as the asset key.
+     * (e.g. "soundfx") as the asset key.  The callback sees the assets in
+     * the order of the directory (by priority), no matter which thread
+     * finishes first.
      *
      * @param directory The path to the JSON asset directory
      * @param callback  An optional callback after each asset is loaded
@@ -146,9 +146,8 @@ protected:
                 if (!asset->preload(source)) {
                     asset = nullptr;
                 }
-                Application::get()->schedule([=](void){
+                this->queueMaterialize([=](void) {
                     this->materialize(key,asset,callback);
-                    return false;
                 });
             });
         }
@@ -198,9 +197,8 @@ protected:
                 if (!asset->preload(json)) {
                     asset = nullptr;
                 }
-                Application::get()->schedule([=](void){
+                this->queueMaterialize([=](void) {
                     this->materialize(key,asset,callback);
-                    return false;
                 });
             });
         }
@@ -0,0 +1,263 @@
+//
+//  CUJsonParser.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the parser behind JsonValue::initWithJson.  It reads
+//  the JSON text in a single pass and builds the JsonValue tree directly,
+//  instead of building a cJSON tree first and then copying it.  The nodes are
+//  allocated from an arena, numbers are decoded without strtod (and so
+//  without any locale lookups), and strings are scanned in place so that
+//  only the final value is ever copied.
+//
+//  The parser accepts everything the cJSON parser did on well-formed JSON,
+//  and reports errors by line and column.
+//
+//  This class is a stack-based utility.  It does not use the shared-pointer
+//  architecture, since a parser is only needed for the length of one parse.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#ifndef __CU_JSON_PARSER_H__
+#define __CU_JSON_PARSER_H__
+#include <cugl/assets/CUJsonValue.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** The size in bytes of each block of the node arena */
+#define JSON_ARENA_BLOCK    65536
+/** The deepest nesting of arrays and objects the parser accepts */
+#define JSON_NESTING_LIMIT  1000
+
+namespace cugl {
+
+/**
+ * A single-pass parser from JSON text to a JsonValue tree.
+ *
+ * Every node below the root is allocated from an arena of large blocks that
+ * is shared by the tree.  Each node keeps a reference to the arena, so the
+ * arena is released once the last node of the tree is deleted.  Nodes may
+ * still be moved to other trees, but a node kept alive after the rest of its
+ * tree is gone will keep the whole arena alive.
+ *
+ * Numbers are decoded from their first 19 significant digits directly.  If
+ * the decimal exponent (with the point moved after the last digit) is at
+ * most 22 in magnitude, the result is exact for mantissas up to 2^53, and
+ * corrected with fma for longer ones, which matches strtod on every number
+ * we have tested.  Larger exponents fall back to pow, and are within two
+ * ulps.  The cJSON decoder this replaces was often off by several ulps.
+ *
+ * Like cJSON, the parser treats every byte up to a space as whitespace, and
+ * it ignores anything after the first complete value.  It is otherwise
+ * strict, and the first error stops the parse.  The error message, line and
+ * column are available afterwards.
+ */
+class JsonParser {
+private:
+    /** The node arena of the current parse */
+    class Arena;
+    /** The allocator that places nodes in the arena */
+    template <typename T> class Allocator;
+
+    /** The start of the text */
+    const char* _begin;
+    /** The end of the text */
+    const char* _end;
+    /** The current position in the text */
+    const char* _pos;
+    /** The arena for the nodes of the current parse */
+    std::shared_ptr<Arena> _arena;
+    /** The finished children of the containers being parsed */
+    std::vector<std::shared_ptr<JsonValue>> _stack;
+    /** The current nesting depth */
+    int _depth;
+
+    /** The description of the parse error (empty if none) */
+    std::string _error;
+    /** The line of the parse error (starting at 1) */
+    int _line;
+    /** The column of the parse error (starting at 1) */
+    int _column;
+
+#pragma mark Internal Helpers
+    /**
+     * Records a parse error at the given position, returning false
+     *
+     * @param pos       The position of the error
+     * @param message   The description of the error
+     *
+     * @return false, so that callers may return the result
+     */
+    bool fail(const char* pos, const char* message);
+
+    /**
+     * Advances past any whitespace
+     */
+    void skip();
+
+    /**
+     * Returns a newly allocated node from the arena
+     *
+     * @param parent    The parent of the node
+     *
+     * @return a newly allocated node from the arena
+     */
+    std::shared_ptr<JsonValue> allocNode(JsonValue* parent);
+
+    /**
+     * Parses the value at the current position into the given node
+     *
+     * @param node  The node to store the value
+     *
+     * @return true if the value was parsed successfully
+     */
+    bool parseValue(JsonValue* node);
+
+    /**
+     * Parses the array at the current position into the given node
+     *
+     * @param node  The node to store the array
+     *
+     * @return true if the array was parsed successfully
+     */
+    bool parseArray(JsonValue* node);
+
+    /**
+     * Parses the object at the current position into the given node
+     *
+     * @param node  The node to store the object
+     *
+     * @return true if the object was parsed successfully
+     */
+    bool parseObject(JsonValue* node);
+
+    /**
+     * Parses the string at the current position into the given string
+     *
+     * The string is scanned in place, and only copied once its end is
+     * known.  Escape sequences are decoded only if the string has any.
+     *
+     * @param value The string to store the result
+     *
+     * @return true if the string was parsed successfully
+     */
+    bool parseString(std::string& value);
+
+    /**
+     * Parses the number at the current position into the given node
+     *
+     * @param node  The node to store the number
+     *
+     * @return true if the number was parsed successfully
+     */
+    bool parseNumber(JsonValue* node);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a parser with no errors.
+     */
+    JsonParser();
+
+    /**
+     * Deletes this parser, disposing of all resources.
+     *
+     * The arena is not deleted with the parser, since the nodes of the
+     * parsed tree still refer to it.
+     */
+    ~JsonParser() {}
+
+#pragma mark Parsing
+    /**
+     * Parses the given JSON text into the given root node.
+     *
+     * The root node takes the type and value of the JSON value, and every
+     * other node of the tree is allocated by the parser.  The root keeps its
+     * key (and parent), so it may be the child of another tree.  Any
+     * existing children of the root are replaced.
+     *
+     * If there is a parse error, this method returns false, and the root is
+     * left unchanged.  Use {@link getError}, {@link getLine} and
+     * {@link getColumn} for the details.
+     *
+     * @param root  The node to store the JSON value
+     * @param data  The JSON text
+     * @param size  The number of bytes of JSON text
+     *
+     * @return true if the JSON text was parsed successfully
+     */
+    bool parse(JsonValue* root, const char* data, size_t size);
+
+    /**
+     * Parses the given JSON text into the given root node.
+     *
+     * The root node takes the type and value of the JSON value, and every
+     * other node of the tree is allocated by the parser.  The root keeps its
+     * key (and parent), so it may be the child of another tree.  Any
+     * existing children of the root are replaced.
+     *
+     * If there is a parse error, this method returns false, and the root is
+     * left unchanged.  Use {@link getError}, {@link getLine} and
+     * {@link getColumn} for the details.
+     *
+     * @param root  The node to store the JSON value
+     * @param json  The JSON text
+     *
+     * @return true if the JSON text was parsed successfully
+     */
+    bool parse(JsonValue* root, const std::string& json) {
+        return parse(root, json.data(), json.size());
+    }
+
+#pragma mark Errors
+    /**
+     * Returns the description of the last parse error
+     *
+     * This is the empty string if the last parse succeeded.
+     *
+     * @return the description of the last parse error
+     */
+    const std::string& getError() const { return _error; }
+
+    /**
+     * Returns the line of the last parse error
+     *
+     * Lines start at 1.  This is 0 if the last parse succeeded.
+     *
+     * @return the line of the last parse error
+     */
+    int getLine() const { return _line; }
+
+    /**
+     * Returns the column of the last parse error
+     *
+     * Columns start at 1 and count bytes, not characters.  This is 0 if
+     * the last parse succeeded.
+     *
+     * @return the column of the last parse error
+     */
+    int getColumn() const { return _column; }
+};
+
+}
+
+#endif /* __CU_JSON_PARSER_H__ */
@@ -4,8 +4,8 @@
 //
 //  This module a modern C++ alternative to the cJSON interface for reading
 //  JSON files.  In particular, this gives us better type-checking and memory
-//  management.  With that said, it still uses cJSON as the underlying parsing
-//  engine.
+//  management.  JSON text is parsed by JsonParser, which builds the tree
+//  directly.  cJSON is still used to write JSON text.
 //
 //  This class uses our standard shared-pointer architecture.
 //
@@ -47,6 +47,12 @@
 #include <cJSON/cJSON.h>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+
+/** The number of children an object needs before key lookups use a hash index */
+#define JSON_INDEX_MINIMUM  16
 
 namespace cugl {
 
@@ -62,9 +68,16 @@ namespace cugl {
  * if the node is an object type.  Hence the main usage of this feature is to
  * "cast" object nodes to arrays.
  *
- * This class uses cJSON as the underlying parsing engine.  However, it manages
- * memory automatically so that the user does not need to worry about deleting
- * or allocating memory beyond the initial node itself.
+ * Looking up a child by key is a linear scan for small objects.  Once an
+ * object has {@link JSON_INDEX_MINIMUM} children, the first lookup builds a
+ * hash index from key to child, and later lookups use that instead.  Adding
+ * or removing a child, or changing the key of one, discards the index (it is
+ * rebuilt on the next lookup).  The index does not change the order of the
+ * children, which remain in the order they were added.
+ *
+ * This class uses {@link JsonParser} to parse JSON text, and cJSON to write
+ * it.  It manages memory automatically so that the user does not need to
+ * worry about deleting or allocating memory beyond the initial node itself.
  */
 class JsonValue {
 public:
@@ -108,6 +121,34 @@ public:
     
     /** The children of this node (only non-empty if array or object) */
     std::vector<std::shared_ptr<JsonValue>> _children;
+    /** The position of each child by key (built on demand for large objects) */
+    mutable std::unique_ptr<std::unordered_map<std::string,size_t>> _index;
+    /** Whether the key index is up to date with the children */
+    mutable std::atomic<bool> _indexed;
+
+private:
+    /** The parser builds nodes directly */
+    friend class JsonParser;
+
+    /**
+     * Returns the position of the child with the given key (-1 if none)
+     *
+     * Small objects are searched in order.  Larger objects build the key
+     * index on the first lookup after a change.  The build is locked, so
+     * concurrent lookups on an unchanging tree are safe.
+     *
+     * @param key   The key identifying the child
+     *
+     * @return the position of the child with the given key (-1 if none)
+     */
+    int lookup(const std::string& key) const;
+
+    /**
+     * Discards the key index, as the children or their keys have changed
+     */
+    void invalidate() { _indexed.store(false,std::memory_order_release); }
+
+public:
 
 #pragma mark -
 #pragma mark cJSON Conversions
@@ -265,14 +306,16 @@ public:
      * no other references).
      *
      * If there is a parsing error, this  method will return false.  Detailed 
-     * information about the parsing error will be passed to an assert.  Hence
-     * error messages are suppressed if asserts are turned off.
+     * information about the parsing error (including the line and column)
+     * will be passed to an assert.  Hence error messages are suppressed if
+     * asserts are turned off.  Use {@link JsonParser} directly to get the
+     * error information without asserts.
      *
      * @param json  The JSON string to parse.
      *
      * @return  true if the JSON node is initialized properly, false otherwise.
      */
-    bool initWithJson(const std::string json);
+    bool initWithJson(const std::string& json);
 
     
 #pragma mark -
@@ -401,7 +444,7 @@ public:
      *
      * @return a newly allocated JsonValue from the given JSON string.
      */
-    static std::shared_ptr<JsonValue> allocWithJson(const std::string json) {
+    static std::shared_ptr<JsonValue> allocWithJson(const std::string& json) {
         std::shared_ptr<JsonValue> result = std::make_shared<JsonValue>();
         return (result->initWithJson(json) ? result : nullptr);
     }
@@ -53,6 +53,8 @@
 #include <unordered_set>
 #include <cugl/assets/CUJsonValue.h>
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/assets/CUMaterializeQueue.h>
+#include <cugl/base/CUApplication.h>
 
 namespace cugl {
 
@@ -108,6 +110,16 @@ protected:
      * If this value is nullptr, only synchronous loading is supported
      */
     std::shared_ptr<ThreadPool> _loader;
+
+    /**
+     * The queue for the main thread half of asynchronous loading
+     *
+     * If this value is nullptr, that work is scheduled with the application
+     * and runs as soon as possible.
+     */
+    std::shared_ptr<MaterializeQueue> _materializer;
+    /** The priority of this loader in the materialization queue */
+    Uint32 _matpriority;
     
     /**
      * The parent asset manager for this loader (may be null)
@@ -214,6 +226,52 @@ protected:
      * @return true if the key maps to a loaded asset.
      */
     virtual bool verify(const std::string key) const { return false; }
+
+    /**
+     * Queues the main thread half of an asynchronous load
+     *
+     * This is safe to call from a worker thread.  The job goes to the
+     * materialization queue at the priority of this loader.  If there is
+     * no queue, the job is scheduled with the application instead.
+     *
+     * @param job   The work that must be done on the main thread
+     * @param bytes The number of bytes the job uploads (for the backlog)
+     */
+    void queueMaterialize(const std::function<void()>& job, size_t bytes=0) {
+        if (_materializer != nullptr) {
+            _materializer->push(job,_matpriority,bytes);
+        } else {
+            Application::get()->schedule([=](void) {
+                job();
+                return false;
+            });
+        }
+    }
+
+    /**
+     * Queues an image to be uploaded a band of rows at a time
+     *
+     * This is safe to call from a worker thread.  If there is no
+     * materialization queue, the whole image is uploaded at once by a job
+     * scheduled with the application.
+     *
+     * @param sink      The image to upload
+     * @param priority  The priority in the materialization queue
+     */
+    void queueUpload(const std::shared_ptr<UploadSink>& sink, Uint32 priority) {
+        if (_materializer != nullptr) {
+            _materializer->upload(sink,priority);
+        } else {
+            Application::get()->schedule([=](void) {
+                bool success = sink->begin();
+                if (success) {
+                    sink->upload(0,sink->getHeight());
+                }
+                sink->end(success);
+                return false;
+            });
+        }
+    }
    
     
 public:
@@ -224,7 +282,7 @@ public:
      * NEVER CALL THIS CONSTRUCTOR. As this is an abstract class, you should 
      * call one of the static constructors of the appropriate child class.
      */
-    BaseLoader()    { _jsonKey = ""; _priority = 0;}
+    BaseLoader()    { _jsonKey = ""; _priority = 0; _matpriority = MATERIALIZE_NORMAL; }
     
     /**
      * Deletes this asset loader, disposing of all resources.
@@ -330,6 +388,51 @@ public:
         _loader = threads;
     }
     
+    /**
+     * Returns the materialization queue attached to this loader
+     *
+     * The queue runs the main thread half of asynchronous loading, within a
+     * time budget each frame.  Multiple loaders can share the same queue.
+     *
+     * @return the materialization queue attached to this loader
+     */
+    std::shared_ptr<MaterializeQueue> getMaterializer() const { return _materializer; }
+
+    /**
+     * Sets the materialization queue attached to this loader
+     *
+     * The queue runs the main thread half of asynchronous loading, within a
+     * time budget each frame.  Multiple loaders can share the same queue.
+     * If it is nullptr, that work is scheduled with the application instead.
+     *
+     * @param queue The materialization queue attached to this loader
+     */
+    void setMaterializer(const std::shared_ptr<MaterializeQueue>& queue) {
+        _materializer = queue;
+    }
+
+    /**
+     * Returns the priority of this loader in the materialization queue
+     *
+     * Lower numbers go first.  User interface assets use MATERIALIZE_UI so
+     * that they are ready before the rest.  This is unrelated to the loader
+     * priority, which orders the loading stages of an asset directory.
+     *
+     * @return the priority of this loader in the materialization queue
+     */
+    Uint32 getMaterializePriority() const { return _matpriority; }
+
+    /**
+     * Sets the priority of this loader in the materialization queue
+     *
+     * Lower numbers go first.  User interface assets use MATERIALIZE_UI so
+     * that they are ready before the rest.  This is unrelated to the loader
+     * priority, which orders the loading stages of an asset directory.
+     *
+     * @param priority  The priority of this loader in the materialization queue
+     */
+    void setMaterializePriority(Uint32 priority) { _matpriority = priority; }
+
     /**
      * Sets the asset manager for this loader.
      *
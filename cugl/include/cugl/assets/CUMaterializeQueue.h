@@ -0,0 +1,343 @@
+//
+//  CUMaterializeQueue.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a queue for the main thread half of asynchronous
+//  asset loading.  Loaders decode their assets on worker threads, but assets
+//  such as textures and fonts must be finished (materialized) on the main
+//  thread, as they need the OpenGL context.  If every decoded asset is
+//  finished as soon as it is ready, a batch of large textures can stall a
+//  frame.  This queue instead runs the jobs in priority order, stopping each
+//  frame once it has used its time budget.  Large uploads are split into
+//  chunks of rows, so that they can be spread across several frames.
+//
+//  The queue does not touch OpenGL itself.  Uploads go through the abstract
+//  UploadSink class, and the clock can be replaced, so the ordering and the
+//  budget accounting can be checked with a mock sink and a fake clock.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#ifndef __CU_MATERIALIZE_QUEUE_H__
+#define __CU_MATERIALIZE_QUEUE_H__
+#include <cugl/base/CUBase.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/** The default number of microseconds the queue may use each frame */
+#define MATERIALIZE_BUDGET  4000
+/** The default number of bytes uploaded in one step of a chunked upload */
+#define MATERIALIZE_CHUNK   262144
+/** The materialization priority of user interface assets (fonts, widgets, scenes) */
+#define MATERIALIZE_UI      0
+/** The materialization priority of all other assets */
+#define MATERIALIZE_NORMAL  1
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Upload Sink
+/**
+ * An interface for an image that is uploaded a band of rows at a time.
+ *
+ * The {@link MaterializeQueue} calls {@link begin} once, then {@link upload}
+ * for consecutive bands of rows (at most one band per step), and finally
+ * {@link end}.  The sink for a texture creates an empty texture in begin,
+ * copies the rows with glTexSubImage2D, and registers the texture in end.
+ * A mock sink may simply record the calls.
+ */
+class UploadSink {
+public:
+    /**
+     * Deletes this sink, disposing of all resources.
+     */
+    virtual ~UploadSink() {}
+
+    /**
+     * Returns the number of rows in the image
+     *
+     * @return the number of rows in the image
+     */
+    virtual Uint32 getHeight() const = 0;
+
+    /**
+     * Returns the number of bytes in a row of the image
+     *
+     * @return the number of bytes in a row of the image
+     */
+    virtual size_t getRowBytes() const = 0;
+
+    /**
+     * Returns true if the destination of the image was created
+     *
+     * If this method fails, no rows are uploaded, and {@link end} is called
+     * immediately with false.
+     *
+     * @return true if the destination of the image was created
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * Uploads a band of rows of the image
+     *
+     * @param row   The first row of the band
+     * @param rows  The number of rows in the band
+     */
+    virtual void upload(Uint32 row, Uint32 rows) = 0;
+
+    /**
+     * Finishes the image, once all rows are uploaded (or begin failed)
+     *
+     * @param success   Whether the destination was created
+     */
+    virtual void end(bool success) = 0;
+};
+
+#pragma mark -
+#pragma mark Materialize Queue
+/**
+ * A frame-budgeted queue for the main thread work of asset loading.
+ *
+ * Jobs may be pushed from any thread, but they are only run by {@link process},
+ * which must be called from the main thread once a frame.  The asset manager
+ * does this for its own queue via {@link Application#schedule}.
+ *
+ * Jobs run in order of priority, where lower numbers go first (just like the
+ * priorities of {@link BaseLoader}).  Jobs of the same priority run in the
+ * order they were pushed.  A call to {@link process} keeps running jobs
+ * until it has used its budget, but it always runs at least one job step,
+ * so the queue cannot stall.
+ *
+ * A job may take several steps.  A chunked upload uploads one band of rows
+ * each step.  Between two steps it keeps its place in the queue, though a
+ * job of higher priority may still cut in front of it.
+ */
+class MaterializeQueue {
+private:
+    /** A job in the queue */
+    struct Job {
+        /** Runs one step of the job, returning the bytes it has left (0 if done) */
+        std::function<size_t()> work;
+        /** The job priority (lower numbers go first) */
+        Uint32 priority;
+        /** The position of the job among jobs of the same priority */
+        Uint64 order;
+        /** The number of bytes the job has left */
+        size_t bytes;
+    };
+
+    /** The jobs, as a heap ordered by priority and then order */
+    std::vector<Job> _jobs;
+    /** The lock for the jobs and the backlog */
+    mutable std::mutex _mutex;
+    /** The number of jobs pushed so far */
+    Uint64 _pushed;
+    /** The number of bytes the queued jobs have left */
+    size_t _bytes;
+    /** The number of microseconds process may use */
+    Uint64 _budget;
+    /** The number of bytes uploaded in one step of a chunked upload */
+    size_t _chunk;
+    /** The number of microseconds used by the last call to process */
+    Uint64 _spent;
+    /** A replacement clock in microseconds (nullptr for the system clock) */
+    std::function<Uint64()> _clock;
+
+    /**
+     * Returns true if job a should run after job b
+     *
+     * @param a The first job
+     * @param b The second job
+     *
+     * @return true if job a should run after job b
+     */
+    static bool later(const Job& a, const Job& b);
+
+    /**
+     * Returns the current time in microseconds
+     *
+     * @return the current time in microseconds
+     */
+    Uint64 now() const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized queue.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    MaterializeQueue();
+
+    /**
+     * Deletes this queue, disposing of all resources.
+     */
+    ~MaterializeQueue() { dispose(); }
+
+    /**
+     * Disposes this queue, dropping any queued jobs.
+     */
+    void dispose();
+
+    /**
+     * Initializes a queue with the given budget.
+     *
+     * @param budget    The number of microseconds {@link process} may use
+     *
+     * @return true if initialization was successful
+     */
+    bool init(Uint64 budget=MATERIALIZE_BUDGET);
+
+    /**
+     * Returns a newly allocated queue with the given budget.
+     *
+     * @param budget    The number of microseconds {@link process} may use
+     *
+     * @return a newly allocated queue with the given budget.
+     */
+    static std::shared_ptr<MaterializeQueue> alloc(Uint64 budget=MATERIALIZE_BUDGET) {
+        std::shared_ptr<MaterializeQueue> result = std::make_shared<MaterializeQueue>();
+        return (result->init(budget) ? result : nullptr);
+    }
+
+#pragma mark Jobs
+    /**
+     * Adds a job that runs in a single step.
+     *
+     * This method is safe to call from any thread.  The byte size is only
+     * used to report the backlog.
+     *
+     * @param job       The job to run on the main thread
+     * @param priority  The job priority (lower numbers go first)
+     * @param bytes     The number of bytes the job uploads
+     */
+    void push(const std::function<void()>& job, Uint32 priority=MATERIALIZE_NORMAL, size_t bytes=0);
+
+    /**
+     * Adds a job that uploads an image a band of rows at a time.
+     *
+     * Each band is as many rows as fit in the chunk size (but at least one
+     * row).  This method is safe to call from any thread.
+     *
+     * @param sink      The image to upload
+     * @param priority  The job priority (lower numbers go first)
+     */
+    void upload(const std::shared_ptr<UploadSink>& sink, Uint32 priority=MATERIALIZE_NORMAL);
+
+    /**
+     * Runs queued jobs until the budget is used, returning the number of steps
+     *
+     * This method must be called from the main thread.  It runs at least one
+     * step if the queue is not empty.
+     *
+     * @return the number of job steps run
+     */
+    size_t process();
+
+#pragma mark Attributes
+    /**
+     * Returns the number of microseconds {@link process} may use
+     *
+     * @return the number of microseconds {@link process} may use
+     */
+    Uint64 getBudget() const { return _budget; }
+
+    /**
+     * Sets the number of microseconds {@link process} may use
+     *
+     * @param budget    The number of microseconds {@link process} may use
+     */
+    void setBudget(Uint64 budget) { _budget = budget; }
+
+    /**
+     * Returns the number of bytes uploaded in one step of a chunked upload
+     *
+     * @return the number of bytes uploaded in one step of a chunked upload
+     */
+    size_t getChunkSize() const { return _chunk; }
+
+    /**
+     * Sets the number of bytes uploaded in one step of a chunked upload
+     *
+     * This only affects uploads queued after it is set.
+     *
+     * @param bytes The number of bytes uploaded in one step of a chunked upload
+     */
+    void setChunkSize(size_t bytes) { _chunk = bytes; }
+
+    /**
+     * Replaces the clock used for the budget
+     *
+     * The clock returns a time in microseconds.  This is for testing the
+     * budget without real work.  A nullptr restores the system clock.
+     *
+     * @param clock The clock used for the budget
+     */
+    void setClock(const std::function<Uint64()>& clock) { _clock = clock; }
+
+    /**
+     * Returns the number of microseconds used by the last call to process
+     *
+     * This may exceed the budget by the length of the last step.
+     *
+     * @return the number of microseconds used by the last call to process
+     */
+    Uint64 getSpent() const { return _spent; }
+
+    /**
+     * Returns the number of queued jobs
+     *
+     * @return the number of queued jobs
+     */
+    size_t getBacklog() const;
+
+    /**
+     * Returns the number of bytes the queued jobs have left to upload
+     *
+     * @return the number of bytes the queued jobs have left to upload
+     */
+    size_t getBacklogBytes() const;
+
+    /**
+     * Returns true if there are no queued jobs
+     *
+     * @return true if there are no queued jobs
+     */
+    bool isEmpty() const { return getBacklog() == 0; }
+};
+
+}
+
+#endif /* __CU_MATERIALIZE_QUEUE_H__ */
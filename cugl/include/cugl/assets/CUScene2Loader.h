@@ -272,7 +272,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a loader on
      * the heap, use one of the static constructors instead.
      */
-    Scene2Loader() { _jsonKey = "scene2s"; _priority = 1; }
+    Scene2Loader() { _jsonKey = "scene2s"; _priority = 1; _matpriority = MATERIALIZE_UI; }
     
     /**
      * Initializes a new asset loader.
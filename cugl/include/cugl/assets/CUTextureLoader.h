@@ -116,11 +116,12 @@ protected:
     SDL_Surface* preload(const std::string source);
     
     /**
-     * Creates an OpenGL texture from the SDL_Surface, and assigns it the given key.
+     * Finishes the uploaded texture, and assigns it the given key.
      *
      * This method finishes the asset loading started in {@link preload}.  This
      * step is not safe to be done in a separate thread.  Instead, it takes
-     * place in the main CUGL thread via {@link Application#schedule}.
+     * place in the main CUGL thread, once the materialization queue has
+     * uploaded every row of the SDL_Surface.
      *
      * The loaded texture will have default parameters for scaling and wrap.
      * It will only have a mipmap if that is the default.
@@ -129,17 +130,18 @@ protected:
      * the asset was successfully materialized.
      *
      * @param key       The key to access the asset after loading
-     * @param surface   The SDL_Surface to convert
+     * @param texture   The uploaded texture (nullptr if it failed)
      * @param callback  An optional callback for asynchronous loading
      */
-    void materialize(const std::string key, SDL_Surface* surface, LoaderCallback callback);
+    void materialize(const std::string key, const std::shared_ptr<Texture>& texture, LoaderCallback callback);
     
     /**
-     * Creates an OpenGL texture from the SDL_Surface accoring to the directory entry.
+     * Finishes the uploaded texture accoring to the directory entry.
      *
      * This method finishes the asset loading started in {@link preload}.  This
      * step is not safe to be done in a separate thread.  Instead, it takes
-     * place in the main CUGL thread via {@link Application#schedule}.
+     * place in the main CUGL thread, once the materialization queue has
+     * uploaded every row of the SDL_Surface.
      *
      * This version of read provides support for JSON directories. A texture
      * directory entry has the following values
@@ -159,10 +161,10 @@ protected:
      * the asset was successfully materialized.
      *
      * @param json      The asset directory entry
-     * @param surface   The SDL_Surface to convert
+     * @param texture   The uploaded texture (nullptr if it failed)
      * @param callback  An optional callback for asynchronous loading
      */
-    void materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback);
+    void materialize(const std::shared_ptr<JsonValue>& json, const std::shared_ptr<Texture>& texture, LoaderCallback callback);
     
 
     /**
@@ -208,6 +210,7 @@ protected:
      *      "magfilter":    The name of the min filter ("nearest" or "linear")
      *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
      *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+     *      "priority":     The materialization priority (int, lower goes first)
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
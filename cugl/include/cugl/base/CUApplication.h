@@ -158,6 +158,10 @@ protected:
     
     /** The target FPS of this application */
     float _fps;
+    /** The fixed update rate of this application (0 if disabled) */
+    float _fixedrate;
+    /** The most fixed updates allowed in a single animation frame */
+    Uint32 _fixedmax;
     /** Whether to respect the display vsync */
     bool _vsync;
     /** The default background color of this application */
@@ -180,6 +184,13 @@ private:
     Timestamp _start;
     /** The timestamp for the end of an animation frame */
     Timestamp _finish;
+
+    /** The length of a fixed update in microseconds */
+    Uint64 _fixedmicros;
+    /** The simulation time not yet consumed by a fixed update (in microseconds) */
+    Uint64 _fixedtime;
+    /** The fraction of a fixed update left over at the last frame */
+    float _fixedalpha;
     
     /** Counter to assign unique keys to callbacks */
     Uint32 _funcid;
@@ -328,6 +339,23 @@ public:
      */
     virtual void update(float timestep) { }
 
+    /**
+     * The method called to advance the simulation by a fixed amount.
+     *
+     * This method is only called if a fixed update rate has been set (see
+     * {@link #setFixedRate}). In that case it is called zero or more times
+     * each animation frame, after {@link #update}, so that the simulation
+     * advances at the fixed rate no matter the frame rate. Anything that
+     * must be reproducible (such as physics) belongs here, while input and
+     * presentation belong in update.
+     *
+     * When overriding this method, you do not need to call the parent method
+     * at all. The default implmentation does nothing.
+     *
+     * @param step  The length of a fixed update (in seconds)
+     */
+    virtual void fixedUpdate(float step) { }
+
     /**
      * The method called to draw the application to the screen.
      *
@@ -339,6 +367,22 @@ public:
      */
     virtual void draw() { }
 
+    /**
+     * The method called to draw the application with an interpolation factor.
+     *
+     * The value alpha is the fraction of a fixed update that has elapsed
+     * since the last call to {@link #fixedUpdate}. Interpolating between the
+     * previous and current simulation state by this amount hides the
+     * difference between the update rate and the frame rate. If there is no
+     * fixed update rate, alpha is always 1.
+     *
+     * The default implementation calls {@link #draw()}, so applications that
+     * do not interpolate need only override that method.
+     *
+     * @param alpha The fraction of a fixed update since the last one
+     */
+    virtual void draw(float alpha) { draw(); }
+
     
 #pragma mark -
 #pragma mark Application Loop
@@ -786,6 +830,68 @@ public:
      * @return the average frames per second over the last 10 frames.
      */
     float getAverageFPS() const;
+
+    /**
+     * Sets the fixed update rate of this application.
+     *
+     * If this value is positive, the time of each animation frame is added
+     * to an accumulator, and {@link #fixedUpdate} is called once for every
+     * whole step of 1/rate seconds in it. Hence the simulation advances at
+     * the same speed whatever the frame rate, and a run with the same input
+     * produces the same result. If this value is 0, fixedUpdate is never
+     * called.
+     *
+     * This method may be safely changed at any time while the application
+     * is running. Changing it discards any partial step. By default, this
+     * value is 0.
+     *
+     * @param rate  The fixed updates per second (0 to disable)
+     */
+    void setFixedRate(float rate);
+
+    /**
+     * Returns the fixed update rate of this application.
+     *
+     * If this value is 0, {@link #fixedUpdate} is never called.
+     *
+     * @return the fixed update rate of this application.
+     */
+    float getFixedRate() const { return _fixedrate; }
+
+    /**
+     * Returns the length of a fixed update in seconds (0 if disabled).
+     *
+     * @return the length of a fixed update in seconds (0 if disabled).
+     */
+    float getFixedStep() const { return _fixedrate > 0 ? 1.0f/_fixedrate : 0.0f; }
+
+    /**
+     * Sets the most fixed updates allowed in a single animation frame.
+     *
+     * After a long frame (such as a level load or a debugger pause) the
+     * application would otherwise try to catch up all at once, making the
+     * next frame longer still. Any time beyond this many steps is dropped,
+     * so the simulation slows down instead. By default, this value is 5.
+     *
+     * @param steps The most fixed updates in a single animation frame
+     */
+    void setMaxFixedSteps(Uint32 steps) { _fixedmax = steps > 0 ? steps : 1; }
+
+    /**
+     * Returns the most fixed updates allowed in a single animation frame.
+     *
+     * @return the most fixed updates allowed in a single animation frame.
+     */
+    Uint32 getMaxFixedSteps() const { return _fixedmax; }
+
+    /**
+     * Returns the fraction of a fixed update left over at the last frame.
+     *
+     * This is the value passed to {@link #draw(float)}.
+     *
+     * @return the fraction of a fixed update left over at the last frame.
+     */
+    float getFixedAlpha() const { return _fixedalpha; }
     
     /**
      * Sets the clear color of this application
@@ -106,6 +106,21 @@ protected:
      * @param bytes The minimum number of bytes to ensure in the stream
      */
     void fill(unsigned int bytes=1);
+
+    /**
+     * Copies a sequence of fixed size elements from the stream
+     *
+     * Elements are taken from the storage buffer, refilling it as it runs out.
+     * Large requests are read straight from the file once the buffer is drained.
+     * The elements are not marshalled.
+     *
+     * @param dest      The array to store the data when read
+     * @param maximum   The maximum number of elements to read from the stream
+     * @param bytes     The size of a single element
+     *
+     * @return the number of elements read from the stream
+     */
+    size_t readBlock(char* dest, size_t maximum, unsigned int bytes);
     
     
 #pragma mark -
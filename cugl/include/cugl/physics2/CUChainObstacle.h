@@ -0,0 +1,284 @@
+//
+//  CUChainObstacle.h
+//  Cornell University Game Library (CUGL)
+//
+//  This class implements a physics object made of line chains.  It is a thin
+//  wrapper around the Box2D chain shape, with one fixture per chain.  Unlike
+//  PolygonObstacle, there is no triangulation and a whole collection of
+//  outlines (e.g. the contours of a level) lives in a single body.  Chains
+//  have no area, so this obstacle is only useful for static geometry.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#ifndef __CU_CHAIN_OBSTACLE_H__
+#define __CU_CHAIN_OBSTACLE_H__
+
+#include "CUSimpleObstacle.h"
+#include <cugl/math/CUPath2.h>
+#include <vector>
+
+namespace cugl {
+    /**
+     * The classes to represent 2-d physics.
+     *
+     * This namespace was chosen to future-proof the game engine. We will
+     * eventually want to add a 3-d physics engine as well, and this namespace
+     * will prevent any collisions with those scene graph nodes.
+     */
+    namespace physics2 {
+
+#pragma mark -
+#pragma mark Chain Obstacle
+
+/**
+ * A collection of line chains that support collisions.
+ *
+ * Each path becomes a single Box2D chain fixture on the same body. A closed
+ * path becomes a loop, and an open path becomes an ordinary chain. Vertices
+ * that are too close for Box2D to tell apart are welded together, and paths
+ * that are degenerate after welding are ignored.
+ *
+ * Box2D chains are one-sided: they only collide with objects on the right of
+ * the path direction. That means a counter-clockwise loop stops objects from
+ * the outside. If the orientation of the paths is not known, the obstacle can
+ * be made two-sided, which adds a second (reversed) fixture for every path.
+ *
+ * Each chain edge may also be given a radius. This makes the surface of the
+ * edge that far from the path, so a two-sided chain with a radius is a band
+ * around the path (with rounded ends).
+ *
+ * Chains have no mass, so this obstacle should always be static.
+ */
+class ChainObstacle : public SimpleObstacle {
+protected:
+    /** The paths defining this obstacle (for the debug wireframe) */
+    std::vector<Path2> _paths;
+    /** The welded vertices of each chain, relative to the body position */
+    std::vector<std::vector<b2Vec2>> _chains;
+    /** Whether each chain is a closed loop */
+    std::vector<bool> _loops;
+    /** The fixtures of this obstacle */
+    std::vector<b2Fixture*> _geoms;
+    /** The bounding box of all of the paths */
+    Rect _bounds;
+    /** Whether to collide with objects on both sides of each path */
+    bool _twoSided;
+    /** The distance of the collision surface from each path */
+    float _radius;
+
+
+#pragma mark -
+#pragma mark Scene Graph Methods
+    /**
+     * Creates the outline of the physics fixtures in the debug node
+     *
+     * The debug node is use to outline the fixtures attached to this object.
+     * This is very useful when the fixtures have a very different shape than
+     * the texture (e.g. a circular shape attached to a square texture).
+     */
+    virtual void resetDebug() override;
+
+    /**
+     * Recreates the chain vertices from the paths.
+     *
+     * This must be called whenever the paths change.
+     */
+    void resetShapes();
+
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an empty chain obstacle at the origin.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ChainObstacle(void) : SimpleObstacle(), _twoSided(false), _radius(b2_polygonRadius) { }
+
+    /**
+     * Deletes this physics object and all of its resources.
+     */
+    virtual ~ChainObstacle();
+
+    // Turn off init warnings
+    using SimpleObstacle::init;
+
+    /**
+     * Initializes a chain obstacle from the given paths
+     *
+     * The paths define an implicit coordinate space, with (0,0) at the
+     * origin. This origin will be the position of the body.
+     *
+     * @param paths  The paths (one chain per path)
+     *
+     * @return  true if the obstacle is initialized properly, false otherwise.
+     */
+    virtual bool init(const std::vector<Path2>& paths) { return init(paths,Vec2::ZERO); }
+
+    /**
+     * Initializes a chain obstacle from the given paths
+     *
+     * The paths define an implicit coordinate space. The body will be placed
+     * at the given origin position.
+     *
+     * @param paths  The paths (one chain per path)
+     * @param origin The body position with respect to the path vertices
+     *
+     * @return  true if the obstacle is initialized properly, false otherwise.
+     */
+    virtual bool init(const std::vector<Path2>& paths, const Vec2 origin);
+
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a chain obstacle for the given paths
+     *
+     * The paths define an implicit coordinate space, with (0,0) at the
+     * origin. This origin will be the position of the body.
+     *
+     * @param paths  The paths (one chain per path)
+     *
+     * @return a chain obstacle for the given paths
+     */
+    static std::shared_ptr<ChainObstacle> alloc(const std::vector<Path2>& paths) {
+        std::shared_ptr<ChainObstacle> result = std::make_shared<ChainObstacle>();
+        return (result->init(paths) ? result : nullptr);
+    }
+
+    /**
+     * Returns a chain obstacle for the given paths
+     *
+     * The paths define an implicit coordinate space. The body will be placed
+     * at the given origin position.
+     *
+     * @param paths  The paths (one chain per path)
+     * @param origin The body position with respect to the path vertices
+     *
+     * @return a chain obstacle for the given paths
+     */
+    static std::shared_ptr<ChainObstacle> alloc(const std::vector<Path2>& paths, const Vec2 origin) {
+        std::shared_ptr<ChainObstacle> result = std::make_shared<ChainObstacle>();
+        return (result->init(paths,origin) ? result : nullptr);
+    }
+
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the paths defining this object
+     *
+     * @return the paths defining this object
+     */
+    const std::vector<Path2>& getPaths() const { return _paths; }
+
+    /**
+     * Sets the paths defining this object
+     *
+     * This change cannot happen immediately.  It must wait until the
+     * next update is called.
+     *
+     * @param paths   the paths defining this object
+     */
+    void setPaths(const std::vector<Path2>& paths);
+
+    /**
+     * Returns the dimensions of the bounding box of all paths
+     *
+     * @return the dimensions of the bounding box of all paths
+     */
+    const Size getSize() const { return _bounds.size; }
+
+    /**
+     * Returns the number of (non-degenerate) chains in this obstacle
+     *
+     * @return the number of (non-degenerate) chains in this obstacle
+     */
+    size_t getChainCount() const { return _chains.size(); }
+
+    /**
+     * Returns true if this obstacle collides on both sides of each path
+     *
+     * @return true if this obstacle collides on both sides of each path
+     */
+    bool isTwoSided() const { return _twoSided; }
+
+    /**
+     * Sets whether this obstacle collides on both sides of each path
+     *
+     * A two-sided obstacle has twice as many fixtures. This change cannot
+     * happen immediately.  It must wait until the next update is called.
+     *
+     * @param value   whether this obstacle collides on both sides of each path
+     */
+    void setTwoSided(bool value) { _twoSided = value; markDirty(true); }
+
+    /**
+     * Returns the distance of the collision surface from each path
+     *
+     * @return the distance of the collision surface from each path
+     */
+    float getRadius() const { return _radius; }
+
+    /**
+     * Sets the distance of the collision surface from each path
+     *
+     * By default this is the Box2D polygon skin. This change cannot happen
+     * immediately.  It must wait until the next update is called.
+     *
+     * @param value   the distance of the collision surface from each path
+     */
+    void setRadius(float value) { _radius = value; markDirty(true); }
+
+
+#pragma mark -
+#pragma mark Physics Methods
+    /**
+     * Create new fixtures for this body, defining the shape
+     *
+     * This is the primary method to override for custom physics objects
+     */
+    virtual void createFixtures() override;
+
+    /**
+     * Release the fixtures for this body, reseting the shape
+     *
+     * This is the primary method to override for custom physics objects
+     */
+    virtual void releaseFixtures() override;
+};
+	}
+}
+#endif /* __CU_CHAIN_OBSTACLE_H__ */
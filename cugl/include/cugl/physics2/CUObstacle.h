@@ -103,6 +103,17 @@ protected:
     
     /** (Singular) callback function for state updates */
     std::function<void(Obstacle* obstacle)> _listener;
+
+    /** Whether the transforms of the last physics step are recorded */
+    bool _interpolate;
+    /** The position before the last physics step */
+    Vec2 _prevpos;
+    /** The angle before the last physics step */
+    float _prevangle;
+    /** The position after the last physics step */
+    Vec2 _nextpos;
+    /** The angle after the last physics step */
+    float _nextangle;
     
 #pragma mark -
 #pragma mark Scene Graph Internals
@@ -903,6 +914,75 @@ public:
         _listener = listener;
     }
 
+    /**
+     * Records the transform of this object before a physics step.
+     *
+     * This method is called by {@link ObstacleWorld} for every non-static
+     * object, and should not be called otherwise.
+     */
+    void beginStep() {
+        _prevpos = getPosition();
+        _prevangle = getAngle();
+    }
+
+    /**
+     * Records the transform of this object after a physics step.
+     *
+     * This method is called by {@link ObstacleWorld} for every non-static
+     * object, and should not be called otherwise.
+     */
+    void endStep() {
+        _nextpos = getPosition();
+        _nextangle = getAngle();
+        _interpolate = true;
+    }
+
+    /**
+     * Returns the position of this object interpolated between physics steps.
+     *
+     * The value alpha is the fraction of a step that has elapsed since the
+     * last physics step (see {@link Application#draw(float)}). The result
+     * blends the positions before and after that step, so drawing it hides
+     * the difference between the physics rate and the frame rate. It lags the
+     * simulation by at most one step.
+     *
+     * If the object has not been stepped, or was moved directly since the
+     * last step, this is the current position.
+     *
+     * @param alpha The fraction of a step since the last physics step
+     *
+     * @return the position of this object interpolated between physics steps
+     */
+    Vec2 getInterpolatedPosition(float alpha) const {
+        Vec2 pos = getPosition();
+        if (!_interpolate || pos != _nextpos) {
+            return pos;
+        }
+        return _prevpos + (_nextpos - _prevpos) * alpha;
+    }
+
+    /**
+     * Returns the angle of this object interpolated between physics steps.
+     *
+     * The value alpha is the fraction of a step that has elapsed since the
+     * last physics step (see {@link Application#draw(float)}). The angle is
+     * in radians.
+     *
+     * If the object has not been stepped, or was rotated directly since the
+     * last step, this is the current angle.
+     *
+     * @param alpha The fraction of a step since the last physics step
+     *
+     * @return the angle of this object interpolated between physics steps
+     */
+    float getInterpolatedAngle(float alpha) const {
+        float angle = getAngle();
+        if (!_interpolate || angle != _nextangle) {
+            return angle;
+        }
+        return _prevangle + (_nextangle - _prevangle) * alpha;
+    }
+
 #pragma mark -
 #pragma mark Debugging Methods
     /**
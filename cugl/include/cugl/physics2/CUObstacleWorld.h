@@ -69,6 +69,8 @@ class Obstacle;
 #define DEFAULT_WORLD_VELOC 6
 /** Default number of position iterations for the constrain solvers */
 #define DEFAULT_WORLD_POSIT 2
+/** The default cap on Box2D steps in a single update */
+#define DEFAULT_WORLD_SUBSTEPS  8
 
 
 #pragma mark -
@@ -93,6 +95,10 @@ protected:
     bool _lockstep;
     /** The amount of time for a single engine step */
     float _stepssize;
+    /** The longest Box2D step allowed before an update is split (0 to never split) */
+    float _substep;
+    /** The most Box2D steps a single update may be split into */
+    int _maxsubsteps;
     /** The number of velocity iterations for the constrain solvers */
     int _itvelocity;
     /** The number of position iterations for the constrain solvers */
@@ -264,6 +270,54 @@ public:
      */
     void setStepsize(float step) { _stepssize = step; }
 
+    /**
+     * Returns the longest Box2D step allowed in a single update.
+     *
+     * If the time of an update (the step size in lock step, or the frame
+     * delta otherwise) is longer than this, it is split into equal Box2D
+     * steps no longer than this. The obstacles are only updated once, after
+     * all of the steps, and forces applied before the update act on all of
+     * them. If this value is 0, an update is never split.
+     *
+     * @return the longest Box2D step allowed in a single update.
+     */
+    float getSubstepSize() const { return _substep; }
+
+    /**
+     * Sets the longest Box2D step allowed in a single update.
+     *
+     * If the time of an update (the step size in lock step, or the frame
+     * delta otherwise) is longer than this, it is split into equal Box2D
+     * steps no longer than this. The obstacles are only updated once, after
+     * all of the steps, and forces applied before the update act on all of
+     * them. If this value is 0, an update is never split.
+     *
+     * Any change will take effect at the time of the next call to update.
+     *
+     * @param step  the longest Box2D step allowed in a single update.
+     */
+    void setSubstepSize(float step) { _substep = step > 0 ? step : 0; }
+
+    /**
+     * Returns the most Box2D steps a single update may be split into.
+     *
+     * This keeps a very long frame from stalling the physics. By default,
+     * this value is 8.
+     *
+     * @return the most Box2D steps a single update may be split into.
+     */
+    int getMaxSubsteps() const { return _maxsubsteps; }
+
+    /**
+     * Sets the most Box2D steps a single update may be split into.
+     *
+     * This keeps a very long frame from stalling the physics. Any change will
+     * take effect at the time of the next call to update.
+     *
+     * @param steps the most Box2D steps a single update may be split into.
+     */
+    void setMaxSubsteps(int steps) { _maxsubsteps = steps > 0 ? steps : 1; }
+
     /** 
      * Returns number of velocity iterations for the constrain solvers 
      *
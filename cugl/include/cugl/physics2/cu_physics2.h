@@ -35,6 +35,7 @@
 #include "CUBoxObstacle.h"
 #include "CUWheelObstacle.h"
 #include "CUPolygonObstacle.h"
+#include "CUChainObstacle.h"
 #include "CUCapsuleObstacle.h"
 #include "CUObstacleSelector.h"
 
@@ -416,6 +416,23 @@ public:
      */
     const Texture& set(const void *data);
 
+    /**
+     * Sets a band of rows of this texture to the contents of the given buffer.
+     *
+     * The buffer must have the correct data format, and must be of size
+     * width*rows*bytesize.  Its first row becomes the given row of the
+     * texture.  This allows a large image to be uploaded over several frames.
+     *
+     * This method is only successful if the texture is currently active.
+     *
+     * @param data  The buffer to read into the texture
+     * @param row   The first texture row to set
+     * @param rows  The number of rows to set
+     *
+     * @return a reference to this (modified) texture for chaining.
+     */
+    const Texture& set(const void *data, int row, int rows);
+
     
 #pragma mark -
 #pragma mark Attributes
@@ -109,6 +109,8 @@ private:
     GLuint _vertBuffer;
     /** The index buffer for drawing a shape */
     GLuint _indxBuffer;
+    /** The buffer that owns the vertex and index data (if shared) */
+    std::shared_ptr<VertexBuffer> _source;
     
     /** The shader currently attached to this vertex buffer */
     std::shared_ptr<Shader> _shader;
@@ -176,6 +178,41 @@ public:
         return (result->init(stride) ? result : nullptr);
     }
 
+    /**
+     * Initializes this vertex buffer to share the data of another buffer.
+     *
+     * The new buffer has its own vertex array, and hence its own attributes
+     * and shader, but it draws from the vertex and index data of the source
+     * buffer. This allows the same (large) mesh to be drawn by several shaders
+     * with different attribute layouts while only uploading it once. Loading
+     * data into either buffer changes the data of both.
+     *
+     * The source buffer is kept alive until this buffer is disposed.
+     *
+     * @param source    The buffer owning the vertex and index data
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithBuffer(const std::shared_ptr<VertexBuffer>& source);
+
+    /**
+     * Returns a new vertex buffer sharing the data of another buffer.
+     *
+     * The new buffer has its own vertex array, and hence its own attributes
+     * and shader, but it draws from the vertex and index data of the source
+     * buffer. This allows the same (large) mesh to be drawn by several shaders
+     * with different attribute layouts while only uploading it once. Loading
+     * data into either buffer changes the data of both.
+     *
+     * @param source    The buffer owning the vertex and index data
+     *
+     * @return a new vertex buffer sharing the data of another buffer.
+     */
+    static std::shared_ptr<VertexBuffer> allocWithBuffer(const std::shared_ptr<VertexBuffer>& source) {
+        std::shared_ptr<VertexBuffer> result = std::make_shared<VertexBuffer>();
+        return (result->initWithBuffer(source) ? result : nullptr);
+    }
+
 
 #pragma mark -
 #pragma mark Binding
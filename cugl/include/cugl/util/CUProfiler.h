@@ -0,0 +1,257 @@
+//
+//  CUProfiler.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a lightweight frame profiler.  Code is instrumented
+//  with scoped timers and named counters, which record into a ring buffer
+//  owned by the calling thread.  The buffers are drained on the main thread
+//  once per frame, and the results can be exported as a Chrome trace (open it
+//  in chrome://tracing or Perfetto) or as a CSV summary.
+//
+//  The instrumentation macros only exist when CU_PROFILING is defined.  In any
+//  other build they expand to nothing (their arguments are not evaluated), so
+//  instrumented code pays nothing for them.  When compiled in, an inactive
+//  profiler costs one atomic load per scope.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#ifndef __CU_PROFILER_H__
+#define __CU_PROFILER_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CUTimestamp.h>
+#include <string>
+
+/** The default number of events each thread can hold between two frames */
+#define PROFILER_CAPACITY   16384
+/** The default number of events kept for the trace (the summary keeps counting after that) */
+#define PROFILER_HISTORY    524288
+
+#pragma mark -
+#pragma mark Instrumentation Macros
+
+#if defined(CU_PROFILING)
+    #define __CU_PROFILE_CONCAT2__(a,b)         a##b
+    #define __CU_PROFILE_CONCAT__(a,b)          __CU_PROFILE_CONCAT2__(a,b)
+    /** Times the rest of the enclosing scope (the name must outlive the profiler) */
+    #define CU_PROFILE_SCOPE(name)              cugl::Profiler::Scope __CU_PROFILE_CONCAT__(__cu_profile_,__LINE__)(name)
+    /** Records a span between two timestamps */
+    #define CU_PROFILE_SPAN(name,start,end)     cugl::Profiler::record(name,start,end)
+    /** Records a sample of a named counter */
+    #define CU_PROFILE_COUNT(name,value)        cugl::Profiler::count(name,value)
+    /** Collects the events of every thread (once per frame, on the main thread) */
+    #define CU_PROFILE_FRAME()                  cugl::Profiler::frame()
+#else
+    #define CU_PROFILE_SCOPE(name)              ((void)0)
+    #define CU_PROFILE_SPAN(name,start,end)     ((void)0)
+    #define CU_PROFILE_COUNT(name,value)        ((void)0)
+    #define CU_PROFILE_FRAME()                  ((void)0)
+#endif
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Profiler Class
+/**
+ * Class to time the subsystems of an application.
+ *
+ * This class is a collection of static methods; there is only one profiler.
+ * Nothing is recorded until {@link #start} is called, and nothing more after
+ * {@link #stop}.
+ *
+ * Every thread that records an event is given its own ring buffer, which the
+ * thread writes without locks.  Only the main thread reads the buffers, in
+ * {@link #frame}.  If a thread records more events in a frame than its buffer
+ * holds, the extra events are dropped (and counted, see {@link #getDropped}),
+ * so a recording thread never waits on the main thread.
+ *
+ * Events are named with C strings, and only the pointer is stored.  Hence
+ * names must be string literals, or strings that live as long as the profiler.
+ * Use {@link #intern} for a name that is built at run time.
+ *
+ * The collected events are kept for the trace, up to a maximum history.  The
+ * summary statistics (calls, total, mean, minimum and maximum per name) are
+ * kept for every event, even past the history.
+ */
+class Profiler {
+public:
+    /**
+     * A timer for the enclosing scope.
+     *
+     * The timer starts when it is created and records a span when it is
+     * destroyed.  A timer created while the profiler is inactive records
+     * nothing.  Use the macro CU_PROFILE_SCOPE rather than this class, so that
+     * the timer is compiled out with the rest of the instrumentation.
+     */
+    class Scope {
+    private:
+        /** The span name (nullptr if the profiler was inactive) */
+        const char* _name;
+        /** The start of the span in nanoseconds since the profiler started */
+        Uint64 _start;
+
+    public:
+        /**
+         * Starts timing a span with the given name
+         *
+         * @param name  The span name
+         */
+        Scope(const char* name);
+
+        /**
+         * Records the span, if the profiler was active when it started
+         */
+        ~Scope();
+
+        // Timers are tied to their scope
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+#pragma mark Activation
+    /**
+     * Starts recording, discarding anything recorded before
+     *
+     * The capacity only applies to the buffers of threads that have not
+     * recorded yet.  It is rounded up to a power of two.
+     *
+     * @param capacity  The number of events each thread can hold between frames
+     * @param history   The number of events kept for the trace
+     */
+    static void start(size_t capacity=PROFILER_CAPACITY, size_t history=PROFILER_HISTORY);
+
+    /**
+     * Stops recording
+     *
+     * The events recorded so far are collected, and can still be exported.
+     */
+    static void stop();
+
+    /**
+     * Returns true if the profiler is recording
+     *
+     * @return true if the profiler is recording
+     */
+    static bool isActive();
+
+#pragma mark Recording
+    /**
+     * Records a span between two timestamps
+     *
+     * This is for spans that do not match a scope, such as the passes of a
+     * renderer that shares one timestamp between them.
+     *
+     * @param name  The span name
+     * @param start The start of the span
+     * @param end   The end of the span
+     */
+    static void record(const char* name, const Timestamp& start, const Timestamp& end);
+
+    /**
+     * Records a sample of a named counter
+     *
+     * @param name  The counter name
+     * @param value The counter value
+     */
+    static void count(const char* name, double value);
+
+    /**
+     * Returns a copy of the name that lives as long as the profiler
+     *
+     * The same string is returned for equal names, so this is safe to call
+     * every frame.  However, it takes a lock, so it is best done once.
+     *
+     * @param name  The name to copy
+     *
+     * @return a copy of the name that lives as long as the profiler
+     */
+    static const char* intern(const std::string& name);
+
+    /**
+     * Names the calling thread in the trace
+     *
+     * @param name  The thread name
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Ends a frame, collecting the events of every thread
+     *
+     * This method must be called on the main thread (the one that exports).
+     * {@link Application} calls it at the end of every step.
+     */
+    static void frame();
+
+#pragma mark Results
+    /**
+     * Returns the number of frames since the profiler started
+     *
+     * @return the number of frames since the profiler started
+     */
+    static Uint64 getFrames();
+
+    /**
+     * Returns the number of events dropped because a thread buffer was full
+     *
+     * @return the number of events dropped because a thread buffer was full
+     */
+    static Uint64 getDropped();
+
+    /**
+     * Returns the mean of the given span in microseconds (or counter value)
+     *
+     * This only counts the events collected so far.
+     *
+     * @param name  The span or counter name
+     *
+     * @return the mean of the given span in microseconds (or counter value)
+     */
+    static double getMean(const std::string& name);
+
+    /**
+     * Writes the collected events as a Chrome trace
+     *
+     * Spans become complete events, and counters become counter events, with
+     * one track per thread.
+     *
+     * @param file  The path to the trace file
+     *
+     * @return true if the trace was written
+     */
+    static bool writeTrace(const std::string file);
+
+    /**
+     * Writes the summary statistics as a CSV file
+     *
+     * There is one row per span or counter, with the number of calls and the
+     * total, mean, minimum, maximum and per-frame value.  Times are in
+     * microseconds.
+     *
+     * @param file  The path to the CSV file
+     *
+     * @return true if the summary was written
+     */
+    static bool writeSummary(const std::string file);
+};
+
+}
+
+#endif /* __CU_PROFILER_H__ */
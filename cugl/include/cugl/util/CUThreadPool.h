@@ -6,6 +6,10 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  Each worker has its own task queue, and an idle worker steals from the
+//  others.  Tasks can be submitted for a future, collected in a TaskGroup to
+//  wait on, or spread over an index range with parallelFor.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -30,15 +34,20 @@
 //      3. This notice may not be removed or altered from any source distribution.
 //
 //  Author: Walker White
-//  Version: 11/29/16
+//  Version: 10/17/26
 //
 #ifndef __CU_THREAD_POOL_H__
 #define __CU_THREAD_POOL_H__
 #include <cugl/base/CUBase.h>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
-#include <queue>
 #include <vector>
 #include <thread>
 
@@ -49,24 +58,39 @@
 
 namespace cugl {
 
+class TaskGroup;
+
 #pragma mark -
 #pragma mark Thread Pool
 
 /**
  *  Class to providing a collection of worker threads.
  *
- *  This is a general purpose class for performing tasks asynchronously.  There 
- *  is no notification process for when a task is complete.  Instead, your task 
- *  should either set a flag, or execute a callback when it is done.
+ *  This is a general purpose class for performing tasks asynchronously.  A
+ *  task added with {@link addTask} has no notification for when it is
+ *  complete; it should either set a flag, or execute a callback when it is
+ *  done.  A task added with {@link submit} returns a future for its result
+ *  instead.  To wait for a batch of tasks, add them to a {@link TaskGroup}.
+ *  To split a loop over the workers, use {@link parallelFor}.
+ *
+ *  Every worker thread has its own task queue.  A task added by a worker
+ *  goes to the queue of that worker, and a task added by any other thread is
+ *  dealt to the queues in turn.  A worker runs the tasks in its own queue in
+ *  the order they were added.  When its queue is empty, it steals the newest
+ *  task from another worker.  Hence a pool with one thread runs its tasks in
+ *  order (which {@link AssetManager} depends on), while a larger pool only
+ *  touches a shared lock when a worker runs out of work.
  *
  *  There are some important safety considerations for using this class over
- *  direct thread objects. For example, stopping a thread pool does not shut it 
- *  down immediately; it just marks it for shutdown.  Because of mutex locks, 
- *  it is not safe to delete a thread pool until it is completely shutdown.
+ *  direct thread objects. For example, stopping a thread pool does not shut it
+ *  down immediately; it just marks it for shutdown.  Tasks that have not
+ *  started when the pool stops are never run (and their futures, or the
+ *  task groups waiting on them, report a broken promise once the pool is
+ *  disposed).
  *
  *  More importantly, we do not allow for detached threads. This makes no sense
- *  in this application, because the threads share a resource (_taskQueue) with 
- *  the main thread that will be deleted.  It is therefore unsafe for the 
+ *  in this application, because the threads share a resource (the task queues)
+ *  with the main thread that will be deleted.  It is therefore unsafe for the
  *  threads to ever detach.
  *
  *  See the class {@link AssetManager} for an example of how to use a thread 
@@ -74,45 +98,100 @@ namespace cugl {
  */
 class ThreadPool {
 private:
+    /** The tasks queued for one worker thread */
+    struct alignas(64) TaskQueue {
+        /** The pool of the worker */
+        ThreadPool* pool;
+        /** The index of the worker in the pool */
+        int index;
+        /** A mutex lock for the tasks */
+        std::mutex mutex;
+        /** The tasks, oldest first */
+        std::deque< std::function<void()> > tasks;
+    };
+
     /** The individual worker threads for this thread pool */
 #ifdef CU_SDL_THREADS
     std::vector<SDL_Thread*> _workers;
 #else
     std::vector<std::thread> _workers;
 #endif
-    
-    /** Tasks waiting to be assigned to a thread */
-    std::queue< std::function<void()> > _taskQueue;
-    
-    /** A mutex lock for the task queue */
-    std::mutex _queueMutex;
-    /** A condition variable to manage tasks waiting for a worker */
+    /** The task queue of each worker thread */
+    std::vector< std::unique_ptr<TaskQueue> > _queues;
+
+    /** The number of tasks queued and not yet taken by a thread */
+    std::atomic<long> _pending;
+    /** The queue for the next task added from outside the pool */
+    std::atomic<size_t> _deal;
+    /** The number of workers waiting for a task */
+    std::atomic<int> _sleeping;
+
+    /** A mutex lock for sleeping workers */
+    std::mutex _sleepMutex;
+    /** A condition variable to manage workers waiting for a task */
     std::condition_variable _taskCondition;
     
     /** Whether or not the thread pool has been marked for shutdown */
-    bool _stop;
+    std::atomic<bool> _stop;
     /** The number of child threads that are completed */
-    int _complete;
+    std::atomic<int> _complete;
     
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.  
+     * This function pulls tasks from the queue of the worker, or steals them
+     * from the other workers, and sleeps when there are none.
      *
      * This implementation is safe to use with std::thread.
+     *
+     * @param index The index of the worker
      */
-    void threadFunc();
+    void threadFunc(int index);
 
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.
-     *
      * This static implementation uses the SDL thread API.  It should be used
      * on Android and Windows, which have special thread requirements.
+     *
+     * @param ptr   The task queue of the worker
      */
     static int sdlThreadFunc(void* ptr);
-    
+
+    /**
+     * Queues a task and wakes a worker for it if they are all asleep
+     *
+     * @param task  The task to queue
+     */
+    void push(std::function<void()>&& task);
+
+    /**
+     * Takes a task for the given worker, stealing one if it has none.
+     *
+     * @param index The index of the worker (-1 for a thread outside the pool)
+     *
+     * @return the task, or an empty function if no task is queued
+     */
+    std::function<void()> take(int index);
+
+    /**
+     * Runs one queued task on the calling thread, if there is one
+     *
+     * This is how a thread waiting on a {@link TaskGroup} helps out, rather
+     * than blocking a worker the group may need.
+     *
+     * @return true if a task was run
+     */
+    bool runPending();
+
+    /**
+     * Returns the index of the calling thread in this pool (-1 if it is not a worker)
+     *
+     * @return the index of the calling thread in this pool (-1 if it is not a worker)
+     */
+    int currentIndex() const;
+
+    friend class TaskGroup;
 
 #pragma mark Constructors
 public:
@@ -124,25 +203,25 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool 
      * on the heap, use one of the static constructors instead.
      */
-    ThreadPool() :_stop(false), _complete(0) { }
+    ThreadPool() : _pending(0), _deal(0), _sleeping(0), _stop(false), _complete(0) { }
     
     /**
      * Deletes this thread pool, destroying all resources.
      *
      * It is a bad idea to destroy the thread pool if the pool is not yet shut
-     * down. The task queue is shared by the child threads, so we cannot delete
-     * it until all the threads complete.  This destructor will block unti 
-     * showndown.
+     * down. The task queues are shared by the child threads, so we cannot
+     * delete them until all the threads complete.  This destructor will block
+     * until shutdown.
      */
     ~ThreadPool() { dispose(); }
     
     /**
      * Disposes this thread pool, releasing all memory.
      *
-     * A disposed thread pool can be safely reinitialized. However, it is a bad 
-     * idea to destroy the thread pool if the pool is not yet shut down. The 
-     * task queue is shared by the child threads, so we cannot delete it until 
-     * all the threads complete.  This destructor will block unti showndown.
+     * This stops the pool and blocks until every worker has finished its
+     * current task (without spinning).  Tasks that never started are
+     * discarded, and any {@link TaskGroup} waiting on them is told they were
+     * cancelled.  A disposed thread pool can be safely reinitialized.
      */
     void dispose();
     
@@ -190,6 +269,48 @@ public:
      * @param  task     the task function to add to the thread pool
      */
     void addTask(const std::function<void()> &task);
+
+    /**
+     * Adds a task to the thread pool, returning a future for its result.
+     *
+     * The task is any function with no parameters.  Its result (or the
+     * exception it throws) is delivered through the future.  If the pool is
+     * disposed before the task starts, the future reports a broken promise.
+     *
+     * Do not wait on the future from a worker of this pool; use a
+     * {@link TaskGroup}, which helps with the queued work while it waits.
+     *
+     * @param  task     the task function to add to the thread pool
+     *
+     * @return a future for the result of the task
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        typedef decltype(task()) R;
+        auto packaged = std::make_shared< std::packaged_task<R()> >(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        push([packaged](void) { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * Runs the body over an index range, split across the workers.
+     *
+     * The range [begin,end) is cut into chunks of grain indices (the last
+     * may be shorter), and body is called with the bounds of each chunk.  The
+     * calling thread works on the chunks too, and this method returns once
+     * every chunk is done.  The chunks are handed out as threads ask for them,
+     * so an uneven body still balances.  Pick a grain so that a chunk is
+     * worth at least a few microseconds.
+     *
+     * It is safe to call this from a task of this pool.
+     *
+     * @param begin The first index
+     * @param end   The index after the last one
+     * @param grain The number of indices in a chunk
+     * @param body  The function called with the bounds of each chunk
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t,size_t)>& body);
     
     /**
      * Stop the thread pool, marking it for shut down.
@@ -218,13 +339,115 @@ public:
      *
      * @return whether the thread pool has been shut down.
      */
-    bool isShutdown() const { return _workers.size() == _complete; }
+    bool isShutdown() const { return _workers.size() == (size_t)_complete; }
+
+    /**
+     * Returns the number of worker threads in this pool.
+     *
+     * @return the number of worker threads in this pool.
+     */
+    size_t getThreadCount() const { return _workers.size(); }
   
 private:  
     /** Copying is only allowed via shared pointer. */
     CU_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
+#pragma mark -
+#pragma mark Task Group
+
+/**
+ *  Class to wait for a batch of tasks.
+ *
+ *  A task group runs its tasks on a thread pool and counts them until they
+ *  finish.  The method {@link wait} blocks until every task added so far is
+ *  done.  While it waits, the calling thread runs queued tasks of the pool
+ *  itself, so it is safe to wait on a group from a task of the same pool.
+ *
+ *  If a task throws, the first exception is rethrown by {@link wait}.  If
+ *  the pool is disposed before a task starts, the task is cancelled, and
+ *  {@link wait} throws a std::future_error with a broken promise.
+ *
+ *  This class is meant to be created on the stack, like {@link Timestamp}.
+ *  The destructor waits for any tasks still running, as they refer to the
+ *  group.
+ */
+class TaskGroup {
+private:
+    /** The pool that runs the tasks */
+    ThreadPool* _pool;
+    /** The number of tasks that have not finished */
+    std::atomic<int> _running;
+    /** The number of tasks that have finished (guarded by the mutex) */
+    Uint64 _finished;
+    /** A mutex lock for finishing tasks */
+    std::mutex _mutex;
+    /** A condition variable signalled whenever a task finishes */
+    std::condition_variable _finishCondition;
+    /** The first exception thrown by a task */
+    std::exception_ptr _error;
+
+    /**
+     * Marks a task as finished, waking the waiting thread
+     *
+     * @param ran   Whether the task ran (false if the pool dropped it)
+     */
+    void finish(bool ran);
+
+public:
+    /**
+     * Creates a task group for the given pool
+     *
+     * If the pool is nullptr, tasks run immediately on the calling thread.
+     *
+     * @param pool  The pool that runs the tasks
+     */
+    TaskGroup(ThreadPool* pool) : _pool(pool), _running(0), _finished(0) {}
+
+    /**
+     * Creates a task group for the given pool
+     *
+     * If the pool is nullptr, tasks run immediately on the calling thread.
+     *
+     * @param pool  The pool that runs the tasks
+     */
+    TaskGroup(const std::shared_ptr<ThreadPool>& pool) : TaskGroup(pool.get()) {}
+
+    /**
+     * Deletes this task group, after waiting for its tasks
+     */
+    ~TaskGroup();
+
+    /**
+     * Adds a task to the group and the pool
+     *
+     * If the pool has no workers or has stopped, the task runs immediately.
+     *
+     * @param task  The task function to add
+     */
+    void run(const std::function<void()>& task);
+
+    /**
+     * Blocks until every task in the group is done
+     *
+     * The calling thread runs queued tasks of the pool while it waits, and
+     * sleeps when there are none.  If a task threw, or was cancelled by the
+     * pool, the first exception is rethrown (once).
+     */
+    void wait();
+
+    /**
+     * Returns true if every task in the group is done
+     *
+     * @return true if every task in the group is done
+     */
+    bool isDone() const { return _running == 0; }
+
+    // Tasks refer to their group
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+};
+
 }
 
 #endif /* __CU_THREAD_POOL_H__ */
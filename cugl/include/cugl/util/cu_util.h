@@ -35,5 +35,6 @@
 #include "CUFreeList.h"
 #include "CUGreedyFreeList.h"
 #include "CUThreadPool.h"
+#include "CUProfiler.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
@@ -126,9 +126,56 @@ def config_cmake(config,project):
         incstr += 'list(APPEND EXTRA_INCLUDES "'+path+'")\n'
     context['__EXTRA_INCLUDES__'] = incstr
     
+    # Set the extra targets
+    context['__EXTRA_TARGETS__'] = config_targets(config)
+    
     util.file_replace(cmake,context)
 
 
+def config_targets(config):
+    """
+    Returns the CMake commands for the extra executables of the project
+    
+    Each entry of the cmake targets list in the config file is an executable
+    with a name, a list of sources, and an optional list of preprocessor
+    definitions. These executables link against CUGL just like the application,
+    but only build the sources listed for them. This allows tools (such as a
+    headless simulation) to be built alongside the application.
+    
+    :param config: The project configuration settings
+    :type config:  ``dict``
+    
+    :return: the CMake commands for the extra executables of the project
+    :rtype:  ``str``
+    """
+    if not 'cmake' in config or not 'targets' in config['cmake'] or not config['cmake']['targets']:
+        return ''
+    
+    result = ''
+    for target in config['cmake']['targets']:
+        util.check_config_keys(target,['name','sources'])
+        name = target['name']
+        
+        srclist = []
+        entries = target['sources'] if type(target['sources']) == list else [target['sources']]
+        for item in entries:
+            path = os.path.join('..','..',config['build_to_root'],item)
+            srclist.append(util.path_to_posix(path))
+        
+        defines = target['defines'] if 'defines' in target and target['defines'] else []
+        if type(defines) != list:
+            defines = [defines]
+        
+        result += 'file(GLOB '+name+'_FILES\n    '+'\n    '.join(srclist)+')\n'
+        result += 'add_executable('+name+' ${'+name+'_FILES})\n'
+        result += 'set_target_properties('+name+' PROPERTIES SUFFIX ".exe")\n'
+        if defines:
+            result += 'target_compile_definitions('+name+' PUBLIC '+' '.join(defines)+')\n'
+        result += 'target_link_libraries('+name+' PUBLIC ${EXTRA_LIBS})\n'
+        result += 'target_include_directories('+name+' PUBLIC "${PROJECT_BINARY_DIR}" ${EXTRA_INCLUDES})\n'
+    return result
+
+
 def make(config):
     """
     Creates the CMake build
@@ -48,17 +48,20 @@
 #include <cugl/assets/CUAssetManager.h>
 #include <cugl/base/CUApplication.h>
 #include <cugl/io/CUJsonReader.h>
+#include <cugl/util/CUProfiler.h>
+#include <algorithm>
+#include <map>
 
 using namespace cugl;
 
 #pragma mark -
 #pragma mark Constructors
 /**
- * Initializes a new asset manager with two auxiliary threads.
+ * Initializes a new asset manager.
  *
- * The asset manager will have a thread pool of size 2, giving it two
- * threads to load assets asynchronously.  These threads have no effect on
- * synchronous loading and will sleep when no assets are being loaded.
+ * The asset manager has one worker thread for each core not used by the
+ * main thread, up to ASSET_MAX_WORKERS. Assets of the same priority are
+ * loaded in parallel on these threads.
  *
  * This initializer does not attach any loaders.  It simply creates an
  * object that is ready to accept loader objects.
@@ -66,7 +69,47 @@ using namespace cugl;
  * @return true if the asset manager was initialized successfully
  */
 bool AssetManager::init() {
-    _workers = ThreadPool::alloc(1);
+    int cores = SDL_GetCPUCount()-1;
+    return init((Uint32)std::max(1,std::min(cores,ASSET_MAX_WORKERS)));
+}
+
+/**
+ * Initializes a new asset manager with the given number of threads.
+ *
+ * Assets of the same priority are loaded in parallel on these threads.
+ * The threads have no effect on synchronous loading and will sleep when
+ * no assets are being loaded.
+ *
+ * The main thread half of asynchronous loading goes through a queue
+ * that is processed once an animation frame, within a budget of
+ * MATERIALIZE_BUDGET microseconds (see {@link getMaterializer}).
+ *
+ * This initializer does not attach any loaders.  It simply creates an
+ * object that is ready to accept loader objects.
+ *
+ * @param threads   The number of worker threads
+ *
+ * @return true if the asset manager was initialized successfully
+ */
+bool AssetManager::init(Uint32 threads) {
+    _workers = ThreadPool::alloc(threads);
+    _materializer = MaterializeQueue::alloc();
+    if (_workers == nullptr || _materializer == nullptr) {
+        return false;
+    }
+    
+    // The callback stops once the manager releases the queue
+    std::weak_ptr<MaterializeQueue> queue = _materializer;
+    if (Application::get() != nullptr) {
+        Application::get()->schedule([=](void) {
+            std::shared_ptr<MaterializeQueue> active = queue.lock();
+            if (active == nullptr) {
+                return false;
+            }
+            active->process();
+            return true;
+        });
+    }
     return true;
 }
 
@@ -80,6 +123,9 @@ bool AssetManager::init() {
 void AssetManager::dispose() {
     detachAll();
     _workers = nullptr;
+    _materializer = nullptr;
+    _preload = 0;
+    _staged  = 0;
 }
 
 #pragma mark -
@@ -118,6 +164,7 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
         return false;
     }
     
+    CU_PROFILE_SCOPE(Profiler::intern("AssetManager::load "+json->key()));
     bool success = true;
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
@@ -128,55 +175,106 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
 }
 
 /**
- * Asynchronously reads an asset category from a JSON file
+ * Asynchronously reads the current stage of a directory load
  *
- * JSON directories provide a robust way for us to load a collection of
- * assets. Instead of having to define parameters like asset key, font
- * size, or texture wrap in the code, we can specify them in a JSON file.
- * This JSON file (called the asset directory) is read by the asset manager,
- * and directs the various loaders to load in assets.
+ * Every asset of the stage is queued with its loader, which hands the
+ * work that is safe outside of the main thread to the worker threads.
+ * The loaders materialize the assets on the main thread, via the
+ * {@link Application#schedule} interface.
  *
- * Currently JSON loading supports five types of assets, with the following
- * names: "textures", "fonts", "music", "soundfx", and "jsons".  See the
- * method {@link BaseLoader#read} in each of the individual loaders for a
- * description of the suported JSON format. A loader must still be attached
- * for the asset manager to read that type of asset.  If the asset directory
- * contains an asset for which there is no attached asset manager, those
- * specific assets will not be loaded.
+ * If a category has no attached loader, the callback is given the asset
+ * category name (e.g. "soundfx") as the asset key.
  *
- * As an asynchronous read, all asset loading will take place outside of
- * the main thread.  However, assets such as fonts and textures will need
- * the OpenGL context to complete, so part of their asset loading may take
- * place in the main thread via the {@link Application#schedule} interface.
- * You may either poll this interface to determine when the assets are
- * loaded or use optional callbacks.
+ * @param load  The directory load
+ */
+void AssetManager::readStage(const std::shared_ptr<DirectoryLoad>& load) {
+    load->keys.clear();
+    load->results.clear();
+    load->reported = 0;
+    for(auto it = load->stages[load->stage].begin(); it != load->stages[load->stage].end(); ++it) {
+        std::shared_ptr<JsonValue> json = it->second;
+        _staged -= json->size();
+        
+        auto jt = _handlers.find(it->first);
+        std::shared_ptr<BaseLoader> loader = (jt == _handlers.end() ? nullptr : jt->second);
+        if (loader == nullptr) {
+            if (load->callback != nullptr) {
+                load->keys.push_back(json->key());
+                load->results.push_back(false);
+            }
+            continue;
+        }
+
+        CU_PROFILE_SCOPE(Profiler::intern("AssetManager::queue "+json->key()));
+        for(int ii = 0; ii < json->size(); ii++) {
+            std::shared_ptr<JsonValue> child = json->get(ii);
+            if (load->callback == nullptr) {
+                loader->loadAsync(child, nullptr);
+            } else {
+                // Buffer the result so the callback sees directory order
+                size_t index = load->keys.size();
+                load->keys.push_back(child->key());
+                load->results.push_back(-1);
+                loader->loadAsync(child, [=](const std::string key, bool success) {
+                    load->results[index] = success;
+                    this->reportStage(load,false);
+                });
+            }
+        }
+    }
+    reportStage(load,false);
+}
+
+/**
+ * Returns true if the directory load still has a stage to finish
  *
- * The optional callback function will be called each time an individual
- * asset loads or fails to load.  However, if the entire category fails
- * to load, the callback function will be given the asset category name
- * (e.g. "soundfx") as the asset key.
+ * This method is polled once an animation frame.  When every loader in
+ * the current stage has materialized its assets, it reports the rest of
+ * the stage to the callback and queues the next stage.
  *
- * @param hash      The hash of the asset type
- * @param json      The child of asset directory with these assets
- * @param callback  An optional callback after each asset is loaded
+ * @param load  The directory load
+ *
+ * @return true if the directory load still has a stage to finish
  */
-void AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& json,
-                                LoaderCallback callback) {
-    auto it = _handlers.find(hash);
-    std::shared_ptr<BaseLoader> loader = it->second;
-    if (loader == nullptr) {
-        if (callback) {
-            Application::get()->schedule([=] {
-                callback(json->key(),false);
-                return false;
-            });
+bool AssetManager::advanceStage(const std::shared_ptr<DirectoryLoad>& load) {
+    for(auto it = load->stages[load->stage].begin(); it != load->stages[load->stage].end(); ++it) {
+        auto jt = _handlers.find(it->first);
+        if (jt != _handlers.end() && jt->second->waitCount() > 0) {
+            return true;
         }
-        return;
     }
     
-    for(int ii = 0; ii < json->size(); ii++) {
-        std::shared_ptr<JsonValue> child = json->get(ii);
-        loader->loadAsync(child, callback);
+    reportStage(load,true);
+    load->stage++;
+    if (load->stage < load->stages.size()) {
+        readStage(load);
+        return true;
+    }
+    _preload--;
+    return false;
+}
+
+/**
+ * Passes the results of the current stage of a directory load to its callback
+ *
+ * The callback is given every result from the first unreported asset up
+ * to the first asset still loading. If the stage is finished, it is given
+ * all of the remaining results instead (assets with no result, such as
+ * duplicate keys, are skipped).
+ *
+ * @param load      The directory load
+ * @param finished  Whether the stage is finished
+ */
+void AssetManager::reportStage(const std::shared_ptr<DirectoryLoad>& load, bool finished) {
+    while (load->reported < load->keys.size()) {
+        int result = load->results[load->reported];
+        if (result < 0 && !finished) {
+            return;
+        }
+        size_t index = load->reported++;
+        if (result >= 0) {
+            load->callback(load->keys[index],result != 0);
+        }
     }
 }
 
@@ -213,52 +311,6 @@ bool AssetManager::purgeCategory(size_t hash, const std::shared_ptr<JsonValue>&
     return success;
 }
 
-/**
- * Synchronizes the asset manager to wait until all assets have finished.
- *
- * This method is necessary for assets whose construction depends on
- * previously loaded assets (e.g. scene graphs).  In the current architecture,
- * this method is only correct if the asset manager loads assets in a
- * single thread.
- */
-void AssetManager::sync() {
-    _workers->addTask([=](void) {
-        this->block();
-        this->block(); // Two blocks force one complete cycle
-    });
-}
-
-/**
- * Blocks the asset manager until the next animation frame.
- *
- * Any assets queued after a block will not be added to thread pool
- * until at least one animation frame has passed.  This method is used
- * to implement the {@link sync()} method.
- */
-void AssetManager::block() {
-    Application::get()->schedule([=](void){
-        this->resume();
-        return false;
-    });
-    _wait = true;
-    while (_wait) {
-        int delay = (int)(500/Application::get()->getFPS());
-        SDL_Delay(delay);
-    }
-    return;
-}
-
-/**
- * Resumes a previously blocked the asset manager.
- *
- * Any assets queued after a block will not be added to thread pool
- * until at least one animation frame has passed.  This method is used
- * to implement the {@link sync()} method.
- */
-void AssetManager::resume() {
-    _wait = false;
-}
-
 #pragma mark -
 #pragma mark Directory Support
 /**
@@ -398,49 +450,55 @@ bool AssetManager::loadDirectory(const std::string directory) {
  * You may either poll this interface to determine when the assets are
  * loaded or use optional callbacks.
  *
+ * Assets of the same priority are loaded in parallel, on all of the
+ * worker threads of this manager.
+ *
  * The optional callback function will be called each time an individual
  * asset loads or fails to load.  However, if the entire category fails
  * to load, the callback function will be given the asset category name
- * (e.g. "soundfx") as the asset key.
+ * (e.g. "soundfx") as the asset key.  The callback sees the assets in
+ * the order of the directory (by priority), no matter which thread
+ * finishes first.
+ *
+ * This method must be called on the main thread.
  *
  * @param json      The JSON asset directory
  * @param callback  An optional callback after each asset is loaded
  */
 void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, LoaderCallback callback) {
-    size_t entries = json->size();
+    CU_PROFILE_SCOPE("AssetManager::loadDirectoryAsync");
     
-    // Process entries by priority
-    Uint32 curr = 0;
-    Uint32 next = 0;
-    Uint32 err  = 0;
-    while (entries > err) {
-        for(int ii = 0; ii < json->size(); ii++) {
-            std::shared_ptr<JsonValue> child = json->get(ii);
-            auto hash = _jsonKeys.find(child->key());
-            if (hash != _jsonKeys.end()) {
-                auto rank = _priority.find(child->key());
-                CUAssertLog(rank != _priority.end(), "AssetDirectory loaders are corrupted");
-                if (rank->second == curr) {
-                    readCategory(hash->second,child,callback);
-                    entries--;
-                } else if (rank->second > curr) {
-                    // We are looking for the NEXT available rank
-                    if (next == curr) {
-                        next = rank->second;
-                    } else if (rank->second < next) {
-                        next = rank->second;
-                    }
-                }
-            } else {
-                CULogError("Unknown asset category '%s'",child->key().c_str());
-                err++;
-            }
-        }
-        if (entries != err) {
-            curr = next;
-            sync();
+    // Group the categories into stages by priority
+    std::map<Uint32,std::vector<std::pair<size_t,std::shared_ptr<JsonValue>>>> ranks;
+    for(int ii = 0; ii < json->size(); ii++) {
+        std::shared_ptr<JsonValue> child = json->get(ii);
+        auto hash = _jsonKeys.find(child->key());
+        if (hash != _jsonKeys.end()) {
+            auto rank = _priority.find(child->key());
+            CUAssertLog(rank != _priority.end(), "AssetDirectory loaders are corrupted");
+            ranks[rank->second].push_back(std::make_pair(hash->second,child));
+            _staged += child->size();
+        } else {
+            CULogError("Unknown asset category '%s'",child->key().c_str());
         }
     }
+    if (ranks.empty()) {
+        return;
+    }
+
+    std::shared_ptr<DirectoryLoad> load = std::make_shared<DirectoryLoad>();
+    for(auto it = ranks.begin(); it != ranks.end(); ++it) {
+        load->stages.push_back(std::move(it->second));
+    }
+    load->stage = 0;
+    load->callback = callback;
+    load->reported = 0;
+    
+    _preload++;
+    readStage(load);
+    Application::get()->schedule([=](void) {
+        return this->advanceStage(load);
+    });
 }
 
 /**
@@ -467,27 +525,43 @@ void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, Lo
  * You may either poll this interface to determine when the assets are
  * loaded or use optional callbacks.
  *
+ * Assets of the same priority are loaded in parallel, on all of the
+ * worker threads of this manager.
+ *
  * The optional callback function will be called each time an individual
  * asset loads or fails to load.  However, if the entire category fails
  * to load, the callback function will be given the asset category name
- * (e.g. "soundfx") as the asset key.
+ * (e.g. "soundfx") as the asset key.  The callback sees the assets in
+ * the order of the directory (by priority), no matter which thread
+ * finishes first.
  *
  * @param directory The path to the JSON asset directory
  * @param callback  An optional callback after each asset is loaded
  */
 void AssetManager::loadDirectoryAsync(const std::string directory, LoaderCallback callback) {
-    _preload = true;
-    
     std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
-    if (reader == nullptr && callback != nullptr) {
-        callback("",false);
+    if (reader == nullptr) {
+        CULogError("No asset directory located at '%s'",directory.c_str());
+        if (callback != nullptr) {
+            callback("",false);
+        }
         return;
     }
     
+    // Only the parsing happens off the main thread
+    _preload++;
     _workers->addTask([=](void) {
+        CU_PROFILE_SCOPE("AssetManager::readDirectory");
         std::shared_ptr<JsonValue> json = reader->readJson();
-        loadDirectoryAsync(json,callback);
-        _preload = false;
+        Application::get()->schedule([=](void) {
+            _preload--;
+            if (json != nullptr) {
+                this->loadDirectoryAsync(json,callback);
+            } else if (callback != nullptr) {
+                callback("",false);
+            }
+            return false;
+        });
     });
 }
 
@@ -569,7 +643,8 @@ size_t AssetManager::loadCount() const {
  * loading process has not yet finished. This method counts each asset
  * equally regardless of the memory requirements of each asset.
  *
- * The value returned is the sum of the waitCount for all attached loaders.
+ * The value returned is the sum of the waitCount for all attached loaders,
+ * plus the assets of directories that are not yet queued with a loader.
  *
  * @return the number of assets waiting to load.
  */
@@ -578,5 +653,5 @@ size_t AssetManager::waitCount() const {
     for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
         result += it->second->waitCount();
     }
-    return _preload ? result+1 : result;
+    return result+_staged+_preload;
 }
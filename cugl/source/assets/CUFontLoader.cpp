@@ -46,9 +46,18 @@
 #include <cugl/assets/CUFontLoader.h>
 #include <cugl/base/CUApplication.h>
 #include <SDL_ttf.h>
+#include <mutex>
 
 using namespace cugl;
 
+/**
+ * The lock for opening fonts
+ *
+ * Fonts are loaded in parallel by the asset manager, but every FreeType face
+ * is created from the same library, which is not thread-safe.
+ */
+static std::mutex _ttf_mutex;
+
 /** What the source name is if we do not know it */
 #define UNKNOWN_SOURCE  "<unknown>"
 /** The default character set (ASCII) */
@@ -70,6 +79,7 @@ _fontsize(UNKNOWN_SIZE),
 _charset(UNKNOWN_CHARS) {
     _jsonKey  = "fonts";
     _priority = 0;
+    _matpriority = MATERIALIZE_UI;
 }
 
 
@@ -90,7 +100,11 @@ _charset(UNKNOWN_CHARS) {
  * @return the font asset with no generated atlas
  */
 std::shared_ptr<Font> FontLoader::preload(const std::string source, const std::string charset, int size) {
-    std::shared_ptr<Font> result = Font::alloc(source.c_str(),size);
+    std::shared_ptr<Font> result;
+    {
+        std::lock_guard<std::mutex> lock(_ttf_mutex);
+        result = Font::alloc(source.c_str(),size);
+    }
     if (result == nullptr) {
         return result;
     }
@@ -155,7 +169,11 @@ std::shared_ptr<Font> FontLoader::preload(const std::shared_ptr<JsonValue>& json
     Uint32 stretch = json->getInt("stretch",0);
     Uint32 shrink  = json->getInt("shrink", 0);
 
-    std::shared_ptr<Font> result = Font::alloc(source.c_str(),size);
+    std::shared_ptr<Font> result;
+    {
+        std::lock_guard<std::mutex> lock(_ttf_mutex);
+        result = Font::alloc(source.c_str(),size);
+    }
     if (result == nullptr) {
         return result;
     }
@@ -245,9 +263,8 @@ bool FontLoader::read(const std::string key, const std::string source, int size,
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Font> font = this->preload(source,_charset,size);
-            Application::get()->schedule([=](void){
+            this->queueMaterialize([=](void) {
                 this->materialize(key,font,callback);
-                return false;
             });
         });
     }
@@ -304,9 +321,8 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Font> font = this->preload(json);
-            Application::get()->schedule([=](void){
+            this->queueMaterialize([=](void) {
                 this->materialize(key,font,callback);
-                return false;
             });
         });
     }
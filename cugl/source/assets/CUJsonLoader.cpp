@@ -112,9 +112,8 @@ bool JsonLoader::read(const std::string key, const std::string source, LoaderCal
         _loader->addTask([=](void) {
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(key,json,callback);
-                return false;
             });
         });
     }
@@ -163,9 +162,8 @@ bool JsonLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
         _loader->addTask([=](void) {
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(key,json,callback);
-                return false;
             });
         });
     }
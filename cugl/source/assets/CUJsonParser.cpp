@@ -0,0 +1,772 @@
+//
+//  CUJsonParser.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the parser behind JsonValue::initWithJson.  It reads
+//  the JSON text in a single pass and builds the JsonValue tree directly,
+//  instead of building a cJSON tree first and then copying it.  The nodes are
+//  allocated from an arena, numbers are decoded without strtod whenever that
+//  can be done exactly (and otherwise without the locale getting in the way),
+//  and strings are scanned in place so that only the final value is ever
+//  copied.
+//
+//  The parser accepts everything the cJSON parser did on well-formed JSON,
+//  and reports errors by line and column.
+//
+//  This class is a stack-based utility.  It does not use the shared-pointer
+//  architecture, since a parser is only needed for the length of one parse.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#include <cugl/assets/CUJsonParser.h>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+using namespace cugl;
+
+/** The largest mantissa that converts to a double exactly (2^53) */
+#define EXACT_MANTISSA  9007199254740992ULL
+/** The most significant digits that fit in a 64 bit mantissa */
+#define MANTISSA_DIGITS 19
+
+/** The powers of ten that are exact doubles */
+static const double EXACT_POWERS[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Returns the correctly rounded value of the JSON number text
+ *
+ * This is the slow path for the numbers that cannot be decoded exactly
+ * with double arithmetic.  The text is known to be a valid (unsigned) JSON
+ * number, so it is read the same whatever the locale: from_chars never
+ * looks at the locale, and strtod is given the decimal point of the current
+ * locale (which is what cJSON did).
+ *
+ * @param begin The start of the number text
+ * @param end   The end of the number text
+ * @param value The value of the number
+ *
+ * @return false if the number is too large or small for a double
+ */
+static bool parse_exact(const char* begin, const char* end, double& value) {
+#if defined(__cpp_lib_to_chars)
+    return std::from_chars(begin, end, value).ec != std::errc::result_out_of_range;
+#else
+    std::string text(begin, end);
+    char point = std::localeconv()->decimal_point[0];
+    std::replace(text.begin(), text.end(), '.', point);
+    // strtod already rounds a number out of range to infinity or zero
+    value = std::strtod(text.c_str(), nullptr);
+    return true;
+#endif
+}
+
+/**
+ * Returns true if c is a decimal digit
+ *
+ * @param c The character to test
+ *
+ * @return true if c is a decimal digit
+ */
+static inline bool is_digit(char c) {
+    return (unsigned)(c - '0') < 10;
+}
+
+/**
+ * Returns the value of the hexadecimal digit c (or -1 if it is not one)
+ *
+ * @param c The character to convert
+ *
+ * @return the value of the hexadecimal digit c (or -1 if it is not one)
+ */
+static inline int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Returns the four digit hexadecimal number at str (or -1 if invalid)
+ *
+ * @param str   The start of the digits
+ * @param end   The end of the text
+ *
+ * @return the four digit hexadecimal number at str (or -1 if invalid)
+ */
+static int parse_hex4(const char* str, const char* end) {
+    if (end - str < 4) {
+        return -1;
+    }
+    int result = 0;
+    for(int ii = 0; ii < 4; ii++) {
+        int digit = hex_digit(str[ii]);
+        if (digit < 0) {
+            return -1;
+        }
+        result = (result << 4) | digit;
+    }
+    return result;
+}
+
+/**
+ * Appends the UTF8 encoding of the code point to the string
+ *
+ * @param value The string to append to
+ * @param code  The unicode code point
+ */
+static void append_utf8(std::string& value, unsigned code) {
+    if (code < 0x80) {
+        value.push_back((char)code);
+    } else if (code < 0x800) {
+        value.push_back((char)(0xC0 | (code >> 6)));
+        value.push_back((char)(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        value.push_back((char)(0xE0 | (code >> 12)));
+        value.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+        value.push_back((char)(0x80 | (code & 0x3F)));
+    } else {
+        value.push_back((char)(0xF0 | (code >> 18)));
+        value.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+        value.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+        value.push_back((char)(0x80 | (code & 0x3F)));
+    }
+}
+
+#pragma mark -
+#pragma mark Arena
+/**
+ * A bump allocator for the nodes of one parse.
+ *
+ * Memory is only released when the arena is deleted, which happens once
+ * every node allocated from it is gone.
+ */
+class JsonParser::Arena {
+private:
+    /** The blocks of memory */
+    std::vector<char*> _blocks;
+    /** The next free byte of the current block */
+    char* _next;
+    /** The number of free bytes in the current block */
+    size_t _left;
+    /** The size of the next block */
+    size_t _block;
+
+public:
+    /**
+     * Creates an arena whose first block has the given size
+     *
+     * @param first The size of the first block
+     */
+    Arena(size_t first) : _next(nullptr), _left(0), _block(first) {}
+
+    /**
+     * Deletes this arena, releasing all of its blocks
+     */
+    ~Arena() {
+        for(auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+            delete[] *it;
+        }
+    }
+
+    /**
+     * Returns a pointer to the given number of bytes with the given alignment
+     *
+     * @param bytes The number of bytes
+     * @param align The alignment of the bytes
+     *
+     * @return a pointer to the given number of bytes with the given alignment
+     */
+    void* allocate(size_t bytes, size_t align) {
+        size_t pad = _next ? (align - ((uintptr_t)_next % align)) % align : 0;
+        if (_next == nullptr || pad + bytes > _left) {
+            size_t size = std::max(_block, bytes + align);
+            _blocks.push_back(new char[size]);
+            _next = _blocks.back();
+            _left = size;
+            _block = JSON_ARENA_BLOCK;
+            pad = (align - ((uintptr_t)_next % align)) % align;
+        }
+        void* result = _next + pad;
+        _next += pad + bytes;
+        _left -= pad + bytes;
+        return result;
+    }
+};
+
+/**
+ * The allocator for the nodes (and their control blocks) of one parse.
+ *
+ * Each copy keeps the arena alive, and deallocation does nothing.  As the
+ * shared pointer of a node stores a copy of its allocator, the arena lives
+ * as long as any node allocated from it.
+ */
+template <typename T>
+class JsonParser::Allocator {
+public:
+    /** The allocated type */
+    typedef T value_type;
+    /** The arena to allocate from */
+    std::shared_ptr<Arena> arena;
+
+    /**
+     * Creates an allocator for the given arena
+     *
+     * @param arena The arena to allocate from
+     */
+    Allocator(const std::shared_ptr<Arena>& arena) : arena(arena) {}
+
+    /**
+     * Creates a copy of an allocator for another type
+     *
+     * @param other The allocator to copy
+     */
+    template <typename U>
+    Allocator(const Allocator<U>& other) : arena(other.arena) {}
+
+    /**
+     * Returns storage for n objects of type T
+     *
+     * @param n The number of objects
+     *
+     * @return storage for n objects of type T
+     */
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n*sizeof(T),alignof(T)));
+    }
+
+    /**
+     * Does nothing, as the arena releases its memory all at once
+     *
+     * @param ptr   The storage to release
+     * @param n     The number of objects
+     */
+    void deallocate(T* /* ptr */, size_t /* n */) {}
+
+    /**
+     * Returns true if the allocators share an arena
+     *
+     * @param other The allocator to compare
+     *
+     * @return true if the allocators share an arena
+     */
+    template <typename U>
+    bool operator==(const Allocator<U>& other) const { return arena == other.arena; }
+
+    /**
+     * Returns true if the allocators do not share an arena
+     *
+     * @param other The allocator to compare
+     *
+     * @return true if the allocators do not share an arena
+     */
+    template <typename U>
+    bool operator!=(const Allocator<U>& other) const { return arena != other.arena; }
+};
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a parser with no errors.
+ */
+JsonParser::JsonParser() :
+_begin(nullptr),
+_end(nullptr),
+_pos(nullptr),
+_depth(0),
+_line(0),
+_column(0) {
+}
+
+#pragma mark -
+#pragma mark Parsing
+/**
+ * Parses the given JSON text into the given root node.
+ *
+ * The root node takes the type and value of the JSON value, and every
+ * other node of the tree is allocated by the parser.  The root keeps its
+ * key (and parent), so it may be the child of another tree.  Any
+ * existing children of the root are replaced.
+ *
+ * If there is a parse error, this method returns false, and the root is
+ * left unchanged.  Use {@link getError}, {@link getLine} and
+ * {@link getColumn} for the details.
+ *
+ * @param root  The node to store the JSON value
+ * @param data  The JSON text
+ * @param size  The number of bytes of JSON text
+ *
+ * @return true if the JSON text was parsed successfully
+ */
+bool JsonParser::parse(JsonValue* root, const char* data, size_t size) {
+    _begin = data;
+    _end = data+size;
+    _pos = data;
+    _depth = 0;
+    _error.clear();
+    _line = 0;
+    _column = 0;
+
+    // Small documents should not hold on to a whole block
+    _arena = std::make_shared<Arena>(std::min(std::max(size*8,(size_t)1024),(size_t)JSON_ARENA_BLOCK));
+    JsonValue scratch;
+    skip();
+    bool success = parseValue(&scratch);
+    _stack.clear();
+    _arena = nullptr;
+    if (!success) {
+        return false;
+    }
+
+    root->_type = scratch._type;
+    root->_stringValue.swap(scratch._stringValue);
+    root->_longValue = scratch._longValue;
+    root->_doubleValue = scratch._doubleValue;
+    root->_children.swap(scratch._children);
+    for(auto it = root->_children.begin(); it != root->_children.end(); ++it) {
+        (*it)->_parent = root;
+    }
+    for(auto it = scratch._children.begin(); it != scratch._children.end(); ++it) {
+        (*it)->_parent = nullptr;
+    }
+    root->invalidate();
+    return true;
+}
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Records a parse error at the given position, returning false
+ *
+ * @param pos       The position of the error
+ * @param message   The description of the error
+ *
+ * @return false, so that callers may return the result
+ */
+bool JsonParser::fail(const char* pos, const char* message) {
+    if (!_error.empty()) {
+        return false;
+    }
+    _error = message;
+    _line = 1;
+    _column = 1;
+    for(const char* curr = _begin; curr < pos && curr < _end; curr++) {
+        if (*curr == '\n') {
+            _line++;
+            _column = 1;
+        } else {
+            _column++;
+        }
+    }
+    return false;
+}
+
+/**
+ * Advances past any whitespace
+ */
+void JsonParser::skip() {
+    while (_pos < _end && (unsigned char)*_pos <= 32) {
+        _pos++;
+    }
+}
+
+/**
+ * Returns a newly allocated node from the arena
+ *
+ * @param parent    The parent of the node
+ *
+ * @return a newly allocated node from the arena
+ */
+std::shared_ptr<JsonValue> JsonParser::allocNode(JsonValue* parent) {
+    std::shared_ptr<JsonValue> result = std::allocate_shared<JsonValue>(Allocator<JsonValue>(_arena));
+    result->_parent = parent;
+    return result;
+}
+
+/**
+ * Parses the value at the current position into the given node
+ *
+ * @param node  The node to store the value
+ *
+ * @return true if the value was parsed successfully
+ */
+bool JsonParser::parseValue(JsonValue* node) {
+    if (_pos >= _end) {
+        return fail(_pos, "Unexpected end of JSON");
+    }
+    switch (*_pos) {
+        case '{':
+            return parseObject(node);
+        case '[':
+            return parseArray(node);
+        case '"':
+            node->_type = JsonValue::Type::StringType;
+            return parseString(node->_stringValue);
+        case 't':
+            if (_end - _pos >= 4 && memcmp(_pos, "true", 4) == 0) {
+                node->_type = JsonValue::Type::BoolType;
+                node->_longValue = 1;
+                _pos += 4;
+                return true;
+            }
+            break;
+        case 'f':
+            if (_end - _pos >= 5 && memcmp(_pos, "false", 5) == 0) {
+                node->_type = JsonValue::Type::BoolType;
+                node->_longValue = 0;
+                _pos += 5;
+                return true;
+            }
+            break;
+        case 'n':
+            if (_end - _pos >= 4 && memcmp(_pos, "null", 4) == 0) {
+                node->_type = JsonValue::Type::NullType;
+                _pos += 4;
+                return true;
+            }
+            break;
+        default:
+            if (*_pos == '-' || is_digit(*_pos)) {
+                return parseNumber(node);
+            }
+            break;
+    }
+    return fail(_pos, "Unexpected character");
+}
+
+/**
+ * Parses the array at the current position into the given node
+ *
+ * @param node  The node to store the array
+ *
+ * @return true if the array was parsed successfully
+ */
+bool JsonParser::parseArray(JsonValue* node) {
+    if (++_depth > JSON_NESTING_LIMIT) {
+        return fail(_pos, "Arrays and objects are nested too deeply");
+    }
+    node->_type = JsonValue::Type::ArrayType;
+    size_t base = _stack.size();
+    _pos++;
+    skip();
+    if (_pos < _end && *_pos == ']') {
+        _pos++;
+    } else {
+        while (true) {
+            _stack.push_back(allocNode(node));
+            if (!parseValue(_stack.back().get())) {
+                return false;
+            }
+            skip();
+            if (_pos >= _end) {
+                return fail(_pos, "Unterminated array");
+            } else if (*_pos == ',') {
+                _pos++;
+                skip();
+            } else if (*_pos == ']') {
+                _pos++;
+                break;
+            } else {
+                return fail(_pos, "Expected ',' or ']'");
+            }
+        }
+    }
+
+    // One allocation of the exact size, rather than growing as we go
+    node->_children.assign(std::make_move_iterator(_stack.begin()+base),
+                           std::make_move_iterator(_stack.end()));
+    _stack.resize(base);
+    _depth--;
+    return true;
+}
+
+/**
+ * Parses the object at the current position into the given node
+ *
+ * @param node  The node to store the object
+ *
+ * @return true if the object was parsed successfully
+ */
+bool JsonParser::parseObject(JsonValue* node) {
+    if (++_depth > JSON_NESTING_LIMIT) {
+        return fail(_pos, "Arrays and objects are nested too deeply");
+    }
+    node->_type = JsonValue::Type::ObjectType;
+    size_t base = _stack.size();
+    _pos++;
+    skip();
+    if (_pos < _end && *_pos == '}') {
+        _pos++;
+    } else {
+        while (true) {
+            if (_pos >= _end || *_pos != '"') {
+                return fail(_pos, "Expected a string key");
+            }
+            _stack.push_back(allocNode(node));
+            JsonValue* child = _stack.back().get();
+            if (!parseString(child->_key)) {
+                return false;
+            }
+            skip();
+            if (_pos >= _end || *_pos != ':') {
+                return fail(_pos, "Expected ':' after key");
+            }
+            _pos++;
+            skip();
+            if (!parseValue(child)) {
+                return false;
+            }
+            skip();
+            if (_pos >= _end) {
+                return fail(_pos, "Unterminated object");
+            } else if (*_pos == ',') {
+                _pos++;
+                skip();
+            } else if (*_pos == '}') {
+                _pos++;
+                break;
+            } else {
+                return fail(_pos, "Expected ',' or '}'");
+            }
+        }
+    }
+
+    node->_children.assign(std::make_move_iterator(_stack.begin()+base),
+                           std::make_move_iterator(_stack.end()));
+    _stack.resize(base);
+    _depth--;
+    return true;
+}
+
+/**
+ * Parses the string at the current position into the given string
+ *
+ * The string is scanned in place, and only copied once its end is
+ * known.  Escape sequences are decoded only if the string has any.
+ *
+ * @param value The string to store the result
+ *
+ * @return true if the string was parsed successfully
+ */
+bool JsonParser::parseString(std::string& value) {
+    const char* start = _pos+1;
+    const char* curr  = start;
+    bool escaped = false;
+    while (curr < _end && *curr != '"') {
+        if (*curr == '\\') {
+            escaped = true;
+            curr++;
+        }
+        curr++;
+    }
+    if (curr >= _end) {
+        return fail(_pos, "Unterminated string");
+    }
+    if (!escaped) {
+        value.assign(start, curr-start);
+        _pos = curr+1;
+        return true;
+    }
+
+    const char* last = curr;
+    value.clear();
+    value.reserve(last-start);
+    for(curr = start; curr < last; curr++) {
+        if (*curr != '\\') {
+            value.push_back(*curr);
+            continue;
+        }
+        const char* escape = curr++;
+        switch (*curr) {
+            case 'b':
+                value.push_back('\b');
+                break;
+            case 'f':
+                value.push_back('\f');
+                break;
+            case 'n':
+                value.push_back('\n');
+                break;
+            case 'r':
+                value.push_back('\r');
+                break;
+            case 't':
+                value.push_back('\t');
+                break;
+            case '"':
+            case '\\':
+            case '/':
+                value.push_back(*curr);
+                break;
+            case 'u':
+            {
+                int code = parse_hex4(curr+1, last);
+                if (code <= 0 || (code >= 0xDC00 && code <= 0xDFFF)) {
+                    return fail(escape, "Invalid unicode escape");
+                }
+                curr += 4;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    // The second half of a surrogate pair must follow
+                    int low = (last-curr > 6 && curr[1] == '\\' && curr[2] == 'u') ? parse_hex4(curr+3, last) : -1;
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail(escape, "Invalid unicode surrogate pair");
+                    }
+                    code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+                    curr += 6;
+                }
+                append_utf8(value, (unsigned)code);
+                break;
+            }
+            default:
+                return fail(escape, "Invalid escape sequence");
+        }
+    }
+    _pos = last+1;
+    return true;
+}
+
+/**
+ * Parses the number at the current position into the given node
+ *
+ * @param node  The node to store the number
+ *
+ * @return true if the number was parsed successfully
+ */
+bool JsonParser::parseNumber(JsonValue* node) {
+    const char* curr = _pos;
+    bool negative = false;
+    if (*curr == '-') {
+        negative = true;
+        curr++;
+    }
+    if (curr >= _end || !is_digit(*curr)) {
+        return fail(_pos, "Invalid number");
+    }
+
+    // Keep the first 19 significant digits, and track the decimal point in exp10
+    const char* text = curr;
+    Uint64 mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool truncated = false;
+    if (*curr == '0') {
+        curr++;
+    } else {
+        while (curr < _end && is_digit(*curr)) {
+            if (digits < MANTISSA_DIGITS) {
+                mantissa = mantissa*10 + (*curr - '0');
+                digits += (mantissa != 0);
+            } else {
+                exp10++;
+                truncated |= (*curr != '0');
+            }
+            curr++;
+        }
+    }
+    if (curr < _end && *curr == '.') {
+        curr++;
+        if (curr >= _end || !is_digit(*curr)) {
+            return fail(curr, "Invalid number");
+        }
+        while (curr < _end && is_digit(*curr)) {
+            if (digits < MANTISSA_DIGITS) {
+                mantissa = mantissa*10 + (*curr - '0');
+                digits += (mantissa != 0);
+                exp10--;
+            } else {
+                truncated |= (*curr != '0');
+            }
+            curr++;
+        }
+    }
+    if (curr < _end && (*curr == 'e' || *curr == 'E')) {
+        curr++;
+        int sign = 1;
+        if (curr < _end && (*curr == '+' || *curr == '-')) {
+            sign = (*curr == '-' ? -1 : 1);
+            curr++;
+        }
+        if (curr >= _end || !is_digit(*curr)) {
+            return fail(curr, "Invalid number");
+        }
+        int exponent = 0;
+        while (curr < _end && is_digit(*curr)) {
+            if (exponent < 100000) {
+                exponent = exponent*10 + (*curr - '0');
+            }
+            curr++;
+        }
+        exp10 += sign*exponent;
+    }
+
+    double value = (double)mantissa;
+    bool small = exp10 >= -22 && exp10 <= 22 && !truncated;
+    if (mantissa == 0) {
+        value = 0.0;
+    } else if (small && mantissa <= EXACT_MANTISSA) {
+        // Correctly rounded, as both operands are exact
+        value = exp10 < 0 ? value/EXACT_POWERS[-exp10] : value*EXACT_POWERS[exp10];
+    } else if (small) {
+        // Split the mantissa into two exact doubles, and correct the rounding
+        // error of the first with the second (and the residual from fma)
+        Uint64 high = (Uint64)value;
+        double low = high > mantissa ? -(double)(high-mantissa) : (double)(mantissa-high);
+        double power = EXACT_POWERS[exp10 < 0 ? -exp10 : exp10];
+        if (exp10 < 0) {
+            double quotient = value/power;
+            value = quotient + (std::fma(-quotient, power, value) + low)/power;
+        } else {
+            double product = value*power;
+            value = product + (std::fma(value, power, -product) + low*power);
+        }
+    } else if (!parse_exact(text, curr, value)) {
+        // Out of range, so round as strtod does
+        value = exp10 > 0 ? HUGE_VAL : 0.0;
+    }
+    value = negative ? -value : value;
+
+    node->_type = JsonValue::Type::NumberType;
+    node->_doubleValue = value;
+    if (value >= (double)LONG_MAX) {
+        node->_longValue = LONG_MAX;
+    } else if (value <= (double)LONG_MIN) {
+        node->_longValue = LONG_MIN;
+    } else {
+        node->_longValue = (long)value;
+    }
+    _pos = curr;
+    return true;
+}
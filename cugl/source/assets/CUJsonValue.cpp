@@ -42,45 +42,38 @@
 //  Version: 1/7/18
 //
 #include <cugl/assets/CUJsonValue.h>
+#include <cugl/assets/CUJsonParser.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUStrings.h>
+#include <mutex>
 
 using namespace cugl;
 
+/** The lock for building key indices (shared, as builds are rare) */
+static std::mutex _index_mutex;
+
 /**
  * Returns the line of JSON with the offending error.
  *
- * Error messages in this library correspond to the tail of the JSON after the error is encounterd.  These
- * can be hard to read if the error happens early.  This function truncates the error to only include the
- * first line of the error.  It also indicates (via the reference variable) the line on which the error occurred.
+ * The parser reports errors by line and column.  This function extracts that
+ * line from the JSON, so that the error message can show it.
  *
  * @param data      The JSON value being parsed
- * @param error     The tail of the JSON after encountering an error
- * @param lineno    The variable to store the line number
+ * @param lineno    The line of the error (starting at 1)
  *
  * @return the line of JSON with the offending error.
  */
-static std::string isolate_error(const char* data, const char* error, int& lineno) {
-    lineno = 1;
-    const char* pos = data;
-    while (pos != error) {
-        if (*pos == '\n') {
-            lineno++;
-        }
-        pos++;
+static std::string isolate_error(const std::string& data, int lineno) {
+    size_t start = 0;
+    for(int line = 1; line < lineno && start != std::string::npos; line++) {
+        start = data.find('\n',start);
+        start = (start == std::string::npos ? start : start+1);
     }
-    size_t len = 0;
-    bool goon = true;
-    pos = error;
-    while (*pos && goon) {
-        if (*pos == '\n') {
-            goon = false;
-        } else {
-            len++;
-        }
-        pos++;
+    if (start == std::string::npos) {
+        return "";
     }
-    return std::string(error,len);
+    size_t end = data.find('\n',start);
+    return data.substr(start,end == std::string::npos ? std::string::npos : end-start);
 }
 
 #pragma mark -
@@ -221,6 +214,7 @@ void JsonValue::toJsonValue(JsonValue* value, const cJSON* node) {
         }
     }
     value->_children.assign(items.begin(),items.end());
+    value->invalidate();
 }
 
 /**
@@ -292,7 +286,8 @@ _parent(nullptr),
 _key(""),
 _stringValue(""),
 _longValue(0L),
-_doubleValue(0.0) {
+_doubleValue(0.0),
+_indexed(false) {
 }
 
 /**
@@ -392,28 +387,23 @@ bool JsonValue::init(double value) {
  * no other references).
  *
  * If there is a parsing error, this  method will return false.  Detailed
- * information about the parsing error will be passed to an assert.  Hence
- * error messages are suppressed if asserts are turned off.
+ * information about the parsing error (including the line and column)
+ * will be passed to an assert.  Hence error messages are suppressed if
+ * asserts are turned off.  Use {@link JsonParser} directly to get the
+ * error information without asserts.
  *
  * @param json  The JSON string to parse.
  *
  * @return  true if the JSON node is initialized properly, false otherwise.
  */
-bool JsonValue::initWithJson(const std::string json) {
-    const char *error = NULL;
-    cJSON* node = cJSON_ParseWithOpts(json.c_str(), &error, 0);
-    if (node) {
-        toJsonValue(this,node);
-        cJSON_Delete(node);
+bool JsonValue::initWithJson(const std::string& json) {
+    JsonParser parser;
+    if (parser.parse(this,json)) {
         return true;
     }
-    if (error) {
-        int line = 0;
-        std::string source = isolate_error(json.c_str(),error,line);
-        CUAssertLog(false, "Invalid token at line %d:\n  %s",line,source.c_str());
-    } else {
-        CUAssertLog(false, "Invalid JSON");
-    }
+    std::string source = isolate_error(json,parser.getLine());
+    CUAssertLog(false, "%s at line %d, column %d:\n  %s", parser.getError().c_str(),
+                parser.getLine(), parser.getColumn(), source.c_str());
     return false; // If asserts turned off
 }
 
@@ -781,6 +771,48 @@ void JsonValue::setNull() {
 }
 
 
+#pragma mark -
+#pragma mark Key Index
+/**
+ * Returns the position of the child with the given key (-1 if none)
+ *
+ * Small objects are searched in order.  Larger objects build the key
+ * index on the first lookup after a change.  The build is locked, so
+ * concurrent lookups on an unchanging tree are safe.
+ *
+ * @param key   The key identifying the child
+ *
+ * @return the position of the child with the given key (-1 if none)
+ */
+int JsonValue::lookup(const std::string& key) const {
+    if (_children.size() < JSON_INDEX_MINIMUM) {
+        for(size_t ii = 0; ii < _children.size(); ii++) {
+            if (_children[ii]->_key == key) {
+                return (int)ii;
+            }
+        }
+        return -1;
+    }
+
+    if (!_indexed.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(_index_mutex);
+        if (!_indexed.load(std::memory_order_relaxed)) {
+            if (_index == nullptr) {
+                _index = std::make_unique<std::unordered_map<std::string,size_t>>();
+            }
+            _index->clear();
+            _index->reserve(_children.size());
+            for(size_t ii = 0; ii < _children.size(); ii++) {
+                // Emplace keeps the first child of a duplicate key
+                _index->emplace(_children[ii]->_key,ii);
+            }
+            _indexed.store(true,std::memory_order_release);
+        }
+    }
+    auto it = _index->find(key);
+    return it == _index->end() ? -1 : (int)it->second;
+}
+
 #pragma mark -
 #pragma mark Child Access
 /**
@@ -809,6 +841,7 @@ void JsonValue::setKey(const std::string key) {
     if (_parent) {
         CUAssertLog(!_parent->has(key), "The key %s is already in use", key.c_str());
         _key = key;
+        _parent->invalidate();
     }
 }
 
@@ -842,12 +875,7 @@ const int JsonValue::index() const {
  */
 bool JsonValue::has(const std::string key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return true;
-        }
-    }
-    return false;
+    return lookup(key) >= 0;
 }
 
 /**
@@ -896,12 +924,8 @@ const std::shared_ptr<JsonValue> JsonValue::get(int index) const {
  */
 std::shared_ptr<JsonValue> JsonValue::get(const std::string key) {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = lookup(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 /**
@@ -918,12 +942,8 @@ std::shared_ptr<JsonValue> JsonValue::get(const std::string key) {
  */
 const std::shared_ptr<JsonValue> JsonValue::get(const std::string key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = lookup(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 #pragma mark -
@@ -1061,6 +1081,7 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
     std::shared_ptr<JsonValue> result = _children[index];
     _children.erase(_children.begin() + index);
     result->_parent = nullptr;
+    invalidate();
     return result;
 }
 
@@ -1077,16 +1098,12 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
  * Returns the child with the specified key and removes it from this node.
  */
 std::shared_ptr<JsonValue> JsonValue::removeChild(const std::string key) {
-    auto jt = _children.end();
-    for(auto it = _children.begin(); jt == _children.end() && it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            jt = it;
-        }
-    }
-    if (jt != _children.end()) {
-        std::shared_ptr<JsonValue> result = *jt;
-        _children.erase(jt);
+    int pos = lookup(key);
+    if (pos >= 0) {
+        std::shared_ptr<JsonValue> result = _children[pos];
+        _children.erase(_children.begin() + pos);
         result->_parent = nullptr;
+        invalidate();
         return result;
     }
     return nullptr;
@@ -1107,6 +1124,7 @@ void JsonValue::merge(const std::shared_ptr<JsonValue>& node) {
     node->_key = _key;
     _parent->removeChild(_key);
     node->_parent->_children.push_back(node);
+    node->_parent->invalidate();
 }
 
 
@@ -1132,6 +1150,7 @@ void JsonValue::appendChild(const std::shared_ptr<JsonValue>& child) {
                 "The key %s is already in use", child->key().c_str());
     _children.push_back(child);
     child->_parent = this;
+    invalidate();
 }
 
 /**
@@ -1157,6 +1176,7 @@ void JsonValue::appendChild(const std::string key, const std::shared_ptr<JsonVal
     child->_key = key;
     _children.push_back(child);
     child->_parent = this;
+    invalidate();
 }
 
 /**
@@ -1181,6 +1201,7 @@ void JsonValue::insertChild(unsigned int index, const std::shared_ptr<JsonValue>
     CUAssertLog(isArray() || isObject(), "This node is a value type");
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    invalidate();
 }
 
 /**
@@ -1210,6 +1231,7 @@ void JsonValue::insertChild(unsigned int index, const std::string key,
     child->_key = key;
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    invalidate();
 }
 
 
@@ -0,0 +1,265 @@
+//
+//  CUMaterializeQueue.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a queue for the main thread half of asynchronous
+//  asset loading.  Loaders decode their assets on worker threads, but assets
+//  such as textures and fonts must be finished (materialized) on the main
+//  thread, as they need the OpenGL context.  If every decoded asset is
+//  finished as soon as it is ready, a batch of large textures can stall a
+//  frame.  This queue instead runs the jobs in priority order, stopping each
+//  frame once it has used its time budget.  Large uploads are split into
+//  chunks of rows, so that they can be spread across several frames.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#include <cugl/assets/CUMaterializeQueue.h>
+#include <cugl/util/CUTimestamp.h>
+#include <cugl/util/CUProfiler.h>
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Creates an uninitialized queue.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+MaterializeQueue::MaterializeQueue() :
+_pushed(0),
+_bytes(0),
+_budget(0),
+_chunk(MATERIALIZE_CHUNK),
+_spent(0) {
+}
+
+/**
+ * Disposes this queue, dropping any queued jobs.
+ */
+void MaterializeQueue::dispose() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.clear();
+    _pushed = 0;
+    _bytes  = 0;
+    _spent  = 0;
+    _clock  = nullptr;
+}
+
+/**
+ * Initializes a queue with the given budget.
+ *
+ * @param budget    The number of microseconds {@link process} may use
+ *
+ * @return true if initialization was successful
+ */
+bool MaterializeQueue::init(Uint64 budget) {
+    _budget = budget;
+    _chunk  = MATERIALIZE_CHUNK;
+    return true;
+}
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Returns true if job a should run after job b
+ *
+ * @param a The first job
+ * @param b The second job
+ *
+ * @return true if job a should run after job b
+ */
+bool MaterializeQueue::later(const Job& a, const Job& b) {
+    if (a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    return a.order > b.order;
+}
+
+/**
+ * Returns the current time in microseconds
+ *
+ * @return the current time in microseconds
+ */
+Uint64 MaterializeQueue::now() const {
+    if (_clock) {
+        return _clock();
+    }
+    static Timestamp epoch;
+    Timestamp time;
+    return Timestamp::ellapsedMicros(epoch,time);
+}
+
+#pragma mark -
+#pragma mark Jobs
+/**
+ * Adds a job that runs in a single step.
+ *
+ * This method is safe to call from any thread.  The byte size is only
+ * used to report the backlog.
+ *
+ * @param job       The job to run on the main thread
+ * @param priority  The job priority (lower numbers go first)
+ * @param bytes     The number of bytes the job uploads
+ */
+void MaterializeQueue::push(const std::function<void()>& job, Uint32 priority, size_t bytes) {
+    Job item;
+    item.work = [job](void) {
+        job();
+        return (size_t)0;
+    };
+    item.priority = priority;
+    item.bytes = bytes;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    item.order = _pushed++;
+    _bytes += bytes;
+    _jobs.push_back(std::move(item));
+    std::push_heap(_jobs.begin(), _jobs.end(), later);
+}
+
+/**
+ * Adds a job that uploads an image a band of rows at a time.
+ *
+ * Each band is as many rows as fit in the chunk size (but at least one
+ * row).  This method is safe to call from any thread.
+ *
+ * @param sink      The image to upload
+ * @param priority  The job priority (lower numbers go first)
+ */
+void MaterializeQueue::upload(const std::shared_ptr<UploadSink>& sink, Uint32 priority) {
+    Uint32 height = sink->getHeight();
+    size_t width  = std::max(sink->getRowBytes(),(size_t)1);
+    Uint32 band   = (Uint32)std::max(_chunk/width,(size_t)1);
+
+    Job item;
+    item.work = [=, row = (Uint32)0, begun = false](void) mutable {
+        if (!begun) {
+            begun = true;
+            if (!sink->begin()) {
+                sink->end(false);
+                return (size_t)0;
+            }
+        }
+        Uint32 rows = std::min(band,height-row);
+        if (rows > 0) {
+            sink->upload(row,rows);
+            row += rows;
+        }
+        if (row < height) {
+            return (height-row)*width;
+        }
+        sink->end(true);
+        return (size_t)0;
+    };
+    item.priority = priority;
+    item.bytes = height*width;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    item.order = _pushed++;
+    _bytes += item.bytes;
+    _jobs.push_back(std::move(item));
+    std::push_heap(_jobs.begin(), _jobs.end(), later);
+}
+
+/**
+ * Runs queued jobs until the budget is used, returning the number of steps
+ *
+ * This method must be called from the main thread.  It runs at least one
+ * step if the queue is not empty.
+ *
+ * @return the number of job steps run
+ */
+size_t MaterializeQueue::process() {
+    CU_PROFILE_SCOPE("MaterializeQueue::process");
+    Uint64 start = now();
+    Uint64 spent = 0;
+    size_t steps = 0;
+    while (true) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_jobs.empty()) {
+                break;
+            }
+            std::pop_heap(_jobs.begin(), _jobs.end(), later);
+            job = std::move(_jobs.back());
+            _jobs.pop_back();
+        }
+
+        // Run outside the lock, as workers may push meanwhile
+        size_t left = job.work();
+        steps++;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _bytes -= std::min(_bytes,job.bytes-std::min(left,job.bytes));
+            if (left > 0) {
+                // Keeps its order, so it stays ahead of later jobs
+                job.bytes = left;
+                _jobs.push_back(std::move(job));
+                std::push_heap(_jobs.begin(), _jobs.end(), later);
+            }
+        }
+
+        spent = now()-start;
+        if (spent >= _budget) {
+            break;
+        }
+    }
+    _spent = spent;
+    CU_PROFILE_COUNT("MaterializeQueue::backlog",(double)getBacklog());
+    return steps;
+}
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Returns the number of queued jobs
+ *
+ * @return the number of queued jobs
+ */
+size_t MaterializeQueue::getBacklog() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _jobs.size();
+}
+
+/**
+ * Returns the number of bytes the queued jobs have left to upload
+ *
+ * @return the number of bytes the queued jobs have left to upload
+ */
+size_t MaterializeQueue::getBacklogBytes() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+}
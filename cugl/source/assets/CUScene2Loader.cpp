@@ -422,9 +422,8 @@ bool Scene2Loader::read(const std::string key, const std::string source,
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(node,callback);
-                return false;
             });
         });
     }
@@ -486,9 +485,8 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
         _loader->addTask([=](void) {
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(node,callback);
-                return false;
             });
         });
     }
@@ -152,8 +152,8 @@ bool SoundLoader::read(const std::string key, const std::string source, LoaderCa
         success = (sound != nullptr);
         if (success) {
             sound->setVolume(_volume);
-            materialize(key,sound,callback);
         }
+        materialize(key,sound,callback);
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Sound> sound = nullptr;
@@ -162,11 +162,11 @@ bool SoundLoader::read(const std::string key, const std::string source, LoaderCa
             }
             if (sound != nullptr) {
                 sound->setVolume(_volume);
-                Application::get()->schedule([=](void){
-                    this->materialize(key,sound,callback);
-                    return false;
-                });
             }
+            // Failures must materialize too, to leave the queue
+            this->queueMaterialize([=](void) {
+                this->materialize(key,sound,callback);
+            });
         });
     }
     
@@ -217,8 +217,8 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
         success = (sound != nullptr);
         if (success) {
             sound->setVolume(volume);
-            materialize(key,sound,callback);
         }
+        materialize(key,sound,callback);
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Sound> sound = nullptr;
@@ -229,11 +229,11 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
             }
             if (sound != nullptr) {
                 sound->setVolume(volume);
-                Application::get()->schedule([=](void) {
-                    this->materialize(key,sound,callback);
-                    return false;
-                });
             }
+            // Failures must materialize too, to leave the queue
+            this->queueMaterialize([=](void) {
+                this->materialize(key,sound,callback);
+            });
         });
     }
     
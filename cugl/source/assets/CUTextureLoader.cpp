@@ -45,10 +45,68 @@
 //
 #include <cugl/assets/CUTextureLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/util/CUProfiler.h>
 #include <SDL_image.h>
 
 using namespace cugl;
 
+/**
+ * The upload of a decoded surface into a new texture, a band of rows at a time
+ *
+ * The surface is freed when the sink is deleted, even if the upload never
+ * finished (e.g. the materialization queue was disposed).
+ */
+class TextureSink : public UploadSink {
+private:
+    /** The decoded surface (may be nullptr) */
+    SDL_Surface* _surface;
+    /** The texture being uploaded */
+    std::shared_ptr<Texture> _texture;
+    /** The function to finish the texture (given nullptr on failure) */
+    std::function<void(const std::shared_ptr<Texture>&)> _done;
+
+public:
+    TextureSink(SDL_Surface* surface, const std::function<void(const std::shared_ptr<Texture>&)>& done) :
+    _surface(surface), _done(done) {}
+
+    ~TextureSink() {
+        if (_surface != nullptr) {
+            SDL_FreeSurface(_surface);
+        }
+    }
+
+    Uint32 getHeight() const override {
+        return _surface == nullptr ? 0 : _surface->h;
+    }
+
+    size_t getRowBytes() const override {
+        return _surface == nullptr ? 0 : _surface->pitch;
+    }
+
+    bool begin() override {
+        if (_surface == nullptr) {
+            return false;
+        }
+        _texture = Texture::alloc(_surface->w, _surface->h);
+        return _texture != nullptr;
+    }
+
+    void upload(Uint32 row, Uint32 rows) override {
+        CU_PROFILE_SCOPE("TextureLoader::upload");
+        const Uint8* pixels = (const Uint8*)_surface->pixels;
+        _texture->bind();
+        _texture->set(pixels+row*_surface->pitch, row, rows);
+        _texture->unbind();
+    }
+
+    void end(bool success) override {
+        _done(success ? _texture : nullptr);
+        _texture = nullptr;
+        SDL_FreeSurface(_surface);
+        _surface = nullptr;
+    }
+};
+
 #pragma mark Support Functions
 /** What the source name is if we do not know it */
 #define UNKNOWN_SOURCE  "<unknown>"
@@ -159,6 +217,7 @@ _mipmaps(false) {
  * @return the SDL_Surface with the texture information
  */
 SDL_Surface* TextureLoader::preload(const std::string source) {
+    CU_PROFILE_SCOPE("TextureLoader::preload");
     // Make sure we reference the asset directory
 #if defined (__WINDOWS__)
     bool absolute = (bool)strstr(source.c_str(),":") || source[0] == '\\';
@@ -185,11 +244,12 @@ SDL_Surface* TextureLoader::preload(const std::string source) {
 }
 
 /**
- * Creates an OpenGL texture from the SDL_Surface, and assigns it the given key.
+ * Finishes the uploaded texture, and assigns it the given key.
  *
  * This method finishes the asset loading started in {@link preload}.  This
  * step is not safe to be done in a separate thread.  Instead, it takes
- * place in the main CUGL thread via {@link Application#schedule}.
+ * place in the main CUGL thread, once the materialization queue has
+ * uploaded every row of the SDL_Surface.
  *
  * The loaded texture will have default parameters for scaling and wrap.
  * It will not have any mipmaps.
@@ -198,12 +258,11 @@ SDL_Surface* TextureLoader::preload(const std::string source) {
  * the asset was successfully materialized.
  *
  * @param key       The key to access the asset after loading
- * @param surface   The SDL_Surface to convert
+ * @param texture   The uploaded texture (nullptr if it failed)
  * @param callback  An optional callback for asynchronous loading
  */
-void TextureLoader::materialize(const std::string key, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
-    
+void TextureLoader::materialize(const std::string key, const std::shared_ptr<Texture>& texture, LoaderCallback callback) {
+    CU_PROFILE_SCOPE("TextureLoader::materialize");
     bool success = false;
     if (texture != nullptr) {
         _assets[key] = texture;
@@ -220,16 +279,16 @@ void TextureLoader::materialize(const std::string key, SDL_Surface* surface, Loa
     if (callback != nullptr) {
         callback(key,success);
     }
-    SDL_FreeSurface(surface);
     _queue.erase(key);
 }
                                 
 /**
- * Creates an OpenGL texture from the SDL_Surface accoring to the directory entry.
+ * Finishes the uploaded texture accoring to the directory entry.
  *
  * This method finishes the asset loading started in {@link preload}.  This
  * step is not safe to be done in a separate thread.  Instead, it takes
- * place in the main CUGL thread via {@link Application#schedule}.
+ * place in the main CUGL thread, once the materialization queue has
+ * uploaded every row of the SDL_Surface.
  *
  * This version of read provides support for JSON directories. A texture
  * directory entry has the following values
@@ -249,11 +308,11 @@ void TextureLoader::materialize(const std::string key, SDL_Surface* surface, Loa
  * the asset was successfully materialized.
  *
  * @param json      The asset directory entry
- * @param surface   The SDL_Surface to convert
+ * @param texture   The uploaded texture (nullptr if it failed)
  * @param callback  An optional callback for asynchronous loading
  */
-void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, const std::shared_ptr<Texture>& texture, LoaderCallback callback) {
+    CU_PROFILE_SCOPE("TextureLoader::materialize");
     std::string key = json->key();
 
     bool success = false;
@@ -280,7 +339,6 @@ void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surf
     if (callback != nullptr) {
         callback(key,success);
     }
-    SDL_FreeSurface(surface);
     _queue.erase(key);
 }
 
@@ -317,12 +375,12 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
 		}
         _queue.erase(key);
     } else {
+        Uint32 priority = _matpriority;
         _loader->addTask([=](void) {
             SDL_Surface* surface = this->preload(source);
-            Application::get()->schedule([=](void){
-                this->materialize(key,surface,callback);
-                return false;
-            });
+            this->queueUpload(std::make_shared<TextureSink>(surface,[=](const std::shared_ptr<Texture>& texture) {
+                this->materialize(key,texture,callback);
+            }), priority);
         });
     }
 
@@ -362,6 +420,7 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
  *      "magfilter":    The name of the min filter ("nearest" or "linear")
  *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
  *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+ *      "priority":     The materialization priority (int, lower goes first)
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -386,12 +445,12 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
 		}
         _queue.erase(key);
     } else {
+        Uint32 priority = json->getInt("priority",_matpriority);
         _loader->addTask([=](void) {
             SDL_Surface* surface = this->preload(source);
-            Application::get()->schedule([=](void){
-                this->materialize(json,surface,callback);
-                return false;
-            });
+            this->queueUpload(std::make_shared<TextureSink>(surface,[=](const std::shared_ptr<Texture>& texture) {
+                this->materialize(json,texture,callback);
+            }), priority);
         });
     }
     
@@ -121,9 +121,8 @@ bool WidgetLoader::read(const std::string key, const std::string source, LoaderC
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(key,widget,callback);
-                return false;
             });
         });
     }
@@ -171,9 +170,8 @@ bool WidgetLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
-            Application::get()->schedule([=](void) {
+            this->queueMaterialize([=](void) {
                 this->materialize(key,widget,callback);
-                return false;
             });
         });
     }
@@ -35,6 +35,7 @@
 #include <cugl/render/CUTexture.h>
 #include <cugl/input/CUInput.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUProfiler.h>
 #include <algorithm>
 #include <vector>
 
@@ -44,6 +45,8 @@
 #define DEFAULT_HEIGHT  576
 /** The default smoothing window for fps calculation */
 #define FPS_WINDOW      10
+/** The default cap on fixed updates in one frame */
+#define FIXED_MAX_STEPS 5
 
 using namespace cugl;
 
@@ -68,7 +71,12 @@ _state(State::NONE),
 _fullscreen(false),
 _highdpi(true),
 _fps(0),
+_fixedrate(0),
+_fixedmax(FIXED_MAX_STEPS),
 _vsync(true),
+_fixedmicros(0),
+_fixedtime(0),
+_fixedalpha(1.0f),
 _funcid(0),
 _clearColor(Color4f::CORNFLOWER) // Ah, XNA
 {
@@ -99,6 +107,8 @@ void Application::dispose() {
     _fpswindow.clear();
     _clearColor = Color4f::CORNFLOWER;
     setFPS(60.0f);
+    setFixedRate(0);
+    _fixedmax = FIXED_MAX_STEPS;
 }
 
 /**
@@ -250,13 +260,19 @@ bool Application::getInput() {
     return true;
 }
 
-// TODO: Add a deterministic time step
 /**
  * Processes a single animation frame.
  *
  * This method processes the input, calls the update method, and then
  * draws it.  It also updates any running statics, like the average FPS.
  *
+ * If there is a fixed update rate, the frame time is added to an accumulator
+ * and fixedUpdate is called once for each whole step in it (up to the
+ * maximum), between update and draw.
+ *
+ * When compiled with CU_PROFILING, the frame ends the {@link Profiler}
+ * frame, collecting the events recorded by every thread.
+ *
  * @return false if the application should quit next frame
  */
 bool Application::step() {
@@ -268,21 +284,41 @@ bool Application::step() {
     Uint32 micros   = (Uint32)poststep.ellapsedMicros(_start);
     _start.mark();
     if (running &&  _state == State::FOREGROUND) {
+        CU_PROFILE_SCOPE("Application::step");
         processCallbacks((micros)/1000);
 
         _fpswindow.pop_front();
         _fpswindow.push_back(1000000.0f/micros);
-        update(micros/1000000.0f);
+        {
+            CU_PROFILE_SCOPE("Application::update");
+            update(micros/1000000.0f);
+        }
+
+        if (_fixedmicros > 0) {
+            // Drop any time beyond the catch-up limit
+            _fixedtime = std::min(_fixedtime + micros, _fixedmicros * _fixedmax);
+            float step = _fixedmicros/1000000.0f;
+            while (_fixedtime >= _fixedmicros) {
+                CU_PROFILE_SCOPE("Application::fixedUpdate");
+                fixedUpdate(step);
+                _fixedtime -= _fixedmicros;
+            }
+            _fixedalpha = (float)_fixedtime/_fixedmicros;
+        }
 
         glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
         glStencilMask(0xffffffff);
         glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        draw();
+        {
+            CU_PROFILE_SCOPE("Application::draw");
+            draw(_fixedalpha);
+        }
         Display::get()->refresh();
     } else {
         running = _state == State::BACKGROUND;
     }
+    CU_PROFILE_FRAME();
 
 	// Sleep the remainder
     poststep.mark();
@@ -663,6 +699,29 @@ void Application::setFPS(float fps) {
     }
 }
 
+/**
+ * Sets the fixed update rate of this application.
+ *
+ * If this value is positive, the time of each animation frame is added
+ * to an accumulator, and {@link #fixedUpdate} is called once for every
+ * whole step of 1/rate seconds in it. Hence the simulation advances at
+ * the same speed whatever the frame rate, and a run with the same input
+ * produces the same result. If this value is 0, fixedUpdate is never
+ * called.
+ *
+ * This method may be safely changed at any time while the application
+ * is running. Changing it discards any partial step. By default, this
+ * value is 0.
+ *
+ * @param rate  The fixed updates per second (0 to disable)
+ */
+void Application::setFixedRate(float rate) {
+    _fixedrate = rate > 0 ? rate : 0;
+    _fixedmicros = _fixedrate > 0 ? (Uint64)(1000000.0/_fixedrate + 0.5) : 0;
+    _fixedtime = 0;
+    _fixedalpha = 1.0f;
+}
+
 /**
  * Returns the average frames per second over the last 10 frames.
  *
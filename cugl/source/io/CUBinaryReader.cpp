@@ -55,6 +55,7 @@
 #include <cugl/base/CUApplication.h>
 #include <cugl/base/CUEndian.h>
 #include <cugl/util/CUFiletools.h>
+#include <algorithm>
 
 using namespace cugl;
 
@@ -254,6 +255,55 @@ void BinaryReader::fill(unsigned int bytes) {
     _scursor += amt;
 }
 
+/**
+ * Copies a sequence of fixed size elements from the stream
+ *
+ * Elements are taken from the storage buffer, refilling it as it runs out.
+ * Once the buffer is drained, any request of at least a full buffer is read
+ * straight from the file into the destination, skipping the extra copy.
+ * The elements are not marshalled.
+ *
+ * @param dest      The array to store the data when read
+ * @param maximum   The maximum number of elements to read from the stream
+ * @param bytes     The size of a single element
+ *
+ * @return the number of elements read from the stream
+ */
+size_t BinaryReader::readBlock(char* dest, size_t maximum, unsigned int bytes) {
+    size_t done = 0;
+    while (done < maximum && ready(bytes)) {
+        size_t available = (_bufsize-_bufoff)/bytes;
+        if (available == 0) {
+            size_t wanted = (maximum-done)*bytes;
+            if (wanted >= _capacity) {
+                // Move the partial element and read the rest directly
+                size_t remain = _bufsize-_bufoff;
+                size_t stream = (size_t)(_ssize-_scursor);
+                size_t count = std::min(maximum-done,(remain+stream)/bytes);
+                memcpy(dest+done*bytes,&(_buffer[_bufoff]),remain);
+                size_t amt = SDL_RWread(_stream,dest+done*bytes+remain,1,count*bytes-remain);
+                _scursor += amt;
+                done += (remain+amt)/bytes;
+
+                // Start the buffer over
+                amt = SDL_RWread(_stream,_buffer,1,_capacity);
+                _scursor += amt;
+                _bufsize = (Uint32)amt;
+                _bufoff = 0;
+            } else {
+                fill(bytes);
+            }
+            continue;
+        }
+        size_t wanted = maximum-done;
+        wanted = wanted < available ? wanted : available;
+        memcpy(dest+done*bytes,&(_buffer[_bufoff]),wanted*bytes);
+        _bufoff += (Sint32)(wanted*bytes);
+        done += wanted;
+    }
+    return done;
+}
+
 #pragma mark -
 #pragma mark Single Element Reads
 /**
@@ -455,16 +505,7 @@ double BinaryReader::readDouble()  {
  */
 size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readBlock((char*)&(buffer[offset]), maximum, 1);
 }
 
 /**
@@ -481,16 +522,7 @@ size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readBlock((char*)&(buffer[offset]), maximum, 1);
 }
 
 /**
@@ -510,17 +542,8 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 2);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -544,17 +567,8 @@ size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 2);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -579,17 +593,8 @@ size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 4);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -613,17 +618,8 @@ size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 4);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -647,17 +643,8 @@ size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 8);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -681,17 +668,8 @@ size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 8);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -715,17 +693,8 @@ size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 4);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -749,17 +718,8 @@ size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(double* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
+    size_t pos = offset+readBlock((char*)&(buffer[offset]), maximum, 8);
+    for(size_t ii = offset; ii < pos; ii++) {
         buffer[ii] = marshall(buffer[ii]);
     }
     
@@ -0,0 +1,249 @@
+//
+//  CUChainObstacle.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This class implements a physics object made of line chains.  It is a thin
+//  wrapper around the Box2D chain shape, with one fixture per chain.  Unlike
+//  PolygonObstacle, there is no triangulation and a whole collection of
+//  outlines (e.g. the contours of a level) lives in a single body.  Chains
+//  have no area, so this obstacle is only useful for static geometry.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#include <box2d/b2_chain_shape.h>
+#include <cugl/physics2/CUChainObstacle.h>
+#include <cugl/scene2/graph/CUWireNode.h>
+
+using namespace cugl::physics2;
+
+/** Vertices closer than this are welded (box2d asserts on anything below b2_linearSlop) */
+#define WELD_DISTANCE (2*b2_linearSlop)
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Initializes a chain obstacle from the given paths
+ *
+ * The paths define an implicit coordinate space. The body will be placed
+ * at the given origin position.
+ *
+ * @param paths  The paths (one chain per path)
+ * @param origin The body position with respect to the path vertices
+ *
+ * @return  true if the obstacle is initialized properly, false otherwise.
+ */
+bool ChainObstacle::init(const std::vector<Path2>& paths, const Vec2 origin) {
+    Obstacle::init(Vec2::ZERO);
+    _bodyinfo.position.Set(origin.x,origin.y);
+    setPaths(paths);
+    return true;
+}
+
+/**
+ * Deletes this physics object and all of its resources.
+ */
+ChainObstacle::~ChainObstacle() {
+    CUAssertLog(_body == nullptr, "You must deactive physics before deleting an object");
+}
+
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Sets the paths defining this object
+ *
+ * This change cannot happen immediately.  It must wait until the
+ * next update is called.
+ *
+ * @param paths   the paths defining this object
+ */
+void ChainObstacle::setPaths(const std::vector<Path2>& paths) {
+    _paths = paths;
+    resetShapes();
+    if (_debug != nullptr) {
+        resetDebug();
+    }
+}
+
+/**
+ * Recreates the chain vertices from the paths.
+ *
+ * This must be called whenever the paths change.
+ */
+void ChainObstacle::resetShapes() {
+    _chains.clear();
+    _loops.clear();
+    _bounds = Rect::ZERO;
+
+    Vec2 pos = getPosition();
+    bool first = true;
+    for(auto it = _paths.begin(); it != _paths.end(); ++it) {
+        if (it->vertices.empty()) {
+            continue;
+        }
+        if (first) {
+            _bounds = it->getBounds();
+            first = false;
+        } else {
+            _bounds.merge(it->getBounds());
+        }
+
+        std::vector<b2Vec2> chain;
+        chain.reserve(it->vertices.size());
+        for(auto jt = it->vertices.begin(); jt != it->vertices.end(); ++jt) {
+            b2Vec2 v(jt->x-pos.x, jt->y-pos.y);
+            if (chain.empty() || b2DistanceSquared(v, chain.back()) > WELD_DISTANCE*WELD_DISTANCE) {
+                chain.push_back(v);
+            }
+        }
+
+        // Loops also need the ends to be apart
+        bool loop = it->closed;
+        while (loop && chain.size() > 1 &&
+               b2DistanceSquared(chain.front(), chain.back()) <= WELD_DISTANCE*WELD_DISTANCE) {
+            chain.pop_back();
+        }
+
+        if (chain.size() >= (loop ? 3 : 2)) {
+            _chains.push_back(std::move(chain));
+            _loops.push_back(loop);
+        }
+    }
+    markDirty(true);
+}
+
+
+#pragma mark -
+#pragma mark Scene Graph Methods
+/**
+ * Creates the outline of the physics fixtures in the debug node
+ *
+ * The debug node is use to outline the fixtures attached to this object.
+ * This is very useful when the fixtures have a very different shape than
+ * the texture (e.g. a circular shape attached to a square texture).
+ */
+void ChainObstacle::resetDebug() {
+    std::vector<Vec2> vertices;
+    std::vector<Uint32> indices;
+    for(auto it = _paths.begin(); it != _paths.end(); ++it) {
+        Uint32 start = (Uint32)vertices.size();
+        Uint32 count = (Uint32)it->vertices.size();
+        vertices.insert(vertices.end(), it->vertices.begin(), it->vertices.end());
+        Uint32 segments = it->closed ? count : (count > 0 ? count-1 : 0);
+        for(Uint32 ii = 0; ii < segments; ii++) {
+            indices.push_back(start+ii);
+            indices.push_back(start+(ii+1) % count);
+        }
+    }
+
+    if (_debug == nullptr) {
+        _debug = scene2::WireNode::allocWithTraversal(vertices,indices);
+        _debug->setColor(_dcolor);
+        if (_scene != nullptr) {
+            _scene->addChild(_debug);
+        }
+    } else {
+        _debug->setPolygon(Poly2(vertices));
+        _debug->setTraversal(indices);
+    }
+
+    // Anchor the wireframe at the body position
+    Vec2 anchor = Vec2::ZERO;
+    if (_bounds.size.width > 0 && _bounds.size.height > 0) {
+        anchor.x = (getX()-_bounds.origin.x)/_bounds.size.width;
+        anchor.y = (getY()-_bounds.origin.y)/_bounds.size.height;
+    }
+    _debug->setAnchor(anchor);
+    _debug->setPosition(getPosition());
+}
+
+
+#pragma mark -
+#pragma mark Physics Methods
+/**
+ * Create new fixtures for this body, defining the shape
+ *
+ * This is the primary method to override for custom physics objects
+ */
+void ChainObstacle::createFixtures() {
+    if (_body == nullptr) {
+        return;
+    }
+
+    releaseFixtures();
+
+    // Box2D copies the shape into the fixture, so one scratch shape is enough
+    b2ChainShape shape;
+    std::vector<b2Vec2> reversed;
+    _geoms.reserve(_chains.size()*(_twoSided ? 2 : 1));
+    for(size_t ii = 0; ii < _chains.size(); ii++) {
+        const std::vector<b2Vec2>& chain = _chains[ii];
+        for(int side = 0; side < (_twoSided ? 2 : 1); side++) {
+            const std::vector<b2Vec2>* verts = &chain;
+            if (side == 1) {
+                reversed.assign(chain.rbegin(), chain.rend());
+                verts = &reversed;
+            }
+
+            shape.Clear();
+            if (_loops[ii]) {
+                shape.CreateLoop(verts->data(), (int32)verts->size());
+            } else {
+                // Ghost vertices extend the end segments so the ends stay smooth
+                const b2Vec2& a = verts->front();
+                const b2Vec2& b = verts->back();
+                b2Vec2 prev = a+a-(*verts)[1];
+                b2Vec2 next = b+b-(*verts)[verts->size()-2];
+                shape.CreateChain(verts->data(), (int32)verts->size(), prev, next);
+            }
+            shape.m_radius = _radius;
+            _fixture.shape = &shape;
+            _geoms.push_back(_body->CreateFixture(&_fixture));
+        }
+    }
+    markDirty(false);
+}
+
+/**
+ * Release the fixtures for this body, reseting the shape
+ *
+ * This is the primary method to override for custom physics objects
+ */
+void ChainObstacle::releaseFixtures() {
+    for(auto it = _geoms.begin(); it != _geoms.end(); ++it) {
+        if (*it != nullptr) {
+            _body->DestroyFixture(*it);
+        }
+    }
+    _geoms.clear();
+}
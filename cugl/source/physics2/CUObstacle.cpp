@@ -63,7 +63,10 @@ using namespace cugl::physics2;
 Obstacle::Obstacle() :
 _scene(nullptr),
 _debug(nullptr),
-_listener(nullptr)
+_listener(nullptr),
+_interpolate(false),
+_prevangle(0),
+_nextangle(0)
 { }
 
 /**
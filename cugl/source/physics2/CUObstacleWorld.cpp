@@ -48,6 +48,9 @@
 #include <box2d/b2_collision.h>
 #include <cugl/physics2/CUObstacleWorld.h>
 #include <cugl/physics2/CUObstacle.h>
+#include <cugl/util/CUProfiler.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace cugl;
 using namespace cugl::physics2;
@@ -168,6 +171,8 @@ _filters(false),
 _destroy(false) {
     _lockstep   = false;
     _stepssize  = DEFAULT_WORLD_STEP;
+    _substep    = 0;
+    _maxsubsteps = DEFAULT_WORLD_SUBSTEPS;
     _itvelocity = DEFAULT_WORLD_VELOC;
     _itposition = DEFAULT_WORLD_POSIT;
     _gravity = Vec2(0,DEFAULT_GRAVITY);
@@ -357,15 +362,47 @@ void ObstacleWorld::setGravity(const Vec2 gravity) {
  * physics.  The primary method is the step() method in world.  This implementation
  * works for all applications and should not need to be overwritten.
  *
+ * If there is a substep size, a long step is split into several Box2D steps.
+ * The forces applied before the update act on every one of these substeps
+ * (Box2D would otherwise clear them after the first). The transforms of the
+ * moving objects before and after the whole update are recorded, so that they
+ * can be drawn interpolated.
+ *
  * @param dt    Number of seconds since last animation frame
  */
 void ObstacleWorld::update(float dt) {
+    CU_PROFILE_SCOPE("ObstacleWorld::update");
+    for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
+        if ((*it)->getBodyType() != b2_staticBody) {
+            (*it)->beginStep();
+        }
+    }
+
     // Turn the physics engine crank.
-    _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+    float time = _lockstep ? _stepssize : dt;
+    int steps = 1;
+    if (_substep > 0 && time > _substep) {
+        steps = std::min((int)std::ceil(time/_substep), _maxsubsteps);
+    }
+    // Keep the forces for every substep, and clear them once at the end
+    bool autoclear = _world->GetAutoClearForces();
+    _world->SetAutoClearForces(false);
+    for(int ii = 0; ii < steps; ii++) {
+        CU_PROFILE_SCOPE("ObstacleWorld::step");
+        _world->Step(time/steps,_itvelocity,_itposition);
+    }
+    _world->SetAutoClearForces(autoclear);
+    if (autoclear) {
+        _world->ClearForces();
+    }
+    CU_PROFILE_COUNT("ObstacleWorld::bodies", _world->GetBodyCount());
     
     // Post process all objects after physics (this updates graphics)
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
+        if (obj->getBodyType() != b2_staticBody) {
+            obj->endStep();
+        }
         obj->update(dt);
     }
 }
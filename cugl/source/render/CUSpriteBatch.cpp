@@ -45,6 +45,7 @@
 //
 #include <cugl/math/cu_math.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUProfiler.h>
 #include <cugl/render/CUSpriteBatch.h>
 #include <cugl/render/CUVertexBuffer.h>
 #include <cugl/render/CUTexture.h>
@@ -1133,6 +1134,8 @@ void SpriteBatch::flush() {
     } else if (_context->first != _indxSize) {
         record();
     }
+    CU_PROFILE_SCOPE("SpriteBatch::flush");
+    CU_PROFILE_COUNT("SpriteBatch::vertices", _vertSize);
     
     // Load all the vertex data at once
     _vertbuff->loadVertexData(_vertData, _vertSize);
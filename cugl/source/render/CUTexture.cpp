@@ -394,6 +394,41 @@ const Texture& Texture::set(const void *data) {
 }
 
 
+/**
+ * Sets a band of rows of this texture to the contents of the given buffer.
+ *
+ * The buffer must have the correct data format, and must be of size
+ * width*rows*bytesize.  Its first row becomes the given row of the
+ * texture.  This allows a large image to be uploaded over several frames.
+ *
+ * This method is only successful if the texture is currently active.
+ *
+ * @param data  The buffer to read into the texture
+ * @param row   The first texture row to set
+ * @param rows  The number of rows to set
+ *
+ * @return a reference to this (modified) texture for chaining.
+ */
+const Texture& Texture::set(const void *data, int row, int rows) {
+    if (!isActive()) {
+        CUAssertLog(false,"Texture %s is not currently active.",_name.c_str());
+        return *this;
+    }
+    CUAssertLog(row >= 0 && rows >= 0 && (GLuint)(row+rows) <= _height, "Rows %d to %d are out of range",row,row+rows);
+
+    if (_pixelFormat == PixelFormat::RGBA32F || _pixelFormat == PixelFormat::RGBA16F) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, _width, rows,
+            (GLenum)PixelFormat::RGBA, format_type(_pixelFormat), data);
+    }
+    else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, _width, rows,
+            (GLenum)_pixelFormat, format_type(_pixelFormat), data);
+    }
+
+    return *this;
+}
+
+
 #pragma mark -
 #pragma mark Attributes
 /**
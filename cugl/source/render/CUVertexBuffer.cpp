@@ -102,6 +102,38 @@ bool VertexBuffer::init(GLsizei stride) {
     return true;
 }
 
+/**
+ * Initializes this vertex buffer to share the data of another buffer.
+ *
+ * The new buffer has its own vertex array, and hence its own attributes
+ * and shader, but it draws from the vertex and index data of the source
+ * buffer. This allows the same (large) mesh to be drawn by several shaders
+ * with different attribute layouts while only uploading it once. Loading
+ * data into either buffer changes the data of both.
+ *
+ * The source buffer is kept alive until this buffer is disposed.
+ *
+ * @param source    The buffer owning the vertex and index data
+ *
+ * @return true if initialization was successful.
+ */
+bool VertexBuffer::initWithBuffer(const std::shared_ptr<VertexBuffer>& source) {
+    CUAssertLog(source && source->_vertBuffer, "Source buffer has not been initialized");
+    glGenVertexArrays (1, &_vertArray);
+    if (!_vertArray) {
+        GLenum error = glGetError();
+        CULogError("Could not create vertex array. %s", gl_error_name(error).c_str());
+        return false;
+    }
+
+    // Sharing a chain of buffers only needs the original owner
+    _source = source->_source ? source->_source : source;
+    _stride = source->_stride;
+    _vertBuffer = source->_vertBuffer;
+    _indxBuffer = source->_indxBuffer;
+    return true;
+}
+
 /**
  * Deletes the vertex buffer, freeing all resources.
  *
@@ -113,9 +145,12 @@ void VertexBuffer::dispose() {
     }
     _enabled.clear();
     _attributes.clear();
-    glDeleteBuffers(1,&_indxBuffer);
-    glDeleteBuffers(1,&_vertBuffer);
+    if (_source == nullptr) {
+        glDeleteBuffers(1,&_indxBuffer);
+        glDeleteBuffers(1,&_vertBuffer);
+    }
     glDeleteVertexArrays(1,&_vertArray);
+    _source = nullptr;
     _indxBuffer = 0;
     _vertBuffer = 0;
     _vertArray  = 0;
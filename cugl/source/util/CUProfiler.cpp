@@ -0,0 +1,600 @@
+//
+//  CUProfiler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a lightweight frame profiler.  Code is instrumented
+//  with scoped timers and named counters, which record into a ring buffer
+//  owned by the calling thread.  The buffers are drained on the main thread
+//  once per frame, and the results can be exported as a Chrome trace (open it
+//  in chrome://tracing or Perfetto) or as a CSV summary.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/17/26
+//
+#include <cugl/util/CUProfiler.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/io/CUTextWriter.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Profiler State
+
+namespace {
+
+/** The kind of a recorded event */
+enum class Kind : Uint8 {
+    /** A timed span (the value is the duration in nanoseconds) */
+    SPAN,
+    /** A counter sample (the value is the sample) */
+    COUNT
+};
+
+/** A recorded event */
+struct Event {
+    /** The event name */
+    const char* name;
+    /** The event time in nanoseconds since the profiler started */
+    Uint64 start;
+    /** The span duration in nanoseconds, or the counter value */
+    double value;
+    /** The index of the recording thread (set on collection) */
+    Uint32 thread;
+    /** The kind of event */
+    Kind kind;
+};
+
+/**
+ * The event ring of one thread
+ *
+ * Only the owning thread advances the head, and only the main thread
+ * advances the tail, so neither needs a lock.
+ */
+struct ThreadBuffer {
+    /** The ring of events (a power of two in size) */
+    std::vector<Event> events;
+    /** The mask that wraps an index into the ring */
+    Uint64 mask;
+    /** The index of the next event to write */
+    std::atomic<Uint64> head;
+    /** The index of the next event to collect */
+    std::atomic<Uint64> tail;
+    /** The number of events dropped because the ring was full */
+    std::atomic<Uint64> dropped;
+    /** The index of the thread in the trace */
+    Uint32 thread;
+    /** The thread name in the trace */
+    std::string name;
+};
+
+/** The statistics of one name */
+struct Stats {
+    /** The kind of event */
+    Kind kind;
+    /** The number of events */
+    Uint64 calls;
+    /** The sum of the event values */
+    double total;
+    /** The smallest event value */
+    double min;
+    /** The largest event value */
+    double max;
+};
+
+/** Whether the profiler is recording */
+std::atomic<bool> _active(false);
+/** The clock time the profiler started, in nanoseconds */
+std::atomic<Sint64> _epoch(0);
+/** The lock for everything below (never taken to record an event) */
+std::mutex _mutex;
+/** The buffer of every thread that has recorded (they outlive their threads) */
+std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+/** The ring capacity of new thread buffers */
+size_t _capacity = PROFILER_CAPACITY;
+/** The maximum number of events kept for the trace */
+size_t _limit = PROFILER_HISTORY;
+/** The collected events */
+std::vector<Event> _history;
+/** The statistics of every name pointer */
+std::unordered_map<const char*, Stats> _stats;
+/** The interned names */
+std::unordered_set<std::string> _names;
+/** The number of frames since the profiler started */
+Uint64 _frames = 0;
+/** The number of dropped events, as of the last collection */
+Uint64 _dropped = 0;
+/** Whether we have warned that the history is full */
+bool _full = false;
+
+/** The buffer of the calling thread (nullptr until it records) */
+thread_local ThreadBuffer* _local = nullptr;
+
+/**
+ * Returns the clock time in nanoseconds
+ *
+ * @param time  The clock time
+ */
+Sint64 toNanos(const timestamp_t& time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+/**
+ * Returns the given clock time in nanoseconds since the profiler started
+ *
+ * @param time  The clock time
+ */
+Uint64 sinceEpoch(const timestamp_t& time) {
+    Sint64 nanos = toNanos(time)-_epoch.load(std::memory_order_relaxed);
+    return nanos > 0 ? (Uint64)nanos : 0;
+}
+
+/**
+ * Returns the buffer of the calling thread, creating it if necessary
+ */
+ThreadBuffer* localBuffer() {
+    if (_local == nullptr) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        size_t size = 1;
+        while (size < _capacity) {
+            size <<= 1;
+        }
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events.resize(size);
+        buffer->mask = size-1;
+        buffer->head.store(0);
+        buffer->tail.store(0);
+        buffer->dropped.store(0);
+        buffer->thread = (Uint32)_buffers.size();
+        _local = buffer.get();
+        _buffers.push_back(std::move(buffer));
+    }
+    return _local;
+}
+
+/**
+ * Adds an event to the buffer of the calling thread
+ *
+ * If the buffer is full, the event is dropped.
+ *
+ * @param event The event to add
+ */
+void push(const Event& event) {
+    ThreadBuffer* buffer = localBuffer();
+    Uint64 head = buffer->head.load(std::memory_order_relaxed);
+    if (head-buffer->tail.load(std::memory_order_acquire) > buffer->mask) {
+        buffer->dropped.fetch_add(1,std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[head & buffer->mask] = event;
+    buffer->head.store(head+1,std::memory_order_release);
+}
+
+/**
+ * Moves the events of every thread buffer into the history and statistics
+ *
+ * The caller must hold the lock.
+ */
+void collect() {
+    Uint64 dropped = 0;
+    // Events from one site come in runs, so remember the last lookup
+    const char* name = nullptr;
+    Stats* stats = nullptr;
+    for(auto it = _buffers.begin(); it != _buffers.end(); ++it) {
+        ThreadBuffer* buffer = it->get();
+        Uint64 tail = buffer->tail.load(std::memory_order_relaxed);
+        Uint64 head = buffer->head.load(std::memory_order_acquire);
+        for(Uint64 ii = tail; ii < head; ii++) {
+            Event event = buffer->events[ii & buffer->mask];
+            event.thread = buffer->thread;
+
+            if (event.name != name) {
+                name = event.name;
+                auto found = _stats.find(name);
+                if (found == _stats.end()) {
+                    found = _stats.emplace(name, Stats{event.kind, 0, 0, event.value, event.value}).first;
+                }
+                stats = &(found->second);
+            }
+            stats->calls++;
+            stats->total += event.value;
+            stats->min = std::min(stats->min,event.value);
+            stats->max = std::max(stats->max,event.value);
+
+            if (_history.size() < _limit) {
+                _history.push_back(event);
+            } else if (!_full) {
+                _full = true;
+                CUWarn("Profiler history is full; later events are only summarized");
+            }
+        }
+        buffer->tail.store(head,std::memory_order_release);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    _dropped = dropped;
+}
+
+/**
+ * Returns the statistics merged by name, in name order
+ *
+ * The same name may be recorded through several pointers (e.g. a string
+ * literal used in two files). The caller must hold the lock.
+ */
+std::map<std::string,Stats> merged() {
+    std::map<std::string,Stats> result;
+    for(auto it = _stats.begin(); it != _stats.end(); ++it) {
+        auto found = result.find(it->first);
+        if (found == result.end()) {
+            result.emplace(it->first, it->second);
+        } else {
+            Stats& stats = found->second;
+            stats.calls += it->second.calls;
+            stats.total += it->second.total;
+            stats.min = std::min(stats.min,it->second.min);
+            stats.max = std::max(stats.max,it->second.max);
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the name escaped for a JSON string
+ *
+ * @param name  The name to escape
+ */
+std::string jsonName(const char* name) {
+    std::string result;
+    for(const char* c = name; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            result.push_back('\\');
+            result.push_back(*c);
+        } else if ((unsigned char)*c < 0x20) {
+            result.push_back(' ');
+        } else {
+            result.push_back(*c);
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the name quoted for a CSV cell (if it needs it)
+ *
+ * @param name  The name to quote
+ */
+std::string csvName(const std::string& name) {
+    if (name.find_first_of(",\"\n") == std::string::npos) {
+        return name;
+    }
+    std::string result = "\"";
+    for(auto it = name.begin(); it != name.end(); ++it) {
+        if (*it == '"') {
+            result.push_back('"');
+        }
+        result.push_back(*it);
+    }
+    result.push_back('"');
+    return result;
+}
+
+}
+
+#pragma mark -
+#pragma mark Scope
+/**
+ * Starts timing a span with the given name
+ *
+ * @param name  The span name
+ */
+Profiler::Scope::Scope(const char* name) {
+    if (_active.load(std::memory_order_acquire)) {
+        _name = name;
+        _start = sinceEpoch(cuclock_t::now());
+    } else {
+        _name = nullptr;
+        _start = 0;
+    }
+}
+
+/**
+ * Records the span, if the profiler was active when it started
+ */
+Profiler::Scope::~Scope() {
+    if (_name != nullptr) {
+        Uint64 end = sinceEpoch(cuclock_t::now());
+        push(Event{_name, _start, (double)(end-_start), 0, Kind::SPAN});
+    }
+}
+
+#pragma mark -
+#pragma mark Activation
+/**
+ * Starts recording, discarding anything recorded before
+ *
+ * The capacity only applies to the buffers of threads that have not
+ * recorded yet.  It is rounded up to a power of two.
+ *
+ * @param capacity  The number of events each thread can hold between frames
+ * @param history   The number of events kept for the trace
+ */
+void Profiler::start(size_t capacity, size_t history) {
+    ThreadBuffer* main = localBuffer();
+    std::lock_guard<std::mutex> guard(_mutex);
+    if (main->name.empty()) {
+        main->name = "main";
+    }
+    _capacity = std::max(capacity,(size_t)1);
+    _limit = history;
+    for(auto it = _buffers.begin(); it != _buffers.end(); ++it) {
+        (*it)->tail.store((*it)->head.load(std::memory_order_acquire),std::memory_order_release);
+        (*it)->dropped.store(0,std::memory_order_relaxed);
+    }
+    _history.clear();
+    _history.reserve(std::min(_limit,(size_t)PROFILER_CAPACITY));
+    _stats.clear();
+    _frames = 0;
+    _dropped = 0;
+    _full = false;
+    _epoch.store(toNanos(cuclock_t::now()),std::memory_order_relaxed);
+    _active.store(true,std::memory_order_release);
+}
+
+/**
+ * Stops recording
+ *
+ * The events recorded so far are collected, and can still be exported.
+ */
+void Profiler::stop() {
+    _active.store(false,std::memory_order_release);
+    std::lock_guard<std::mutex> guard(_mutex);
+    collect();
+}
+
+/**
+ * Returns true if the profiler is recording
+ *
+ * @return true if the profiler is recording
+ */
+bool Profiler::isActive() {
+    return _active.load(std::memory_order_acquire);
+}
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Records a span between two timestamps
+ *
+ * This is for spans that do not match a scope, such as the passes of a
+ * renderer that shares one timestamp between them.
+ *
+ * @param name  The span name
+ * @param start The start of the span
+ * @param end   The end of the span
+ */
+void Profiler::record(const char* name, const Timestamp& start, const Timestamp& end) {
+    if (!_active.load(std::memory_order_acquire)) {
+        return;
+    }
+    Uint64 begin = sinceEpoch(start.getTime());
+    Uint64 finish = std::max(begin,sinceEpoch(end.getTime()));
+    push(Event{name, begin, (double)(finish-begin), 0, Kind::SPAN});
+}
+
+/**
+ * Records a sample of a named counter
+ *
+ * @param name  The counter name
+ * @param value The counter value
+ */
+void Profiler::count(const char* name, double value) {
+    if (!_active.load(std::memory_order_acquire)) {
+        return;
+    }
+    push(Event{name, sinceEpoch(cuclock_t::now()), value, 0, Kind::COUNT});
+}
+
+/**
+ * Returns a copy of the name that lives as long as the profiler
+ *
+ * The same string is returned for equal names, so this is safe to call
+ * every frame.  However, it takes a lock, so it is best done once.
+ *
+ * @param name  The name to copy
+ *
+ * @return a copy of the name that lives as long as the profiler
+ */
+const char* Profiler::intern(const std::string& name) {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _names.insert(name).first->c_str();
+}
+
+/**
+ * Names the calling thread in the trace
+ *
+ * @param name  The thread name
+ */
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer* buffer = localBuffer();
+    std::lock_guard<std::mutex> guard(_mutex);
+    buffer->name = name;
+}
+
+/**
+ * Ends a frame, collecting the events of every thread
+ *
+ * This method must be called on the main thread (the one that exports).
+ * {@link Application} calls it at the end of every step.
+ */
+void Profiler::frame() {
+    if (!_active.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_mutex);
+    collect();
+    _frames++;
+}
+
+#pragma mark -
+#pragma mark Results
+/**
+ * Returns the number of frames since the profiler started
+ *
+ * @return the number of frames since the profiler started
+ */
+Uint64 Profiler::getFrames() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _frames;
+}
+
+/**
+ * Returns the number of events dropped because a thread buffer was full
+ *
+ * @return the number of events dropped because a thread buffer was full
+ */
+Uint64 Profiler::getDropped() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _dropped;
+}
+
+/**
+ * Returns the mean of the given span in microseconds (or counter value)
+ *
+ * This only counts the events collected so far.
+ *
+ * @param name  The span or counter name
+ *
+ * @return the mean of the given span in microseconds (or counter value)
+ */
+double Profiler::getMean(const std::string& name) {
+    std::lock_guard<std::mutex> guard(_mutex);
+    Uint64 calls = 0;
+    double total = 0;
+    Kind kind = Kind::SPAN;
+    for(auto it = _stats.begin(); it != _stats.end(); ++it) {
+        if (name == it->first) {
+            calls += it->second.calls;
+            total += it->second.total;
+            kind = it->second.kind;
+        }
+    }
+    if (calls == 0) {
+        return 0;
+    }
+    return kind == Kind::SPAN ? total/calls/1000.0 : total/calls;
+}
+
+/**
+ * Writes the collected events as a Chrome trace
+ *
+ * Spans become complete events, and counters become counter events, with
+ * one track per thread.
+ *
+ * @param file  The path to the trace file
+ *
+ * @return true if the trace was written
+ */
+bool Profiler::writeTrace(const std::string file) {
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(file);
+    if (writer == nullptr) {
+        CULogError("Could not write the profiler trace to %s",file.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    collect();
+
+    char line[256];
+    bool first = true;
+    writer->write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for(auto it = _buffers.begin(); it != _buffers.end(); ++it) {
+        std::string name = (*it)->name.empty() ? "thread "+std::to_string((*it)->thread) : (*it)->name;
+        snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                 first ? "" : ",\n", (*it)->thread);
+        writer->write(line);
+        writer->write(jsonName(name.c_str()));
+        writer->write("\"}}");
+        first = false;
+    }
+    for(auto it = _history.begin(); it != _history.end(); ++it) {
+        writer->write(first ? "{\"name\":\"" : ",\n{\"name\":\"");
+        writer->write(jsonName(it->name));
+        if (it->kind == Kind::SPAN) {
+            snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     it->thread, it->start/1000.0, it->value/1000.0);
+        } else {
+            snprintf(line, sizeof(line), "\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                     it->thread, it->start/1000.0, it->value);
+        }
+        writer->write(line);
+        first = false;
+    }
+    writer->write("\n]}\n");
+    writer->close();
+    CULog("Wrote %zu profiler events to %s",_history.size(),file.c_str());
+    return true;
+}
+
+/**
+ * Writes the summary statistics as a CSV file
+ *
+ * There is one row per span or counter, with the number of calls and the
+ * total, mean, minimum, maximum and per-frame value.  Times are in
+ * microseconds.
+ *
+ * @param file  The path to the CSV file
+ *
+ * @return true if the summary was written
+ */
+bool Profiler::writeSummary(const std::string file) {
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(file);
+    if (writer == nullptr) {
+        CULogError("Could not write the profiler summary to %s",file.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    collect();
+
+    char line[256];
+    writer->write("name,kind,calls,total,mean,min,max,per_frame\n");
+    std::map<std::string,Stats> rows = merged();
+    for(auto it = rows.begin(); it != rows.end(); ++it) {
+        const Stats& stats = it->second;
+        bool span = stats.kind == Kind::SPAN;
+        double scale = span ? 0.001 : 1.0;
+        double frames = _frames > 0 ? (double)_frames : 1.0;
+        writer->write(csvName(it->first));
+        snprintf(line, sizeof(line), ",%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n", span ? "span" : "counter",
+                 (unsigned long long)stats.calls, stats.total*scale, stats.total*scale/stats.calls,
+                 stats.min*scale, stats.max*scale, stats.total*scale/frames);
+        writer->write(line);
+    }
+    writer->close();
+    CULog("Wrote %zu profiler rows to %s",rows.size(),file.c_str());
+    return true;
+}
@@ -6,6 +6,10 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  Each worker has its own task queue, and an idle worker steals from the
+//  others.  Tasks can be submitted for a future, collected in a TaskGroup to
+//  wait on, or spread over an index range with parallelFor.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -30,25 +34,61 @@
 //      3. This notice may not be removed or altered from any source distribution.
 //
 //  Author: Walker White
-//  Version: 11/29/16
+//  Version: 10/17/26
 //
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUProfiler.h>
+#include <algorithm>
+#include <iterator>
+#include <string>
 
 using namespace cugl;
 
+/** How many times an idle worker yields before it sleeps */
+#define POOL_SPIN_YIELDS    64
+
+/** The pool of the calling thread, if it is a worker */
+static thread_local ThreadPool* _currentPool = nullptr;
+/** The index of the calling thread in its pool, if it is a worker */
+static thread_local int _currentIndex = -1;
+
 #pragma mark -
 #pragma mark Constructors
 /**
  * Disposes this thread pool, releasing all memory.
  *
- * A disposed thread pool can be safely reinitialized. However, it is a bad
- * idea to destroy the thread pool if the pool is not yet shut down. The
- * task queue is shared by the child threads, so we cannot delete it until
- * all the threads complete.  This destructor will block unti showndown.
+ * This stops the pool and blocks until every worker has finished its
+ * current task (without spinning).  Tasks that never started are
+ * discarded, and any {@link TaskGroup} waiting on them is told they were
+ * cancelled.  A disposed thread pool can be safely reinitialized.
  */
 void ThreadPool::dispose() {
     stop();
-    while (!isShutdown());
+    for (auto&& worker : _workers) {
+#ifdef CU_SDL_THREADS
+        int status;
+        SDL_WaitThread(worker,&status);
+#else
+        if (worker.joinable()) {
+            worker.join();
+        }
+#endif
+    }
+    // Drop the tasks that never started outside of the queue locks, as a
+    // dropped group task wakes its group (which may look at the queues)
+    std::vector< std::function<void()> > dropped;
+    for (auto&& queue : _queues) {
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        std::move(queue->tasks.begin(), queue->tasks.end(), std::back_inserter(dropped));
+        queue->tasks.clear();
+    }
+    _pending = 0;
+    dropped.clear();
+    _workers.clear();
+    _queues.clear();
+    _deal = 0;
+    _complete = 0;
+    _stop = false;
 }
 
 /**
@@ -63,11 +103,20 @@ void ThreadPool::dispose() {
  * @return true if the threed pool is initialized properly, false otherwise.
  */
 bool ThreadPool::init(int threads) {
+    if (!_workers.empty()) {
+        return false;
+    }
+    // Every queue must exist before any worker can steal from it
+    for (int index = 0; index < threads; ++index) {
+        _queues.emplace_back(std::make_unique<TaskQueue>());
+        _queues.back()->pool = this;
+        _queues.back()->index = index;
+    }
     for (int index = 0; index < threads; ++index) {
 #ifdef CU_SDL_THREADS
-        _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)this));
+        _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)_queues[index].get()));
 #else
-        _workers.emplace_back(std::thread(std::bind(&ThreadPool::threadFunc, this)));
+        _workers.emplace_back(std::thread(std::bind(&ThreadPool::threadFunc, this, index)));
 #endif
     }
     return true;
@@ -80,66 +129,155 @@ bool ThreadPool::init(int threads) {
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
+ * This function pulls tasks from the queue of the worker, or steals them
+ * from the other workers, and sleeps when there are none.
  *
  * This implementation is safe to use with std::thread.
+ *
+ * @param index The index of the worker
  */
-void ThreadPool::threadFunc() {
+void ThreadPool::threadFunc(int index) {
+    _currentPool = this;
+    _currentIndex = index;
+#ifdef CU_PROFILING
+    Profiler::setThreadName("Pool Dispatch "+std::to_string(index));
+#endif
     while (!_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(_queueMutex);
-            if (_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!_taskQueue.empty()) {
-                task = std::move(_taskQueue.front());
-                _taskQueue.pop();
-            } else {
-                _taskCondition.wait(lk);
-                continue;
-            }
+        std::function<void()> task = take(index);
+        if (task) {
+            // Perform the current task
+            task();
+            continue;
         }
-        // Perform the current task
-        task();
+
+        // Tasks tend to come in bursts, so yield a little before sleeping
+        for (int spin = 0; spin < POOL_SPIN_YIELDS && _pending <= 0 && !_stop; spin++) {
+            std::this_thread::yield();
+        }
+        if (_pending > 0) {
+            continue;
+        }
+
+        // Sleep until there is a task.  A pusher reads _sleeping after it
+        // raises _pending, so one of us always sees the other.
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _sleeping++;
+        _taskCondition.wait(lk, [this] { return _stop || _pending > 0; });
+        _sleeping--;
     }
+    _currentPool = nullptr;
+    _currentIndex = -1;
     _complete++;
 }
 
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
- *
  * This static implementation uses the SDL thread API.  It should be used
  * on Android and Windows, which have special thread requirements.
+ *
+ * @param ptr   The task queue of the worker
  */
 int ThreadPool::sdlThreadFunc(void* ptr) {
-    ThreadPool* self = (ThreadPool*)ptr;
-    while (!self->_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(self->_queueMutex);
-            if (self->_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!self->_taskQueue.empty()) {
-                task = std::move(self->_taskQueue.front());
-                self->_taskQueue.pop();
-            } else {
-                self->_taskCondition.wait(lk);
-                continue;
-            }
+    TaskQueue* queue = (TaskQueue*)ptr;
+    queue->pool->threadFunc(queue->index);
+    return 0;
+}
+
+/**
+ * Queues a task and wakes a worker for it if they are all asleep
+ *
+ * @param task  The task to queue
+ */
+void ThreadPool::push(std::function<void()>&& task) {
+    if (_queues.empty()) {
+        // Nothing would ever take it
+        return;
+    }
+    int index = currentIndex();
+    if (index < 0) {
+        index = (int)(_deal++ % _queues.size());
+    }
+    {
+        TaskQueue* queue = _queues[index].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        queue->tasks.push_back(std::move(task));
+    }
+    // A thief may have taken it already (leaving the count briefly negative)
+    _pending++;
+    if (_sleeping > 0) {
+        std::lock_guard<std::mutex> lk(_sleepMutex);
+        _taskCondition.notify_one();
+    }
+}
+
+/**
+ * Takes a task for the given worker, stealing one if it has none.
+ *
+ * @param index The index of the worker (-1 for a thread outside the pool)
+ *
+ * @return the task, or an empty function if no task is queued
+ */
+std::function<void()> ThreadPool::take(int index) {
+    std::function<void()> task = nullptr;
+    if (_pending <= 0) {
+        return task;
+    }
+    if (index >= 0) {
+        TaskQueue* queue = _queues[index].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!queue->tasks.empty()) {
+            task = std::move(queue->tasks.front());
+            queue->tasks.pop_front();
+            _pending--;
+            return task;
+        }
+    }
+
+    // Steal the newest task of another worker, leaving it the older ones
+    size_t count = _queues.size();
+    size_t first = index >= 0 ? index+1 : 0;
+    for (size_t ii = 0; ii < count; ii++) {
+        TaskQueue* queue = _queues[(first+ii) % count].get();
+        if (queue->index == index) {
+            continue;
         }
-        // Perform the current task
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!queue->tasks.empty()) {
+            task = std::move(queue->tasks.back());
+            queue->tasks.pop_back();
+            _pending--;
+            return task;
+        }
+    }
+    return task;
+}
+
+/**
+ * Runs one queued task on the calling thread, if there is one
+ *
+ * This is how a thread waiting on a {@link TaskGroup} helps out, rather
+ * than blocking a worker the group may need.
+ *
+ * @return true if a task was run
+ */
+bool ThreadPool::runPending() {
+    std::function<void()> task = take(currentIndex());
+    if (task) {
         task();
+        return true;
     }
-    self->_complete++;
-    return 0;
+    return false;
 }
 
+/**
+ * Returns the index of the calling thread in this pool (-1 if it is not a worker)
+ *
+ * @return the index of the calling thread in this pool (-1 if it is not a worker)
+ */
+int ThreadPool::currentIndex() const {
+    return _currentPool == this ? _currentIndex : -1;
+}
 
 
 #pragma mark -
@@ -155,9 +293,51 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
  * @param  task     the task function to add to the thread pool
  */
 void ThreadPool::addTask(const std::function<void()> &task){
-    std::unique_lock<std::mutex> lk(_queueMutex);
-    _taskQueue.emplace(task);
-    _taskCondition.notify_one();
+    push(std::function<void()>(task));
+}
+
+/**
+ * Runs the body over an index range, split across the workers.
+ *
+ * The range [begin,end) is cut into chunks of grain indices (the last
+ * may be shorter), and body is called with the bounds of each chunk.  The
+ * calling thread works on the chunks too, and this method returns once
+ * every chunk is done.  The chunks are handed out as threads ask for them,
+ * so an uneven body still balances.  Pick a grain so that a chunk is
+ * worth at least a few microseconds.
+ *
+ * It is safe to call this from a task of this pool.
+ *
+ * @param begin The first index
+ * @param end   The index after the last one
+ * @param grain The number of indices in a chunk
+ * @param body  The function called with the bounds of each chunk
+ */
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t,size_t)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    grain = std::max(grain,(size_t)1);
+    size_t chunks = (end-begin+grain-1)/grain;
+
+    // Each helper takes chunks until there are none left
+    std::atomic<size_t> next(0);
+    auto work = [&](void) {
+        size_t chunk;
+        while ((chunk = next++) < chunks) {
+            size_t first = begin+chunk*grain;
+            body(first,std::min(first+grain,end));
+        }
+    };
+
+    size_t helpers = _stop ? 0 : std::min(chunks-1,_workers.size());
+    TaskGroup group(this);
+    for (size_t ii = 0; ii < helpers; ii++) {
+        group.run(work);
+    }
+    work();
+    group.wait();
 }
 
 /**
@@ -168,18 +348,106 @@ void ThreadPool::addTask(const std::function<void()> &task){
  * threads have finished with their tasks.
  */
 void ThreadPool::stop() {
-    {
-        std::unique_lock<std::mutex> lk(_queueMutex);
-        _stop = true;
-        _taskCondition.notify_all();
+    std::lock_guard<std::mutex> lk(_sleepMutex);
+    _stop = true;
+    _taskCondition.notify_all();
+}
+
+
+#pragma mark -
+#pragma mark Task Group
+/**
+ * Deletes this task group, after waiting for its tasks
+ */
+TaskGroup::~TaskGroup() {
+    // Nothing may refer to the group once it is gone, error or not
+    while (_running > 0) {
+        try {
+            wait();
+        } catch (...) {
+        }
     }
-    
-    for (auto&& worker : _workers) {
-#ifdef CU_SDL_THREADS
-        int status;
-        SDL_WaitThread(worker,&status);
-#else
-        worker.join();
-#endif
+}
+
+/**
+ * Marks a task as finished, waking the waiting thread
+ *
+ * @param ran   Whether the task ran (false if the pool dropped it)
+ */
+void TaskGroup::finish(bool ran) {
+    // Decrement under the lock, so the group outlives this call
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (!ran && !_error) {
+        _error = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+    }
+    _running--;
+    _finished++;
+    _finishCondition.notify_all();
+}
+
+/**
+ * Adds a task to the group and the pool
+ *
+ * If the pool has no workers or has stopped, the task runs immediately.
+ *
+ * @param task  The task function to add
+ */
+void TaskGroup::run(const std::function<void()>& task) {
+    _running++;
+    // The task finishes when the pool lets go of it, so one the pool drops
+    // unrun still finishes (as cancelled) and never leaves wait hanging
+    std::shared_ptr<bool> ran(new bool(false), [this](bool* flag) {
+        finish(*flag);
+        delete flag;
+    });
+    auto body = [this,task,ran](void) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+        *ran = true;
+    };
+    ran = nullptr;
+    if (_pool == nullptr || _pool->isStopped() || _pool->getThreadCount() == 0) {
+        body();
+    } else {
+        _pool->push(std::move(body));
+    }
+}
+
+/**
+ * Blocks until every task in the group is done
+ *
+ * The calling thread runs queued tasks of the pool while it waits, and
+ * sleeps when there are none.  If a task threw, or was cancelled by the
+ * pool, the first exception is rethrown (once).
+ */
+void TaskGroup::wait() {
+    while (true) {
+        Uint64 finished;
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            if (_running == 0) {
+                if (_error) {
+                    std::exception_ptr error = _error;
+                    _error = nullptr;
+                    std::rethrow_exception(error);
+                }
+                return;
+            }
+            finished = _finished;
+        }
+        // Run queued tasks (ours or not) instead of idling a thread
+        if (_pool != nullptr && _pool->runPending()) {
+            continue;
+        }
+        // Our tasks are running elsewhere.  Sleep until one finishes, as it
+        // may have queued more for us to help with.
+        std::unique_lock<std::mutex> lk(_mutex);
+        _finishCondition.wait(lk, [&] { return _running == 0 || _finished != finished; });
     }
 }
@@ -88,6 +88,7 @@ b2Shape* b2ChainShape::Clone(b2BlockAllocator* allocator) const
 	void* mem = allocator->Allocate(sizeof(b2ChainShape));
 	b2ChainShape* clone = new (mem) b2ChainShape;
 	clone->CreateChain(m_vertices, m_count, m_prevVertex, m_nextVertex);
+	clone->m_radius = m_radius;
 	return clone;
 }
 